@@ -0,0 +1,101 @@
+#include <Arduino.h>
+#include "ConnectionEventTracker.h"
+
+// Number of packets required before the estimate is used.
+#define TRACKER_LOCK_SAMPLE_COUNT 4
+// The receptions the estimate is acquired from must be within 1/8 of the
+// Connection-Interval of each other (also bounds the spread of the receptions).
+#define TRACKER_LOCK_TOLERANCE_DIVISOR 8
+// Maximum adjustment (per packet) of the estimated anchor towards
+// later receptions (in µs).
+#define TRACKER_MAX_DRIFT_CORRECTION 20L
+
+ConnectionEventTracker::ConnectionEventTracker()
+  : m_interval(0),
+    m_anchor(0),
+    m_spread(0),
+    m_sampleCount(0) {}
+
+void ConnectionEventTracker::reset() {
+  m_anchor = 0;
+  m_spread = 0;
+  m_sampleCount = 0;
+}
+
+void ConnectionEventTracker::setConnectionInterval(unsigned long interval) {
+  if (interval != m_interval) {
+    m_interval = interval;
+    reset();
+  }
+}
+
+void ConnectionEventTracker::onPacketReceived(unsigned long receivedTime) {
+  if (m_interval == 0) return;
+
+  long residual = getResidual(receivedTime);
+  long tolerance = (long)m_interval / TRACKER_LOCK_TOLERANCE_DIVISOR;
+  if (m_sampleCount == 0 || (!isLocked() && abs(residual) > tolerance)) {
+    // Acquisition (re)started: A reception inconsistent with the ones before is due to
+    // a packet delayed by most of the Connection-Interval (it or one before).
+    m_anchor = receivedTime;
+    m_spread = 0;
+    m_sampleCount = 1;
+    return;
+  }
+
+  if (residual < 0) {
+    if (isLocked() && -residual > m_spread + TRACKER_MAX_DRIFT_CORRECTION) {
+      // Earlier than the estimate could be late: A packet delayed by 3/4 of the
+      // Connection-Interval (or more), that must not re-anchor the estimate.
+      return;
+    }
+
+    // Received earlier than any packet before: Use as the new anchor.
+    m_anchor = receivedTime;
+    m_spread = min(m_spread - residual, tolerance);
+  } else {
+    // Keep the anchor close to the most recent Connection-Event (the
+    // subtraction is overflow-safe) and follow drift.
+    m_anchor = receivedTime - residual + min(residual, TRACKER_MAX_DRIFT_CORRECTION);
+    if (residual <= tolerance) {
+      m_spread = max(m_spread - 1, residual);
+    }
+  }
+
+  if (m_sampleCount < TRACKER_LOCK_SAMPLE_COUNT) {
+    m_sampleCount++;
+  }
+}
+
+bool ConnectionEventTracker::isLocked() {
+  return m_sampleCount >= TRACKER_LOCK_SAMPLE_COUNT;
+}
+
+unsigned long ConnectionEventTracker::getAnchor(unsigned long receivedTime) {
+  if (!isLocked()) return receivedTime;
+
+  long residual = getResidual(receivedTime);
+  if (residual >= 0) return receivedTime - residual;
+  // Received before the anchor, but not earlier than it could be late.
+  if (-residual <= m_spread + TRACKER_MAX_DRIFT_CORRECTION) return receivedTime;
+  // Delayed by 3/4 of the Connection-Interval (or more): Attributed to the preceding
+  // Connection-Event.
+  return receivedTime - (residual + (long)m_interval);
+}
+
+// Private
+
+long ConnectionEventTracker::getResidual(unsigned long receivedTime) {
+  // Note: `receivedTime` may precede the estimated anchor.
+  long phase = (long)(receivedTime - m_anchor) % (long)m_interval;
+  if (phase < 0) {
+    phase += m_interval;
+  }
+
+  // Receptions are only delayed (never early), thus late receptions up to
+  // 3/4 of the Connection-Interval are still attributed to the preceding anchor.
+  if (phase >= (long)(m_interval * 3 / 4)) {
+    return phase - (long)m_interval;
+  }
+  return phase;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+/// Estimates the anchors of the Connection-Events (BLE) of an established
+/// connection from the reception times of the packets sent by the Central.
+///
+/// Background: The Central transmits its packets at the anchor of a Connection-Event.
+/// The host receives them with a delay, that is (mostly) constant, but sometimes
+/// exceeded (i.e. when the loop is busy). Thus the anchor is acquired from the earliest
+/// receptions (phase of the Connection-Interval), slowly following later receptions
+/// to account for the drift between the Central's and our clock. Once locked, a
+/// reception before the anchor only re-anchors the estimate within the spread of the
+/// receptions (the estimate could be that late): Otherwise it has been delayed by 3/4 of
+/// the Connection-Interval (or more) and wrapped to the next Connection-Event.
+///
+/// All times are specified in µs (i.e. `micros()`).
+class ConnectionEventTracker {
+public:
+  ConnectionEventTracker();
+
+  /// Discards the current estimate.
+  void reset();
+  /// Sets the Connection-Interval. Discards the current estimate, if the
+  /// Connection-Interval changed.
+  void setConnectionInterval(unsigned long interval);
+
+  /// Feeds the reception time of a packet sent by the Central.
+  void onPacketReceived(unsigned long receivedTime);
+
+  /// `true`, if the anchor has been estimated from a sufficient number of packets.
+  bool isLocked();
+  /// Returns the estimated anchor of the Connection-Event in which a packet
+  /// that was received at `receivedTime` was transmitted.
+  ///
+  /// Returns `receivedTime`, if the tracker is not locked. A reception earlier than the
+  /// estimate could be late is attributed to the preceding Connection-Event.
+  unsigned long getAnchor(unsigned long receivedTime);
+
+private:
+  unsigned long m_interval;
+  /// Estimated anchor of any (past) Connection-Event.
+  unsigned long m_anchor;
+  /// Spread (in µs) of the recent receptions after the anchor (decays slowly, at most
+  /// 1/8 of the Connection-Interval): The estimate may be late by that much.
+  long m_spread;
+  /// Number of packets the estimate is based on.
+  unsigned int m_sampleCount;
+
+  /// Returns the offset of `receivedTime` in the Connection-Event relative to
+  /// the estimated anchor. Negative values indicate receptions before the anchor.
+  long getResidual(unsigned long receivedTime);
+};
@@ -1,32 +1,36 @@
 #include <Arduino.h>
+#include "Globals.hpp"
+
+#ifndef HEADLESS
+
 #include "ErrorViewController.h"
 #include "Resources.h"
-#include <memory>
 
 ErrorViewController::ErrorViewController()
-  : m_error(NULL) {}
+  : m_fault(),
+    m_hasFault(false) {}
 
-void ErrorViewController::setError(Signalboy::Error *error) {
-  // auto errorMoved = std::move(error);
-  // m_error = &errorMoved;
-  m_error = error;
+void ErrorViewController::setFault(const FaultRecord &fault) {
+  m_fault = fault;
+  m_hasFault = true;
+  setNeedsDisplay();
 }
 
 arduino::String ErrorViewController::getLine1() {
   arduino::String string = Resources::shared->errorCodeLabelPrefix;
-  if (m_error) {
+  if (m_hasFault) {
     string += "0x";
-    string += String(m_error->getDomain(), HEX);
+    string += String(m_fault.domain, HEX);
     string += " ";
-    string += String(m_error->getCode(), HEX);
+    string += String(m_fault.code, HEX);
   }
   return string;
 }
 
 arduino::String ErrorViewController::getLine2() {
   arduino::String string = "(";
-  if (m_error) {
-    string += m_error->getMsg();
+  if (m_hasFault) {
+    string += getFaultMessage(m_fault.domain, m_fault.code);
   }
   string += ")";
   return string;
@@ -34,4 +38,6 @@ arduino::String ErrorViewController::getLine2() {
 
 void ErrorViewController::update() {}
 
-void ErrorViewController::onButtonPushed(Button_t button) {}
\ No newline at end of file
+void ErrorViewController::onButtonPushed(Button_t button) {}
+
+#endif /* HEADLESS */
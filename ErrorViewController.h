@@ -1,11 +1,11 @@
 #include "ViewController.h"
-#include "Error.h"
+#include "fault.h"
 
 class ErrorViewController : public ViewController {
 public:
   ErrorViewController();
 
-  void setError(Signalboy::Error *error);
+  void setFault(const FaultRecord &fault);
 
   // ViewController
   arduino::String getLine1();
@@ -16,5 +16,6 @@ public:
   void onButtonPushed(Button_t button);
 
 private:
-  Signalboy::Error *m_error;
+  FaultRecord m_fault;
+  bool m_hasFault;
 };
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include <Arduino.h>
+#include "Globals.hpp"
+
+#ifndef HEADLESS
+
+#include "FaultLogViewController.h"
+#include "Resources.h"
+#include "faultLog.h"
+
+// Constants
+#define TIMEOUT_FAULT_LOG 15 * 1000UL  // in ms
+
+FaultLogViewController::FaultLogViewController()
+  : m_dismissHandler(nullptr),
+    m_index(0),
+    m_faultsCount(0),
+    m_lastInteractionTime(0) {}
+
+void FaultLogViewController::setDismissHandler(DismissHandler dismissHandler) {
+  m_dismissHandler = dismissHandler;
+}
+
+void FaultLogViewController::reset() {
+  m_index = 0;
+  m_faultsCount = faultsCount();
+  m_lastInteractionTime = millis();
+  setNeedsDisplay();
+}
+
+arduino::String FaultLogViewController::getLine1() {
+  FaultRecord fault;
+  if (!faultAt(m_index, &fault)) {
+    return Resources::shared->noFaults;
+  }
+
+  arduino::String string = String(m_index + 1);
+  string += "/";
+  string += String(storedFaultsCount());
+  string += " 0x";
+  string += String(fault.domain, HEX);
+  string += " ";
+  string += String(fault.code, HEX);
+  string += " ";
+  string += String(fault.time / 1000);
+  string += "s";
+  return string;
+}
+
+arduino::String FaultLogViewController::getLine2() {
+  FaultRecord fault;
+  if (!faultAt(m_index, &fault)) {
+    return "";
+  }
+
+  arduino::String string = "(";
+  string += getFaultMessage(fault.domain, fault.code);
+  string += ")";
+  return string;
+}
+
+void FaultLogViewController::update() {
+  if (millis() - m_lastInteractionTime >= TIMEOUT_FAULT_LOG) {
+    dismiss();
+    return;
+  }
+
+  // A new fault: Keep the selected one (unless overwritten).
+  uint16_t count = faultsCount();
+  if (count != m_faultsCount) {
+    unsigned int index = m_index + (uint16_t)(count - m_faultsCount);
+    m_index = min(index, (unsigned int)FAULT_LOG_SIZE - 1);
+    m_faultsCount = count;
+    setNeedsDisplay();
+  }
+}
+
+void FaultLogViewController::onButtonPushed(Button_t button) {
+  m_lastInteractionTime = millis();
+
+  switch (button) {
+    case btnUP:
+      if (m_index > 0) m_index--;
+      break;
+    case btnDOWN:
+      if (m_index + 1 < storedFaultsCount()) m_index++;
+      break;
+    case btnLEFT:
+    case btnSELECT:
+      dismiss();
+      return;
+    default:
+      return;
+  }
+  setNeedsDisplay();
+}
+
+void FaultLogViewController::dismiss() {
+  if (m_dismissHandler) m_dismissHandler();
+}
+
+#endif /* HEADLESS */
@@ -0,0 +1,35 @@
+#include "ViewController.h"
+
+/// Browses the faults of the log (s. faultLog.h), from the latest to the oldest: UP and
+/// DOWN select the next newer or older fault, LEFT or SELECT dismiss the log.
+class FaultLogViewController : public ViewController {
+public:
+  typedef void (*DismissHandler)(void);
+
+  FaultLogViewController();
+
+  void setDismissHandler(DismissHandler dismissHandler);
+
+  /// Selects the latest fault.
+  void reset();
+
+  // ViewController
+  arduino::String getLine1();
+  arduino::String getLine2();
+  void update();
+
+  // IResponder
+  void onButtonPushed(Button_t button);
+
+private:
+  DismissHandler m_dismissHandler;
+  /// Index of the selected fault (0: the latest one).
+  uint8_t m_index;
+  /// `faultsCount()` when displayed last: The indices shift with every new fault.
+  uint16_t m_faultsCount;
+  /// Time when user last interacted with the log.
+  /// (Used for timeout.)
+  unsigned long m_lastInteractionTime;
+
+  void dismiss();
+};
\ No newline at end of file
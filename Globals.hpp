@@ -4,6 +4,25 @@
 // Uncomment to set Debug-Flag (or pass via compiler-flag)
 // #define DEBUG
 
+// Uncomment to enable the Broadcast-Observer (s. observer.h)
+// #define OBSERVER_MODE
+
+// Uncomment to enable the timeline trace (s. trace.h)
+// #define TRACE
+
+// Uncomment to record the inputs (s. recorder.h)
+// #define RECORD
+
+// Uncomment to let the loop sleep while idle (s. idle.h)
+// #define IDLE_SLEEP
+
+// Uncomment to watch the loop for stalls (s. watchdog.h)
+// #define WATCHDOG
+
+// Uncomment to build without the LCD Keypad Shield: The state is shown by the status-LED
+// instead (s. statusLed.h). Set by the build profile "headless" (s. `sketch.yaml`).
+// #define HEADLESS
+
 class Logger;
 extern Logger Log;
 
@@ -0,0 +1,114 @@
+#include <Arduino.h>
+#include "HCITap.h"
+
+#define HCI_EVENT_HEADER_SIZE 2
+#define HCI_ACLDATA_HEADER_SIZE 4
+
+HCITap hciTap(&HCITransport);
+
+HCITap::HCITap(HCITransportInterface *transport)
+  : m_transport(transport),
+    m_packetHandlers(),
+    m_packetHandlerCount(0),
+    m_hasPendingTime(false),
+    m_pendingTime(0),
+    m_packetType(0),
+    m_packetReceivedTime(0),
+    m_receivedLength(0),
+    m_packetLength(0) {}
+
+bool HCITap::addPacketHandler(HCITapPacketHandler handler) {
+  if (m_packetHandlerCount >= HCI_TAP_MAX_HANDLERS) return false;
+
+  m_packetHandlers[m_packetHandlerCount++] = handler;
+  return true;
+}
+
+// HCITransportInterface
+
+int HCITap::begin() {
+  reset();
+  m_hasPendingTime = false;
+  return m_transport->begin();
+}
+
+void HCITap::end() {
+  m_transport->end();
+}
+
+void HCITap::wait(unsigned long timeout) {
+  m_transport->wait(timeout);
+}
+
+int HCITap::available() {
+  int count = m_transport->available();
+
+  // Capture the time bytes are available as early as the tap can: ArduinoBLE
+  // checks for available bytes on every poll, before reading them. (Bytes received
+  // by the UART while the loop was busy are only observed by the next poll.)
+  if (count > 0 && !m_hasPendingTime) {
+    m_pendingTime = micros();
+    m_hasPendingTime = true;
+  }
+
+  return count;
+}
+
+int HCITap::peek() {
+  return m_transport->peek();
+}
+
+int HCITap::read() {
+  int b = m_transport->read();
+  if (b >= 0) {
+    handleByte(b);
+  }
+
+  return b;
+}
+
+size_t HCITap::write(const uint8_t *data, size_t length) {
+  return m_transport->write(data, length);
+}
+
+// Private
+
+void HCITap::reset() {
+  m_packetType = 0;
+  m_packetReceivedTime = 0;
+  m_receivedLength = 0;
+  m_packetLength = 0;
+}
+
+void HCITap::handleByte(uint8_t b) {
+  if (m_packetType == 0) {
+    // Start of packet: Only events and ACL-data are expected from the controller.
+    if (b == HCI_EVENT_PKT || b == HCI_ACLDATA_PKT) {
+      m_packetType = b;
+      m_packetReceivedTime = m_hasPendingTime ? m_pendingTime : micros();
+    }
+    return;
+  }
+
+  if (m_receivedLength < HCI_TAP_CAPTURE_SIZE) {
+    m_buffer[m_receivedLength] = b;
+  }
+  m_receivedLength++;
+
+  // Determine packet length once header is complete.
+  if (m_packetType == HCI_EVENT_PKT && m_receivedLength == HCI_EVENT_HEADER_SIZE) {
+    m_packetLength = HCI_EVENT_HEADER_SIZE + m_buffer[1];
+  } else if (m_packetType == HCI_ACLDATA_PKT && m_receivedLength == HCI_ACLDATA_HEADER_SIZE) {
+    m_packetLength = HCI_ACLDATA_HEADER_SIZE + (m_buffer[2] | (m_buffer[3] << 8));
+  }
+
+  if (m_packetLength > 0 && m_receivedLength >= m_packetLength) {
+    for (uint8_t i = 0; i < m_packetHandlerCount; i++) {
+      m_packetHandlers[i](m_packetType, m_buffer, min(m_receivedLength, HCI_TAP_CAPTURE_SIZE), m_packetReceivedTime);
+    }
+    reset();
+    // Bytes of any subsequent packet are already available (but have not been
+    // observed separately).
+    m_hasPendingTime = false;
+  }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <utility/HCITransport.h>
+
+// HCI packet indicators (H4 framing)
+#define HCI_COMMAND_PKT 0x01
+#define HCI_ACLDATA_PKT 0x02
+#define HCI_EVENT_PKT 0x04
+
+// Number of bytes of every packet that will be captured (and passed to the
+// packet handler). Remaining bytes of larger packets are passed through only.
+#define HCI_TAP_CAPTURE_SIZE 48
+// Maximum number of packet handlers.
+#define HCI_TAP_MAX_HANDLERS 4
+
+/// Called for every packet received from the controller.
+/// - `data`: The packet (w/o the packet indicator), starting with the packet's header.
+/// - `length`: Number of captured bytes in `data` (s. `HCI_TAP_CAPTURE_SIZE`).
+/// - `receivedTime`: Time (in µs, `micros()`) at which the packet's first byte was
+///   observed to be available from the wrapped transport: When ArduinoBLE polls it (from
+///   the loop, s. `BLE.poll()`), not when the UART received it. It excludes the parsing
+///   and dispatching by ArduinoBLE, but not the latency of the loop until the poll.
+typedef void (*HCITapPacketHandler)(uint8_t packetType, const uint8_t *data, uint16_t length, unsigned long receivedTime);
+
+/// Transport that wraps the board's HCI transport (i.e. `HCITransport`) and
+/// inspects the packets that are read by ArduinoBLE's HCI layer.
+///
+/// This allows us to track events that ArduinoBLE does not expose
+/// (i.e. LE Connection Update Complete).
+///
+/// Usage: Install via `HCI.setTransport()` before calling `BLE.begin()`.
+class HCITap : public HCITransportInterface {
+public:
+  HCITap(HCITransportInterface *transport);
+
+  /// Returns `false`, if the maximum number of handlers has been added already.
+  bool addPacketHandler(HCITapPacketHandler handler);
+
+  // HCITransportInterface
+  int begin();
+  void end();
+  void wait(unsigned long timeout);
+  int available();
+  int peek();
+  int read();
+  size_t write(const uint8_t *data, size_t length);
+
+private:
+  /// The wrapped (actual) transport.
+  HCITransportInterface *m_transport;
+  HCITapPacketHandler m_packetHandlers[HCI_TAP_MAX_HANDLERS];
+  uint8_t m_packetHandlerCount;
+
+  /// `true`, if bytes of a not yet started packet have been observed (s. `available()`).
+  bool m_hasPendingTime;
+  unsigned long m_pendingTime;
+
+  uint8_t m_packetType;
+  unsigned long m_packetReceivedTime;
+  uint8_t m_buffer[HCI_TAP_CAPTURE_SIZE];
+  /// Number of bytes received for the current packet (header and payload).
+  uint16_t m_receivedLength;
+  /// Total length of the current packet (header and payload), or 0 if
+  /// the packet's header has not been received, yet.
+  uint16_t m_packetLength;
+
+  void reset();
+  void handleByte(uint8_t b);
+};
+
+/// Wraps the board's HCI transport.
+extern HCITap hciTap;
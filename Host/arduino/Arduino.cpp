@@ -0,0 +1,163 @@
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <Arduino.h>
+#include "ArduinoShim.h"
+
+static bool isSimulated = false;
+static uint64_t simulatedTime = 0;
+
+uint64_t monotonicMicros() {
+  if (isSimulated) return simulatedTime;
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static const uint64_t startTime = monotonicMicros();
+
+void setSimulatedMicros(uint64_t time) {
+  isSimulated = true;
+  simulatedTime = time;
+}
+
+uint64_t simulatedMicros() {
+  return simulatedTime;
+}
+
+unsigned long millis() {
+  return (unsigned long)(isSimulated ? simulatedTime / 1000 : (monotonicMicros() - startTime) / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)(isSimulated ? simulatedTime++ : monotonicMicros() - startTime);
+}
+
+void delay(unsigned long ms) {
+  if (isSimulated) {
+    simulatedTime += ms * 1000;
+  } else {
+    usleep(ms * 1000);
+  }
+}
+
+void delayMicroseconds(unsigned int us) {
+  if (isSimulated) {
+    simulatedTime += us;
+  } else {
+    usleep(us);
+  }
+}
+
+// Single-threaded: Interrupts are dispatched synchronously (s. `setInputPin()`).
+void noInterrupts() {}
+void interrupts() {}
+
+// MARK: - Pins
+
+struct Pin {
+  int mode;
+  int level;
+  voidFuncPtr callback;
+  int interruptMode;
+};
+
+static Pin pins[NUM_DIGITAL_PINS];
+static PinChangeHandler pinChangeHandler = nullptr;
+
+static Pin *findPin(int pin) {
+  return pin >= 0 && pin < NUM_DIGITAL_PINS ? &pins[pin] : nullptr;
+}
+
+void setPinChangeHandler(PinChangeHandler handler) {
+  pinChangeHandler = handler;
+}
+
+void pinMode(int pin, int mode) {
+  Pin *p = findPin(pin);
+  if (!p) return;
+
+  p->mode = mode;
+  p->level = mode == INPUT_PULLUP ? HIGH : LOW;
+}
+
+void digitalWrite(int pin, int value) {
+  Pin *p = findPin(pin);
+  if (!p || p->level == value) return;
+
+  p->level = value;
+  if (p->mode == OUTPUT && pinChangeHandler) {
+    pinChangeHandler(pin, value, monotonicMicros());
+  }
+}
+
+PinStatus digitalRead(int pin) {
+  Pin *p = findPin(pin);
+  return p && p->level ? HIGH : LOW;
+}
+
+int analogRead(int pin) {
+  // No button pressed (s. LCDKeypadScreen).
+  return 1023;
+}
+
+int digitalPinToInterrupt(int pin) {
+  return pin;
+}
+
+void attachInterrupt(int interrupt, voidFuncPtr callback, int mode) {
+  Pin *p = findPin(interrupt);
+  if (!p) return;
+
+  p->callback = callback;
+  p->interruptMode = mode;
+}
+
+void detachInterrupt(int interrupt) {
+  Pin *p = findPin(interrupt);
+  if (p) p->callback = nullptr;
+}
+
+void setInputPin(int pin, int level) {
+  Pin *p = findPin(pin);
+  if (!p || p->level == level) return;
+
+  p->level = level;
+  if (!p->callback) return;
+
+  bool isTriggered = p->interruptMode == CHANGE
+    || (p->interruptMode == RISING && level == HIGH)
+    || (p->interruptMode == FALLING && level == LOW);
+  if (isTriggered) p->callback();
+}
+
+// MARK: - Serial
+
+int FileSerial::available() {
+  int count = 0;
+  return fd >= 0 && ioctl(fd, FIONREAD, &count) == 0 ? count : 0;
+}
+
+int FileSerial::read() {
+  uint8_t value;
+  return fd >= 0 && ::read(fd, &value, 1) == 1 ? value : -1;
+}
+
+size_t FileSerial::write(const uint8_t *buffer, size_t size) {
+  if (fd < 0) return size;
+
+  ssize_t written = ::write(fd, buffer, size);
+  return written > 0 ? written : 0;
+}
+
+int FileSerial::availableForWrite() {
+  return 4096;
+}
+
+FileSerial serialUsb(-1);
+FileSerial serialUart(STDOUT_FILENO);
+
+arduino::HardwareSerial &Serial = serialUsb;
+arduino::HardwareSerial &Serial1 = serialUart;
@@ -0,0 +1,150 @@
+/*
+  Arduino-Shim
+
+  The subset of the Arduino core used by the sketch, for the Linux build of the
+  sketch (s. `Host/virtual`). The time is the host's monotonic clock; pins are
+  only recorded (s. ArduinoShim.h).
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "binary.h"
+
+typedef uint8_t byte;
+
+#define DEC 10
+#define HEX 16
+
+#define F(string) (string)
+#define PROGMEM
+
+typedef enum {
+  LOW = 0,
+  HIGH = 1,
+  CHANGE = 2,
+  FALLING = 3,
+  RISING = 4,
+} PinStatus;
+
+typedef enum {
+  INPUT = 0x0,
+  OUTPUT = 0x1,
+  INPUT_PULLUP = 0x2,
+  INPUT_PULLDOWN = 0x3,
+} PinMode;
+
+// Analog pins (as numbered by the Nano 33 IoT's variant).
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+
+// Number of simulated pins.
+#define NUM_DIGITAL_PINS 22
+
+template <class T, class L> auto min(const T &a, const L &b) -> decltype((b < a) ? b : a) { return (b < a) ? b : a; }
+template <class T, class L> auto max(const T &a, const L &b) -> decltype((b < a) ? b : a) { return (a < b) ? b : a; }
+
+namespace arduino {
+
+class String {
+public:
+  String(const char *s = "") : s(s ? s : "") {}
+  explicit String(char c) : s(1, c) {}
+  explicit String(unsigned char v, unsigned char base = DEC) : s(format(v, base)) {}
+  explicit String(int v, unsigned char base = DEC) : s(format(v, base)) {}
+  explicit String(unsigned int v, unsigned char base = DEC) : s(format(v, base)) {}
+  explicit String(long v, unsigned char base = DEC) : s(format(v, base)) {}
+  explicit String(unsigned long v, unsigned char base = DEC) : s(format(v, base)) {}
+
+  const char *c_str() const { return s.c_str(); }
+  unsigned int length() const { return s.size(); }
+  bool reserve(unsigned int size) { s.reserve(size); return true; }
+  void remove(unsigned int index, unsigned int count) { s.erase(index, count); }
+
+  String &operator+=(const String &other) { s += other.s; return *this; }
+  String &operator+=(const char *other) { s += other; return *this; }
+  String &operator+=(char other) { s += other; return *this; }
+  friend String operator+(const String &lhs, const String &rhs) { return String((lhs.s + rhs.s).c_str()); }
+  friend String operator+(const String &lhs, const char *rhs) { return String((lhs.s + rhs).c_str()); }
+  friend String operator+(const char *lhs, const String &rhs) { return String((lhs + rhs.s).c_str()); }
+  bool operator==(const String &other) const { return s == other.s; }
+  bool operator!=(const String &other) const { return s != other.s; }
+
+private:
+  std::string s;
+
+  template <class T> static std::string format(T value, unsigned char base) {
+    return base == HEX ? toHex((unsigned long)value) : std::to_string(value);
+  }
+  static std::string toHex(unsigned long value) {
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%lX", value);
+    return buffer;
+  }
+};
+
+class Stream {
+public:
+  virtual ~Stream() {}
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size) = 0;
+  virtual int availableForWrite() = 0;
+  virtual void flush() {}
+
+  size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+  size_t print(const char *s) { return write(s, strlen(s)); }
+  size_t print(const String &s) { return print(s.c_str()); }
+  size_t println(const char *s = "") { return print(s) + print("\r\n"); }
+  size_t println(const String &s) { return println(s.c_str()); }
+};
+
+class HardwareSerial : public Stream {
+public:
+  virtual void begin(unsigned long baudrate) {}
+  virtual void end() {}
+  explicit operator bool() { return true; }
+};
+
+}  // namespace arduino
+
+using arduino::String;
+using arduino::Stream;
+
+/// The native USB port.
+extern arduino::HardwareSerial &Serial;
+/// The hardware UART (logs).
+extern arduino::HardwareSerial &Serial1;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void noInterrupts();
+void interrupts();
+
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+PinStatus digitalRead(int pin);
+int analogRead(int pin);
+
+typedef void (*voidFuncPtr)(void);
+int digitalPinToInterrupt(int pin);
+void attachInterrupt(int interrupt, voidFuncPtr callback, int mode);
+void detachInterrupt(int interrupt);
+
+#endif /* Arduino_h */
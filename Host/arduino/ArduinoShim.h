@@ -0,0 +1,55 @@
+/*
+  Arduino-Shim (host interface)
+
+  Lets the host program (s. `Host/virtual`) attach the simulated pins and serial
+  ports of the shim (s. Arduino.h) to the outside world.
+*/
+
+#ifndef ArduinoShim_h
+#define ArduinoShim_h
+
+#include <Arduino.h>
+
+/// The host's monotonic time (`CLOCK_MONOTONIC`) in µs. `micros()` is relative
+/// to the start of the program; this one is comparable between processes.
+uint64_t monotonicMicros();
+
+/// Replaces the host's monotonic time by a simulated time (s. `Host/replay`): From now
+/// on, `monotonicMicros()` returns `time` (in µs), and so do `micros()` and `millis()`
+/// (in ms). Every read of `micros()` advances the simulated time by 1 µs (so busy-waits
+/// end), `delay()` and `delayMicroseconds()` advance it by their delay.
+void setSimulatedMicros(uint64_t time);
+/// The simulated time (in µs), s. `setSimulatedMicros()`.
+uint64_t simulatedMicros();
+
+/// Called whenever an output pin changes its level (s. `digitalWrite()`).
+/// - `time`: The time of the change in µs (s. `monotonicMicros()`).
+typedef void (*PinChangeHandler)(int pin, int level, uint64_t time);
+void setPinChangeHandler(PinChangeHandler handler);
+
+/// Drives an input pin: Calls the interrupt attached to it (if any) on a matching edge.
+void setInputPin(int pin, int level);
+
+/// A serial port on a file descriptor (non-blocking). Writes are discarded and
+/// nothing is read while no file descriptor is set.
+class FileSerial : public arduino::HardwareSerial {
+public:
+  explicit FileSerial(int fd) : fd(fd) {}
+
+  void setFileDescriptor(int fd) { this->fd = fd; }
+
+  int available() override;
+  int read() override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  int availableForWrite() override;
+
+private:
+  int fd;
+};
+
+/// The native USB port (`Serial`).
+extern FileSerial serialUsb;
+/// The hardware UART (`Serial1`): Writes to stdout.
+extern FileSerial serialUart;
+
+#endif /* ArduinoShim_h */
@@ -0,0 +1,18 @@
+#ifndef LiquidCrystal_h
+#define LiquidCrystal_h
+
+#include <Arduino.h>
+
+/// No display is attached to the shim.
+class LiquidCrystal {
+public:
+  LiquidCrystal(uint8_t rs, uint8_t enable, uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3) {}
+
+  void begin(uint8_t cols, uint8_t rows) {}
+  void clear() {}
+  void setCursor(uint8_t col, uint8_t row) {}
+  void createChar(uint8_t location, uint8_t charmap[]) {}
+  size_t write(uint8_t value) { return 1; }
+};
+
+#endif /* LiquidCrystal_h */
@@ -0,0 +1,7 @@
+#ifndef MemoryFree_h
+#define MemoryFree_h
+
+/// Not tracked by the simulator.
+inline int freeMemory() { return 0; }
+
+#endif /* MemoryFree_h */
@@ -0,0 +1,81 @@
+#include "PulseCodeDecoder.h"
+
+namespace signalboy {
+
+// Tolerance (in units) of the measured widths.
+#define UNIT_TOLERANCE 0.5
+
+PulseCodeDecoder::PulseCodeDecoder() : level(false), riseTime(0), bitsCount(-1), markerTime(0),
+  markerWidth(0), code(0), lastFallTime(0) {}
+
+void PulseCodeDecoder::setHandler(Handler handler) {
+  this->handler = handler;
+}
+
+void PulseCodeDecoder::addEdge(int64_t time, bool level) {
+  if (level == this->level) return;
+  this->level = level;
+
+  if (level) {
+    riseTime = time;
+  } else {
+    onPulse(riseTime, (uint32_t)(time - riseTime));
+  }
+}
+
+void PulseCodeDecoder::finish() {
+  abandonTrain();
+}
+
+bool PulseCodeDecoder::isMarkerWidth(uint32_t width) {
+  return width >= (PULSE_CODE_MARKER_UNITS - UNIT_TOLERANCE) * PULSE_CODE_UNIT_WIDTH_MIN
+    && width <= (PULSE_CODE_MARKER_UNITS + UNIT_TOLERANCE) * PULSE_CODE_UNIT_WIDTH_MAX;
+}
+
+void PulseCodeDecoder::onPulse(int64_t time, uint32_t width) {
+  if (bitsCount >= 0) {
+    double unit = (double)markerWidth / PULSE_CODE_MARKER_UNITS;
+    double gap = (time - lastFallTime) / unit;
+    double units = width / unit;
+
+    bool isValidGap = gap >= PULSE_CODE_GAP_UNITS - UNIT_TOLERANCE && gap <= PULSE_CODE_GAP_UNITS + UNIT_TOLERANCE;
+    bool isValidWidth = units >= PULSE_CODE_ZERO_UNITS - UNIT_TOLERANCE && units <= PULSE_CODE_ONE_UNITS + UNIT_TOLERANCE;
+    if (isValidGap && isValidWidth) {
+      bool bit = units > (PULSE_CODE_ZERO_UNITS + PULSE_CODE_ONE_UNITS) / 2.0;
+      code = (code << 1) | bit;
+      lastFallTime = time + width;
+
+      if (++bitsCount == PULSE_CODE_BITS_COUNT) {
+        bitsCount = -1;
+        if (handler) handler({ markerTime, true, code, (uint32_t)(unit + 0.5) });
+      }
+      return;
+    }
+
+    // Not a bit of the train: The pulse may start another one.
+    abandonTrain();
+  }
+
+  if (isMarkerWidth(width)) {
+    bitsCount = 0;
+    markerTime = time;
+    markerWidth = width;
+    code = 0;
+    lastFallTime = time + width;
+  } else {
+    reportPlain(time, width);
+  }
+}
+
+void PulseCodeDecoder::reportPlain(int64_t time, uint32_t width) {
+  if (handler) handler({ time, false, 0, width });
+}
+
+void PulseCodeDecoder::abandonTrain() {
+  if (bitsCount < 0) return;
+
+  bitsCount = -1;
+  reportPlain(markerTime, markerWidth);
+}
+
+}  // namespace signalboy
@@ -0,0 +1,65 @@
+/*
+  PulseCodeDecoder
+
+  Decodes the pulse trains of coded signals (s. `pulseCode.h` of the sketch) from the
+  edges of a captured trace of the output. The unit width of each train is measured by
+  its marker: Trains of any supported unit width are decoded. Pulses that do not belong
+  to a train (i.e. uncoded signals) are reported as such.
+*/
+
+#ifndef PulseCodeDecoder_h
+#define PulseCodeDecoder_h
+
+#include <stdint.h>
+#include <functional>
+
+#include "../../pulseCode.h"
+
+namespace signalboy {
+
+struct DecodedPulse {
+  /// Time (in µs) of the rising edge (of the marker).
+  int64_t time;
+  /// `true`, if the pulse is the marker of a decoded train (otherwise, a plain pulse).
+  bool isCoded;
+  uint8_t code;
+  /// Measured unit width (in µs) of a train, the width of a plain pulse.
+  uint32_t width;
+};
+
+class PulseCodeDecoder {
+public:
+  typedef std::function<void(const DecodedPulse &pulse)> Handler;
+
+  PulseCodeDecoder();
+
+  /// Called for every decoded train and plain pulse (in the order of their rising edges).
+  void setHandler(Handler handler);
+  /// Adds an edge of the trace (in µs, ascending).
+  void addEdge(int64_t time, bool level);
+  /// Ends the trace: Reports a pending train as plain pulses.
+  void finish();
+
+private:
+  Handler handler;
+  bool level;
+  int64_t riseTime;
+
+  /// The train being decoded (if `bitsCount >= 0`).
+  int bitsCount;
+  int64_t markerTime;
+  uint32_t markerWidth;
+  uint8_t code;
+  int64_t lastFallTime;
+
+  void onPulse(int64_t time, uint32_t width);
+  /// `true`, if `width` is the width of a marker of any supported unit width.
+  static bool isMarkerWidth(uint32_t width);
+  void reportPlain(int64_t time, uint32_t width);
+  /// Abandons the train being decoded: Its marker is reported as a plain pulse.
+  void abandonTrain();
+};
+
+}  // namespace signalboy
+
+#endif /* PulseCodeDecoder_h */
@@ -0,0 +1,492 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stddef.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+
+#include "SerialClient.h"
+#include "../../constants.h"
+
+namespace signalboy {
+
+uint64_t hostMicros() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/// The local time of the device in µs (relative to an arbitrary origin, but
+/// consistent for times within ~24 days).
+static int64_t toDeviceMicros(const SerialLocalTime &time, const SerialLocalTime &origin) {
+  return (int64_t)(int32_t)(time.time - origin.time) * 1000 + time.fraction - origin.fraction;
+}
+
+SerialClient::SerialClient() : fd(-1), sequence(0), timeout(500) {
+  initSerialFrameDecoder(decoder);
+}
+
+SerialClient::~SerialClient() {
+  close();
+}
+
+bool SerialClient::open(const std::string &path) {
+  close();
+
+  fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (fd < 0) {
+    error = "Cannot open " + path + ": " + strerror(errno);
+    return false;
+  }
+
+  struct termios tty;
+  if (tcgetattr(fd, &tty) == 0) {
+    cfmakeraw(&tty);
+    cfsetspeed(&tty, B115200);  // Ignored by USB CDC
+    tty.c_cflag |= CLOCAL | CREAD;
+    tcsetattr(fd, TCSANOW, &tty);
+  }
+  tcflush(fd, TCIOFLUSH);
+
+  initSerialFrameDecoder(decoder);
+  // Flush any partial frame on the device.
+  uint8_t terminator = 0;
+  if (::write(fd, &terminator, 1) != 1) {
+    error = std::string("Cannot write: ") + strerror(errno);
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+void SerialClient::close() {
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+}
+
+bool SerialClient::isOpen() const {
+  return fd >= 0;
+}
+
+void SerialClient::setTimeout(int timeout) {
+  this->timeout = timeout;
+}
+
+void SerialClient::setTimeNeedsSyncHandler(TimeNeedsSyncHandler handler) {
+  timeNeedsSyncHandler = handler;
+}
+
+const std::string &SerialClient::lastError() const {
+  return error;
+}
+
+uint32_t SerialClient::hostTime() {
+  return (uint32_t)(hostMicros() / 1000);
+}
+
+bool SerialClient::send(uint8_t type, uint8_t sequence, const void *parameters, size_t length) {
+  uint8_t payload[SERIAL_FRAME_MAX_PAYLOAD_SIZE];
+  if (sizeof(SerialMessageHeader) + length > sizeof(payload)) {
+    error = "Message too large";
+    return false;
+  }
+
+  SerialMessageHeader header = { type, sequence };
+  memcpy(payload, &header, sizeof(header));
+  memcpy(&payload[sizeof(header)], parameters, length);
+
+  uint8_t frame[SERIAL_FRAME_MAX_SIZE];
+  size_t size = encodeSerialFrame(payload, sizeof(header) + length, frame);
+
+  size_t written = 0;
+  while (written < size) {
+    ssize_t n = ::write(fd, &frame[written], size - written);
+    if (n < 0 && errno == EAGAIN) {
+      struct pollfd pfd = { fd, POLLOUT, 0 };
+      ::poll(&pfd, 1, timeout);
+      continue;
+    }
+    if (n <= 0) {
+      error = std::string("Cannot write: ") + strerror(errno);
+      return false;
+    }
+    written += n;
+  }
+
+  return true;
+}
+
+int SerialClient::receive(uint8_t *payload, uint64_t deadline) {
+  while (true) {
+    uint8_t value;
+    ssize_t n = ::read(fd, &value, 1);
+
+    if (n == 1) {
+      int length = feedSerialFrameDecoder(decoder, value, payload);
+      if (length > 0) return length;
+      continue;
+    }
+
+    if (n < 0 && errno != EAGAIN) {
+      error = std::string("Cannot read: ") + strerror(errno);
+      return -1;
+    }
+
+    uint64_t time = hostMicros();
+    if (time >= deadline) {
+      error = "Timeout";
+      return -1;
+    }
+
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    ::poll(&pfd, 1, (int)((deadline - time + 999) / 1000));
+  }
+}
+
+void SerialClient::dispatchNotification(const uint8_t *payload, size_t length) {
+  if (payload[0] == SERIAL_MSG_TIME_NEEDS_SYNC && length >= sizeof(SerialMessageHeader) + 1) {
+    if (timeNeedsSyncHandler) {
+      timeNeedsSyncHandler(payload[sizeof(SerialMessageHeader)]);
+    }
+  }
+}
+
+bool SerialClient::request(uint8_t type, const void *parameters, size_t length, std::vector<uint8_t> *response) {
+  if (!isOpen()) {
+    error = "Not open";
+    return false;
+  }
+
+  // Sequence number 0 is reserved for notifications.
+  sequence = sequence == 0xff ? 1 : sequence + 1;
+  if (!send(type, sequence, parameters, length)) return false;
+
+  uint64_t deadline = hostMicros() + timeout * 1000ULL;
+  uint8_t payload[SERIAL_FRAME_MAX_PAYLOAD_SIZE];
+
+  while (true) {
+    int size = receive(payload, deadline);
+    if (size < 0) return false;
+    if (size < (int)sizeof(SerialMessageHeader) + 1) continue;
+
+    if (!(payload[0] & SERIAL_MSG_RESPONSE)) {
+      dispatchNotification(payload, size);
+      continue;
+    }
+    // Ignore late responses of previous (timed out) requests.
+    if (payload[0] != (type | SERIAL_MSG_RESPONSE) || payload[1] != sequence) continue;
+
+    response->assign(&payload[sizeof(SerialMessageHeader)], &payload[size]);
+
+    uint8_t status = (*response)[0];
+    if (status != SERIAL_STATUS_OK) {
+      error = "Request failed (status=" + std::to_string(status) + ")";
+      return false;
+    }
+
+    return true;
+  }
+}
+
+bool SerialClient::requestStatus(uint8_t type, const void *parameters, size_t length) {
+  std::vector<uint8_t> response;
+  return request(type, parameters, length, &response);
+}
+
+bool SerialClient::requestValue(uint8_t type, void *value, size_t size) {
+  std::vector<uint8_t> response;
+  if (!request(type, nullptr, 0, &response)) return false;
+
+  if (response.size() < size) {
+    error = "Invalid response";
+    return false;
+  }
+
+  memcpy(value, response.data(), size);
+  return true;
+}
+
+bool SerialClient::sync(int roundsCount, SyncResult *result) {
+  bool hasSample = false;
+  int64_t bestRoundTripTime = 0;
+  /// The device's time the best response has been sent...
+  SerialLocalTime bestSentTime = {};
+  /// ... and the host's time (in µs) at that moment.
+  uint64_t bestHostTime = 0;
+  int completedCount = 0;
+
+  for (int i = 0; i < roundsCount; i++) {
+    uint64_t requestTime = hostMicros();
+    uint32_t hostTimestamp = (uint32_t)requestTime;
+
+    std::vector<uint8_t> response;
+    if (!request(SERIAL_MSG_SYNC, &hostTimestamp, sizeof(hostTimestamp), &response)) continue;
+    uint64_t responseTime = hostMicros();
+
+    SerialSyncResponse value;
+    if (response.size() < sizeof(value)) continue;
+    memcpy(&value, response.data(), sizeof(value));
+    if (value.hostTimestamp != hostTimestamp) continue;
+
+    // The time spent by the device does not add to the latency.
+    int64_t processingTime = toDeviceMicros(value.sentTime, value.receivedTime);
+    int64_t roundTripTime = (int64_t)(responseTime - requestTime) - processingTime;
+    if (roundTripTime < 0) roundTripTime = 0;
+    completedCount++;
+
+    if (!hasSample || roundTripTime < bestRoundTripTime) {
+      hasSample = true;
+      bestRoundTripTime = roundTripTime;
+      bestSentTime = value.sentTime;
+      // Assume a symmetric latency.
+      bestHostTime = responseTime - roundTripTime / 2;
+    }
+  }
+
+  if (!hasSample) return false;
+
+  // The host's time at which the device's local time advanced to `bestSentTime.time`.
+  uint64_t hostTimeAtLocalTime = bestHostTime - bestSentTime.fraction;
+
+  SerialSetTimeRequest request = {
+    bestSentTime.time,
+    (uint32_t)((hostTimeAtLocalTime + 500) / 1000),
+    // The latency's asymmetry and the resolution of the device's time (1 ms).
+    (uint32_t)(bestRoundTripTime / 2 + 1000),
+    (uint16_t)completedCount
+  };
+  if (!requestStatus(SERIAL_MSG_SET_TIME, &request, sizeof(request))) return false;
+
+  if (result) {
+    result->roundTripTime = (uint32_t)bestRoundTripTime;
+    result->uncertainty = request.uncertainty;
+    result->roundsCount = completedCount;
+  }
+
+  return true;
+}
+
+bool SerialClient::train(int messagesCount) {
+  for (int i = 0; i < messagesCount; i++) {
+    if (i > 0) {
+      // The Training accepts a single Reference-Timestamp per Connection-Event (USB-frame).
+      usleep(USB_FRAME_INTERVAL);
+    }
+
+    uint32_t referenceTimestamp = hostTime();
+    if (!send(SERIAL_MSG_REFERENCE_TIMESTAMP, 0, &referenceTimestamp, sizeof(referenceTimestamp))) return false;
+  }
+
+  // The responses (sent with sequence number 0) are not awaited: Awaiting them would
+  // delay the Reference-Timestamps.
+  poll(10);
+  return true;
+}
+
+bool SerialClient::scheduleAt(uint32_t targetTimestamp) {
+  return requestStatus(SERIAL_MSG_TARGET_TIMESTAMP, &targetTimestamp, sizeof(targetTimestamp));
+}
+
+bool SerialClient::schedule(const std::vector<uint32_t> &targetTimestamps) {
+  if (targetTimestamps.empty() || targetTimestamps.size() > SERIAL_SCHEDULE_MAX_TARGETS) {
+    error = "Invalid number of Target-Timestamps";
+    return false;
+  }
+
+  return requestStatus(SERIAL_MSG_SCHEDULE, targetTimestamps.data(), targetTimestamps.size() * sizeof(uint32_t));
+}
+
+bool SerialClient::scheduleOnChannel(uint8_t channel, const std::vector<uint32_t> &targetTimestamps) {
+  if (targetTimestamps.empty() || targetTimestamps.size() > SERIAL_SCHEDULE_MAX_TARGETS) {
+    error = "Invalid number of Target-Timestamps";
+    return false;
+  }
+
+  std::vector<uint8_t> parameters(sizeof(channel) + targetTimestamps.size() * sizeof(uint32_t));
+  parameters[0] = channel;
+  memcpy(&parameters[sizeof(channel)], targetTimestamps.data(), targetTimestamps.size() * sizeof(uint32_t));
+  return requestStatus(SERIAL_MSG_CHANNEL_SCHEDULE, parameters.data(), parameters.size());
+}
+
+bool SerialClient::scheduleCoded(const std::vector<SerialCodedTarget> &targets, uint16_t unitWidth) {
+  if (targets.empty() || targets.size() > SERIAL_SCHEDULE_MAX_TARGETS) {
+    error = "Invalid number of Target-Timestamps";
+    return false;
+  }
+
+  std::vector<uint8_t> parameters(sizeof(unitWidth) + targets.size() * sizeof(SerialCodedTarget));
+  memcpy(parameters.data(), &unitWidth, sizeof(unitWidth));
+  memcpy(&parameters[sizeof(unitWidth)], targets.data(), targets.size() * sizeof(SerialCodedTarget));
+  return requestStatus(SERIAL_MSG_CODED_SCHEDULE, parameters.data(), parameters.size());
+}
+
+bool SerialClient::trigger(uint8_t delay) {
+  return requestStatus(SERIAL_MSG_TRIGGER, &delay, sizeof(delay));
+}
+
+bool SerialClient::sendReferenceTimestamp(uint32_t referenceTimestamp) {
+  return requestStatus(SERIAL_MSG_REFERENCE_TIMESTAMP, &referenceTimestamp, sizeof(referenceTimestamp));
+}
+
+bool SerialClient::sendWiredReferenceTimestamp(uint32_t referenceTimestamp) {
+  return requestStatus(SERIAL_MSG_WIRED_REFERENCE_TIMESTAMP, &referenceTimestamp, sizeof(referenceTimestamp));
+}
+
+bool SerialClient::calibrate() {
+  return requestStatus(SERIAL_MSG_CALIBRATE, nullptr, 0);
+}
+
+bool SerialClient::configure(const std::vector<uint8_t> &entries, Config *config) {
+  if (entries.size() >= CONFIG_MAX_LENGTH) {
+    error = "Too many entries";
+    return false;
+  }
+
+  uint8_t parameters[CONFIG_MAX_LENGTH];
+  parameters[0] = CONFIG_FORMAT_VERSION;
+  memcpy(&parameters[1], entries.data(), entries.size());
+
+  std::vector<uint8_t> response;
+  bool isApplied = request(SERIAL_MSG_CONFIGURE, parameters, 1 + entries.size(), &response);
+  if (!isApplied && (response.empty() || response[0] != SERIAL_STATUS_INVALID_PARAMETER)) return false;
+
+  // Rejected: The reason is reported along with the configuration.
+  uint8_t configStatus = CONFIG_STATUS_OK;
+  if (!parseConfigResponse(response, config, &configStatus)) return false;
+  if (!isApplied) {
+    error = std::string("Configuration rejected (") + getConfigStatusName(configStatus) + ")";
+    return false;
+  }
+
+  return true;
+}
+
+bool SerialClient::provisionBroadcaster(const SerialBroadcasterKey &key) {
+  return requestStatus(SERIAL_MSG_PROVISION_BROADCASTER, &key, sizeof(key));
+}
+
+bool SerialClient::provisionConfigKey(const SerialConfigKey &key) {
+  return requestStatus(SERIAL_MSG_PROVISION_CONFIG_KEY, &key, sizeof(key));
+}
+
+bool SerialClient::readConfig(Config *config) {
+  std::vector<uint8_t> response;
+  if (!request(SERIAL_MSG_READ_CONFIG, nullptr, 0, &response)) return false;
+
+  return parseConfigResponse(response, config);
+}
+
+bool SerialClient::parseConfigResponse(const std::vector<uint8_t> &response, Config *config, uint8_t *configStatus) {
+  const size_t headerSize = offsetof(SerialConfigResponse, bytes);
+  Config parsed = {};
+  if (response.size() < headerSize || response.size() < headerSize + response[1]
+      || parseConfig(&response[headerSize], response[1], parsed, configStatus) != CONFIG_STATUS_OK) {
+    error = "Invalid response";
+    return false;
+  }
+
+  *config = parsed;
+  return true;
+}
+
+bool SerialClient::readInfo(SerialInfo *info) {
+  return requestValue(SERIAL_MSG_READ_INFO, info, sizeof(*info));
+}
+
+bool SerialClient::readDiagnostics(SerialDiagnostics *diagnostics) {
+  return requestValue(SERIAL_MSG_READ_DIAGNOSTICS, diagnostics, sizeof(*diagnostics));
+}
+
+bool SerialClient::readTrace(std::vector<TraceEvent> *events) {
+  const size_t headerSize = offsetof(SerialTraceResponse, events);
+
+  while (true) {
+    std::vector<uint8_t> response;
+    if (!request(SERIAL_MSG_READ_TRACE, nullptr, 0, &response)) return false;
+
+    SerialTraceResponse value = {};
+    memcpy(&value, response.data(), std::min(response.size(), sizeof(value)));
+    if (response.size() < headerSize || value.count > SERIAL_TRACE_MAX_EVENTS
+        || response.size() < headerSize + value.count * sizeof(TraceEvent)) {
+      error = "Invalid response";
+      return false;
+    }
+
+    // Drained
+    if (value.count == 0) return true;
+
+    events->insert(events->end(), value.events, value.events + value.count);
+  }
+}
+
+bool SerialClient::readRecording(std::vector<uint8_t> *bytes) {
+  const size_t headerSize = offsetof(SerialRecordingResponse, bytes);
+
+  std::vector<uint8_t> response;
+  if (!request(SERIAL_MSG_READ_RECORDING, nullptr, 0, &response)) return false;
+
+  SerialRecordingResponse value = {};
+  memcpy(&value, response.data(), std::min(response.size(), sizeof(value)));
+  if (response.size() < headerSize || value.length > SERIAL_RECORDING_MAX_LENGTH
+      || response.size() < headerSize + value.length) {
+    error = "Invalid response";
+    return false;
+  }
+
+  bytes->insert(bytes->end(), value.bytes, value.bytes + value.length);
+  return true;
+}
+
+bool SerialClient::readStalls(StallReport *report) {
+  SerialStallsResponse response;
+  if (!requestValue(SERIAL_MSG_READ_STALLS, &response, sizeof(response))) return false;
+
+  *report = response.report;
+  return true;
+}
+
+bool SerialClient::readFaults(std::vector<FaultRecord> *faults, uint16_t *faultsCount) {
+  const size_t headerSize = offsetof(SerialFaultsResponse, page.faults);
+
+  uint8_t index = 0;
+  while (true) {
+    std::vector<uint8_t> response;
+    if (!request(SERIAL_MSG_READ_FAULTS, &index, sizeof(index), &response)) return false;
+
+    SerialFaultsResponse value = {};
+    memcpy(&value, response.data(), std::min(response.size(), sizeof(value)));
+    if (response.size() < headerSize || value.page.count > FAULT_LOG_PAGE_SIZE
+        || response.size() < headerSize + value.page.count * sizeof(FaultRecord)) {
+      error = "Invalid response";
+      return false;
+    }
+
+    *faultsCount = value.page.faultsCount;
+    faults->insert(faults->end(), value.page.faults, value.page.faults + value.page.count);
+    index += value.page.count;
+    // A new fault shifts the indices: A fault may be read twice (but none is skipped).
+    if (value.page.count < FAULT_LOG_PAGE_SIZE || index >= value.page.storedCount) return true;
+  }
+}
+
+void SerialClient::poll(int timeout) {
+  if (!isOpen()) return;
+
+  uint64_t deadline = hostMicros() + timeout * 1000ULL;
+  uint8_t payload[SERIAL_FRAME_MAX_PAYLOAD_SIZE];
+
+  int size;
+  while ((size = receive(payload, deadline)) >= 0) {
+    if (size >= (int)sizeof(SerialMessageHeader) && !(payload[0] & SERIAL_MSG_RESPONSE)) {
+      dispatchNotification(payload, size);
+    }
+  }
+}
+
+}  // namespace signalboy
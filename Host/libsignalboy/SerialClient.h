@@ -0,0 +1,138 @@
+/*
+  SerialClient
+
+  Client of the Serial-Protocol (s. `serialProtocol.h` of the sketch) for Linux hosts
+  connected to a Signalboy by USB (or to the virtual Signalboy, s. `Host/virtual`).
+
+  The synced time is the host's monotonic clock (in ms, s. `hostTime()`): After
+  `sync()`, Target-Timestamps are specified in that clock.
+*/
+
+#ifndef SerialClient_h
+#define SerialClient_h
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../../constants.h"
+#include "../../serialFrame.h"
+#include "../../serialMessages.h"
+
+namespace signalboy {
+
+struct SyncResult {
+  /// Round-trip time (in µs) of the round-trip the synced time has been estimated of.
+  uint32_t roundTripTime;
+  /// Uncertainty (in µs) of the synced time (as reported to the device).
+  uint32_t uncertainty;
+  /// Number of completed round-trips.
+  int roundsCount;
+};
+
+class SerialClient {
+public:
+  typedef std::function<void(uint8_t timeNeedsSync)> TimeNeedsSyncHandler;
+
+  SerialClient();
+  ~SerialClient();
+
+  /// Opens the serial device (i.e. `/dev/ttyACM0`) in raw mode.
+  bool open(const std::string &path);
+  void close();
+  bool isOpen() const;
+
+  /// Timeout (in ms) of a request.
+  void setTimeout(int timeout);
+  /// Called for every `SERIAL_MSG_TIME_NEEDS_SYNC`-notification.
+  void setTimeNeedsSyncHandler(TimeNeedsSyncHandler handler);
+  /// Describes the last failure.
+  const std::string &lastError() const;
+
+  /// The host's time (in ms): The synced time established by `sync()`.
+  static uint32_t hostTime();
+
+  /// Round-trip sync: Syncs the device to `hostTime()` by the fastest of
+  /// `roundsCount` round-trips.
+  bool sync(int roundsCount, SyncResult *result = nullptr);
+  /// Syncs the device by a Training (as a BLE-Central would): Sends `messagesCount`
+  /// Reference-Timestamps (the device's `trainingMsgsCount`, s. `readConfig()`) in
+  /// consecutive USB-frames.
+  bool train(int messagesCount = TRAINING_MSGS_COUNT_DEFAULT);
+
+  bool scheduleAt(uint32_t targetTimestamp);
+  /// Schedules up to `SERIAL_SCHEDULE_MAX_TARGETS` signals with a single request.
+  bool schedule(const std::vector<uint32_t> &targetTimestamps);
+  /// Schedules up to `SERIAL_SCHEDULE_MAX_TARGETS` signals on output channel `channel`.
+  bool scheduleOnChannel(uint8_t channel, const std::vector<uint32_t> &targetTimestamps);
+  /// Schedules up to `SERIAL_SCHEDULE_MAX_TARGETS` coded signals (s. `pulseCode.h`) with a
+  /// single request. `unitWidth` (in µs) of 0 selects the default.
+  bool scheduleCoded(const std::vector<SerialCodedTarget> &targets, uint16_t unitWidth = 0);
+  /// Fires a signal `delay` ms after the request has been received.
+  bool trigger(uint8_t delay);
+  bool sendReferenceTimestamp(uint32_t referenceTimestamp);
+  bool sendWiredReferenceTimestamp(uint32_t referenceTimestamp);
+  /// Starts the calibration of the output (read the result by `readDiagnostics()`).
+  bool calibrate();
+  /// Writes the entries of the parameters to change (s. `encodeConfigEntry()`) and reads
+  /// the effective configuration to `config`: Fails, if any entry is rejected.
+  bool configure(const std::vector<uint8_t> &entries, Config *config);
+  /// Provisions the key of a broadcaster of the Broadcast-Observer: Requires a sketch
+  /// built with `OBSERVER_MODE`.
+  bool provisionBroadcaster(const SerialBroadcasterKey &key);
+  /// Provisions the key authenticating the Centrals' writes of the configuration (s.
+  /// `authenticateConfig()`): An all-zero key revokes it.
+  bool provisionConfigKey(const SerialConfigKey &key);
+
+  bool readInfo(SerialInfo *info);
+  bool readDiagnostics(SerialDiagnostics *diagnostics);
+  /// Reads the effective configuration (s. `configFormat.h` of the sketch).
+  bool readConfig(Config *config);
+  /// Drains the timeline trace (appended to `events`): Requires a sketch built with `TRACE`.
+  bool readTrace(std::vector<TraceEvent> *events);
+  /// Reads the next bytes of the recording of the inputs (appended to `bytes`, none if
+  /// nothing has been recorded since): Requires a sketch built with `RECORD`.
+  bool readRecording(std::vector<uint8_t> *bytes);
+  /// Reads the stalls of the loop: Requires a sketch built with `WATCHDOG`.
+  bool readStalls(StallReport *report);
+  /// Reads the faults kept by the log (appended to `faults`, from the latest to the
+  /// oldest) and the number of faults since startup.
+  bool readFaults(std::vector<FaultRecord> *faults, uint16_t *faultsCount);
+
+  /// Dispatches the notifications received within `timeout` ms.
+  void poll(int timeout);
+
+private:
+  int fd;
+  uint8_t sequence;
+  int timeout;
+  SerialFrameDecoder decoder;
+  TimeNeedsSyncHandler timeNeedsSyncHandler;
+  std::string error;
+
+  bool send(uint8_t type, uint8_t sequence, const void *parameters, size_t length);
+  /// Receives the next frame until `deadline` (in µs, s. `hostMicros()`). Returns
+  /// the size of its payload, or -1 on timeout.
+  int receive(uint8_t *payload, uint64_t deadline);
+  void dispatchNotification(const uint8_t *payload, size_t length);
+
+  /// Sends a request and awaits its response (dispatching notifications meanwhile).
+  /// `response` receives the response's parameters (starting with the status).
+  bool request(uint8_t type, const void *parameters, size_t length, std::vector<uint8_t> *response);
+  /// Sends a request whose response holds a status only.
+  bool requestStatus(uint8_t type, const void *parameters, size_t length);
+  /// Sends a request whose response holds `size` bytes of parameters (starting with
+  /// the status) copied to `value`.
+  bool requestValue(uint8_t type, void *value, size_t size);
+  /// Parses the configuration of a `SerialConfigResponse` (and the status of the last
+  /// write to `configStatus`).
+  bool parseConfigResponse(const std::vector<uint8_t> &response, Config *config, uint8_t *configStatus = nullptr);
+};
+
+/// The host's monotonic time in µs.
+uint64_t hostMicros();
+
+}  // namespace signalboy
+
+#endif /* SerialClient_h */
@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "VirtualCentral.h"
+#include "SerialClient.h"
+#include "../../constants.h"
+
+namespace signalboy {
+
+const char *const UUID_TARGET_TIMESTAMP = "37410001-b4d1-f445-aa29-989ea26dc614";
+const char *const UUID_TRIGGER_TIMER = "37410002-b4d1-f445-aa29-989ea26dc614";
+const char *const UUID_CODED_TARGET_TIMESTAMP = "37410003-b4d1-f445-aa29-989ea26dc614";
+const char *const UUID_CHANNEL_TARGET_TIMESTAMP = "37410004-b4d1-f445-aa29-989ea26dc614";
+const char *const UUID_TIME_NEEDS_SYNC = "92360001-7858-41a5-b0cc-942dd4189715";
+const char *const UUID_REFERENCE_TIMESTAMP = "92360002-7858-41a5-b0cc-942dd4189715";
+const char *const UUID_SYNC_QUALITY = "92360004-7858-41a5-b0cc-942dd4189715";
+const char *const UUID_CONFIGURATION = "6e4c0001-2f5b-4c1e-9a7d-3b8e1f0c5a62";
+const char *const UUID_FAULT_LOG = "5b6a0002-3b1b-4a8f-9d0e-2c6f4e1d7a10";
+
+VirtualCentral::VirtualCentral() : fd(-1), lastInterval(0), eventsCount(0), clockOffset(0) {}
+
+VirtualCentral::~VirtualCentral() {
+  close();
+}
+
+bool VirtualCentral::connect(const std::string &path, const std::string &address, uint16_t interval) {
+  close();
+
+  sockaddr_un socketAddress = {};
+  socketAddress.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(socketAddress.sun_path)) {
+    error = "Path too long";
+    return false;
+  }
+  strcpy(socketAddress.sun_path, path.c_str());
+
+  fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+  if (fd < 0 || ::connect(fd, (sockaddr *)&socketAddress, sizeof(socketAddress)) != 0) {
+    error = "Cannot connect to " + path + ": " + strerror(errno);
+    close();
+    return false;
+  }
+
+  VirtualLinkConnect request = {};
+  memcpy(request.address, address.c_str(), std::min(address.size(), sizeof(request.address)));
+  request.interval = interval;
+
+  uint8_t message[1 + sizeof(request)];
+  message[0] = VIRTUAL_LINK_MSG_CONNECT;
+  memcpy(&message[1], &request, sizeof(request));
+  return send(message, sizeof(message));
+}
+
+void VirtualCentral::close() {
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+  lastInterval = 0;
+}
+
+bool VirtualCentral::isConnected() const {
+  return fd >= 0;
+}
+
+void VirtualCentral::setConnectionEventHandler(ConnectionEventHandler handler) {
+  connectionEventHandler = handler;
+}
+
+void VirtualCentral::setNotificationHandler(NotificationHandler handler) {
+  notificationHandler = handler;
+}
+
+void VirtualCentral::setPinChangeHandler(PinChangeHandler handler) {
+  pinChangeHandler = handler;
+}
+
+const std::string &VirtualCentral::lastError() const {
+  return error;
+}
+
+uint32_t VirtualCentral::connectionInterval() const {
+  return lastInterval;
+}
+
+void VirtualCentral::setClockOffset(int32_t offset) {
+  clockOffset = offset;
+}
+
+uint32_t VirtualCentral::time() const {
+  return SerialClient::hostTime() + clockOffset;
+}
+
+bool VirtualCentral::send(const uint8_t *message, size_t length) {
+  if (!isConnected()) {
+    error = "Not connected";
+    return false;
+  }
+
+  if (::send(fd, message, length, MSG_NOSIGNAL) != (ssize_t)length) {
+    error = std::string("Cannot send: ") + strerror(errno);
+    return false;
+  }
+
+  return true;
+}
+
+bool VirtualCentral::write(const char *uuid, const void *value, size_t length) {
+  uint8_t message[VIRTUAL_LINK_MAX_MESSAGE_SIZE];
+  int size = encodeVirtualLinkMessage(VIRTUAL_LINK_MSG_WRITE, uuid, (const uint8_t *)value, length, message);
+  if (size == 0) {
+    error = "Value too large";
+    return false;
+  }
+
+  return send(message, size);
+}
+
+bool VirtualCentral::writeUInt32(const char *uuid, uint32_t value) {
+  return write(uuid, &value, sizeof(value));
+}
+
+bool VirtualCentral::subscribe(const char *uuid) {
+  uint8_t message[VIRTUAL_LINK_MAX_MESSAGE_SIZE];
+  int size = encodeVirtualLinkMessage(VIRTUAL_LINK_MSG_SUBSCRIBE, uuid, nullptr, 0, message);
+  return send(message, size);
+}
+
+bool VirtualCentral::read(const char *uuid, std::vector<uint8_t> *value, int timeout) {
+  uint8_t message[VIRTUAL_LINK_MAX_MESSAGE_SIZE];
+  int size = encodeVirtualLinkMessage(VIRTUAL_LINK_MSG_READ, uuid, nullptr, 0, message);
+  if (!send(message, size)) return false;
+
+  uint64_t deadline = hostMicros() + timeout * 1000ULL;
+  while (true) {
+    size = receive(message, deadline);
+    if (size < 0) return false;
+    if (size == 0) {
+      error = "Timeout";
+      return false;
+    }
+    if (message[0] != VIRTUAL_LINK_MSG_READ_RESPONSE) continue;
+
+    char responseUuid[VIRTUAL_LINK_MAX_UUID_SIZE + 1];
+    const uint8_t *data;
+    int length = decodeVirtualLinkMessage(message, size, responseUuid, &data);
+    if (length < 0 || strcmp(responseUuid, uuid) != 0) continue;
+
+    value->assign(data, data + length);
+    return true;
+  }
+}
+
+int VirtualCentral::receive(uint8_t *message, uint64_t deadline) {
+  if (!isConnected()) {
+    error = "Not connected";
+    return -1;
+  }
+
+  while (true) {
+    ssize_t size = recv(fd, message, VIRTUAL_LINK_MAX_MESSAGE_SIZE, MSG_DONTWAIT);
+
+    if (size == 0) {
+      error = "Disconnected";
+      close();
+      return -1;
+    }
+    if (size < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+      error = std::string("Cannot receive: ") + strerror(errno);
+      return -1;
+    }
+
+    if (size > 0) {
+      switch (message[0]) {
+        case VIRTUAL_LINK_MSG_CONNECTION_EVENT:
+          {
+            VirtualLinkConnectionEvent event;
+            if (size < 1 + (ssize_t)sizeof(event)) break;
+            memcpy(&event, &message[1], sizeof(event));
+
+            lastInterval = event.interval;
+            eventsCount++;
+            if (connectionEventHandler) connectionEventHandler(event);
+            break;
+          }
+
+        case VIRTUAL_LINK_MSG_NOTIFY:
+          {
+            char uuid[VIRTUAL_LINK_MAX_UUID_SIZE + 1];
+            const uint8_t *data;
+            int length = decodeVirtualLinkMessage(message, size, uuid, &data);
+            if (length >= 0 && notificationHandler) {
+              notificationHandler(uuid, std::vector<uint8_t>(data, data + length));
+            }
+            break;
+          }
+
+        case VIRTUAL_LINK_MSG_PIN_CHANGE:
+          {
+            VirtualLinkPinChange change;
+            if (size < 1 + (ssize_t)sizeof(change)) break;
+            memcpy(&change, &message[1], sizeof(change));
+
+            if (pinChangeHandler) pinChangeHandler(change);
+            break;
+          }
+
+        default:
+          break;
+      }
+
+      return size;
+    }
+
+    uint64_t time = hostMicros();
+    if (time >= deadline) return 0;
+
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    ::poll(&pfd, 1, (int)((deadline - time + 999) / 1000));
+  }
+}
+
+bool VirtualCentral::pollUntil(uint64_t deadline) {
+  uint8_t message[VIRTUAL_LINK_MAX_MESSAGE_SIZE];
+
+  int size;
+  while ((size = receive(message, deadline)) > 0) {}
+
+  return size == 0;
+}
+
+bool VirtualCentral::poll(int timeout) {
+  return pollUntil(hostMicros() + timeout * 1000ULL);
+}
+
+bool VirtualCentral::awaitConnectionEvent(uint64_t deadline) {
+  uint8_t message[VIRTUAL_LINK_MAX_MESSAGE_SIZE];
+  uint32_t count = eventsCount;
+
+  while (eventsCount == count) {
+    int size = receive(message, deadline);
+    if (size < 0) return false;
+    if (size == 0) {
+      error = "Timeout";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool VirtualCentral::train(int messagesCount) {
+  // Skip the Connection-Events that passed already.
+  if (!poll(0)) return false;
+
+  uint64_t deadline = hostMicros() + 1000000ULL;
+
+  for (int i = 0; i < messagesCount; i++) {
+    if (!awaitConnectionEvent(deadline)) return false;
+
+    // The application is not aware of the Connection-Events: Its writes are
+    // created anytime within the Connection-Interval.
+    usleep(rand() % (lastInterval * 3 / 4 + 1));
+
+    if (!writeUInt32(UUID_REFERENCE_TIMESTAMP, time())) return false;
+  }
+
+  return true;
+}
+
+}  // namespace signalboy
@@ -0,0 +1,105 @@
+/*
+  VirtualCentral
+
+  A Central of the virtual Signalboy (s. `Host/virtual`): Connects on the Virtual Link
+  and writes, reads and subscribes to the characteristics of the sketch. The output
+  pins of the virtual Signalboy are probed (s. `setPinChangeHandler()`).
+
+  The synced time is the host's monotonic clock (in ms, s. `SerialClient::hostTime()`),
+  offset by the Central's clock offset (s. `setClockOffset()`). The time of the probed
+  pins is the host's monotonic clock (in µs, s. `hostMicros()`).
+*/
+
+#ifndef VirtualCentral_h
+#define VirtualCentral_h
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../../constants.h"
+#include "../virtual/virtualLink.h"
+
+namespace signalboy {
+
+// Characteristics of the sketch (s. `signalboy-arduino.ino`)
+extern const char *const UUID_TARGET_TIMESTAMP;
+extern const char *const UUID_TRIGGER_TIMER;
+extern const char *const UUID_CODED_TARGET_TIMESTAMP;
+extern const char *const UUID_CHANNEL_TARGET_TIMESTAMP;
+extern const char *const UUID_TIME_NEEDS_SYNC;
+extern const char *const UUID_REFERENCE_TIMESTAMP;
+extern const char *const UUID_SYNC_QUALITY;
+extern const char *const UUID_CONFIGURATION;
+extern const char *const UUID_FAULT_LOG;
+
+class VirtualCentral {
+public:
+  typedef std::function<void(const VirtualLinkConnectionEvent &event)> ConnectionEventHandler;
+  typedef std::function<void(const std::string &uuid, const std::vector<uint8_t> &value)> NotificationHandler;
+  typedef std::function<void(const VirtualLinkPinChange &change)> PinChangeHandler;
+
+  VirtualCentral();
+  ~VirtualCentral();
+
+  /// Connects to the virtual Signalboy listening on `path`.
+  /// - `interval`: The initial Connection-Interval (in units of 1.25 ms).
+  bool connect(const std::string &path, const std::string &address, uint16_t interval = 24);
+  void close();
+  bool isConnected() const;
+
+  void setConnectionEventHandler(ConnectionEventHandler handler);
+  void setNotificationHandler(NotificationHandler handler);
+  void setPinChangeHandler(PinChangeHandler handler);
+  /// Describes the last failure.
+  const std::string &lastError() const;
+
+  /// Writes are queued by the Signalboy's controller until the next Connection-Event.
+  bool write(const char *uuid, const void *value, size_t length);
+  bool writeUInt32(const char *uuid, uint32_t value);
+  bool subscribe(const char *uuid);
+  /// Reads the value (dispatching other messages meanwhile) within `timeout` ms.
+  bool read(const char *uuid, std::vector<uint8_t> *value, int timeout = 500);
+
+  /// The Connection-Interval (in µs) of the last Connection-Event (0 before the first).
+  uint32_t connectionInterval() const;
+
+  /// Offsets the Central's clock (in ms) from the host's monotonic clock (default: 0),
+  /// i.e. its Reference-Timestamps (s. `train()`).
+  void setClockOffset(int32_t offset);
+  /// The time (in ms) of the Central's clock.
+  uint32_t time() const;
+
+  /// Performs a Training (as a Central application would): Writes a Reference-Timestamp
+  /// in each of `messagesCount` (the Signalboy's `trainingMsgsCount`, s. configFormat.h)
+  /// consecutive Connection-Intervals, at a random offset within the interval.
+  bool train(int messagesCount = TRAINING_MSGS_COUNT_DEFAULT);
+
+  /// Dispatches the messages received within `timeout` ms.
+  bool poll(int timeout);
+  /// Dispatches the messages received until `deadline` (in µs, s. `hostMicros()`).
+  bool pollUntil(uint64_t deadline);
+
+private:
+  int fd;
+  uint32_t lastInterval;
+  /// Number of Connection-Events received.
+  uint32_t eventsCount;
+  int32_t clockOffset;
+  ConnectionEventHandler connectionEventHandler;
+  NotificationHandler notificationHandler;
+  PinChangeHandler pinChangeHandler;
+  std::string error;
+
+  bool send(const uint8_t *message, size_t length);
+  /// Receives and dispatches a single message until `deadline`. Returns its size
+  /// (0 on timeout, -1 on failure); the message is copied to `message`.
+  int receive(uint8_t *message, uint64_t deadline);
+  /// Awaits the next Connection-Event.
+  bool awaitConnectionEvent(uint64_t deadline);
+};
+
+}  // namespace signalboy
+
+#endif /* VirtualCentral_h */
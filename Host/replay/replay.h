@@ -0,0 +1,39 @@
+/*
+  Replay (host interface)
+
+  Lets `signalboy-replay` drive the sketch by a recording (s. `recording.h` of the
+  sketch): The simulated RTC (`rtc.cpp`) ticks as told, the Replay Controller
+  (`replayController.cpp`, in place of the Virtual Controller) dispatches the recorded
+  inputs once due, and the Connection-Events of the recorded writes are reported by
+  `replayConnection.cpp` (in place of `connection.cpp`).
+*/
+
+#ifndef replay_h
+#define replay_h
+
+#include <stdint.h>
+#include <vector>
+
+#include "recording.h"
+
+struct ReplayRecord {
+  RecordHeader header;
+  /// `header.time`, unwrapped (in µs).
+  uint64_t time;
+  std::vector<uint8_t> parameters;
+};
+
+/// Sets the SQW ticks of the simulated RTC (s. `rtcTicks()`) and the time (in µs,
+/// `micros()`) of the last tick.
+void setReplayTicks(unsigned int ticks, unsigned long time);
+
+/// Queues the recorded inputs: Each is dispatched by `pollVirtualController()` (s.
+/// `BLE.poll()`) once the RTC ticked to its ticks.
+void setReplayInputs(const std::vector<ReplayRecord> &records);
+/// `true`, while inputs are queued.
+bool isAnyReplayInputPending();
+
+/// Reports the Connection-Event that delivered a recorded write (s. connection.h).
+void setReplayConnectionEvent(uint16_t handle, const RecordWritten &written);
+
+#endif /* replay_h */
@@ -0,0 +1,123 @@
+/*
+  Replayed Connection-Parameters: Implements `connection.h` of the sketch (in place of
+  `connection.cpp`). The Connection-Events are those recorded with the writes (s.
+  `setReplayConnectionEvent()`); requested Connection-Parameters are ignored (their
+  effect is part of the recording).
+*/
+
+#include <Arduino.h>
+#include "connection.h"
+#include "constants.h"
+#include "rtc.hpp"
+#include "virtualController.h"
+#include "replay.h"
+
+struct Connection {
+  bool isConnected;
+  uint16_t handle;
+  char address[18];
+
+  /// The Connection-Event that delivered the last write.
+  unsigned long connectionEventTime;
+  unsigned long rxOffset;
+  unsigned long interval;  // in µs
+};
+
+static Connection connections[MAX_CENTRALS];
+
+static Connection *findConnection(uint16_t handle) {
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    if (connections[i].isConnected && connections[i].handle == handle) {
+      return &connections[i];
+    }
+  }
+
+  return nullptr;
+}
+
+static void onVirtualControllerEvent(const VirtualControllerEvent &event) {
+  switch (event.type) {
+    case virtualEventCONNECTED:
+      for (int i = 0; i < MAX_CENTRALS; i++) {
+        Connection &connection = connections[i];
+        if (connection.isConnected) continue;
+
+        connection = {};
+        connection.isConnected = true;
+        connection.handle = event.handle;
+        strncpy(connection.address, event.address, sizeof(connection.address) - 1);
+        break;
+      }
+      break;
+
+    case virtualEventDISCONNECTED:
+      {
+        Connection *connection = findConnection(event.handle);
+        if (connection) connection->isConnected = false;
+        break;
+      }
+
+    default:
+      break;
+  }
+}
+
+void setReplayConnectionEvent(uint16_t handle, const RecordWritten &written) {
+  Connection *connection = findConnection(handle);
+  if (!connection) return;
+
+  connection->connectionEventTime = written.connectionEventTime;
+  connection->rxOffset = written.rxOffset;
+  connection->interval = written.connectionInterval;
+}
+
+// MARK: - connection.h
+
+void setupConnection(void) {
+  addVirtualControllerEventHandler(onVirtualControllerEvent);
+}
+
+uint16_t getConnectionHandle(const char *address) {
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    if (connections[i].isConnected && strcasecmp(connections[i].address, address) == 0) {
+      return connections[i].handle;
+    }
+  }
+
+  return CONNECTION_HANDLE_NONE;
+}
+
+void setConnectionIntervals(uint16_t fast, uint16_t idle) {}
+
+void setConnectionMode(uint16_t handle, connectionMode_t mode) {}
+
+void updateConnectionParametersIfNeeded(void) {}
+
+bool isConnectionEstablished(uint16_t handle) {
+  return findConnection(handle) != nullptr;
+}
+
+uint16_t getConnectionInterval(uint16_t handle) {
+  Connection *connection = findConnection(handle);
+  return connection ? connection->interval / 1250UL : 0;
+}
+
+unsigned long getConnectionIntervalMicros(uint16_t handle) {
+  Connection *connection = findConnection(handle);
+  return connection ? connection->interval : 0;
+}
+
+uint16_t getSlaveLatency(uint16_t handle) {
+  // Not recorded (its effect is: The Connection-Events of the writes).
+  return 0;
+}
+
+unsigned long getLastConnectionEventTime(uint16_t handle) {
+  Connection *connection = findConnection(handle);
+  return connection ? connection->connectionEventTime : millisRtc(false);
+}
+
+unsigned long getLastConnectionEventRxOffsetMicros(uint16_t handle) {
+  Connection *connection = findConnection(handle);
+  return connection ? connection->rxOffset : 0;
+}
@@ -0,0 +1,214 @@
+/*
+  Replay Controller: Implements `virtualController.h` (in place of
+  `virtualController.cpp`) by dispatching the recorded inputs (s. `setReplayInputs()`):
+  Connects, disconnects and the Central's packets (writes and subscriptions) to the host
+  stack, edges to the input pins and the configuration to the sketch (s. config.h).
+  Whatever the sketch sends is dropped: Its effect on the Centrals is part of the
+  recording.
+*/
+
+#include <string.h>
+
+#include <Arduino.h>
+#include "ArduinoShim.h"
+#include "config.h"
+#include "replay.h"
+#include "rtc.hpp"
+#include "virtualController.h"
+#include "virtualLink.h"
+
+struct ReplayConnection {
+  bool isConnected;
+  uint16_t handle;
+  char address[18];
+};
+
+static ReplayConnection connections[VIRTUAL_CONTROLLER_MAX_CONNECTIONS];
+static uint16_t nextHandle = 1;
+
+static VirtualControllerEventHandler eventHandlers[VIRTUAL_CONTROLLER_MAX_HANDLERS];
+static int eventHandlerCount = 0;
+
+static const std::vector<ReplayRecord> *inputs = nullptr;
+static size_t nextInput = 0;
+
+static void dispatchEvent(const VirtualControllerEvent &event) {
+  for (int i = 0; i < eventHandlerCount; i++) {
+    eventHandlers[i](event);
+  }
+}
+
+static ReplayConnection *findConnection(const uint8_t *packedAddress) {
+  char address[18];
+  formatRecordAddress(packedAddress, address);
+
+  for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+    if (connections[i].isConnected && strcmp(connections[i].address, address) == 0) {
+      return &connections[i];
+    }
+  }
+
+  return nullptr;
+}
+
+static VirtualControllerEvent makeEvent(virtualEventType_t type, ReplayConnection &connection) {
+  VirtualControllerEvent event = {};
+  event.type = type;
+  event.handle = connection.handle;
+  event.address = connection.address;
+  event.receivedTime = micros();
+  return event;
+}
+
+static void onConnected(const RecordCentral &central) {
+  if (findConnection(central.address)) return;
+
+  for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+    ReplayConnection &connection = connections[i];
+    if (connection.isConnected) continue;
+
+    connection.isConnected = true;
+    connection.handle = nextHandle++;
+    formatRecordAddress(central.address, connection.address);
+    dispatchEvent(makeEvent(virtualEventCONNECTED, connection));
+    return;
+  }
+}
+
+static void onDisconnected(const RecordCentral &central) {
+  ReplayConnection *connection = findConnection(central.address);
+  if (!connection) return;
+
+  connection->isConnected = false;
+  dispatchEvent(makeEvent(virtualEventDISCONNECTED, *connection));
+}
+
+static void onPacket(uint8_t type, const uint8_t *packedAddress, const uint8_t *packedUuid, const uint8_t *value, int length) {
+  ReplayConnection *connection = findConnection(packedAddress);
+  if (!connection) return;
+
+  char uuid[37];
+  formatRecordUuid(packedUuid, uuid);
+
+  uint8_t message[VIRTUAL_LINK_MAX_MESSAGE_SIZE];
+  VirtualControllerEvent event = makeEvent(virtualEventPACKET, *connection);
+  event.length = encodeVirtualLinkMessage(type, uuid, value, length, message);
+  event.data = message;
+  if (event.length > 0) dispatchEvent(event);
+}
+
+static void dispatchInput(const ReplayRecord &input) {
+  const uint8_t *parameters = input.parameters.data();
+  size_t length = input.parameters.size();
+
+  switch (input.header.type) {
+    case RECORD_CONNECTED:
+    case RECORD_DISCONNECTED:
+      {
+        if (length < sizeof(RecordCentral)) break;
+
+        RecordCentral central;
+        memcpy(&central, parameters, sizeof(central));
+        if (input.header.type == RECORD_CONNECTED) {
+          onConnected(central);
+        } else {
+          onDisconnected(central);
+        }
+        break;
+      }
+
+    case RECORD_WRITTEN:
+      {
+        if (length < sizeof(RecordWritten)) break;
+
+        RecordWritten written;
+        memcpy(&written, parameters, sizeof(written));
+        ReplayConnection *connection = findConnection(written.address);
+        if (!connection) break;
+
+        // The Connection-Event, the value has been delivered in (s. replayConnection.cpp)
+        setReplayConnectionEvent(connection->handle, written);
+        onPacket(VIRTUAL_LINK_MSG_WRITE, written.address, written.uuid,
+          parameters + sizeof(written), length - sizeof(written));
+        break;
+      }
+
+    case RECORD_SUBSCRIBED:
+      {
+        if (length < sizeof(RecordSubscribed)) break;
+
+        RecordSubscribed subscribed;
+        memcpy(&subscribed, parameters, sizeof(subscribed));
+        onPacket(VIRTUAL_LINK_MSG_SUBSCRIBE, subscribed.address, subscribed.uuid, nullptr, 0);
+        break;
+      }
+
+    case RECORD_INPUT_EDGE:
+      {
+        if (length < sizeof(RecordInputEdge)) break;
+
+        RecordInputEdge edge;
+        memcpy(&edge, parameters, sizeof(edge));
+        setInputPin(edge.pin, edge.level);
+        break;
+      }
+
+    case RECORD_CONFIG:
+      applyConfig(parameters, length);
+      break;
+
+    default:
+      break;
+  }
+}
+
+void setReplayInputs(const std::vector<ReplayRecord> &records) {
+  inputs = &records;
+  nextInput = 0;
+}
+
+bool isAnyReplayInputPending() {
+  return inputs && nextInput < inputs->size();
+}
+
+// MARK: - virtualController.h
+
+bool openVirtualController(const char *path) {
+  return true;
+}
+
+void closeVirtualController() {}
+
+bool isVirtualControllerOpen() {
+  return true;
+}
+
+bool addVirtualControllerEventHandler(VirtualControllerEventHandler handler) {
+  if (eventHandlerCount == VIRTUAL_CONTROLLER_MAX_HANDLERS) return false;
+
+  eventHandlers[eventHandlerCount++] = handler;
+  return true;
+}
+
+void pollVirtualController() {
+  while (isAnyReplayInputPending()) {
+    const ReplayRecord &input = (*inputs)[nextInput];
+    // Due, once the RTC ticked to its ticks (s. `rtcTicks()`)
+    if ((int)(input.header.ticks - rtcTicks()) > 0) break;
+
+    nextInput++;
+    // Dispatched no earlier than recorded
+    if (input.time > simulatedMicros()) setSimulatedMicros(input.time);
+    dispatchInput(input);
+  }
+}
+
+bool sendVirtualPacket(uint16_t handle, const uint8_t *data, int length) {
+  return true;
+}
+
+void requestVirtualConnectionUpdate(uint16_t handle, uint16_t interval, uint16_t latency) {}
+
+void disconnectVirtualConnection(uint16_t handle) {}
+
+void sendVirtualPinChange(int pin, int level, uint64_t time) {}
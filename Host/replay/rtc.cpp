@@ -0,0 +1,46 @@
+/*
+  Replayed RTC: Implements `rtc.hpp` of the sketch (in place of `rtc.cpp`). The SQW
+  ticks are set by the replay (s. `setReplayTicks()`).
+*/
+
+#include <Arduino.h>
+#include "rtc.hpp"
+#include "Globals.hpp"
+#include "Logger.hpp"
+#include "replay.h"
+
+static unsigned int ticks = 0;
+// Time (in µs, `micros()`) of the last tick
+static unsigned long lastTickTime = 0;
+
+void setReplayTicks(unsigned int value, unsigned long time) {
+  ticks = value;
+  lastTickTime = time;
+}
+
+void printSqwMode() {
+  Log.println("Sqw Pin Mode: replayed");
+}
+
+void pps_tick(void) {}
+
+void setupRtc() {
+  printSqwMode();
+}
+
+unsigned int rtcTicks(void) {
+  return ticks;
+}
+
+unsigned long millisRtc(bool skipSuspendInterrupts) {
+  return millisFromRtcTicks(ticks);
+}
+
+unsigned long rtcLastTickMicros(void) {
+  return lastTickTime;
+}
+
+unsigned long microsAtMillisRtc(unsigned long t) {
+  // As estimated by `rtc.cpp`
+  return lastTickTime - (millisRtc(false) - t) * 1000UL;
+}
@@ -0,0 +1,204 @@
+/*
+  signalboy-replay
+
+  Replays a recording of the inputs (s. `recorder.h` of the sketch), as written by
+  `signalboy-cli <port> record <duration> <file>`, through the sketch (its modules,
+  unmodified, as by `signalboy-virtual`): Tick by tick of the SQW, the recorded inputs
+  are dispatched once due - the writes to the characteristics through their handlers
+  (i.e. `onTargetTimestampWritten()`), with the recorded Connection-Events - and the
+  loop runs the timers. No host clock is involved: A replay is deterministic.
+
+    signalboy-replay [--log] [--tail <ms>] <recording> > outputs.csv
+
+  - `--log`: Prints the logs of the sketch (to stderr).
+  - `--tail`: Keeps running the loop beyond the last record (default: 1000 ms).
+
+  Prints the edges of the output channels as CSV: recorded and replayed local time
+  (in ms, `millisRtc()`), their difference and the levels (bit `i`: channel `i`).
+  Fails, if any edge is missing or its levels differ (except for the edges replayed
+  beyond the end of the recording).
+  NOTE: Build with the flags the recorded sketch has been built with (s. `Makefile`).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <Arduino.h>
+#include "ArduinoShim.h"
+#include "recorder.h"
+#include "replay.h"
+#include "rtc.hpp"
+
+// The sketch (s. `ino2cpp.sh`).
+void setup();
+void loop();
+
+// Runs of the loop per tick: The second one runs the timers armed by the inputs
+// dispatched in the first.
+static const int LOOPS_PER_TICK = 2;
+
+struct OutputEdge {
+  unsigned long time;  // local, in ms
+  uint8_t levels;
+};
+
+static int usage() {
+  fprintf(stderr, "usage: signalboy-replay [--log] [--tail <ms>] <recording>\n");
+  return 2;
+}
+
+/// Reads the records of `bytes` (up to the first incomplete one), unwrapping `micros()`.
+static std::vector<ReplayRecord> parseRecords(const std::vector<uint8_t> &bytes) {
+  std::vector<ReplayRecord> records;
+  size_t offset = 0;
+
+  while (offset + sizeof(RecordHeader) <= bytes.size()) {
+    ReplayRecord record;
+    memcpy(&record.header, &bytes[offset], sizeof(record.header));
+    offset += sizeof(record.header);
+    if (offset + record.header.length > bytes.size()) break;
+
+    record.parameters.assign(bytes.begin() + offset, bytes.begin() + offset + record.header.length);
+    offset += record.header.length;
+
+    // `micros()` wraps every ~71.6 min.
+    record.time = records.empty() ? record.header.time
+      : records.back().time + (uint32_t)(record.header.time - records.back().header.time);
+    records.push_back(record);
+  }
+
+  return records;
+}
+
+static void collectOutputEdges(const std::vector<ReplayRecord> &records, std::vector<OutputEdge> *edges) {
+  for (const ReplayRecord &record : records) {
+    if (record.header.type != RECORD_OUTPUT || record.parameters.empty()) continue;
+
+    edges->push_back({ millisFromRtcTicks(record.header.ticks), record.parameters[0] });
+  }
+}
+
+int main(int argc, char *argv[]) {
+  const char *path = nullptr;
+  bool isLogging = false;
+  long tail = 1000;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--log") == 0) {
+      isLogging = true;
+    } else if (strcmp(argv[i], "--tail") == 0 && i + 1 < argc) {
+      tail = atol(argv[++i]);
+    } else if (!path && argv[i][0] != '-') {
+      path = argv[i];
+    } else {
+      return usage();
+    }
+  }
+  if (!path) return usage();
+
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    fprintf(stderr, "error: Cannot open %s\n", path);
+    return 1;
+  }
+
+  std::vector<uint8_t> bytes;
+  uint8_t buffer[4096];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    bytes.insert(bytes.end(), buffer, buffer + count);
+  }
+  fclose(file);
+
+  std::vector<ReplayRecord> records = parseRecords(bytes);
+  if (records.empty() || records[0].header.type != RECORD_START || records[0].parameters.size() < sizeof(RecordStart)) {
+    fprintf(stderr, "error: %s does not start with RECORD_START\n", path);
+    return 1;
+  }
+
+  RecordStart start;
+  memcpy(&start, records[0].parameters.data(), sizeof(start));
+  if (start.formatVersion != RECORDING_FORMAT_VERSION) {
+    fprintf(stderr, "error: Unsupported format version %u\n", start.formatVersion);
+    return 1;
+  }
+
+  // Records dropped by the recorder: The inputs are incomplete beyond.
+  for (size_t i = 0; i < records.size(); i++) {
+    if (records[i].header.type == RECORD_OVERFLOW) {
+      fprintf(stderr, "warning: Records have been dropped: Replaying the first %zu records only\n", i);
+      records.resize(i);
+      break;
+    }
+  }
+
+  std::vector<OutputEdge> recordedEdges;
+  collectOutputEdges(records, &recordedEdges);
+
+  // The logs of the sketch (`Serial1`)
+  serialUart.setFileDescriptor(isLogging ? STDERR_FILENO : -1);
+
+  const ReplayRecord &first = records[0];
+  setSimulatedMicros(first.time);
+  setReplayTicks(first.header.ticks, first.time);
+  setup();
+  setReplayInputs(records);
+
+  std::vector<OutputEdge> replayedEdges;
+  uint8_t taken[256];
+
+  unsigned int lastTicks = records.back().header.ticks + (unsigned int)(tail * 1024 / 1000);
+  // The last record at or before the current tick: Its time anchors the time of the tick.
+  size_t anchor = 0;
+
+  for (unsigned int ticks = first.header.ticks; (int)(lastTicks - ticks) >= 0; ticks++) {
+    while (anchor + 1 < records.size() && (int)(records[anchor + 1].header.ticks - ticks) <= 0) anchor++;
+
+    const ReplayRecord &record = records[anchor];
+    uint64_t tickTime = record.time + (uint64_t)(ticks - record.header.ticks) * 1000000ULL / 1024;
+    if (tickTime > simulatedMicros()) setSimulatedMicros(tickTime);
+    setReplayTicks(ticks, simulatedMicros());
+
+    for (int i = 0; i < LOOPS_PER_TICK; i++) {
+      loop();
+    }
+
+    // The replay's own recording: Its output edges
+    std::vector<uint8_t> replayed;
+    int length;
+    while ((length = takeRecording(taken, sizeof(taken))) > 0) {
+      replayed.insert(replayed.end(), taken, taken + length);
+    }
+    collectOutputEdges(parseRecords(replayed), &replayedEdges);
+  }
+
+  printf("recorded,replayed,delta,levels\n");
+  size_t edgesCount = std::max(recordedEdges.size(), replayedEdges.size());
+  unsigned long endTime = millisFromRtcTicks(records.back().header.ticks);
+  long maxDelta = 0;
+  int mismatchedCount = 0;
+
+  for (size_t i = 0; i < edgesCount; i++) {
+    if (i < recordedEdges.size() && i < replayedEdges.size()) {
+      const OutputEdge &recorded = recordedEdges[i];
+      const OutputEdge &replayed = replayedEdges[i];
+      long delta = (long)(replayed.time - recorded.time);
+      maxDelta = std::max(maxDelta, labs(delta));
+      if (recorded.levels != replayed.levels) mismatchedCount++;
+      printf("%lu,%lu,%ld,0x%02x\n", recorded.time, replayed.time, delta, replayed.levels);
+    } else if (i < recordedEdges.size()) {
+      mismatchedCount++;
+      printf("%lu,,,0x%02x\n", recordedEdges[i].time, recordedEdges[i].levels);
+    } else {
+      // Unless beyond the end of the recording (s. `--tail`)
+      if (replayedEdges[i].time <= endTime) mismatchedCount++;
+      printf(",%lu,,0x%02x\n", replayedEdges[i].time, replayedEdges[i].levels);
+    }
+  }
+
+  fprintf(stderr, "%zu records, %zu recorded and %zu replayed output edges, max. delta %ld ms, %d mismatched\n",
+    records.size(), recordedEdges.size(), replayedEdges.size(), maxDelta, mismatchedCount);
+  return mismatchedCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#include <deque>
+#include <ArduinoBLE.h>
+#include <utility/HCI.h>
+#include "fakeHci.h"
+
+class FakeHCITransport : public HCITransportInterface {
+public:
+  std::deque<uint8_t> bytes;
+
+  int begin() override { return 1; }
+  void end() override {}
+  void wait(unsigned long timeout) override {}
+  int available() override { return bytes.size(); }
+  int peek() override { return bytes.empty() ? -1 : bytes.front(); }
+
+  int read() override {
+    if (bytes.empty()) return -1;
+
+    int b = bytes.front();
+    bytes.pop_front();
+    return b;
+  }
+
+  size_t write(const uint8_t *data, size_t length) override { return length; }
+};
+
+static FakeHCITransport fakeTransport;
+HCITransportInterface &HCITransport = fakeTransport;
+
+static HCIClass fakeHci;
+HCIClass &HCI = fakeHci;
+
+static std::vector<FakeHciAclPacket> sentAclPackets;
+
+void HCIClass::setTransport(HCITransportInterface *transport) {
+  m_transport = transport;
+}
+
+void HCIClass::poll() {
+  while (m_transport->available()) {
+    m_transport->read();
+  }
+}
+
+int HCIClass::sendAclPkt(uint16_t handle, uint8_t cid, uint8_t plen, void *data) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  sentAclPackets.push_back({ handle, cid, std::vector<uint8_t>(bytes, bytes + plen) });
+  return 0;
+}
+
+void fakeHciReceive(const std::vector<uint8_t> &packet) {
+  fakeTransport.bytes.insert(fakeTransport.bytes.end(), packet.begin(), packet.end());
+}
+
+std::vector<FakeHciAclPacket> &fakeHciSentAclPackets(void) {
+  return sentAclPackets;
+}
+
+// The advertisements are read by the HCI-tap: ArduinoBLE discovers no devices.
+
+static BLELocalDevice fakeBle;
+BLELocalDevice &BLE = fakeBle;
+
+int BLELocalDevice::scan(bool withDuplicates) {
+  return 1;
+}
+
+bool BLELocalDevice::available() {
+  return false;
+}
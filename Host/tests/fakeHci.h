@@ -0,0 +1,30 @@
+/*
+  Fake HCI
+
+  The controller's side of the faked ArduinoBLE HCI layer (s. `utility/HCI.h`): The
+  tests queue canned packets (as received from the controller) and inspect the
+  ACL-packets sent by the sketch. Scanning (`BLE.scan()`) is accepted, but ArduinoBLE
+  discovers no devices: The advertisements reach the sketch by the HCI-tap only.
+*/
+
+#ifndef fakeHci_h
+#define fakeHci_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/// Queues a packet (starting with its packet indicator, s. `HCI_EVENT_PKT`) to be read
+/// by the next `HCI.poll()`.
+void fakeHciReceive(const std::vector<uint8_t> &packet);
+
+struct FakeHciAclPacket {
+  uint16_t handle;
+  uint8_t cid;
+  std::vector<uint8_t> data;
+};
+
+/// The ACL-packets sent by `HCI.sendAclPkt()` (oldest first).
+std::vector<FakeHciAclPacket> &fakeHciSentAclPackets(void);
+
+#endif /* fakeHci_h */
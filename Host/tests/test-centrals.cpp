@@ -0,0 +1,325 @@
+/*
+  Tests several Centrals sharing the scheduler (s. `CentralContext` of the sketch) on
+  the virtual Signalboy: Each Central is trained with a clock of its own, and its
+  timers fire in its synced time.
+
+    test-centrals [<signalboy-virtual>]
+
+  Starts the virtual Signalboy (default: `build/signalboy-virtual`) on a socket and a
+  pseudo terminal (the Serial-Protocol) of its own; its log is written to
+  `build/tests/test-centrals.log`.
+*/
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../libsignalboy/VirtualCentral.h"
+#include "../libsignalboy/SerialClient.h"
+#include "configFormat.h"
+#include "fault.h"
+#include "test.h"
+
+using namespace signalboy;
+
+static const int OUTPUT_PINS[] = { 10, 5, 16 /* A2 */ };
+/// Deviation (in ms) of a pulse from its target time: The sync of the Training and
+/// the latency of the virtual Signalboy's loop.
+static const long PULSE_TOLERANCE = 15;
+static const int SYNC_TIMEOUT = 10000;
+
+static char socketPath[64];
+static char serialPath[64];
+
+/// The rising edges probed (in ms of the host's monotonic clock), by channel. (The
+/// changes are probed by every connected Central.)
+static std::mutex risesMutex;
+static std::vector<uint32_t> rises[3];
+
+static void onPinChange(const VirtualLinkPinChange &change) {
+  if (!change.level) return;
+
+  std::lock_guard<std::mutex> lock(risesMutex);
+  for (int channel = 0; channel < 3; channel++) {
+    if (change.pin != OUTPUT_PINS[channel]) continue;
+
+    uint32_t time = change.time / 1000;
+    if (std::find(rises[channel].begin(), rises[channel].end(), time) == rises[channel].end()) {
+      rises[channel].push_back(time);
+    }
+  }
+}
+
+static void clearRises(void) {
+  std::lock_guard<std::mutex> lock(risesMutex);
+  for (std::vector<uint32_t> &channelRises : rises) channelRises.clear();
+}
+
+/// Checks that `channel` rose once, at `expectedTime` (host time in ms).
+static bool isRisenAt(int channel, uint32_t expectedTime) {
+  std::lock_guard<std::mutex> lock(risesMutex);
+  if (rises[channel].size() != 1) {
+    fprintf(stderr, "channel %d rose %zu times\n", channel, rises[channel].size());
+    return false;
+  }
+
+  long deviation = (long)(int32_t)(rises[channel][0] - expectedTime);
+  if (deviation < -PULSE_TOLERANCE || deviation > PULSE_TOLERANCE) {
+    fprintf(stderr, "channel %d rose %ld ms off\n", channel, deviation);
+    return false;
+  }
+  return true;
+}
+
+static bool connectCentral(VirtualCentral &central, const char *address, int32_t clockOffset) {
+  central.setClockOffset(clockOffset);
+  central.setPinChangeHandler(onPinChange);
+  if (!central.connect(socketPath, address)) return false;
+  // The Signalboy disconnects a Central it has no slot for.
+  return central.poll(300);
+}
+
+static uint8_t readTimeNeedsSync(VirtualCentral &central) {
+  std::vector<uint8_t> value;
+  if (!central.read(UUID_TIME_NEEDS_SYNC, &value) || value.empty()) return 0xff;
+  return value[0];
+}
+
+/// Trains the Central until every Central is synced (as the Central applications do:
+/// `timeNeedsSync` is shared).
+static bool sync(VirtualCentral &central) {
+  uint64_t deadline = hostMicros() + SYNC_TIMEOUT * 1000ULL;
+  while (hostMicros() < deadline) {
+    if (readTimeNeedsSync(central) == TIME_NEEDS_SYNC_NONE) return true;
+    if (!central.train() || !central.poll(200)) return false;
+  }
+  return false;
+}
+
+/// Trains the Centrals concurrently.
+static bool syncAll(const std::vector<VirtualCentral *> &centrals) {
+  std::atomic<int> syncedCount(0);
+  std::vector<std::thread> threads;
+  for (VirtualCentral *central : centrals) {
+    threads.emplace_back([central, &syncedCount]() {
+      if (sync(*central)) syncedCount++;
+    });
+  }
+  for (std::thread &thread : threads) thread.join();
+  return syncedCount == (int)centrals.size();
+}
+
+static void pollAll(const std::vector<VirtualCentral *> &centrals, int timeout) {
+  uint64_t deadline = hostMicros() + timeout * 1000ULL;
+  while (hostMicros() < deadline) {
+    for (VirtualCentral *central : centrals) central->poll(1);
+  }
+}
+
+static bool scheduleChannel(VirtualCentral &central, uint8_t channel, uint32_t targetTimestamp) {
+  uint8_t value[5] = {
+    (uint8_t)targetTimestamp, (uint8_t)(targetTimestamp >> 8),
+    (uint8_t)(targetTimestamp >> 16), (uint8_t)(targetTimestamp >> 24), channel
+  };
+  return central.write(UUID_CHANNEL_TARGET_TIMESTAMP, value, sizeof(value));
+}
+
+/// Whether the fault log (read by `central`) holds a fault of `domain` and `code`.
+static bool isFaultLogged(VirtualCentral &central, uint8_t domain, uint8_t code) {
+  for (uint8_t index = 0; index < FAULT_LOG_SIZE; index += FAULT_LOG_PAGE_SIZE) {
+    std::vector<uint8_t> value;
+    if (!central.write(UUID_FAULT_LOG, &index, 1) || !central.poll(50)) return false;
+    if (!central.read(UUID_FAULT_LOG, &value) || value.size() < offsetof(FaultLogPage, faults)) return false;
+
+    FaultLogPage page = {};
+    memcpy(&page, value.data(), std::min(value.size(), sizeof(page)));
+    for (int i = 0; i < page.count && i < FAULT_LOG_PAGE_SIZE; i++) {
+      if (page.faults[i].domain == domain && page.faults[i].code == code) return true;
+    }
+  }
+  return false;
+}
+
+/// Each Central's timers fire in its synced time, concurrently.
+static void testConcurrentCentrals(VirtualCentral centrals[3]) {
+  std::vector<VirtualCentral *> all = { &centrals[0], &centrals[1], &centrals[2] };
+  clearRises();
+
+  uint32_t hostTime = SerialClient::hostTime();
+  for (int channel = 0; channel < 3; channel++) {
+    CHECK(scheduleChannel(centrals[channel], channel, centrals[channel].time() + 400 + channel * 50));
+  }
+  pollAll(all, 800);
+
+  for (int channel = 0; channel < 3; channel++) {
+    CHECK(isRisenAt(channel, hostTime + 400 + channel * 50));
+  }
+}
+
+/// A Central beyond `MAX_CENTRALS` is disconnected (and the fault reported), until a
+/// slot is released.
+static void testSlotAccounting(VirtualCentral centrals[3], VirtualCentral &extraCentral) {
+  CHECK(!connectCentral(extraCentral, "00:00:00:00:00:04", 0));
+  CHECK(!extraCentral.isConnected());
+  CHECK(isFaultLogged(centrals[1], FAULT_DOMAIN_CONNECTION, FAULT_CODE_TOO_MANY_CENTRALS));
+
+  // The others are still served.
+  for (int i = 0; i < 3; i++) {
+    CHECK(centrals[i].poll(100));
+  }
+}
+
+/// Writes the `length` bytes of `data` to the `configuration`-Characteristic. Returns the
+/// sync interval reported afterwards, and the status of the write (`status`).
+static uint32_t writeConfiguration(VirtualCentral &central, const uint8_t *data, size_t length, uint8_t *status) {
+  CHECK(central.write(UUID_CONFIGURATION, data, length));
+  CHECK(central.poll(100));
+
+  std::vector<uint8_t> value;
+  CHECK(central.read(UUID_CONFIGURATION, &value));
+  Config config = {};
+  CHECK_EQUAL(parseConfig(value.data(), value.size(), config, status), CONFIG_STATUS_OK);
+  return config.syncInterval;
+}
+
+/// The Centrals change the configuration only by writes authenticated by the configuration
+/// key (which is provisioned by USB).
+static void testConfigurationAuthenticated(VirtualCentral &central, SerialClient &client) {
+  static const SerialConfigKey KEY = { { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 } };
+  static const SerialConfigKey OTHER_KEY = { { 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1 } };
+
+  Config config;
+  CHECK(client.readConfig(&config));
+  const uint32_t syncInterval = config.syncInterval;
+  setConfigValue(config, CONFIG_TAG_SYNC_INTERVAL, syncInterval / 2);
+  uint8_t data[CONFIG_MAX_AUTHENTICATED_LENGTH];
+  size_t length = encodeConfig(config, data);
+  uint8_t status;
+
+  // Unauthenticated: Rejected.
+  CHECK_EQUAL(writeConfiguration(central, data, length, &status), syncInterval);
+  CHECK_EQUAL(status, CONFIG_STATUS_UNAUTHENTICATED);
+  // No key is provisioned: Rejected.
+  size_t authenticatedLength = authenticateConfig(data, length, 1, KEY.key);
+  CHECK_EQUAL(writeConfiguration(central, data, authenticatedLength, &status), syncInterval);
+  CHECK_EQUAL(status, CONFIG_STATUS_UNAUTHENTICATED);
+
+  CHECK(client.provisionConfigKey(KEY));
+  CHECK_EQUAL(writeConfiguration(central, data, authenticatedLength, &status), syncInterval / 2);
+  CHECK_EQUAL(status, CONFIG_STATUS_OK);
+  // A replay (of a used sequence number) and another key: Rejected.
+  CHECK_EQUAL(writeConfiguration(central, data, authenticatedLength, &status), syncInterval / 2);
+  CHECK_EQUAL(status, CONFIG_STATUS_UNAUTHENTICATED);
+  setConfigValue(config, CONFIG_TAG_SYNC_INTERVAL, syncInterval);
+  length = encodeConfig(config, data);
+  CHECK_EQUAL(writeConfiguration(central, data, authenticateConfig(data, length, 2, OTHER_KEY.key), &status), syncInterval / 2);
+  CHECK_EQUAL(status, CONFIG_STATUS_UNAUTHENTICATED);
+  CHECK_EQUAL(writeConfiguration(central, data, authenticateConfig(data, length, 2, KEY.key), &status), syncInterval);
+  CHECK_EQUAL(status, CONFIG_STATUS_OK);
+
+  // Revoked: Rejected again.
+  CHECK(client.provisionConfigKey(SerialConfigKey {}));
+  setConfigValue(config, CONFIG_TAG_SYNC_INTERVAL, syncInterval / 2);
+  length = encodeConfig(config, data);
+  CHECK_EQUAL(writeConfiguration(central, data, authenticateConfig(data, length, 3, KEY.key), &status), syncInterval);
+  CHECK_EQUAL(status, CONFIG_STATUS_UNAUTHENTICATED);
+}
+
+/// Disconnecting a Central releases its timers (fixed at their local time), but does
+/// not touch the timers of the others: Those follow their Central's clock.
+static void testReleaseTimers(VirtualCentral centrals[3]) {
+  std::vector<VirtualCentral *> remaining = { &centrals[1], &centrals[2] };
+  clearRises();
+
+  uint32_t hostTime = SerialClient::hostTime();
+  CHECK(scheduleChannel(centrals[0], 0, centrals[0].time() + 700));
+  CHECK(scheduleChannel(centrals[1], 1, centrals[1].time() + 900));
+  pollAll({ &centrals[0], &centrals[1], &centrals[2] }, 50);
+
+  centrals[0].close();
+  pollAll(remaining, 50);
+
+  // The clock of the second Central is stepped back by 300 ms: Its timer is rebased.
+  // (A failed Training is retried.)
+  centrals[1].setClockOffset(centrals[1].time() - SerialClient::hostTime() - 300);
+  for (int i = 0; i < 3; i++) {
+    CHECK(centrals[1].train());
+    pollAll(remaining, 50);
+  }
+  CHECK(SerialClient::hostTime() < hostTime + 700);
+  pollAll(remaining, hostTime + 1300 - SerialClient::hostTime());
+
+  CHECK(isRisenAt(0, hostTime + 700));
+  CHECK(isRisenAt(1, hostTime + 1200));
+}
+
+int main(int argc, char *argv[]) {
+  const char *virtualPath = argc > 1 ? argv[1] : "build/signalboy-virtual";
+  snprintf(socketPath, sizeof(socketPath), "/tmp/signalboy-test-centrals-%d", (int)getpid());
+  snprintf(serialPath, sizeof(serialPath), "/tmp/signalboy-test-centrals-%d.tty", (int)getpid());
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    freopen("build/tests/test-centrals.log", "w", stdout);
+    dup2(fileno(stdout), fileno(stderr));
+    execl(virtualPath, virtualPath, "--socket", socketPath, "--serial", serialPath, (char *)nullptr);
+    _exit(127);
+  }
+
+  VirtualCentral centrals[3];
+  const char *addresses[3] = { "00:00:00:00:00:01", "00:00:00:00:00:02", "00:00:00:00:00:03" };
+  // Clocks far apart from each other (and from the Signalboy's).
+  const int32_t clockOffsets[3] = { 0, 250000, 1000000 };
+
+  // Awaits the socket of the virtual Signalboy.
+  bool isConnected = false;
+  for (int attempt = 0; attempt < 50 && !isConnected; attempt++) {
+    usleep(100000);
+    isConnected = connectCentral(centrals[0], addresses[0], clockOffsets[0]);
+  }
+  CHECK(isConnected);
+  for (int i = 1; i < 3; i++) {
+    CHECK(connectCentral(centrals[i], addresses[i], clockOffsets[i]));
+  }
+  // The host connected by USB (which provisions the configuration key).
+  SerialClient client;
+  CHECK(client.open(serialPath));
+
+  if (testFailuresCount == 0) {
+    CHECK(syncAll({ &centrals[0], &centrals[1], &centrals[2] }));
+    testConcurrentCentrals(centrals);
+
+    VirtualCentral extraCentral;
+    testSlotAccounting(centrals, extraCentral);
+    testConfigurationAuthenticated(centrals[2], client);
+    testReleaseTimers(centrals);
+
+    // The released slot is taken by the next Central.
+    CHECK(connectCentral(extraCentral, "00:00:00:00:00:04", -500000));
+    // (The others' resyncs keep `timeNeedsSync` from settling: Trained regardless.)
+    for (int i = 0; i < 3; i++) {
+      CHECK(extraCentral.train());
+      pollAll({ &extraCentral, &centrals[1], &centrals[2] }, 50);
+    }
+    clearRises();
+    uint32_t hostTime = SerialClient::hostTime();
+    CHECK(scheduleChannel(extraCentral, 0, extraCentral.time() + 300));
+    pollAll({ &extraCentral, &centrals[1], &centrals[2] }, 500);
+    CHECK(isRisenAt(0, hostTime + 300));
+  }
+
+  for (VirtualCentral &central : centrals) central.close();
+  kill(pid, SIGTERM);
+  waitpid(pid, nullptr, 0);
+  unlink(socketPath);
+  unlink(serialPath);
+
+  return testResult("test-centrals");
+}
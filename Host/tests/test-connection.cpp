@@ -0,0 +1,247 @@
+/*
+  Tests the tracking of the Connection-Parameters (connection.cpp) and the HCI tap
+  (HCITap.cpp) with canned HCI-packets of the controller (s. fakeHci.h).
+*/
+
+#include <Arduino.h>
+#include <ArduinoShim.h>
+#include <utility/HCI.h>
+#include "connection.h"
+#include "constants.h"
+#include "faultLog.h"
+#include "fakeHci.h"
+#include "test.h"
+
+static const uint16_t HANDLE = 0x0040;
+static const uint16_t ENHANCED_HANDLE = 0x0041;
+static const char ADDRESS[] = "aa:bb:cc:dd:ee:ff";
+
+static void receive(const std::vector<uint8_t> &packet) {
+  fakeHciReceive(packet);
+  HCI.poll();
+}
+
+static std::vector<uint8_t> connectionComplete(uint16_t handle, uint8_t role, uint16_t interval, uint16_t latency) {
+  return {
+    0x04, 0x3e, 0x13, 0x01,
+    0x00,  // status
+    (uint8_t)handle, (uint8_t)(handle >> 8),
+    role,
+    0x00,  // peer address type
+    0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa,
+    (uint8_t)interval, (uint8_t)(interval >> 8),
+    (uint8_t)latency, (uint8_t)(latency >> 8),
+    0xc8, 0x00,  // supervision timeout
+    0x00  // clock accuracy
+  };
+}
+
+static std::vector<uint8_t> enhancedConnectionComplete(uint16_t handle, uint16_t interval, uint16_t latency) {
+  return {
+    0x04, 0x3e, 0x1f, 0x0a,
+    0x00,
+    (uint8_t)handle, (uint8_t)(handle >> 8),
+    0x01,
+    0x01,
+    0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x11, 0x12, 0x13, 0x14, 0x15, 0x16,  // local resolvable private address
+    0x21, 0x22, 0x23, 0x24, 0x25, 0x26,  // peer resolvable private address
+    (uint8_t)interval, (uint8_t)(interval >> 8),
+    (uint8_t)latency, (uint8_t)(latency >> 8),
+    0xc8, 0x00,
+    0x00
+  };
+}
+
+static std::vector<uint8_t> connectionUpdateComplete(uint16_t handle, uint16_t interval, uint16_t latency) {
+  return {
+    0x04, 0x3e, 0x0a, 0x03,
+    0x00,
+    (uint8_t)handle, (uint8_t)(handle >> 8),
+    (uint8_t)interval, (uint8_t)(interval >> 8),
+    (uint8_t)latency, (uint8_t)(latency >> 8),
+    0xc8, 0x00
+  };
+}
+
+static std::vector<uint8_t> disconnectionComplete(uint16_t handle) {
+  return { 0x04, 0x05, 0x04, 0x00, (uint8_t)handle, (uint8_t)(handle >> 8), 0x13 };
+}
+
+/// L2CAP Connection Parameter Update Response (ACL-data, packet boundary flags set).
+static std::vector<uint8_t> updateResponse(uint16_t handle, uint8_t identifier, uint16_t result) {
+  return {
+    0x02,
+    (uint8_t)handle, (uint8_t)((handle >> 8) | 0x20),
+    0x0a, 0x00,  // ACL length
+    0x06, 0x00,  // L2CAP length
+    0x05, 0x00,  // signaling channel
+    0x13, identifier, 0x02, 0x00,
+    (uint8_t)result, (uint8_t)(result >> 8)
+  };
+}
+
+static uint16_t readUInt16(const std::vector<uint8_t> &data, size_t index) {
+  return data[index] | (data[index + 1] << 8);
+}
+
+static void testConnectionComplete(void) {
+  receive(connectionComplete(HANDLE, 0x01, 24, 0));
+
+  CHECK(isConnectionEstablished(HANDLE));
+  CHECK_EQUAL(getConnectionHandle(ADDRESS), HANDLE);
+  CHECK_EQUAL(getConnectionInterval(HANDLE), 24);
+  CHECK_EQUAL(getConnectionIntervalMicros(HANDLE), 30000);
+  CHECK_EQUAL(getSlaveLatency(HANDLE), 0);
+
+  // Connections as Central are not tracked.
+  receive(connectionComplete(0x0050, 0x00, 24, 0));
+  CHECK(!isConnectionEstablished(0x0050));
+
+  // Truncated events are ignored.
+  std::vector<uint8_t> truncated = connectionComplete(0x0051, 0x01, 24, 0);
+  truncated.resize(12);
+  truncated[2] = truncated.size() - 3;
+  receive(truncated);
+  CHECK(!isConnectionEstablished(0x0051));
+}
+
+static void testEnhancedConnectionComplete(void) {
+  receive(enhancedConnectionComplete(ENHANCED_HANDLE, 12, 4));
+
+  CHECK(isConnectionEstablished(ENHANCED_HANDLE));
+  CHECK_EQUAL(getConnectionHandle("06:05:04:03:02:01"), ENHANCED_HANDLE);
+  CHECK_EQUAL(getConnectionInterval(ENHANCED_HANDLE), 12);
+  CHECK_EQUAL(getSlaveLatency(ENHANCED_HANDLE), 4);
+}
+
+static void testConnectionUpdateComplete(void) {
+  receive(connectionUpdateComplete(HANDLE, 6, 0));
+  CHECK_EQUAL(getConnectionInterval(HANDLE), 6);
+  CHECK_EQUAL(getConnectionIntervalMicros(HANDLE), 7500);
+
+  // Other connections are not affected.
+  CHECK_EQUAL(getConnectionInterval(ENHANCED_HANDLE), 12);
+
+  // Failed updates and unknown handles are ignored.
+  std::vector<uint8_t> failed = connectionUpdateComplete(HANDLE, 24, 0);
+  failed[4] = 0x3b;
+  receive(failed);
+  CHECK_EQUAL(getConnectionInterval(HANDLE), 6);
+  receive(connectionUpdateComplete(0x0060, 24, 0));
+  CHECK_EQUAL(getConnectionInterval(HANDLE), 6);
+}
+
+static void testOversizedPacket(void) {
+  // An LE Advertising Report exceeding the capture size: Passed through, and the
+  // next packet is parsed from its start.
+  std::vector<uint8_t> report = { 0x04, 0x3e, 60, 0x02 };
+  report.resize(3 + 60, 0xab);
+  receive(report);
+
+  // Bytes outside of a packet (no packet indicator) are skipped.
+  receive({ 0x00 });
+
+  receive(connectionUpdateComplete(HANDLE, 8, 0));
+  CHECK_EQUAL(getConnectionInterval(HANDLE), 8);
+}
+
+static void testUpdateRequest(void) {
+  fakeHciSentAclPackets().clear();
+
+  // The fast Connection-Mode is desired after connecting: Requested from both
+  // connections (neither matches it).
+  updateConnectionParametersIfNeeded();
+  std::vector<FakeHciAclPacket> &sent = fakeHciSentAclPackets();
+  bool isRequested[2] = {};
+  for (const FakeHciAclPacket &packet : sent) {
+    if (packet.handle == HANDLE) isRequested[0] = true;
+    if (packet.handle == ENHANCED_HANDLE) isRequested[1] = true;
+  }
+  CHECK(isRequested[0]);
+  CHECK(isRequested[1]);
+
+  const FakeHciAclPacket &request = sent[0];
+  CHECK_EQUAL(request.handle, HANDLE);
+  CHECK_EQUAL(request.cid, 0x05);
+  CHECK_EQUAL(request.data.size(), 12);
+  CHECK_EQUAL(request.data[0], 0x12);
+  CHECK(request.data[1] != 0);
+  CHECK_EQUAL(readUInt16(request.data, 2), 8);
+  CHECK_EQUAL(readUInt16(request.data, 4), CONNECTION_INTERVAL_FAST_DEFAULT);
+  CHECK_EQUAL(readUInt16(request.data, 6), CONNECTION_INTERVAL_FAST_DEFAULT);
+  CHECK_EQUAL(readUInt16(request.data, 8), 0);
+  CHECK_EQUAL(readUInt16(request.data, 10), CONNECTION_SUPERVISION_TIMEOUT);
+  uint8_t identifier = request.data[1];
+
+  // Pending: Not resent before the timeout.
+  sent.clear();
+  updateConnectionParametersIfNeeded();
+  CHECK_EQUAL(sent.size(), 0);
+
+  // Rejected: Reported, and kept pending. Responses to other requests are ignored.
+  uint16_t faultsCountBefore = faultsCount();
+  receive(updateResponse(HANDLE, identifier + 1, 0x0001));
+  CHECK_EQUAL(faultsCount(), faultsCountBefore);
+  receive(updateResponse(HANDLE, identifier, 0x0001));
+  CHECK_EQUAL(faultsCount(), faultsCountBefore + 1);
+  FaultRecord fault;
+  CHECK(faultAt(0, &fault));
+  CHECK_EQUAL(fault.domain, FAULT_DOMAIN_CONNECTION);
+  CHECK_EQUAL(fault.code, FAULT_CODE_PARAMETERS_REJECTED);
+  CHECK_EQUAL(fault.arguments[0], HANDLE);
+
+  // Resent with a new identifier after the timeout.
+  setSimulatedMicros(simulatedMicros() + 5001000ULL);
+  updateConnectionParametersIfNeeded();
+  bool isResent = false;
+  for (const FakeHciAclPacket &packet : sent) {
+    if (packet.handle != HANDLE) continue;
+    isResent = true;
+    CHECK(packet.data[1] != identifier);
+  }
+  CHECK(isResent);
+
+  // Granted: Nothing more is requested.
+  receive(connectionUpdateComplete(HANDLE, CONNECTION_INTERVAL_FAST_DEFAULT, 0));
+  receive(connectionUpdateComplete(ENHANCED_HANDLE, CONNECTION_INTERVAL_FAST_DEFAULT, 0));
+  sent.clear();
+  setSimulatedMicros(simulatedMicros() + 5001000ULL);
+  updateConnectionParametersIfNeeded();
+  CHECK_EQUAL(sent.size(), 0);
+
+  // The idle Connection-Mode adds the Slave-Latency.
+  setConnectionMode(HANDLE, connectionModeIDLE);
+  updateConnectionParametersIfNeeded();
+  CHECK_EQUAL(sent.size(), 1);
+  CHECK_EQUAL(readUInt16(sent[0].data, 4), CONNECTION_INTERVAL_IDLE_DEFAULT);
+  CHECK_EQUAL(readUInt16(sent[0].data, 8), CONNECTION_SLAVE_LATENCY_IDLE);
+}
+
+static void testDisconnectionComplete(void) {
+  receive(disconnectionComplete(HANDLE));
+
+  CHECK(!isConnectionEstablished(HANDLE));
+  CHECK_EQUAL(getConnectionHandle(ADDRESS), CONNECTION_HANDLE_NONE);
+  CHECK_EQUAL(getConnectionInterval(HANDLE), 0);
+  CHECK(isConnectionEstablished(ENHANCED_HANDLE));
+
+  // The slot is reused by the next connection.
+  receive(connectionComplete(HANDLE, 0x01, 12, 0));
+  CHECK(isConnectionEstablished(HANDLE));
+  CHECK_EQUAL(getConnectionInterval(HANDLE), 12);
+}
+
+int main(void) {
+  setSimulatedMicros(1000000);
+  setupConnection();
+
+  testConnectionComplete();
+  testEnhancedConnectionComplete();
+  testConnectionUpdateComplete();
+  testOversizedPacket();
+  testUpdateRequest();
+  testDisconnectionComplete();
+
+  return testResult("test-connection");
+}
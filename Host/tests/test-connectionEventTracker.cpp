@@ -0,0 +1,111 @@
+/*
+  Tests the estimation of the anchors of the Connection-Events
+  (ConnectionEventTracker.cpp) with simulated receptions.
+*/
+
+#include <Arduino.h>
+#include "ConnectionEventTracker.h"
+#include "test.h"
+
+static const unsigned long INTERVAL = 7500;  // in µs
+
+/// Distance (in µs) of `anchor` to the nearest Connection-Event of a Central, whose
+/// anchors are at `origin` + k * `interval`.
+static long anchorError(unsigned long anchor, unsigned long origin, unsigned long interval) {
+  long phase = (long)((anchor - origin) % interval);
+  return phase > (long)interval / 2 ? phase - (long)interval : phase;
+}
+
+static long absolute(long value) {
+  return value < 0 ? -value : value;
+}
+
+static void testAcquisition(void) {
+  ConnectionEventTracker tracker;
+  tracker.setConnectionInterval(INTERVAL);
+  const unsigned long origin = 1000000;
+
+  // Not locked: The reception time is returned.
+  CHECK_EQUAL(tracker.getAnchor(origin + 123), origin + 123);
+
+  // The first packet is delayed, the next ones are not: The earliest wins.
+  tracker.onPacketReceived(origin + 400);
+  tracker.onPacketReceived(origin + INTERVAL + 30);
+  tracker.onPacketReceived(origin + 2 * INTERVAL + 10);
+  CHECK(!tracker.isLocked());
+  tracker.onPacketReceived(origin + 3 * INTERVAL + 50);
+  CHECK(tracker.isLocked());
+
+  // (The later receptions are followed by the drift correction.)
+  CHECK(absolute(anchorError(tracker.getAnchor(origin + 4 * INTERVAL + 200), origin, INTERVAL)) <= 10 + 20);
+  CHECK_EQUAL(tracker.getAnchor(origin + 4 * INTERVAL + 200), tracker.getAnchor(origin + 4 * INTERVAL + 100));
+
+  // A changed Connection-Interval starts over.
+  tracker.setConnectionInterval(2 * INTERVAL);
+  CHECK(!tracker.isLocked());
+}
+
+static void testLateWrap(void) {
+  ConnectionEventTracker tracker;
+  tracker.setConnectionInterval(INTERVAL);
+  const unsigned long origin = 2000000;
+
+  for (int i = 0; i < 8; i++) {
+    tracker.onPacketReceived(origin + i * INTERVAL);
+  }
+  unsigned long event = origin + 8 * INTERVAL;
+
+  // Delayed by 4/5 of the Connection-Interval (i.e. the loop was busy): Attributed
+  // to its Connection-Event, and the anchor moves by the drift correction at most.
+  unsigned long lateReception = event + INTERVAL * 4 / 5;
+  CHECK_EQUAL(tracker.getAnchor(lateReception), event);
+  tracker.onPacketReceived(lateReception);
+  CHECK(absolute(anchorError(tracker.getAnchor(event + INTERVAL + 5), origin, INTERVAL)) <= 20);
+
+  // The receptions on time pull it back.
+  for (int i = 2; i < 6; i++) {
+    tracker.onPacketReceived(event + i * INTERVAL);
+  }
+  CHECK_EQUAL(tracker.getAnchor(event + 6 * INTERVAL + 100), event + 6 * INTERVAL);
+
+  // A burst of late receptions does not bias the anchor by their delay.
+  for (int i = 6; i < 10; i++) {
+    tracker.onPacketReceived(event + i * INTERVAL + INTERVAL * 9 / 10);
+  }
+  CHECK(absolute(anchorError(tracker.getAnchor(event + 10 * INTERVAL), origin, INTERVAL)) <= 4 * 20);
+}
+
+/// The Central's clock runs `ppm` faster (or slower): The anchors drift relative to ours.
+static void testDrift(long ppm) {
+  ConnectionEventTracker tracker;
+  tracker.setConnectionInterval(INTERVAL);
+  // Starts close to the wrap-around of `micros()`.
+  const unsigned long origin = 0xffffffffUL - 50 * INTERVAL;
+
+  long maximumError = 0;
+  for (long i = 0; i < 20000; i++) {
+    long drift = i * (long)INTERVAL / 1000000L * ppm;
+    unsigned long event = origin + i * INTERVAL + drift;
+    // Receptions are delayed by up to 150 µs, every 7th by most of the interval.
+    unsigned long delay = (i * 37) % 150 + (i % 7 == 3 ? INTERVAL * 5 / 6 : 0);
+    tracker.onPacketReceived(event + delay);
+
+    if (i >= 100) {
+      long error = (long)(tracker.getAnchor(event + 200) - event);
+      if (absolute(error) > maximumError) maximumError = absolute(error);
+    }
+  }
+
+  // Within the spread of the (regular) delays.
+  CHECK(maximumError <= 150);
+}
+
+int main(void) {
+  testAcquisition();
+  testLateWrap();
+  testDrift(0);
+  testDrift(50);
+  testDrift(-50);
+
+  return testResult("test-connectionEventTracker");
+}
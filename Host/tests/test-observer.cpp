@@ -0,0 +1,176 @@
+/*
+  Tests the Broadcast-Observer (observer.cpp): The authentication of the advertisements
+  by the provisioned keys, the rejection of replays and the recovery of rebooted or
+  silent broadcasters.
+*/
+
+#include <string.h>
+#include <Arduino.h>
+#include <ArduinoShim.h>
+#include <utility/HCI.h>
+#include "HCITap.h"
+#include "constants.h"
+#include "flashStorage.h"
+#include "observer.h"
+#include "rtc.hpp"
+#include "scheduler.h"
+#include "siphash.h"
+#include "fakeHci.h"
+#include "test.h"
+
+static const uint8_t KEY[SIPHASH_KEY_SIZE] = {
+  0x3c, 0x91, 0x5e, 0x02, 0xa7, 0x48, 0xd3, 0x16, 0x7b, 0xe0, 0x29, 0xc4, 0x85, 0x5a, 0xf1, 0x6d
+};
+static const uint8_t OTHER_KEY[SIPHASH_KEY_SIZE] = {
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const uint8_t BROADCASTER_ID = 1;
+
+static void writeUInt32(uint8_t *data, uint32_t value) {
+  for (int i = 0; i < 4; i++) data[i] = value >> (8 * i);
+}
+
+/// The advertising data (flags and the Broadcast-Advertisement, s. observer.h) of a
+/// broadcaster, signed by `key`.
+static std::vector<uint8_t> advertisement(uint8_t broadcasterId, uint32_t epoch, uint32_t sequenceNumber,
+    uint32_t timestamp, uint32_t targetTimestamp, const uint8_t *key = KEY) {
+  uint8_t payload[24] = { (uint8_t)BROADCAST_COMPANY_ID, (uint8_t)(BROADCAST_COMPANY_ID >> 8), BROADCAST_TYPE, broadcasterId };
+  writeUInt32(&payload[4], epoch);
+  writeUInt32(&payload[8], sequenceNumber);
+  writeUInt32(&payload[12], timestamp);
+  writeUInt32(&payload[16], targetTimestamp);
+  writeUInt32(&payload[20], (uint32_t)siphash24(payload, 20, key));
+
+  std::vector<uint8_t> data = { 0x02, 0x01, 0x06, sizeof(payload) + 1, 0xff };
+  data.insert(data.end(), payload, payload + sizeof(payload));
+  return data;
+}
+
+static bool receive(const std::vector<uint8_t> &data) {
+  int armedCount = armedTimersCount();
+  onAdvertisingDataReceived(data.data(), data.size(), micros());
+  return armedTimersCount() > armedCount;
+}
+
+/// Advances the time by `duration` ms, and fires the timers due.
+static void advance(unsigned long duration) {
+  setSimulatedMicros(simulatedMicros() + duration * 1000ULL);
+  for (int i = 0; i < 4; i++) updateTimers();
+}
+
+static void testFailClosed(void) {
+  // No broadcaster is provisioned (i.e. the well-known default key is not accepted).
+  CHECK(!receive(advertisement(0, 1, 1, 1000, 1100, OTHER_KEY)));
+  CHECK(!receive(advertisement(BROADCASTER_ID, 1, 1, 1000, 1100)));
+  CHECK(!provisionBroadcasterKey(BROADCASTERS_MAX, KEY));
+}
+
+static void testAuthentication(void) {
+  CHECK(provisionBroadcasterKey(BROADCASTER_ID, KEY));
+
+  // Armed at the delay from the reception.
+  unsigned long receivedTime = millisRtc(false);
+  CHECK(receive(advertisement(BROADCASTER_ID, 1, 1, 1000, 1100)));
+  unsigned long deadline;
+  CHECK(nextTimerDeadline(&deadline));
+  CHECK((long)(deadline - (receivedTime + 100)) >= 0 && (long)(deadline - (receivedTime + 100)) <= 1);
+  advance(200);
+
+  // Repetitions by subsequent advertising events are not.
+  CHECK(!receive(advertisement(BROADCASTER_ID, 1, 1, 1000, 1100)));
+
+  // Signed by another key, or of a broadcaster not provisioned.
+  CHECK(!receive(advertisement(BROADCASTER_ID, 1, 2, 1200, 1300, OTHER_KEY)));
+  CHECK(!receive(advertisement(BROADCASTER_ID + 1, 1, 2, 1200, 1300)));
+
+  // Tampered.
+  std::vector<uint8_t> tampered = advertisement(BROADCASTER_ID, 1, 2, 1200, 1300);
+  tampered[5 + 16] ^= 0x01;
+  CHECK(!receive(tampered));
+
+  CHECK(receive(advertisement(BROADCASTER_ID, 1, 2, 1200, 1300)));
+  advance(200);
+}
+
+static void testReplays(void) {
+  // An earlier sequence number, and a later one with a discontinuous time.
+  CHECK(!receive(advertisement(BROADCASTER_ID, 1, 1, 1000, 1100)));
+  CHECK(!receive(advertisement(BROADCASTER_ID, 1, 3, 1400 + 5000, 1400 + 5100)));
+
+  // The broadcaster rebooted: A new epoch starts over with its sequence number and time.
+  CHECK(receive(advertisement(BROADCASTER_ID, 2, 1, 50, 150)));
+  advance(200);
+  CHECK(receive(advertisement(BROADCASTER_ID, 2, 2, 250, 350)));
+  advance(200);
+
+  // Advertisements of the previous epoch are replays.
+  CHECK(!receive(advertisement(BROADCASTER_ID, 1, 10, 1800, 1900)));
+}
+
+static void testStaleTime(void) {
+  // The Signalboy restarted (the broadcaster's state is forgotten), and an old
+  // advertisement is replayed: It pins a stale time of the broadcaster, ...
+  CHECK(provisionBroadcasterKey(BROADCASTER_ID, KEY));
+  CHECK(receive(advertisement(BROADCASTER_ID, 2, 2, 250, 350)));
+  advance(200);
+
+  // ... so the current advertisements are rejected, ...
+  CHECK(!receive(advertisement(BROADCASTER_ID, 2, 20, 60000, 60100)));
+
+  // ... but not for longer than `BROADCAST_STATE_TIMEOUT`.
+  advance(BROADCAST_STATE_TIMEOUT);
+  CHECK(receive(advertisement(BROADCASTER_ID, 2, 21, 60000 + BROADCAST_STATE_TIMEOUT, 60100 + BROADCAST_STATE_TIMEOUT)));
+  advance(200);
+
+  // The replayed one is not accepted again.
+  CHECK(!receive(advertisement(BROADCASTER_ID, 2, 2, 250, 350)));
+}
+
+static void testAdvertisingReport(void) {
+  // LE Advertising Report, as received by the HCI-tap.
+  std::vector<uint8_t> data = advertisement(BROADCASTER_ID, 3, 1, 5000, 5100);
+  std::vector<uint8_t> report = {
+    0x04, 0x3e, (uint8_t)(1 + 1 + 1 + 1 + 6 + 1 + data.size() + 1), 0x02,
+    0x01,  // number of reports
+    0x03,  // non-connectable undirected
+    0x01,  // random address
+    0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    (uint8_t)data.size()
+  };
+  report.insert(report.end(), data.begin(), data.end());
+  report.push_back(0xc4);  // RSSI
+
+  int armedCount = armedTimersCount();
+  fakeHciReceive(report);
+  HCI.poll();
+  CHECK_EQUAL(armedTimersCount(), armedCount + 1);
+  advance(200);
+}
+
+static void testPersistence(void) {
+  const uint8_t *stored = flashStorage() + FLASH_STORAGE_KEYS_OFFSET;
+
+  persistBroadcasterKeysIfNeeded();
+  CHECK(memmem(stored, FLASH_STORAGE_KEYS_SIZE, KEY, sizeof(KEY)) != nullptr);
+
+  // Revoked: Rejected at once, and no longer persisted.
+  CHECK(provisionBroadcasterKey(BROADCASTER_ID, nullptr));
+  CHECK(!receive(advertisement(BROADCASTER_ID, 4, 1, 5000, 5100)));
+  persistBroadcasterKeysIfNeeded();
+  CHECK(memmem(stored, FLASH_STORAGE_KEYS_SIZE, KEY, sizeof(KEY)) == nullptr);
+}
+
+int main(void) {
+  setSimulatedMicros(1000000);
+  HCI.setTransport(&hciTap);
+  setupObserver();
+
+  testFailClosed();
+  testAuthentication();
+  testReplays();
+  testStaleTime();
+  testAdvertisingReport();
+  testPersistence();
+
+  return testResult("test-observer");
+}
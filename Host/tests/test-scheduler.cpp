@@ -0,0 +1,174 @@
+/*
+  Tests the corrections of a synced clock (time.cpp) and the timers following them
+  (scheduler.cpp): Corrections up to `CLOCK_STEP_THRESHOLD` are slewed, larger ones are
+  stepped, and a step rebases the timers of the clock. A calibration timer records
+  the SQW tick at which it became due.
+*/
+
+#include <Arduino.h>
+#include <ArduinoShim.h>
+#include "constants.h"
+#include "rtc.hpp"
+#include "scheduler.h"
+#include "time.h"
+#include "test.h"
+
+static const unsigned long UNCERTAINTY = 1000;  // in µs
+
+/// Advances the simulated time to the local time `t` (in ms).
+static void advanceTo(unsigned long t) {
+  setSimulatedMicros(microsAtMillisRtc(t) + 10);
+}
+
+/// Resyncs `clock` to its current synced time corrected by `correction` ms. Returns the step.
+static long resync(SyncedClock &clock, long correction) {
+  return setTime(clock, toSyncedTime(clock, millisRtc(false)) + correction, UNCERTAINTY, TRAINING_MSGS_COUNT_DEFAULT);
+}
+
+/// Synced time (of `clock`) at local time `t`, if the clock is not corrected meanwhile.
+static unsigned long syncedTimeAt(SyncedClock &clock, unsigned long t) {
+  return toSyncedTime(clock, millisRtc(false)) + (t - millisRtc(false));
+}
+
+/// A correction of `correction` ms at local time `t`: Slewed (at `CLOCK_SLEW_RATE`) or stepped.
+static void testCorrection(SyncedClock &clock, unsigned long t, long correction, bool isStepped) {
+  advanceTo(t);
+  unsigned long syncedTime = now(clock);
+  CHECK_EQUAL(resync(clock, correction), isStepped ? correction : 0);
+
+  if (isStepped) {
+    CHECK_EQUAL(now(clock), syncedTime + correction);
+    return;
+  }
+
+  // Continuous: Slewed by 1 ms per second (of `CLOCK_SLEW_RATE` ppm).
+  CHECK_EQUAL(now(clock), syncedTime);
+  long slewed = correction > 0 ? 2 : -2;
+  advanceTo(t + 2000);
+  CHECK_EQUAL(now(clock), syncedTime + 2000 + slewed);
+  // Slewing finished.
+  advanceTo(t + 10000);
+  CHECK_EQUAL(now(clock), syncedTime + 10000 + correction);
+}
+
+static void testSlewOrStep(void) {
+  SyncedClock clock;
+  initClock(clock);
+  CHECK_EQUAL(CLOCK_SLEW_RATE, 1000UL);
+
+  // The first sync sets the time.
+  advanceTo(10000);
+  CHECK_EQUAL(setTime(clock, 500000, UNCERTAINTY, TRAINING_MSGS_COUNT_DEFAULT), 0);
+  CHECK_EQUAL(now(clock), 500000);
+
+  testCorrection(clock, 70000, CLOCK_STEP_THRESHOLD, false);
+  testCorrection(clock, 130000, CLOCK_STEP_THRESHOLD + 1, true);
+  testCorrection(clock, 190000, -(long)CLOCK_STEP_THRESHOLD, false);
+  testCorrection(clock, 250000, -(long)(CLOCK_STEP_THRESHOLD + 1), true);
+}
+
+/// The levels of the channels at local time `t` (s. `updateTimers()`).
+static uint8_t levelsAt(unsigned long t) {
+  advanceTo(t);
+  return updateTimers();
+}
+
+static void testRebase(void) {
+  const unsigned long width = SIGNAL_HIGH_INTERVAL_DEFAULT;
+  SyncedClock clock;
+  initClock(clock);
+  advanceTo(300000);
+  CHECK_EQUAL(setTime(clock, 800000, UNCERTAINTY, TRAINING_MSGS_COUNT_DEFAULT), 0);
+
+  unsigned long localTime = 300000;
+  unsigned long syncedTime = syncedTimeAt(clock, localTime);
+  CHECK(TIMER_LATENESS_TOLERANCE >= 50 && TIMER_LATENESS_TOLERANCE < 150);
+
+  // The clock is stepped ahead by 200 ms: The timers are moved 200 ms into the past.
+  // - More than `TIMER_LATENESS_TOLERANCE` late: Fires immediately (not missed).
+  CHECK(armTimer(clock, syncedTime + 50, 0, timerSourceSCHEDULED));
+  // - Within the tolerance (50 ms late): Keeps its synced target time.
+  CHECK(armTimer(clock, syncedTime + 150, 1, timerSourceSCHEDULED));
+  // - Not late: Fires at its synced target time.
+  CHECK(armTimer(clock, syncedTime + 400, 2, timerSourceSCHEDULED));
+  // - Local time: Not affected.
+  CHECK(armTimer(localTime + 250, 3, timerSourceTRIGGER));
+
+  CHECK_EQUAL(resync(clock, 200), 200);
+  rebaseTimers(clock, 200);
+
+  // (In the order of time.)
+  CHECK_EQUAL(levelsAt(localTime), 0x03);
+  // Fired 50 ms late: Its pulse ends 50 ms early.
+  CHECK_EQUAL(levelsAt(localTime + width - 50), 0x03);
+  CHECK_EQUAL(levelsAt(localTime + width - 50 + 1), 0x01);
+  CHECK_EQUAL(levelsAt(localTime + width), 0x01);
+  CHECK_EQUAL(levelsAt(localTime + width + 1), 0x00);
+
+  CHECK_EQUAL(levelsAt(localTime + 199), 0x00);
+  CHECK_EQUAL(levelsAt(localTime + 200), 0x04);
+  CHECK_EQUAL(levelsAt(localTime + 249), 0x04);
+  CHECK_EQUAL(levelsAt(localTime + 250), 0x0c);
+
+  advanceTo(localTime + 1000);
+  updateTimers();
+  CHECK(!isAnyTimerArmed());
+
+  // Stepped back by 200 ms: The timers are moved into the future.
+  localTime += 1000;
+  syncedTime = syncedTimeAt(clock, localTime);
+  CHECK(armTimer(clock, syncedTime + 100, 0, timerSourceSCHEDULED));
+  CHECK_EQUAL(resync(clock, -200), -200);
+  rebaseTimers(clock, -200);
+
+  CHECK_EQUAL(levelsAt(localTime + 299), 0x00);
+  CHECK_EQUAL(levelsAt(localTime + 300), 0x01);
+  advanceTo(localTime + 1000);
+  updateTimers();
+  CHECK(!isAnyTimerArmed());
+}
+
+/// Without the rebase, a timer moved into the past by more than the tolerance is missed.
+static void testMissedWithoutRebase(void) {
+  SyncedClock clock;
+  initClock(clock);
+  advanceTo(400000);
+  CHECK_EQUAL(setTime(clock, 900000, UNCERTAINTY, TRAINING_MSGS_COUNT_DEFAULT), 0);
+
+  unsigned long localTime = 400000;
+  CHECK(armTimer(clock, syncedTimeAt(clock, localTime) + 50, 0, timerSourceSCHEDULED));
+  CHECK_EQUAL(resync(clock, 200), 200);
+
+  CHECK_EQUAL(levelsAt(localTime), 0x00);
+  CHECK(!isAnyTimerArmed());
+}
+
+/// A calibration timer fired `lateness` ms late: Its due time is the SQW tick that
+/// advanced the local time to its target time (not counted back by 1000 µs per ms).
+static void testCalibrationDueTime(void) {
+  for (unsigned long lateness = 0; lateness < 50; lateness += 7) {
+    unsigned long localTime = 500000 + lateness * 1000;
+    CHECK(armTimer(localTime, 0, timerSourceCALIBRATION));
+    levelsAt(localTime + lateness);
+
+    // (The virtual RTC knows the tick exactly, `rtcTickMicrosAtMillis()` rounds to µs.)
+    long error = (long)(lastCalibrationTimerDueMicros() - microsAtMillisRtc(localTime));
+    CHECK(error >= -1 && error <= 1);
+
+    advanceTo(localTime + 1000);
+    updateTimers();
+    CHECK(!isAnyTimerArmed());
+  }
+}
+
+int main(void) {
+  setSimulatedMicros(1000000);
+  setSyncInterval(SYNC_INTERVAL_DEFAULT);
+
+  testSlewOrStep();
+  testRebase();
+  testMissedWithoutRebase();
+  testCalibrationDueTime();
+
+  return testResult("test-scheduler");
+}
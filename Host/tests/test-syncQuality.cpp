@@ -0,0 +1,155 @@
+/*
+  Tests the quality reported of a synced time (`syncQuality()` of time.cpp, published
+  by the syncQuality-Characteristic) against the simulated time of a Central: The
+  Central is trained by the firmware's Training (trainingEngine.h) with Reference-
+  Timestamps created at random times of the Connection-Intervals and received with a
+  random latency, and its clock is skewed against the local clock.
+*/
+
+#include <random>
+#include <Arduino.h>
+#include <ArduinoShim.h>
+#include "constants.h"
+#include "rtc.hpp"
+#include "time.h"
+#include "trainingEngine.h"
+#include "test.h"
+
+/// Clock policy of the Training: The local time of the sketch.
+struct RtcClock {
+  static unsigned long now(void) { return millisRtc(false); }
+};
+
+/// Maximum latency (in µs) of a reception after its Connection-Event.
+static const unsigned long JITTER = 500;
+
+static std::mt19937 randomGenerator(1);
+
+/// The Central's clock (in µs): Skewed by `skew` ppm against the local clock.
+struct CentralClock {
+  double offset;
+  double skew;
+
+  double at(unsigned long long localTime) const { return offset + localTime * (1.0 + skew * 1e-6); }
+};
+
+/// Trains `clock` on the Connection-Events (`connectionInterval` in µs) following the
+/// current time. Returns `false`, if the Training failed.
+static bool train(SyncedClock &clock, const CentralClock &central, unsigned long connectionInterval) {
+  std::uniform_int_distribution<unsigned long> creationDistribution(0, connectionInterval - 1);
+  std::uniform_int_distribution<unsigned long> latencyDistribution(0, JITTER);
+  TrainingEngine<DefaultTrainingParameters, RtcClock> engine;
+  engine.setSamplesCount(TRAINING_MSGS_COUNT_DEFAULT);
+
+  unsigned long long start = simulatedMicros();
+  bool isComplete = false;
+  for (int i = 0; !isComplete; i++) {
+    unsigned long long event = start + (unsigned long long)(i + 1) * connectionInterval;
+    double creationTime = central.at(event - connectionInterval + creationDistribution(randomGenerator));
+
+    setSimulatedMicros(event + latencyDistribution(randomGenerator));
+    isComplete = engine.onReceivedReferenceTimestamp(millisRtc(false), (unsigned long)(creationTime / 1000), connectionInterval);
+  }
+
+  TrainingStatus status = engine.status();
+  if (status.statusCode != trainingSucceeded) return false;
+
+  setTime(clock, status.adjustedReferenceTimestamp, status.uncertainty, status.samplesCount);
+  return true;
+}
+
+/// Trains `clock` until a Training succeeded (as the Central applications do).
+static bool sync(SyncedClock &clock, const CentralClock &central, unsigned long connectionInterval) {
+  for (int attempt = 0; attempt < 10; attempt++) {
+    if (train(clock, central, connectionInterval)) return true;
+  }
+  return false;
+}
+
+/// Whether the synced time is within the uncertainty reported of the Central's time.
+static bool isWithinUncertainty(SyncedClock &clock, const CentralClock &central) {
+  SyncQuality quality = syncQuality(clock);
+  // The synced time (in ms) covers the µs of its ms: Half a ms either way is not an error.
+  double error = now(clock) * 1000.0 + 500.0 - central.at(simulatedMicros());
+  if (error < 0) error = -error;
+
+  if (error > quality.uncertainty + 500) {
+    fprintf(stderr, "error %.0f us exceeds uncertainty %lu us\n", error, quality.uncertainty);
+    return false;
+  }
+  return true;
+}
+
+static void advance(unsigned long duration) {
+  setSimulatedMicros(simulatedMicros() + duration * 1000ULL);
+}
+
+/// A single Training: Its bound contains the error, whatever the Connection-Interval.
+static void testTrainingBound(unsigned long connectionInterval) {
+  CentralClock central = { 123456789000.0, 0 };
+  int failuresCount = 0;
+
+  for (int i = 0; i < 2000; i++) {
+    SyncedClock clock;
+    initClock(clock);
+    if (!train(clock, central, connectionInterval)) continue;
+
+    SyncQuality quality = syncQuality(clock);
+    CHECK_EQUAL(quality.samplesCount, TRAINING_MSGS_COUNT_DEFAULT);
+    CHECK(quality.uncertainty >= connectionInterval / 2);
+    if (!isWithinUncertainty(clock, central)) failuresCount++;
+    advance(100);
+  }
+  CHECK_EQUAL(failuresCount, 0);
+}
+
+/// A skewed clock, re-synced whenever needed: The skew is estimated (within the
+/// uncertainty reported), and the error stays within the predicted uncertainty.
+static void testSkewedClock(double skew) {
+  CentralClock central = { 987654321000.0, skew };
+  SyncedClock clock;
+  initClock(clock);
+
+  // Not estimated: The default is reported.
+  CHECK(sync(clock, central, CONNECTION_INTERVAL_FAST_DEFAULT * 1250UL));
+  SyncQuality quality = syncQuality(clock);
+  CHECK_EQUAL(quality.skew, 0);
+  CHECK_EQUAL(quality.skewUncertainty, CLOCK_SKEW_DEFAULT);
+
+  int failuresCount = 0;
+  int syncsCount = 1;
+  // 2 h, sampled every second.
+  for (int i = 0; i < 7200; i++) {
+    advance(1000);
+    if (timeStatus(clock) != timeSet) {
+      CHECK(sync(clock, central, CONNECTION_INTERVAL_FAST_DEFAULT * 1250UL));
+      syncsCount++;
+    }
+    if (!isWithinUncertainty(clock, central)) failuresCount++;
+  }
+  CHECK_EQUAL(failuresCount, 0);
+
+  // Resynced before the sync interval elapsed.
+  CHECK(syncsCount > 7200 / (SYNC_INTERVAL_DEFAULT / 1000));
+
+  quality = syncQuality(clock);
+  CHECK(quality.skewUncertainty < CLOCK_SKEW_DEFAULT);
+  CHECK(labs(quality.skew - (long)(skew * 1000)) <= (long)quality.skewUncertainty);
+  CHECK(quality.timeSinceSync < SYNC_INTERVAL_DEFAULT);
+}
+
+int main(void) {
+  setSimulatedMicros(1000000);
+  setSyncInterval(SYNC_INTERVAL_DEFAULT);
+
+  // The fast and the idle Connection-Mode, and the USB frame interval.
+  testTrainingBound(7500);
+  testTrainingBound(30000);
+  testTrainingBound(1000);
+
+  testSkewedClock(0);
+  testSkewedClock(15);
+  testSkewedClock(-15);
+
+  return testResult("test-syncQuality");
+}
@@ -0,0 +1,87 @@
+/*
+  Tests the pairing of Wired-Reference-Timestamps with the edges of the wired sync
+  input (wiredSync.cpp): Each Central pairs each pulse once, so several Centrals (and
+  the host connected by USB) sync by the same pulse.
+*/
+
+#include <Arduino.h>
+#include <ArduinoShim.h>
+#include "constants.h"
+#include "faultLog.h"
+#include "rtc.hpp"
+#include "wiredSync.h"
+#include "test.h"
+
+/// Advances the simulated time to the local time `t` (in ms).
+static void advanceTo(unsigned long t) {
+  setSimulatedMicros(microsAtMillisRtc(t) + 10);
+}
+
+/// A pulse on the wired sync input at local time `t` (rising and falling edge).
+static void pulseAt(unsigned long t) {
+  advanceTo(t);
+  onWiredSyncEdge({ 1, true, t, (unsigned long)simulatedMicros() });
+  onWiredSyncEdge({ 1, false, t + 100, (unsigned long)simulatedMicros() + 100000 });
+}
+
+static void testCentralsPairSamePulse(void) {
+  WiredSyncPairing central0, central1, serial;
+  initWiredSyncPairing(central0);
+  initWiredSyncPairing(central1);
+  initWiredSyncPairing(serial);
+  unsigned long edgeTime = 0;
+
+  pulseAt(10000);
+  CHECK(isWiredSyncSignalPresent());
+  uint16_t faults = faultsCount();
+
+  // Each context pairs the pulse.
+  CHECK(pairWiredReferenceTimestamp(central0, 10120, &edgeTime));
+  CHECK_EQUAL(edgeTime, 10000);
+  edgeTime = 0;
+  CHECK(pairWiredReferenceTimestamp(central1, 10150, &edgeTime));
+  CHECK_EQUAL(edgeTime, 10000);
+  edgeTime = 0;
+  CHECK(pairWiredReferenceTimestamp(serial, 10400, &edgeTime));
+  CHECK_EQUAL(edgeTime, 10000);
+  CHECK_EQUAL(faultsCount(), faults);
+
+  // A second timestamp of the same Central is not paired with the same pulse.
+  CHECK(!pairWiredReferenceTimestamp(central0, 10200, &edgeTime));
+  CHECK_EQUAL(faultsCount(), faults + 1);
+
+  // The next pulse is paired by each context again.
+  pulseAt(11000);
+  CHECK(pairWiredReferenceTimestamp(central1, 11050, &edgeTime));
+  CHECK_EQUAL(edgeTime, 11000);
+  CHECK(pairWiredReferenceTimestamp(central0, 11080, &edgeTime));
+  CHECK_EQUAL(edgeTime, 11000);
+}
+
+static void testPairingWindow(void) {
+  WiredSyncPairing central;
+  initWiredSyncPairing(central);
+  unsigned long edgeTime = 0;
+
+  pulseAt(20000);
+  // Older than `WIRED_SYNC_PAIRING_WINDOW`: Ambiguous (i.e. the previous pulse).
+  CHECK(!pairWiredReferenceTimestamp(central, 20000 + WIRED_SYNC_PAIRING_WINDOW + 1, &edgeTime));
+  // Received before the pulse, and the previous pulse is outside the window.
+  pulseAt(21000);
+  CHECK(!pairWiredReferenceTimestamp(central, 20999, &edgeTime));
+  CHECK(pairWiredReferenceTimestamp(central, 21000 + WIRED_SYNC_PAIRING_WINDOW, &edgeTime));
+  CHECK_EQUAL(edgeTime, 21000);
+
+  // The signal is lost after `WIRED_SYNC_TIMEOUT`.
+  advanceTo(21000 + WIRED_SYNC_TIMEOUT);
+  CHECK(!isWiredSyncSignalPresent());
+}
+
+int main(void) {
+  setSimulatedMicros(1000000);
+
+  testCentralsPairSamePulse();
+  testPairingWindow();
+
+  return testResult("test-wiredSync");
+}
@@ -0,0 +1,46 @@
+/*
+  Host tests
+
+  Checks of the host tests of the sketch's modules (s. `make test`): A failed check
+  prints its location and fails the test, but the test runs on. Each test is a program
+  of its own, linking the modules under test against the shims (s. `Host/arduino`).
+*/
+
+#ifndef test_h
+#define test_h
+
+#include <stdio.h>
+
+static int testFailuresCount = 0;
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      testFailuresCount++; \
+    } \
+  } while (0)
+
+#define CHECK_EQUAL(actual, expected) \
+  do { \
+    long long actualValue = (long long)(actual); \
+    long long expectedValue = (long long)(expected); \
+    if (actualValue != expectedValue) { \
+      fprintf(stderr, "%s:%d: CHECK_EQUAL(%s, %s) failed: %lld != %lld\n", \
+        __FILE__, __LINE__, #actual, #expected, actualValue, expectedValue); \
+      testFailuresCount++; \
+    } \
+  } while (0)
+
+/// Prints the result of the test `name`. Returns the exit code of the test.
+static inline int testResult(const char *name) {
+  if (testFailuresCount > 0) {
+    printf("%s: FAILED (%d checks)\n", name, testFailuresCount);
+    return 1;
+  }
+
+  printf("%s: passed\n", name);
+  return 0;
+}
+
+#endif /* test_h */
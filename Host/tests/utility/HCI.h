@@ -0,0 +1,28 @@
+/*
+  ArduinoBLE's HCI layer, faked for the host tests (s. fakeHci.h): Reads the packets
+  from the installed transport (as ArduinoBLE's `HCI.poll()`) and records the
+  ACL-packets sent.
+*/
+
+#ifndef HCI_h
+#define HCI_h
+
+#include <Arduino.h>
+#include "HCITransport.h"
+
+class HCIClass {
+public:
+  void setTransport(HCITransportInterface *transport);
+
+  /// Reads every byte available from the transport.
+  void poll();
+
+  int sendAclPkt(uint16_t handle, uint8_t cid, uint8_t plen, void *data);
+
+private:
+  HCITransportInterface *m_transport = &HCITransport;
+};
+
+extern HCIClass &HCI;
+
+#endif /* HCI_h */
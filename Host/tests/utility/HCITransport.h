@@ -0,0 +1,26 @@
+/*
+  ArduinoBLE's HCI transport, faked for the host tests (s. fakeHci.h): The board's
+  transport (`HCITransport`) is read from the packets queued by the test.
+*/
+
+#ifndef HCITransport_h
+#define HCITransport_h
+
+#include <Arduino.h>
+
+class HCITransportInterface {
+public:
+  virtual ~HCITransportInterface() {}
+
+  virtual int begin() = 0;
+  virtual void end() = 0;
+  virtual void wait(unsigned long timeout) = 0;
+  virtual int available() = 0;
+  virtual int peek() = 0;
+  virtual int read() = 0;
+  virtual size_t write(const uint8_t *data, size_t length) = 0;
+};
+
+extern HCITransportInterface &HCITransport;
+
+#endif /* HCITransport_h */
@@ -0,0 +1,310 @@
+/*
+  signalboy-cli
+
+  Controls a Signalboy connected by USB via the Serial-Protocol:
+
+    signalboy-cli <port> info
+    signalboy-cli <port> diagnostics
+    signalboy-cli <port> sync [<rounds>]
+    signalboy-cli <port> train
+    signalboy-cli <port> trigger <delay>
+    signalboy-cli <port> calibrate
+    signalboy-cli <port> schedule <delay> [<delay> ...]
+    signalboy-cli <port> coded <delay>:<code> [<delay>:<code> ...]
+    signalboy-cli <port> channel <channel> <delay> [<delay> ...]
+    signalboy-cli <port> monitor <duration>
+    signalboy-cli <port> trace <file>
+    signalboy-cli <port> record <duration> <file>
+    signalboy-cli <port> stalls
+    signalboy-cli <port> faults
+    signalboy-cli <port> config [<name>=<value> ...]
+    signalboy-cli <port> broadcaster <id> <key>
+    signalboy-cli <port> config-key <key>
+
+  Delays and durations are given in ms. `schedule` syncs first (by round-trip sync)
+  and schedules signals at the given delays from now. `coded` does likewise for coded
+  signals (s. `pulseCode.h`), emitting `code` (0-255) at the default unit width, and
+  `channel` for signals on an output channel (s. `Outputs` of the sketch). `calibrate`
+  starts the calibration of the output (the output wired to the first capture pin):
+  Read its result by `diagnostics`.
+
+  `trace` drains the timeline trace (s. `trace.h` of the sketch, built with `TRACE`) into
+  `file` (raw `TraceEvent`s): Convert it by `signalboy-trace2json`. `record` reads the
+  recording of the inputs (s. `recorder.h` of the sketch, built with `RECORD`) for
+  `duration` into `file`: Replay it by `signalboy-replay`. NOTE: The recording starts
+  at boot: Start reading right after booting, or the recorder drops records. `stalls`
+  prints the stalls of the loop captured by the watchdog (s. `watchdog.h` of the sketch,
+  built with `WATCHDOG`). `faults` prints the faults kept by the fault log (s. `faultLog.h`
+  of the sketch), from the latest to the oldest.
+
+  `config` prints the configuration applied at runtime (s. `config.h` of the sketch) with
+  the range of each parameter, after changing the given parameters (by their names, i.e.
+  `sync-interval=300000`): It is persisted by the device. `train` sends as many
+  Reference-Timestamps as the configuration of the device asks for.
+
+  `broadcaster` provisions the secret key (32 hex digits) of a broadcaster of the
+  Broadcast-Observer (s. `observer.h` of the sketch, built with `OBSERVER_MODE`): It is
+  persisted by the device. A key of zeros revokes the broadcaster.
+
+  `config-key` provisions the key (32 hex digits) authenticating the writes of the
+  configuration by the Centrals (s. `configFormat.h` of the sketch): It is persisted by
+  the device. A key of zeros revokes it (the Centrals may read the configuration only).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "../libsignalboy/SerialClient.h"
+
+using signalboy::SerialClient;
+
+static int usage() {
+  fprintf(stderr,
+    "usage: signalboy-cli <port> info | diagnostics | sync [<rounds>] | train\n"
+    "                            | trigger <delay> | calibrate | schedule <delay> [<delay> ...]\n"
+    "                            | coded <delay>:<code> [<delay>:<code> ...]\n"
+    "                            | channel <channel> <delay> [<delay> ...] | monitor <duration>\n"
+    "                            | trace <file> | record <duration> <file> | stalls | faults\n"
+    "                            | config [<name>=<value> ...] | broadcaster <id> <key>\n"
+    "                            | config-key <key>\n");
+  return 2;
+}
+
+/// Parses the key of 32 hex digits `digits` (s. `SIPHASH_KEY_SIZE`). Returns `false`, if malformed.
+static bool parseKey(const char *digits, uint8_t key[16]) {
+  if (strlen(digits) != 32) return false;
+
+  for (size_t i = 0; i < 16; i++) {
+    char byteDigits[3] = { digits[2 * i], digits[2 * i + 1], 0 };
+    char *end;
+    key[i] = strtoul(byteDigits, &end, 16);
+    if (*end != 0) return false;
+  }
+  return true;
+}
+
+static int fail(SerialClient &client) {
+  fprintf(stderr, "error: %s\n", client.lastError().c_str());
+  return 1;
+}
+
+static bool sync(SerialClient &client, int roundsCount) {
+  signalboy::SyncResult result;
+  if (!client.sync(roundsCount, &result)) return false;
+
+  printf("synced: round-trip time %u us, uncertainty %u us (%d rounds)\n",
+    result.roundTripTime, result.uncertainty, result.roundsCount);
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) return usage();
+
+  const char *command = argv[2];
+
+  SerialClient client;
+  client.setTimeNeedsSyncHandler([](uint8_t value) {
+    printf("timeNeedsSync: %u\n", value);
+  });
+  if (!client.open(argv[1])) return fail(client);
+
+  if (strcmp(command, "info") == 0) {
+    SerialInfo info;
+    if (!client.readInfo(&info)) return fail(client);
+
+    printf("protocol version: %u\nhardware revision: %u\nsoftware revision: %u\n",
+      info.protocolVersion, info.hardwareRevision, info.softwareRevision);
+  } else if (strcmp(command, "diagnostics") == 0) {
+    SerialDiagnostics diagnostics;
+    if (!client.readDiagnostics(&diagnostics)) return fail(client);
+
+    static const char *const STATE_NAMES[] = { "starting", "awaiting connection", "connected" };
+    printf("state: %s\n", diagnostics.state <= SERIAL_STATE_CONNECTED ? STATE_NAMES[diagnostics.state] : "unknown");
+    printf("timeNeedsSync: %u\n", diagnostics.timeNeedsSync);
+    printf("sync: uncertainty %u us, %u ms ago, %u samples, skew %d +/- %u ppb\n",
+      diagnostics.syncUncertainty, diagnostics.timeSinceSync, diagnostics.syncSamplesCount,
+      diagnostics.skew, diagnostics.skewUncertainty);
+    printf("output latency: %s, median %d us (min %d us, max %d us, %u samples)\n",
+      diagnostics.isOutputCalibrated ? "calibrated" : "not calibrated",
+      diagnostics.outputLatency, diagnostics.outputLatencyMinimum, diagnostics.outputLatencyMaximum,
+      diagnostics.calibrationSamplesCount);
+    printf("dropped frames: %u\n", diagnostics.droppedFramesCount);
+    printf("memory: heap %u bytes (%u used), min. free stack %u bytes, %u allocations, %u deallocations\n",
+      diagnostics.heapSize, diagnostics.heapUsed, diagnostics.minimumFreeStack,
+      diagnostics.allocationsCount, diagnostics.deallocationsCount);
+    printf("idle: slept %u ms, wake-up latency %u us (max %u us)\n",
+      diagnostics.idleTime, diagnostics.wakeLatencyMean, diagnostics.wakeLatencyMaximum);
+  } else if (strcmp(command, "sync") == 0) {
+    if (!sync(client, argc > 3 ? atoi(argv[3]) : 16)) return fail(client);
+  } else if (strcmp(command, "train") == 0) {
+    // Devices without a configuration expect the default number of Reference-Timestamps.
+    Config config;
+    int messagesCount = client.readConfig(&config) ? config.trainingMsgsCount : TRAINING_MSGS_COUNT_DEFAULT;
+    if (!client.train(messagesCount)) return fail(client);
+  } else if (strcmp(command, "trigger") == 0) {
+    if (argc < 4) return usage();
+    if (!client.trigger((uint8_t)atoi(argv[3]))) return fail(client);
+  } else if (strcmp(command, "calibrate") == 0) {
+    if (!client.calibrate()) return fail(client);
+  } else if (strcmp(command, "schedule") == 0) {
+    if (argc < 4) return usage();
+    if (!sync(client, 16)) return fail(client);
+
+    uint32_t time = SerialClient::hostTime();
+    std::vector<uint32_t> targetTimestamps;
+    for (int i = 3; i < argc; i++) {
+      targetTimestamps.push_back(time + atoi(argv[i]));
+    }
+    if (!client.schedule(targetTimestamps)) return fail(client);
+  } else if (strcmp(command, "coded") == 0) {
+    if (argc < 4) return usage();
+    if (!sync(client, 16)) return fail(client);
+
+    uint32_t time = SerialClient::hostTime();
+    std::vector<SerialCodedTarget> targets;
+    for (int i = 3; i < argc; i++) {
+      const char *code = strchr(argv[i], ':');
+      if (!code) return usage();
+      targets.push_back({ time + atoi(argv[i]), (uint8_t)atoi(code + 1) });
+    }
+    if (!client.scheduleCoded(targets)) return fail(client);
+  } else if (strcmp(command, "channel") == 0) {
+    if (argc < 5) return usage();
+    if (!sync(client, 16)) return fail(client);
+
+    uint32_t time = SerialClient::hostTime();
+    std::vector<uint32_t> targetTimestamps;
+    for (int i = 4; i < argc; i++) {
+      targetTimestamps.push_back(time + atoi(argv[i]));
+    }
+    if (!client.scheduleOnChannel((uint8_t)atoi(argv[3]), targetTimestamps)) return fail(client);
+  } else if (strcmp(command, "monitor") == 0) {
+    if (argc < 4) return usage();
+    client.poll(atoi(argv[3]));
+  } else if (strcmp(command, "trace") == 0) {
+    if (argc < 4) return usage();
+
+    std::vector<TraceEvent> events;
+    if (!client.readTrace(&events)) return fail(client);
+
+    FILE *file = fopen(argv[3], "wb");
+    if (!file) {
+      fprintf(stderr, "error: Cannot open %s\n", argv[3]);
+      return 1;
+    }
+    fwrite(events.data(), sizeof(TraceEvent), events.size(), file);
+    fclose(file);
+
+    printf("%zu events\n", events.size());
+  } else if (strcmp(command, "record") == 0) {
+    if (argc < 5) return usage();
+
+    FILE *file = fopen(argv[4], "wb");
+    if (!file) {
+      fprintf(stderr, "error: Cannot open %s\n", argv[4]);
+      return 1;
+    }
+
+    uint64_t deadline = signalboy::hostMicros() + atoi(argv[3]) * 1000ULL;
+    size_t length = 0;
+    while (signalboy::hostMicros() < deadline) {
+      std::vector<uint8_t> bytes;
+      if (!client.readRecording(&bytes)) {
+        fclose(file);
+        return fail(client);
+      }
+
+      fwrite(bytes.data(), 1, bytes.size(), file);
+      length += bytes.size();
+      // Nothing recorded since: Wait a little (dispatching notifications).
+      if (bytes.empty()) client.poll(5);
+    }
+    fclose(file);
+
+    printf("%zu bytes\n", length);
+  } else if (strcmp(command, "stalls") == 0) {
+    StallReport report;
+    if (!client.readStalls(&report)) return fail(client);
+
+    for (int cause = 0; cause < STALL_CAUSES_COUNT; cause++) {
+      printf("%s: %u stalls\n", getStallCauseName(cause), report.stallsCount[cause]);
+    }
+    if (report.hasLastStall) {
+      const StallContext &stall = report.lastStall;
+      printf("last stall: %s in %s at %u ms, pc 0x%08x, lr 0x%08x, ",
+        getStallCauseName(stall.cause),
+        getStallTaskName(stall.task),
+        stall.time, stall.pc, stall.lr);
+      if (stall.duration == STALL_DURATION_UNRECOVERED) {
+        printf("not recovered");
+      } else {
+        printf("recovered after %u ms", stall.duration);
+      }
+      printf(", %u timers armed", stall.armedTimersCount);
+      if (stall.armedTimersCount > 0) printf(" (next deadline %u ms)", stall.nextTimerDeadline);
+      printf("\n");
+    }
+  } else if (strcmp(command, "faults") == 0) {
+    std::vector<FaultRecord> faults;
+    uint16_t faultsCount;
+    if (!client.readFaults(&faults, &faultsCount)) return fail(client);
+
+    printf("%u faults since startup\n", faultsCount);
+    for (const FaultRecord &fault : faults) {
+      printf("%u ms: %s 0x%x (%s), arguments %d, %d\n",
+        fault.time,
+        getFaultDomainName(fault.domain),
+        fault.code,
+        getFaultMessage(fault.domain, fault.code),
+        fault.arguments[0], fault.arguments[1]);
+    }
+  } else if (strcmp(command, "config") == 0) {
+    Config config;
+    if (argc > 3) {
+      std::vector<uint8_t> entries;
+      for (int i = 3; i < argc; i++) {
+        const char *value = strchr(argv[i], '=');
+        if (!value) return usage();
+
+        const ConfigParameter *parameter = findConfigParameter(std::string(argv[i], value - argv[i]).c_str());
+        if (!parameter) {
+          fprintf(stderr, "error: Unknown parameter %s\n", argv[i]);
+          return 1;
+        }
+
+        uint8_t entry[8];
+        size_t length = encodeConfigEntry(parameter->tag, strtoul(value + 1, nullptr, 10), entry);
+        entries.insert(entries.end(), entry, entry + length);
+      }
+      if (!client.configure(entries, &config)) return fail(client);
+    } else if (!client.readConfig(&config)) {
+      return fail(client);
+    }
+
+    for (int i = 0; i < CONFIG_PARAMETERS_COUNT; i++) {
+      const ConfigParameter &parameter = CONFIG_PARAMETERS[i];
+      printf("%s: %u (%u-%u)\n", parameter.name, getConfigValue(config, parameter.tag),
+        parameter.minimum, parameter.maximum);
+    }
+  } else if (strcmp(command, "broadcaster") == 0) {
+    if (argc != 5) return usage();
+
+    SerialBroadcasterKey key;
+    key.broadcasterId = atoi(argv[3]);
+    if (!parseKey(argv[4], key.key)) return usage();
+    if (!client.provisionBroadcaster(key)) return fail(client);
+  } else if (strcmp(command, "config-key") == 0) {
+    if (argc != 4) return usage();
+
+    SerialConfigKey key;
+    if (!parseKey(argv[3], key.key)) return usage();
+    if (!client.provisionConfigKey(key)) return fail(client);
+  } else {
+    return usage();
+  }
+
+  return 0;
+}
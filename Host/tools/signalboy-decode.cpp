@@ -0,0 +1,91 @@
+/*
+  signalboy-decode
+
+  Decodes the coded signals (s. `pulseCode.h` of the sketch) of a trace of the output,
+  i.e. captured by a logic analyzer or by `signalboy-loadgen --trace`.
+
+    signalboy-decode [--time-unit s|ms|us] [<trace>]
+
+  The trace (default: stdin) lists the edges of the output: A line `<time>,<level>` per
+  edge (separated by `,`, `;` or whitespace, in ascending time). Lines not starting with
+  a number (i.e. headers) are skipped. Prints a line per pulse:
+
+    <time (us)>,coded,<code>,<unit width (us)>
+    <time (us)>,plain,,<width (us)>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../libsignalboy/PulseCodeDecoder.h"
+
+using signalboy::DecodedPulse;
+using signalboy::PulseCodeDecoder;
+
+static int usage() {
+  fprintf(stderr, "usage: signalboy-decode [--time-unit s|ms|us] [<trace>]\n");
+  return 2;
+}
+
+int main(int argc, char *argv[]) {
+  double timeScale = 1;  // to µs
+  const char *path = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--time-unit") == 0 && i + 1 < argc) {
+      const char *unit = argv[++i];
+      if (strcmp(unit, "s") == 0) {
+        timeScale = 1e6;
+      } else if (strcmp(unit, "ms") == 0) {
+        timeScale = 1e3;
+      } else if (strcmp(unit, "us") == 0) {
+        timeScale = 1;
+      } else {
+        return usage();
+      }
+    } else if (!path && argv[i][0] != '-') {
+      path = argv[i];
+    } else {
+      return usage();
+    }
+  }
+
+  FILE *file = path ? fopen(path, "r") : stdin;
+  if (!file) {
+    fprintf(stderr, "error: Cannot open %s\n", path);
+    return 1;
+  }
+
+  int codedCount = 0, plainCount = 0;
+  PulseCodeDecoder decoder;
+  decoder.setHandler([&](const DecodedPulse &pulse) {
+    if (pulse.isCoded) {
+      printf("%lld,coded,%u,%u\n", (long long)pulse.time, pulse.code, pulse.width);
+      codedCount++;
+    } else {
+      printf("%lld,plain,,%u\n", (long long)pulse.time, pulse.width);
+      plainCount++;
+    }
+  });
+
+  char line[256];
+  while (fgets(line, sizeof(line), file)) {
+    char *end;
+    double time = strtod(line, &end);
+    if (end == line) continue;
+
+    while (*end == ',' || *end == ';' || *end == ' ' || *end == '\t') end++;
+    char *levelEnd;
+    long level = strtol(end, &levelEnd, 10);
+    if (levelEnd == end) continue;
+
+    decoder.addEdge((int64_t)(time * timeScale + 0.5), level != 0);
+  }
+  decoder.finish();
+
+  if (file != stdin) fclose(file);
+
+  fprintf(stderr, "%d coded, %d plain pulses\n", codedCount, plainCount);
+  return 0;
+}
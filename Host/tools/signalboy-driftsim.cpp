@@ -0,0 +1,163 @@
+/*
+  signalboy-driftsim
+
+  Simulates the synced clock (`time.cpp` of the sketch) of a Central whose clock is
+  skewed against the local clock: The Central is trained whenever a re-sync is needed
+  (s. `timeStatus()`), by the firmware's Training (s. `trainingEngine.h`) in the fast
+  Connection-Mode. Reports per skew the number of syncs per hour, and the error of the
+  synced time (in µs, relative to the Central's time) against the uncertainty
+  predicted (s. `predictedUncertainty()`), sampled every 100 ms.
+
+    signalboy-driftsim [--hours <h>] [--jitter <us>] [--budget <us>] [--seed <seed>]
+
+  - `--hours`:  Simulated duration per skew (default: 1).
+  - `--jitter`: Maximum latency (in µs) of the reception after the Connection-Event
+                (default: 500).
+  - `--budget`: Accuracy budget (in µs, default: `SYNC_ACCURACY_BUDGET`).
+  - `--seed`:   Seed of the simulation (default: 1).
+
+  Exits with 1, if the error exceeded the predicted uncertainty. (Until the skew is
+  estimated, `CLOCK_SKEW_DEFAULT` is assumed: A larger skew exceeds it.)
+*/
+
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Arduino.h>
+#include <ArduinoShim.h>
+#include "constants.h"
+#include "rtc.hpp"
+#include "time.h"
+#include "trainingEngine.h"
+
+/// Clock policy of the Training: The local time of the sketch.
+struct RtcClock {
+  static unsigned long now(void) { return millisRtc(false); }
+};
+
+/// Connection-Interval (in µs) of the fast Connection-Mode.
+static const unsigned long CONNECTION_INTERVAL = CONNECTION_INTERVAL_FAST_DEFAULT * 1250UL;
+/// Interval (in µs) of the samples of the error.
+static const unsigned long long SAMPLE_INTERVAL = 100000;
+
+static double hours = 1;
+static unsigned long jitter = 500;
+static unsigned long budget = SYNC_ACCURACY_BUDGET;
+static unsigned long seed = 1;
+
+struct Result {
+  int syncsCount;
+  double errorMaximum;        // in µs (absolute)
+  unsigned long uncertaintyMaximum;  // in µs
+  /// Samples whose error exceeded the predicted uncertainty.
+  long exceededCount;
+  long samplesCount;
+};
+
+/// The Central's clock: Skewed by `skew` ppm against the local clock (in µs).
+struct CentralClock {
+  double offset;
+  double skew;
+
+  double at(unsigned long long localTime) const { return offset + localTime * (1.0 + skew * 1e-6); }
+};
+
+/// Trains `clock` on Connection-Events from `localTime` (in µs) on. Returns the local time
+/// (in µs) at the completion, or 0, if the Training failed.
+static unsigned long long train(SyncedClock &clock, const CentralClock &central, unsigned long long localTime, std::mt19937 &random) {
+  std::uniform_int_distribution<unsigned long> creationDistribution(0, CONNECTION_INTERVAL - 1);
+  std::uniform_int_distribution<unsigned long> latencyDistribution(0, jitter);
+  static TrainingEngine<DefaultTrainingParameters, RtcClock> engine;
+  engine.setSamplesCount(TRAINING_MSGS_COUNT_DEFAULT);
+
+  bool isComplete = false;
+  for (int i = 0; !isComplete; i++) {
+    unsigned long long event = localTime + (unsigned long long)(i + 1) * CONNECTION_INTERVAL;
+    double creationTime = central.at(event - CONNECTION_INTERVAL + creationDistribution(random));
+
+    setSimulatedMicros(event + latencyDistribution(random));
+    isComplete = engine.onReceivedReferenceTimestamp(millisRtc(false), (unsigned long)(creationTime / 1000), CONNECTION_INTERVAL);
+  }
+
+  TrainingStatus status = engine.status();
+  if (status.statusCode != trainingSucceeded) return 0;
+
+  setTime(clock, status.adjustedReferenceTimestamp, status.uncertainty, status.samplesCount);
+  return simulatedMicros();
+}
+
+static Result run(double skew) {
+  std::mt19937 random(seed);
+  CentralClock central = { (double)std::uniform_int_distribution<unsigned long>(0, 1000000000UL)(random) * 1000.0, skew };
+
+  Result result = {};
+  unsigned long long startTime = 1000000;
+  unsigned long long endTime = startTime + (unsigned long long)(hours * 3600e6);
+  setSimulatedMicros(startTime);
+
+  SyncedClock clock;
+  initClock(clock);
+
+  for (unsigned long long localTime = startTime; localTime < endTime; localTime += SAMPLE_INTERVAL) {
+    setSimulatedMicros(localTime);
+    if (timeStatus(clock) != timeSet) {
+      if (train(clock, central, localTime, random) == 0) continue;
+      result.syncsCount++;
+    }
+
+    unsigned long uncertainty = predictedUncertainty(clock);
+    // The synced time (in ms) covers the µs of its ms: Half a ms either way is not an error.
+    double syncedTime = now(clock) * 1000.0 + 500.0;
+    double error = syncedTime - central.at(simulatedMicros());
+    double absoluteError = error < 0 ? -error : error;
+
+    result.samplesCount++;
+    if (absoluteError > result.errorMaximum) result.errorMaximum = absoluteError;
+    if (uncertainty > result.uncertaintyMaximum) result.uncertaintyMaximum = uncertainty;
+    if (absoluteError > uncertainty + 500) result.exceededCount++;
+  }
+
+  return result;
+}
+
+static int usage() {
+  fprintf(stderr, "usage: signalboy-driftsim [--hours <h>] [--jitter <us>] [--budget <us>] [--seed <seed>]\n");
+  return 2;
+}
+
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) return usage();
+
+    if (strcmp(argv[i], "--hours") == 0) {
+      hours = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--jitter") == 0) {
+      jitter = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--budget") == 0) {
+      budget = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--seed") == 0) {
+      seed = strtoul(argv[++i], nullptr, 10);
+    } else {
+      return usage();
+    }
+  }
+  if (hours <= 0) return usage();
+
+  setSyncInterval(SYNC_INTERVAL_DEFAULT);
+  setSyncAccuracyBudget(budget);
+
+  printf("%6s %9s %10s %12s %9s\n", "skew", "syncs/h", "max error", "uncertainty", "exceeded");
+
+  bool isExceeded = false;
+  const double skews[] = { 0, 5, 10, 20, -20 };
+  for (double skew : skews) {
+    Result result = run(skew);
+    printf("%6.0f %9.1f %10.0f %12lu %8.2f%%\n",
+      skew, result.syncsCount / hours, result.errorMaximum, result.uncertaintyMaximum,
+      100.0 * result.exceededCount / (result.samplesCount > 0 ? result.samplesCount : 1));
+    if (result.exceededCount > 0) isExceeded = true;
+  }
+
+  return isExceeded ? 1 : 0;
+}
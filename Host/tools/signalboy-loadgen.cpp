@@ -0,0 +1,303 @@
+/*
+  signalboy-loadgen
+
+  Load generator for the virtual Signalboy (s. `Host/virtual`): Connects as a Central,
+  syncs by Training and requests signals at a fixed rate. The probed output pin is
+  matched with the requested signals: Reports the error of the fired signals (relative
+  to their target time) and the rate of dropped signals.
+
+    signalboy-loadgen [--socket <path>] [--mode schedule|trigger|coded] [--rate <Hz>]
+                      [--duration <s>] [--lead <ms>] [--address <address>]
+                      [--unit <us>] [--channel <channel>] [--trace <file>]
+
+  - `schedule`: Writes Target-Timestamps `lead` ms ahead (default).
+  - `trigger`:  Writes the Trigger-Timer with a delay of `lead` ms.
+  - `coded`:    Writes Coded-Target-Timestamps `lead` ms ahead, with consecutive codes
+                emitted at a unit width of `unit` µs (s. `pulseCode.h`). The probed
+                pulse trains are decoded and their codes verified.
+
+  `--channel` writes the Target-Timestamps (`schedule`) to the Channel-Target-Timestamp
+  (probing the channel's pin). `--trace` writes the edges of the probed pin to `file`
+  (s. `signalboy-decode`).
+*/
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "../libsignalboy/PulseCodeDecoder.h"
+#include "../libsignalboy/SerialClient.h"
+#include "../libsignalboy/VirtualCentral.h"
+#include "../../constants.h"
+
+using signalboy::DecodedPulse;
+using signalboy::PulseCodeDecoder;
+using signalboy::SerialClient;
+using signalboy::VirtualCentral;
+
+// The pins of the output channels of the sketch (s. `Outputs`).
+static const int OUTPUT_PINS[] = { 10, 5, 16 /* A2 */ };
+#define OUTPUT_CHANNELS_COUNT (int)(sizeof(OUTPUT_PINS) / sizeof(OUTPUT_PINS[0]))
+// Maximum deviation (in ms) of a fired signal from its target time to be matched.
+#define MATCH_TOLERANCE 50
+// Time (in ms) to wait for a sync.
+#define SYNC_TIMEOUT 10000
+
+struct Signal {
+  /// Target time in µs (`hostMicros()`).
+  int64_t targetTime;
+  /// Code of a coded signal (-1, if uncoded).
+  int code;
+  bool isFired;
+};
+
+/// A probed pulse (rising edge).
+struct Pulse {
+  /// in µs (`hostMicros()`)
+  int64_t time;
+  /// Decoded code (-1, if uncoded).
+  int code;
+};
+
+/// Value of the `channelTargetTimestamp`-Characteristic (s. `signalboy-arduino.ino`).
+struct __attribute__((packed)) ChannelTargetTimestampValue {
+  uint32_t targetTimestamp;
+  uint8_t channel;
+};
+
+/// Value of the `codedTargetTimestamp`-Characteristic (s. `signalboy-arduino.ino`).
+struct __attribute__((packed)) CodedTargetTimestampValue {
+  uint32_t targetTimestamp;
+  uint8_t code;
+  uint16_t unitWidth;
+};
+
+static int usage() {
+  fprintf(stderr,
+    "usage: signalboy-loadgen [--socket <path>] [--mode schedule|trigger|coded] [--rate <Hz>]\n"
+    "                         [--duration <s>] [--lead <ms>] [--address <address>]\n"
+    "                         [--unit <us>] [--channel <channel>] [--trace <file>]\n");
+  return 2;
+}
+
+static int fail(VirtualCentral &central) {
+  fprintf(stderr, "error: %s\n", central.lastError().c_str());
+  return 1;
+}
+
+static double percentile(const std::vector<int64_t> &sorted, double p) {
+  if (sorted.empty()) return 0;
+  return sorted[std::min(sorted.size() - 1, (size_t)(p * sorted.size()))];
+}
+
+int main(int argc, char *argv[]) {
+  const char *socketPath = VIRTUAL_LINK_DEFAULT_PATH;
+  const char *address = "c0:ff:ee:00:00:01";
+  const char *tracePath = nullptr;
+  bool isTriggerMode = false;
+  bool isCodedMode = false;
+  double rate = 2;
+  double duration = 10;
+  int lead = 200;
+  int unitWidth = PULSE_CODE_UNIT_WIDTH_DEFAULT;
+  // The default channel is scheduled by the Target-Timestamp.
+  int channel = -1;
+
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) return usage();
+
+    if (strcmp(argv[i], "--socket") == 0) {
+      socketPath = argv[++i];
+    } else if (strcmp(argv[i], "--mode") == 0) {
+      const char *mode = argv[++i];
+      if (strcmp(mode, "trigger") != 0 && strcmp(mode, "schedule") != 0 && strcmp(mode, "coded") != 0) return usage();
+      isTriggerMode = strcmp(mode, "trigger") == 0;
+      isCodedMode = strcmp(mode, "coded") == 0;
+    } else if (strcmp(argv[i], "--rate") == 0) {
+      rate = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--duration") == 0) {
+      duration = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--lead") == 0) {
+      lead = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--address") == 0) {
+      address = argv[++i];
+    } else if (strcmp(argv[i], "--unit") == 0) {
+      unitWidth = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--channel") == 0) {
+      channel = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--trace") == 0) {
+      tracePath = argv[++i];
+    } else {
+      return usage();
+    }
+  }
+  if (rate <= 0 || duration <= 0 || lead < 0 || (unsigned long)lead > MAX_TIMER_DELAY_DEFAULT || (isTriggerMode && lead > 0xff)
+      || !isValidPulseCodeUnitWidth(unitWidth)
+      || channel >= OUTPUT_CHANNELS_COUNT || (channel >= 0 && (isTriggerMode || isCodedMode))) {
+    return usage();
+  }
+
+  FILE *trace = nullptr;
+  if (tracePath && !(trace = fopen(tracePath, "w"))) {
+    fprintf(stderr, "error: Cannot open %s\n", tracePath);
+    return 1;
+  }
+
+  VirtualCentral central;
+  uint8_t timeNeedsSync = TIME_NEEDS_SYNC_TRAINING;
+  std::vector<Signal> signals;
+  std::vector<Pulse> pulses;
+  PulseCodeDecoder decoder;
+  int trainingsCount = 0;
+
+  central.setNotificationHandler([&](const std::string &uuid, const std::vector<uint8_t> &value) {
+    if (uuid == signalboy::UUID_TIME_NEEDS_SYNC && !value.empty()) {
+      timeNeedsSync = value[0];
+    }
+  });
+  decoder.setHandler([&](const DecodedPulse &pulse) {
+    pulses.push_back({ pulse.time, pulse.isCoded ? pulse.code : -1 });
+  });
+  central.setPinChangeHandler([&](const VirtualLinkPinChange &change) {
+    if (change.pin != OUTPUT_PINS[channel >= 0 ? channel : 0]) return;
+
+    if (trace) fprintf(trace, "%llu,%u\n", (unsigned long long)change.time, change.level);
+    if (isCodedMode) {
+      decoder.addEdge(change.time, change.level);
+    } else if (change.level) {
+      pulses.push_back({ (int64_t)change.time, -1 });
+    }
+  });
+
+  if (!central.connect(socketPath, address)) return fail(central);
+  if (!central.subscribe(signalboy::UUID_TIME_NEEDS_SYNC)) return fail(central);
+
+  std::vector<uint8_t> value;
+  if (!central.read(signalboy::UUID_TIME_NEEDS_SYNC, &value)) return fail(central);
+  if (!value.empty()) timeNeedsSync = value[0];
+
+  // Sync (Training), awaiting the fast Connection-Parameters requested by the Signalboy.
+  uint64_t syncDeadline = signalboy::hostMicros() + SYNC_TIMEOUT * 1000ULL;
+  while (timeNeedsSync != TIME_NEEDS_SYNC_NONE) {
+    if (signalboy::hostMicros() >= syncDeadline) {
+      fprintf(stderr, "error: Not synced within %d ms\n", SYNC_TIMEOUT);
+      return 1;
+    }
+
+    if (!central.poll(200)) return fail(central);
+    if (timeNeedsSync == TIME_NEEDS_SYNC_NONE) break;
+    if (!central.train()) return fail(central);
+    trainingsCount++;
+  }
+  printf("synced (%d trainings), connection interval %u us\n", trainingsCount, central.connectionInterval());
+
+  // Load
+  pulses.clear();
+  uint64_t period = (uint64_t)(1000000 / rate);
+  uint64_t startTime = signalboy::hostMicros();
+  uint64_t endTime = startTime + (uint64_t)(duration * 1000000);
+  int retrainingsCount = 0;
+
+  for (uint64_t time = startTime; time < endTime; time += period) {
+    if (!central.pollUntil(time)) return fail(central);
+
+    if (timeNeedsSync != TIME_NEEDS_SYNC_NONE) {
+      // Signals requested meanwhile are fired in the Central's time anyway (s. `releaseTimers()`).
+      if (!central.train()) return fail(central);
+      retrainingsCount++;
+      continue;
+    }
+
+    Signal signal = {};
+    signal.code = -1;
+    if (isTriggerMode) {
+      // The delay is relative to the Connection-Event that delivers the write.
+      signal.targetTime = (int64_t)signalboy::hostMicros() + lead * 1000LL;
+      uint8_t delay = lead;
+      if (!central.write(signalboy::UUID_TRIGGER_TIMER, &delay, sizeof(delay))) return fail(central);
+    } else if (isCodedMode) {
+      CodedTargetTimestampValue value = { SerialClient::hostTime() + lead, (uint8_t)signals.size(), (uint16_t)unitWidth };
+      signal.targetTime = value.targetTimestamp * 1000LL;
+      signal.code = value.code;
+      if (!central.write(signalboy::UUID_CODED_TARGET_TIMESTAMP, &value, sizeof(value))) return fail(central);
+    } else if (channel >= 0) {
+      ChannelTargetTimestampValue value = { SerialClient::hostTime() + lead, (uint8_t)channel };
+      signal.targetTime = value.targetTimestamp * 1000LL;
+      if (!central.write(signalboy::UUID_CHANNEL_TARGET_TIMESTAMP, &value, sizeof(value))) return fail(central);
+    } else {
+      uint32_t targetTimestamp = SerialClient::hostTime() + lead;
+      signal.targetTime = targetTimestamp * 1000LL;
+      if (!central.writeUInt32(signalboy::UUID_TARGET_TIMESTAMP, targetTimestamp)) return fail(central);
+    }
+    signals.push_back(signal);
+  }
+
+  // Await the pending signals.
+  if (!central.poll(lead + MATCH_TOLERANCE + 100)) return fail(central);
+  decoder.finish();
+  if (trace) fclose(trace);
+
+  // Match every pulse with the closest signal not fired, yet (preferring a signal of
+  // the pulse's code).
+  std::vector<int64_t> errors;
+  int unexpectedCount = 0;
+  int miscodedCount = 0;
+  int undecodableCount = 0;
+  for (const Pulse &pulse : pulses) {
+    if (isCodedMode && pulse.code < 0) {
+      // Distorted pulse train (or an uncoded signal).
+      undecodableCount++;
+      continue;
+    }
+
+    Signal *match = nullptr;
+    for (Signal &signal : signals) {
+      int64_t error = pulse.time - signal.targetTime;
+      if (signal.isFired || llabs(error) > MATCH_TOLERANCE * 1000LL) continue;
+
+      bool isCodeMatching = signal.code == pulse.code;
+      bool isMatchCodeMatching = match && match->code == pulse.code;
+      if (!match || isCodeMatching > isMatchCodeMatching
+          || (isCodeMatching == isMatchCodeMatching && llabs(error) < llabs(pulse.time - match->targetTime))) {
+        match = &signal;
+      }
+    }
+
+    if (!match) {
+      unexpectedCount++;
+      continue;
+    }
+    match->isFired = true;
+    errors.push_back(pulse.time - match->targetTime);
+    if (pulse.code != match->code) miscodedCount++;
+  }
+
+  size_t droppedCount = signals.size() - errors.size();
+  printf("signals: %zu requested, %zu fired, %zu dropped (%.1f %%), %d unexpected, %d retrainings\n",
+    signals.size(), errors.size(), droppedCount,
+    signals.empty() ? 0.0 : 100.0 * droppedCount / signals.size(), unexpectedCount, retrainingsCount);
+  if (isCodedMode) {
+    printf("codes: %zu decoded correctly, %d miscoded, %d undecodable pulses\n",
+      errors.size() - miscodedCount, miscodedCount, undecodableCount);
+  }
+
+  if (!errors.empty()) {
+    std::vector<int64_t> absoluteErrors;
+    double sum = 0;
+    for (int64_t error : errors) {
+      sum += error;
+      absoluteErrors.push_back(llabs(error));
+    }
+    std::sort(errors.begin(), errors.end());
+    std::sort(absoluteErrors.begin(), absoluteErrors.end());
+
+    printf("error (us): mean %.0f, min %lld, max %lld\n", sum / errors.size(), (long long)errors.front(), (long long)errors.back());
+    printf("|error| (us): p50 %.0f, p99 %.0f, max %lld\n",
+      percentile(absoluteErrors, 0.5), percentile(absoluteErrors, 0.99), (long long)absoluteErrors.back());
+  }
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+/*
+  signalboy-trace2json
+
+  Converts a timeline trace (s. `trace.h` of the sketch), as written by
+  `signalboy-cli <port> trace <file>`, to the JSON trace event format of Chrome
+  (`chrome://tracing`) and Perfetto (`ui.perfetto.dev`).
+
+    signalboy-trace2json [<trace>] > trace.json
+
+  The trace (default: stdin) holds raw `TraceEvent`s. Loop tasks and callbacks are
+  shown on the track "loop", ISRs on the track "interrupts". Times are relative to the
+  first event (in µs). Events cut off by the ring buffer (an end without its begin, or
+  a begin without its end) are dropped or closed at the last event, respectively.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "../../traceEvents.h"
+
+static const int PROCESS_ID = 1;
+static const int LOOP_THREAD_ID = 1;
+static const int INTERRUPTS_THREAD_ID = 2;
+
+static int usage() {
+  fprintf(stderr, "usage: signalboy-trace2json [<trace>]\n");
+  return 2;
+}
+
+static bool isFirstEvent = true;
+
+static void printEvent(const char *phase, uint8_t point, int threadId, long long time, const TraceEvent *instant) {
+  printf("%s\n    {\"name\": \"%s\", \"ph\": \"%s\", \"ts\": %lld, \"pid\": %d, \"tid\": %d",
+    isFirstEvent ? "" : ",", getTracePointName(point), phase, time, PROCESS_ID, threadId);
+  if (instant) {
+    printf(", \"s\": \"t\", \"args\": {\"channel\": %u}", instant->argument);
+  }
+  printf("}");
+  isFirstEvent = false;
+}
+
+static void printThreadName(int threadId, const char *name) {
+  printf("%s\n    {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+    isFirstEvent ? "" : ",", PROCESS_ID, threadId, name);
+  isFirstEvent = false;
+}
+
+int main(int argc, char *argv[]) {
+  const char *path = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    if (!path && argv[i][0] != '-') {
+      path = argv[i];
+    } else {
+      return usage();
+    }
+  }
+
+  FILE *file = path ? fopen(path, "rb") : stdin;
+  if (!file) {
+    fprintf(stderr, "error: Cannot open %s\n", path);
+    return 1;
+  }
+
+  std::vector<TraceEvent> events;
+  TraceEvent event;
+  while (fread(&event, sizeof(event), 1, file) == 1) {
+    events.push_back(event);
+  }
+  if (file != stdin) fclose(file);
+
+  printf("{\"traceEvents\": [");
+  printThreadName(LOOP_THREAD_ID, "loop");
+  printThreadName(INTERRUPTS_THREAD_ID, "interrupts");
+
+  // Open scopes of each track
+  std::vector<uint8_t> openPoints[2];
+  long long time = 0;
+  int droppedCount = 0;
+
+  for (size_t i = 0; i < events.size(); i++) {
+    const TraceEvent &event = events[i];
+    // `micros()` wraps every ~71.6 min.
+    if (i > 0) time += (uint32_t)(event.time - events[i - 1].time);
+
+    bool isInterrupt = event.point >= TRACE_POINT_ISR_FIRST;
+    int threadId = isInterrupt ? INTERRUPTS_THREAD_ID : LOOP_THREAD_ID;
+    std::vector<uint8_t> &open = openPoints[isInterrupt ? 1 : 0];
+
+    switch (event.type) {
+      case TRACE_EVENT_BEGIN:
+        open.push_back(event.point);
+        printEvent("B", event.point, threadId, time, nullptr);
+        break;
+
+      case TRACE_EVENT_END: {
+        size_t depth = open.size();
+        while (depth > 0 && open[depth - 1] != event.point) depth--;
+        if (depth == 0) {
+          // Its begin precedes the trace.
+          droppedCount++;
+          break;
+        }
+
+        // Close the scopes nested in it (their ends are missing).
+        while (open.size() >= depth) {
+          printEvent("E", open.back(), threadId, time, nullptr);
+          open.pop_back();
+        }
+        break;
+      }
+
+      case TRACE_EVENT_INSTANT:
+        printEvent("i", event.point, threadId, time, &event);
+        break;
+    }
+  }
+
+  // Scopes still open at the end of the trace
+  for (int track = 0; track < 2; track++) {
+    while (!openPoints[track].empty()) {
+      printEvent("E", openPoints[track].back(), track == 0 ? LOOP_THREAD_ID : INTERRUPTS_THREAD_ID, time, nullptr);
+      openPoints[track].pop_back();
+    }
+  }
+
+  printf("\n]}\n");
+
+  fprintf(stderr, "%zu events (%.3f ms), %d unmatched ends dropped\n",
+    events.size(), time / 1000.0, droppedCount);
+  return 0;
+}
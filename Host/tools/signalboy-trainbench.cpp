@@ -0,0 +1,219 @@
+/*
+  signalboy-trainbench
+
+  Compares specializations of the Training (s. `trainingEngine.h` of the sketch) on
+  simulated Trainings: A Central with a random clock offset sends a Reference-Timestamp
+  per Connection-Event, each created at a random time within the preceding
+  Connection-Interval and received with a random latency. Reports per specialization
+  the rate of successful Trainings, the error of the synced time (in µs, relative to the
+  Central's time) against the uncertainty reported, and the cost of a Training (in ns).
+
+    signalboy-trainbench [--trainings <n>] [--jitter <us>] [--seed <seed>]
+
+  - `--trainings`: Number of Trainings per specialization (default: 10000).
+  - `--jitter`:    Maximum latency (in µs) of the reception after the Connection-Event
+                   (default: 500).
+  - `--seed`:      Seed of the simulation (default: 1): Every specialization is run on
+                   the same Trainings.
+
+  The firmware's specialization (`DefaultTrainingParameters`) sets the number of
+  Reference-Timestamps and the Connection-Interval at runtime; the others fix them at
+  compile time.
+
+  Exits with 1, if the error of a Training exceeded the uncertainty reported, or if the
+  specializations' results of a Training differ (the fixed parameters must not change
+  the math). (A latency common to all Reference-Timestamps of a Training is not
+  observable: With a jitter of the order of the Connection-Interval, a few Trainings
+  exceed the uncertainty.) The cost is informative only: It is measured on the host,
+  and its differences are mostly within the noise.
+*/
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../trainingEngine.h"
+
+/// Clock policy of the simulation: The local time (in ms) of the simulated Signalboy.
+struct SimulatedClock {
+  static unsigned long time;
+  static unsigned long now(void) { return time; }
+};
+
+unsigned long SimulatedClock::time = 0;
+
+/// Fixes the number of Reference-Timestamps and the Connection-Interval (in µs).
+template <int SamplesCount, unsigned long ConnectionInterval>
+struct FixedTrainingParameters : DefaultTrainingParameters {
+  static constexpr int maxSamplesCount = SamplesCount;
+  static constexpr int samplesCount = SamplesCount;
+  static constexpr unsigned long connectionInterval = ConnectionInterval;
+};
+
+/// The outcome of a Training (compared between the specializations).
+struct Outcome {
+  TrainingStatus status;
+  TrainingFailure failure;
+  int networkDelay;
+
+  bool operator==(const Outcome &other) const {
+    return status.statusCode == other.status.statusCode
+      && status.adjustedReferenceTimestamp == other.status.adjustedReferenceTimestamp
+      && status.uncertainty == other.status.uncertainty
+      && status.samplesCount == other.status.samplesCount
+      && failure == other.failure
+      && networkDelay == other.networkDelay;
+  }
+};
+
+struct Result {
+  std::vector<Outcome> outcomes;
+  int succeededCount;
+  double errorSum;       // in µs (absolute)
+  double errorMaximum;   // in µs (absolute)
+  double uncertaintySum; // in µs
+  /// Trainings whose error exceeded the uncertainty reported.
+  int exceededCount;
+  double duration;       // in ns
+};
+
+static int trainingsCount = 10000;
+static unsigned long jitter = 500;
+static unsigned long seed = 1;
+
+/// Runs `trainingsCount` Trainings of `samplesCount` Reference-Timestamps on a connection
+/// with a Connection-Interval of `connectionInterval` µs.
+template <typename Engine>
+static Result run(Engine &engine, int samplesCount, unsigned long connectionInterval) {
+  std::mt19937 random(seed);
+  std::uniform_int_distribution<unsigned long> offsetDistribution(0, 1000000000UL);
+  std::uniform_int_distribution<unsigned long> creationDistribution(0, connectionInterval - 1);
+  std::uniform_int_distribution<unsigned long> latencyDistribution(0, jitter);
+
+  Result result = {};
+  // Local time of the simulated Signalboy (in µs).
+  unsigned long long localTime = 1000000;
+  std::chrono::steady_clock::duration duration(0);
+
+  for (int training = 0; training < trainingsCount; training++) {
+    unsigned long long offset = offsetDistribution(random);
+    engine.setSamplesCount(samplesCount);
+
+    // Every Training starts on a Connection-Event.
+    localTime += 100000 + connectionInterval - localTime % connectionInterval;
+
+    // Generated beforehand: Only the Training is timed.
+    unsigned long receivedTimes[DefaultTrainingParameters::maxSamplesCount];
+    unsigned long referenceTimestamps[DefaultTrainingParameters::maxSamplesCount];
+    unsigned long long receivedTime = 0;
+    for (int i = 0; i < samplesCount; i++) {
+      unsigned long long event = localTime + (unsigned long long)(i + 1) * connectionInterval;
+      unsigned long long creationTime = event - connectionInterval + creationDistribution(random);
+      receivedTime = event + latencyDistribution(random);
+
+      receivedTimes[i] = receivedTime / 1000;
+      referenceTimestamps[i] = (creationTime + offset) / 1000;
+    }
+    localTime = receivedTime;
+    SimulatedClock::time = receivedTime / 1000;
+
+    bool isComplete = false;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < samplesCount; i++) {
+      isComplete = engine.onReceivedReferenceTimestamp(receivedTimes[i], referenceTimestamps[i], connectionInterval);
+    }
+    duration += std::chrono::steady_clock::now() - start;
+
+    TrainingStatus status = engine.status();
+    result.outcomes.push_back({ status, engine.failure(), engine.networkDelay() });
+    if (!isComplete || status.statusCode != trainingSucceeded) continue;
+
+    // The Central's time at the completion (the synced time is estimated for it).
+    double error = (double)status.adjustedReferenceTimestamp * 1000.0 - (double)(SimulatedClock::time * 1000ULL + offset);
+    double absoluteError = error < 0 ? -error : error;
+
+    result.succeededCount++;
+    result.errorSum += absoluteError;
+    if (absoluteError > result.errorMaximum) result.errorMaximum = absoluteError;
+    result.uncertaintySum += status.uncertainty;
+    if (absoluteError > status.uncertainty) result.exceededCount++;
+  }
+
+  result.duration = std::chrono::duration<double, std::nano>(duration).count() / trainingsCount;
+  return result;
+}
+
+static void print(const char *name, int samplesCount, unsigned long connectionInterval, const Result &result) {
+  int count = result.succeededCount > 0 ? result.succeededCount : 1;
+  printf("%-10s %7d %9lu %8.1f%% %10.0f %10.0f %12.0f %9.1f%% %9.1f\n",
+    name, samplesCount, connectionInterval,
+    100.0 * result.succeededCount / trainingsCount,
+    result.errorSum / count, result.errorMaximum, result.uncertaintySum / count,
+    100.0 * result.exceededCount / count,
+    result.duration);
+}
+
+/// Runs the firmware's specialization and one fixed at compile time. Returns `false`, if
+/// the error of a Training exceeded the uncertainty reported or the results differ.
+template <int SamplesCount, unsigned long ConnectionInterval>
+static bool compare(void) {
+  TrainingEngine<DefaultTrainingParameters, SimulatedClock> runtimeEngine;
+  Result runtimeResult = run(runtimeEngine, SamplesCount, ConnectionInterval);
+  print("runtime", SamplesCount, ConnectionInterval, runtimeResult);
+
+  TrainingEngine<FixedTrainingParameters<SamplesCount, ConnectionInterval>, SimulatedClock> fixedEngine;
+  Result fixedResult = run(fixedEngine, SamplesCount, ConnectionInterval);
+  print("fixed", SamplesCount, ConnectionInterval, fixedResult);
+
+  if (runtimeResult.exceededCount > 0 || fixedResult.exceededCount > 0) {
+    fprintf(stderr, "%d samples, %lu us: The error exceeded the uncertainty reported.\n", SamplesCount, ConnectionInterval);
+    return false;
+  }
+  if (runtimeResult.outcomes != fixedResult.outcomes) {
+    fprintf(stderr, "%d samples, %lu us: The results of the specializations differ.\n", SamplesCount, ConnectionInterval);
+    return false;
+  }
+  return true;
+}
+
+static int usage() {
+  fprintf(stderr, "usage: signalboy-trainbench [--trainings <n>] [--jitter <us>] [--seed <seed>]\n");
+  return 2;
+}
+
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) return usage();
+
+    if (strcmp(argv[i], "--trainings") == 0) {
+      trainingsCount = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--jitter") == 0) {
+      jitter = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--seed") == 0) {
+      seed = strtoul(argv[++i], nullptr, 10);
+    } else {
+      return usage();
+    }
+  }
+  if (trainingsCount <= 0) return usage();
+
+  printf("%-10s %7s %9s %9s %10s %10s %12s %10s %9s\n",
+    "engine", "samples", "interval", "succeeded", "error", "max error", "uncertainty", "exceeded", "ns");
+
+  // Connection-Intervals (in µs) requested in the fast mode, the default and the idle
+  // mode, and the USB frame interval of a Training via the Serial-Protocol.
+  bool isPassed = true;
+  isPassed &= compare<2, 7500>();
+  isPassed &= compare<3, 7500>();
+  isPassed &= compare<5, 7500>();
+  isPassed &= compare<8, 7500>();
+  isPassed &= compare<3, 15000>();
+  isPassed &= compare<5, 15000>();
+  isPassed &= compare<3, 30000>();
+  isPassed &= compare<3, 1000>();
+
+  return isPassed ? 0 : 1;
+}
@@ -0,0 +1,340 @@
+#include <Arduino.h>
+#include "ArduinoBLE.h"
+#include "virtualController.h"
+#include "virtualLink.h"
+
+#define MAX_SERVICES 16
+#define MAX_CHARACTERISTIC_HANDLERS (BLECharacteristicEventLast)
+
+struct BLELocalCharacteristic {
+  const char *uuid;
+  uint16_t properties;
+  int valueSize;
+  uint8_t value[VIRTUAL_LINK_MAX_VALUE_SIZE];
+  int valueLength;
+  bool isWritten;
+  BLECharacteristicEventHandler eventHandlers[MAX_CHARACTERISTIC_HANDLERS];
+  /// Handles of the subscribed connections (`0xffff`, if unused).
+  uint16_t subscribers[VIRTUAL_CONTROLLER_MAX_CONNECTIONS];
+};
+
+struct ConnectedDevice {
+  uint16_t handle;
+  char address[18];
+};
+
+static BLEService *services[MAX_SERVICES];
+static int servicesCount = 0;
+
+static ConnectedDevice devices[VIRTUAL_CONTROLLER_MAX_CONNECTIONS];
+static BLEDeviceEventHandler deviceEventHandlers[BLEDeviceLastEvent];
+
+static ConnectedDevice *findDevice(uint16_t handle) {
+  for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+    if (devices[i].handle == handle) return &devices[i];
+  }
+
+  return nullptr;
+}
+
+static BLECharacteristic findCharacteristic(const char *uuid) {
+  for (int i = 0; i < servicesCount; i++) {
+    for (int j = 0; j < services[i]->characteristicCount(); j++) {
+      BLECharacteristic characteristic = services[i]->characteristic(j);
+      if (strcmp(characteristic.uuid(), uuid) == 0) return characteristic;
+    }
+  }
+
+  return BLECharacteristic();
+}
+
+static void setSubscribed(BLELocalCharacteristic *local, uint16_t handle, bool isSubscribed) {
+  for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+    if (local->subscribers[i] == handle) local->subscribers[i] = 0xffff;
+  }
+  if (!isSubscribed) return;
+
+  for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+    if (local->subscribers[i] == 0xffff) {
+      local->subscribers[i] = handle;
+      return;
+    }
+  }
+}
+
+static void sendValue(uint8_t type, uint16_t handle, BLELocalCharacteristic *local) {
+  uint8_t message[VIRTUAL_LINK_MAX_MESSAGE_SIZE];
+  int length = encodeVirtualLinkMessage(type, local->uuid, local->value, local->valueLength, message);
+  if (length > 0) {
+    sendVirtualPacket(handle, message, length);
+  }
+}
+
+static void callCharacteristicEventHandler(BLECharacteristic characteristic, int event, const BLEDevice &device) {
+  BLECharacteristicEventHandler handler = characteristic.local->eventHandlers[event];
+  if (handler) handler(device, characteristic);
+}
+
+/// Handles a packet of a Central (ATT).
+static void handlePacket(const VirtualControllerEvent &event, const BLEDevice &device) {
+  char uuid[VIRTUAL_LINK_MAX_UUID_SIZE + 1];
+  const uint8_t *value;
+  int length = decodeVirtualLinkMessage(event.data, event.length, uuid, &value);
+  if (length < 0) return;
+
+  BLECharacteristic characteristic = findCharacteristic(uuid);
+  if (!characteristic) return;
+  BLELocalCharacteristic *local = characteristic.local;
+
+  switch (event.data[0]) {
+    case VIRTUAL_LINK_MSG_WRITE:
+      if (!(local->properties & (BLEWrite | BLEWriteWithoutResponse))) break;
+
+      local->valueLength = min(length, local->valueSize);
+      memcpy(local->value, value, local->valueLength);
+      local->isWritten = true;
+      callCharacteristicEventHandler(characteristic, BLEWritten, device);
+      break;
+
+    case VIRTUAL_LINK_MSG_SUBSCRIBE:
+      if (!(local->properties & (BLENotify | BLEIndicate))) break;
+
+      setSubscribed(local, event.handle, true);
+      callCharacteristicEventHandler(characteristic, BLESubscribed, device);
+      break;
+
+    case VIRTUAL_LINK_MSG_READ:
+      if (!(local->properties & BLERead)) break;
+
+      sendValue(VIRTUAL_LINK_MSG_READ_RESPONSE, event.handle, local);
+      break;
+
+    default:
+      break;
+  }
+}
+
+static void onVirtualControllerEvent(const VirtualControllerEvent &event) {
+  BLEDevice device(event.handle, event.address);
+
+  switch (event.type) {
+    case virtualEventCONNECTED:
+      {
+        ConnectedDevice *connectedDevice = findDevice(0xffff);
+        if (!connectedDevice) break;
+
+        connectedDevice->handle = event.handle;
+        strncpy(connectedDevice->address, event.address, sizeof(connectedDevice->address) - 1);
+        if (deviceEventHandlers[BLEConnected]) deviceEventHandlers[BLEConnected](device);
+        break;
+      }
+
+    case virtualEventDISCONNECTED:
+      {
+        ConnectedDevice *connectedDevice = findDevice(event.handle);
+        if (!connectedDevice) break;
+
+        connectedDevice->handle = 0xffff;
+        for (int i = 0; i < servicesCount; i++) {
+          for (int j = 0; j < services[i]->characteristicCount(); j++) {
+            setSubscribed(services[i]->characteristic(j).local, event.handle, false);
+          }
+        }
+        if (deviceEventHandlers[BLEDisconnected]) deviceEventHandlers[BLEDisconnected](device);
+        break;
+      }
+
+    case virtualEventPACKET:
+      handlePacket(event, device);
+      break;
+
+    default:
+      break;
+  }
+}
+
+// MARK: - BLEDevice
+
+BLEDevice::BLEDevice() : handle(0xffff), addressString("") {}
+
+BLEDevice::BLEDevice(uint16_t handle, const char *address) : handle(handle) {
+  strncpy(addressString, address ? address : "", sizeof(addressString) - 1);
+  addressString[sizeof(addressString) - 1] = '\0';
+}
+
+String BLEDevice::address() const {
+  return String(addressString);
+}
+
+bool BLEDevice::connected() const {
+  return findDevice(handle) != nullptr;
+}
+
+bool BLEDevice::disconnect() {
+  if (!connected()) return false;
+
+  disconnectVirtualConnection(handle);
+  return true;
+}
+
+// MARK: - BLECharacteristic
+
+BLECharacteristic::BLECharacteristic() : local(nullptr) {}
+
+BLECharacteristic::BLECharacteristic(const char *uuid, uint16_t properties, int valueSize, bool fixedLength)
+  : local(new BLELocalCharacteristic()) {
+  local->uuid = uuid;
+  local->properties = properties;
+  local->valueSize = min(valueSize, VIRTUAL_LINK_MAX_VALUE_SIZE);
+  local->valueLength = fixedLength ? local->valueSize : 0;
+  for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+    local->subscribers[i] = 0xffff;
+  }
+}
+
+BLECharacteristic::BLECharacteristic(const char *uuid, uint16_t properties, const char *value)
+  : BLECharacteristic(uuid, properties, strlen(value)) {
+  writeValue(value);
+}
+
+const char *BLECharacteristic::uuid() const {
+  return local->uuid;
+}
+
+uint16_t BLECharacteristic::properties() const {
+  return local->properties;
+}
+
+int BLECharacteristic::valueSize() const {
+  return local->valueSize;
+}
+
+int BLECharacteristic::valueLength() const {
+  return local->valueLength;
+}
+
+const uint8_t *BLECharacteristic::value() const {
+  return local->value;
+}
+
+int BLECharacteristic::writeValue(const uint8_t value[], int length, bool withResponse) {
+  local->valueLength = min(length, local->valueSize);
+  memcpy(local->value, value, local->valueLength);
+
+  if (local->properties & (BLENotify | BLEIndicate)) {
+    for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+      if (local->subscribers[i] != 0xffff) {
+        sendValue(VIRTUAL_LINK_MSG_NOTIFY, local->subscribers[i], local);
+      }
+    }
+  }
+
+  return 1;
+}
+
+int BLECharacteristic::writeValue(const char *value, int length, bool withResponse) {
+  return writeValue((const uint8_t *)value, length, withResponse);
+}
+
+int BLECharacteristic::writeValue(const char *value, bool withResponse) {
+  return writeValue(value, strlen(value), withResponse);
+}
+
+bool BLECharacteristic::written() {
+  bool isWritten = local->isWritten;
+  local->isWritten = false;
+  return isWritten;
+}
+
+bool BLECharacteristic::subscribed() {
+  for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+    if (local->subscribers[i] != 0xffff) return true;
+  }
+
+  return false;
+}
+
+void BLECharacteristic::setEventHandler(int event, BLECharacteristicEventHandler eventHandler) {
+  if (event >= 0 && event < MAX_CHARACTERISTIC_HANDLERS) {
+    local->eventHandlers[event] = eventHandler;
+  }
+}
+
+// MARK: - BLEService
+
+BLEService::BLEService(const char *uuid) : m_uuid(uuid), m_characteristicCount(0) {}
+
+const char *BLEService::uuid() const {
+  return m_uuid;
+}
+
+void BLEService::addCharacteristic(BLECharacteristic &characteristic) {
+  if (m_characteristicCount < (int)(sizeof(m_characteristics) / sizeof(m_characteristics[0]))) {
+    m_characteristics[m_characteristicCount++] = characteristic;
+  }
+}
+
+int BLEService::characteristicCount() const {
+  return m_characteristicCount;
+}
+
+BLECharacteristic BLEService::characteristic(int index) const {
+  return m_characteristics[index];
+}
+
+// MARK: - BLELocalDevice
+
+int BLELocalDevice::begin() {
+  if (!isVirtualControllerOpen()) return 0;
+
+  for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+    devices[i].handle = 0xffff;
+  }
+  addVirtualControllerEventHandler(onVirtualControllerEvent);
+  return 1;
+}
+
+void BLELocalDevice::end() {}
+
+void BLELocalDevice::poll(unsigned long timeout) {
+  pollVirtualController();
+}
+
+bool BLELocalDevice::connected() const {
+  for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+    if (devices[i].handle != 0xffff) return true;
+  }
+
+  return false;
+}
+
+bool BLELocalDevice::disconnect() {
+  for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+    if (devices[i].handle != 0xffff) disconnectVirtualConnection(devices[i].handle);
+  }
+
+  return true;
+}
+
+bool BLELocalDevice::setAdvertisedService(const BLEService &service) { return true; }
+bool BLELocalDevice::setLocalName(const char *localName) { return true; }
+void BLELocalDevice::setDeviceName(const char *deviceName) {}
+
+void BLELocalDevice::addService(BLEService &service) {
+  if (servicesCount < MAX_SERVICES) {
+    services[servicesCount++] = &service;
+  }
+}
+
+// Connections are accepted regardless of advertising.
+int BLELocalDevice::advertise() { return 1; }
+void BLELocalDevice::stopAdvertise() {}
+
+void BLELocalDevice::setEventHandler(int event, BLEDeviceEventHandler eventHandler) {
+  if (event >= 0 && event < BLEDeviceLastEvent) {
+    deviceEventHandlers[event] = eventHandler;
+  }
+}
+
+static BLELocalDevice localDevice;
+BLELocalDevice &BLE = localDevice;
@@ -0,0 +1,156 @@
+/*
+  ArduinoBLE-Shim
+
+  The subset of ArduinoBLE used by the sketch, serving its GATT-Server on the
+  Virtual Controller (s. virtualController.h): Writes of the Centrals are delivered
+  (and their handlers called) at the anchors of the Connection-Events, notifications
+  are sent at the next Connection-Event.
+*/
+
+#ifndef ArduinoBLE_h
+#define ArduinoBLE_h
+
+#include <Arduino.h>
+
+enum BLEDeviceEvent {
+  BLEConnected = 0,
+  BLEDisconnected = 1,
+  BLEDeviceLastEvent
+};
+
+enum BLECharacteristicEvent {
+  BLESubscribed = 0,
+  BLEUnsubscribed = 1,
+  BLEWritten = 3,
+  BLECharacteristicEventLast
+};
+
+enum BLEProperty {
+  BLEBroadcast = 0x01,
+  BLERead = 0x02,
+  BLEWriteWithoutResponse = 0x04,
+  BLEWrite = 0x08,
+  BLENotify = 0x10,
+  BLEIndicate = 0x20,
+};
+
+class BLEDevice {
+public:
+  BLEDevice();
+  BLEDevice(uint16_t handle, const char *address);
+
+  String address() const;
+  bool connected() const;
+  bool disconnect();
+
+  operator bool() const { return handle != 0xffff; }
+  bool operator==(const BLEDevice &other) const { return handle == other.handle; }
+  bool operator!=(const BLEDevice &other) const { return handle != other.handle; }
+
+private:
+  uint16_t handle;
+  char addressString[18];
+};
+
+struct BLELocalCharacteristic;
+class BLECharacteristic;
+
+typedef void (*BLEDeviceEventHandler)(BLEDevice device);
+typedef void (*BLECharacteristicEventHandler)(BLEDevice device, BLECharacteristic characteristic);
+
+/// A characteristic of the GATT-Server. Copies refer to the same characteristic.
+class BLECharacteristic {
+public:
+  BLECharacteristic();
+  BLECharacteristic(const char *uuid, uint16_t properties, int valueSize, bool fixedLength = false);
+  BLECharacteristic(const char *uuid, uint16_t properties, const char *value);
+
+  const char *uuid() const;
+  uint16_t properties() const;
+
+  int valueSize() const;
+  int valueLength() const;
+  const uint8_t *value() const;
+
+  /// Notifies the subscribed Centrals (if notifiable).
+  int writeValue(const uint8_t value[], int length, bool withResponse = true);
+  int writeValue(const char *value, int length, bool withResponse = true);
+  int writeValue(const char *value, bool withResponse = true);
+
+  bool written();
+  bool subscribed();
+
+  void setEventHandler(int event, BLECharacteristicEventHandler eventHandler);
+
+  operator bool() const { return local != nullptr; }
+
+  BLELocalCharacteristic *local;
+};
+
+template<typename T> class BLETypedCharacteristic : public BLECharacteristic {
+public:
+  BLETypedCharacteristic(const char *uuid, unsigned int permissions)
+    : BLECharacteristic(uuid, permissions, sizeof(T), true) {}
+
+  int writeValue(T value, bool withResponse = true) {
+    return BLECharacteristic::writeValue((const uint8_t *)&value, sizeof(T), withResponse);
+  }
+
+  T value() {
+    T value = T();
+    memcpy(&value, BLECharacteristic::value(), min(valueLength(), (int)sizeof(T)));
+    return value;
+  }
+};
+
+typedef BLETypedCharacteristic<uint8_t> BLEByteCharacteristic;
+// 32 bits (as on the board): `unsigned long` has 64 bits on LP64 hosts.
+typedef BLETypedCharacteristic<uint32_t> BLEUnsignedLongCharacteristic;
+typedef BLETypedCharacteristic<uint16_t> BLEUnsignedShortCharacteristic;
+
+class BLEService {
+public:
+  BLEService(const char *uuid);
+
+  const char *uuid() const;
+  void addCharacteristic(BLECharacteristic &characteristic);
+
+  int characteristicCount() const;
+  BLECharacteristic characteristic(int index) const;
+
+private:
+  const char *m_uuid;
+  BLECharacteristic m_characteristics[16];
+  int m_characteristicCount;
+};
+
+class BLELocalDevice {
+public:
+  /// Requires the Virtual Controller to be open (s. `openVirtualController()`).
+  int begin();
+  void end();
+
+  void poll(unsigned long timeout = 0);
+
+  bool connected() const;
+  bool disconnect();
+
+  bool setAdvertisedService(const BLEService &service);
+  bool setLocalName(const char *localName);
+  void setDeviceName(const char *deviceName);
+  void addService(BLEService &service);
+
+  int advertise();
+  void stopAdvertise();
+
+  /// Scanning is not simulated by the Virtual Controller (s. `OBSERVER_MODE`): Faked by
+  /// the host tests (s. `tests/fakeHci.h`).
+  int scan(bool withDuplicates = false);
+  bool available();
+
+  void setEventHandler(int event, BLEDeviceEventHandler eventHandler);
+};
+
+extern BLELocalDevice &BLE;
+
+#endif /* ArduinoBLE_h */
@@ -0,0 +1,21 @@
+/*
+  Flash-Storage of the virtual Signalboy: Implements `flashStorage.h` of the sketch (in
+  place of `flashStorage.cpp`, which writes the flash of the board). Kept in memory: A
+  restart of the virtual Signalboy (an upload) erases it.
+*/
+
+#include <string.h>
+#include "flashStorage.h"
+
+static uint8_t storage[FLASH_STORAGE_SIZE] = {};
+
+const uint8_t *flashStorage(void) {
+  return storage;
+}
+
+bool writeFlashStorage(size_t offset, const void *data, size_t length) {
+  if (offset > FLASH_STORAGE_SIZE || length > FLASH_STORAGE_SIZE - offset) return false;
+
+  memcpy(&storage[offset], data, length);
+  return true;
+}
@@ -0,0 +1,26 @@
+#!/usr/bin/env bash
+# Converts the sketch to C++ (like arduino-builder does): Prepends `#include <Arduino.h>`
+# and inserts the prototypes of the sketch's functions before their first definition.
+#
+#   ino2cpp.sh <sketch.ino> <output.cpp>
+set -euo pipefail
+
+sketch="$1"
+output="$2"
+
+# Function definitions start at column 0 (s. the sketch's style).
+definition='^[A-Za-z_][A-Za-z0-9_:<>*&, ]* \**[A-Za-z_][A-Za-z0-9_]*\([^;]*\) *\{'
+
+prototypes=$(grep -E "$definition" "$sketch" \
+  | grep -vE '^(if|for|while|switch|else|return|struct|class) ' \
+  | sed -E 's/ *\{ *$/;/')
+firstDefinition=$(grep -nE "$definition" "$sketch" | head -n 1 | cut -d: -f1)
+
+{
+  echo '#include <Arduino.h>'
+  echo "#line 1 \"$sketch\""
+  head -n "$((firstDefinition - 1))" "$sketch"
+  echo "$prototypes"
+  echo "#line $firstDefinition \"$sketch\""
+  tail -n +"$firstDefinition" "$sketch"
+} > "$output"
@@ -0,0 +1,13 @@
+/*
+  Memory-Usage of the virtual Signalboy: Implements `memoryUsage.h` of the sketch (in
+  place of `memoryUsage.cpp`, which paints the RAM of the board). Not tracked by the
+  simulator (like `freeMemory()`, s. `arduino/MemoryFree.h`).
+*/
+
+#include "memoryUsage.h"
+
+void setupMemoryUsage(void) {}
+
+MemoryUsage memoryUsage(void) {
+  return MemoryUsage{};
+}
@@ -0,0 +1,33 @@
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "pseudoTerminal.h"
+
+// Not built with the Arduino-Shim: Its binary constants (i.e. `B110`) collide
+// with the baud rates of termios.
+
+int openPseudoTerminal(const char *link, int *slaveFd) {
+  int fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) return -1;
+
+  struct termios tty;
+  if (tcgetattr(fd, &tty) == 0) {
+    cfmakeraw(&tty);
+    tcsetattr(fd, TCSANOW, &tty);
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+  const char *path = ptsname(fd);
+  // Keep the slave open: Otherwise, reading the master fails while no host is attached.
+  *slaveFd = open(path, O_RDWR | O_NOCTTY);
+
+  unlink(link);
+  if (symlink(path, link) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
@@ -0,0 +1,8 @@
+#ifndef pseudoTerminal_h
+#define pseudoTerminal_h
+
+/// Opens a pseudo terminal (raw mode) and links it at `link`. Returns the master's
+/// file descriptor (and the slave's by `slaveFd`), or -1 on failure.
+int openPseudoTerminal(const char *link, int *slaveFd);
+
+#endif /* pseudoTerminal_h */
@@ -0,0 +1,41 @@
+/*
+  Simulated RTC: Implements `rtc.hpp` of the sketch (in place of `rtc.cpp`). The
+  simulated RTC does not drift: Its SQW ticks (1.024 kHz) are derived from the host's
+  monotonic time (`micros()`), and the local time from the ticks (as by the RTC).
+*/
+
+#include <Arduino.h>
+#include "rtc.hpp"
+#include "Globals.hpp"
+#include "Logger.hpp"
+
+void printSqwMode() {
+  Log.println("Sqw Pin Mode: simulated");
+}
+
+void pps_tick(void) {}
+
+void setupRtc() {
+  printSqwMode();
+}
+
+unsigned int rtcTicks(void) {
+  return (unsigned int)((unsigned long long)micros() * 1024 / 1000000);
+}
+
+unsigned long millisRtc(bool skipSuspendInterrupts) {
+  return millisFromRtcTicks(rtcTicks());
+}
+
+unsigned long rtcLastTickMicros(void) {
+  return (unsigned long)(((unsigned long long)rtcTicks() * 1000000 + 1023) / 1024);
+}
+
+unsigned long microsAtMillisRtc(unsigned long t) {
+  // The first tick of `t`
+  unsigned int ticks = (unsigned int)((unsigned long long)t * 1024 / 1000);
+  while (millisFromRtcTicks(ticks) < t) ticks++;
+  while (ticks > 0 && millisFromRtcTicks(ticks - 1) >= t) ticks--;
+
+  return (unsigned long)(((unsigned long long)ticks * 1000000 + 1023) / 1024);
+}
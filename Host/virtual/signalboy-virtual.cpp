@@ -0,0 +1,88 @@
+/*
+  signalboy-virtual
+
+  Runs the sketch (`signalboy-arduino.ino` and its modules, unmodified) on Linux:
+  Centrals connect on the Virtual Link (s. virtualLink.h), a host may connect by the
+  Serial-Protocol on a pseudo terminal (as by USB).
+
+    signalboy-virtual [--socket <path>] [--serial <link>]
+
+  - `--socket`: The socket of the Virtual Link (default: `VIRTUAL_LINK_DEFAULT_PATH`).
+  - `--serial`: Serves the Serial-Protocol on a pseudo terminal linked at `<link>`.
+
+  The logs of the sketch (`Serial1`) are printed to stdout.
+*/
+
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <Arduino.h>
+#include "ArduinoShim.h"
+#include "pseudoTerminal.h"
+#include "virtualController.h"
+#include "virtualLink.h"
+
+// The sketch (s. `ino2cpp.sh`).
+void setup();
+void loop();
+
+static volatile sig_atomic_t isRunning = 1;
+
+static void onSignal(int) {
+  isRunning = 0;
+}
+
+int main(int argc, char *argv[]) {
+  const char *socketPath = VIRTUAL_LINK_DEFAULT_PATH;
+  const char *serialLink = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+      socketPath = argv[++i];
+    } else if (strcmp(argv[i], "--serial") == 0 && i + 1 < argc) {
+      serialLink = argv[++i];
+    } else {
+      fprintf(stderr, "usage: signalboy-virtual [--socket <path>] [--serial <link>]\n");
+      return 2;
+    }
+  }
+
+  if (!openVirtualController(socketPath)) {
+    fprintf(stderr, "Cannot listen on %s: %s\n", socketPath, strerror(errno));
+    return 1;
+  }
+
+  int serialFd = -1, slaveFd = -1;
+  if (serialLink) {
+    serialFd = openPseudoTerminal(serialLink, &slaveFd);
+    if (serialFd < 0) {
+      fprintf(stderr, "Cannot open pseudo terminal at %s: %s\n", serialLink, strerror(errno));
+      return 1;
+    }
+    serialUsb.setFileDescriptor(serialFd);
+  }
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+
+  setPinChangeHandler(sendVirtualPinChange);
+
+  printf("Virtual Signalboy listening on %s%s%s\n", socketPath, serialLink ? " and " : "", serialLink ? serialLink : "");
+  setup();
+
+  while (isRunning) {
+    loop();
+    // Yields the CPU (to Centrals on the same host): Delays the loop by ~0.1 ms.
+    usleep(100);
+  }
+
+  closeVirtualController();
+  if (serialLink) {
+    unlink(serialLink);
+    close(slaveFd);
+    close(serialFd);
+  }
+  return 0;
+}
@@ -0,0 +1,247 @@
+/*
+  Connection-Parameters on the Virtual Controller: Implements `connection.h` of the
+  sketch (in place of `connection.cpp`, which taps the HCI-transport of the board).
+  Like the original, the anchors of the Connection-Events are estimated from the
+  reception times of the Central's packets (s. `ConnectionEventTracker`).
+*/
+
+#include <Arduino.h>
+#include "connection.h"
+#include "constants.h"
+#include "Globals.hpp"
+#include "Logger.hpp"
+#include "ConnectionEventTracker.h"
+#include "rtc.hpp"
+#include "virtualController.h"
+
+struct Connection {
+  bool isConnected;
+  uint16_t handle;
+  char address[18];
+  /// Negotiated Connection-Interval (in units of 1.25 ms).
+  uint16_t interval;
+  uint16_t latency;
+
+  ConnectionEventTracker connectionEventTracker;
+  /// Time (in µs, `micros()`) the last packet was received from the Central.
+  unsigned long lastPacketReceivedTime;
+
+  connectionMode_t desiredMode;
+
+  bool isUpdateRequestPending;
+  uint16_t requestedInterval;
+  uint16_t requestedLatency;
+};
+
+static Connection connections[MAX_CENTRALS];
+// Connection-Intervals of the Connection-Modes (s. `setConnectionIntervals()`)
+static uint16_t connectionIntervalFast = CONNECTION_INTERVAL_FAST_DEFAULT;
+static uint16_t connectionIntervalIdle = CONNECTION_INTERVAL_IDLE_DEFAULT;
+
+static Connection *findConnection(uint16_t handle) {
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    if (connections[i].isConnected && connections[i].handle == handle) {
+      return &connections[i];
+    }
+  }
+
+  return nullptr;
+}
+
+static unsigned long getIntervalMicros(Connection &connection) {
+  return connection.interval * 1250UL;
+}
+
+static void setConnectionParameters(Connection &connection, uint16_t interval, uint16_t latency) {
+  connection.interval = interval;
+  connection.latency = latency;
+
+  // The anchors are shifted by the update: Start over.
+  connection.connectionEventTracker.reset();
+  connection.connectionEventTracker.setConnectionInterval(getIntervalMicros(connection));
+
+  Log.printTimestamp();
+  Log.print("Connection-Parameters updated (handle=");
+  Log.print(connection.handle);
+  Log.print("): interval=");
+  Log.print(getIntervalMicros(connection));
+  Log.print(" us, latency=");
+  Log.println(latency);
+}
+
+static void onVirtualControllerEvent(const VirtualControllerEvent &event) {
+  switch (event.type) {
+    case virtualEventCONNECTED:
+      {
+        Connection *connection = nullptr;
+        for (int i = 0; i < MAX_CENTRALS; i++) {
+          if (!connections[i].isConnected) {
+            connection = &connections[i];
+            break;
+          }
+        }
+        if (!connection) break;
+
+        connection->isConnected = true;
+        connection->handle = event.handle;
+        strncpy(connection->address, event.address, sizeof(connection->address) - 1);
+        connection->address[sizeof(connection->address) - 1] = '\0';
+        connection->lastPacketReceivedTime = event.receivedTime;
+        connection->desiredMode = connectionModeFAST;
+        connection->isUpdateRequestPending = false;
+        setConnectionParameters(*connection, event.interval, event.latency);
+        break;
+      }
+
+    case virtualEventDISCONNECTED:
+      {
+        Connection *connection = findConnection(event.handle);
+        if (connection) {
+          connection->isConnected = false;
+          connection->interval = 0;
+          connection->latency = 0;
+          connection->isUpdateRequestPending = false;
+        }
+        break;
+      }
+
+    case virtualEventCONNECTION_UPDATED:
+      {
+        Connection *connection = findConnection(event.handle);
+        if (!connection) break;
+
+        connection->isUpdateRequestPending = false;
+        setConnectionParameters(*connection, event.interval, event.latency);
+        break;
+      }
+
+    case virtualEventPACKET:
+      {
+        Connection *connection = findConnection(event.handle);
+        if (!connection) break;
+
+        connection->lastPacketReceivedTime = event.receivedTime;
+        connection->connectionEventTracker.onPacketReceived(event.receivedTime);
+        break;
+      }
+  }
+}
+
+static void getConnectionParameters(connectionMode_t mode, uint16_t *interval, uint16_t *latency) {
+  switch (mode) {
+    case connectionModeIDLE:
+      *interval = connectionIntervalIdle;
+      *latency = CONNECTION_SLAVE_LATENCY_IDLE;
+      break;
+
+    case connectionModeFAST:
+      *interval = connectionIntervalFast;
+      *latency = 0;
+      break;
+  }
+}
+
+static void updateConnectionParametersIfNeeded(Connection &connection) {
+  uint16_t interval = 0, latency = 0;
+  getConnectionParameters(connection.desiredMode, &interval, &latency);
+
+  if (interval == connection.interval && latency == connection.latency) {
+    connection.isUpdateRequestPending = false;
+    return;
+  }
+
+  // The Virtual Controller's Central accepts every request.
+  if (connection.isUpdateRequestPending
+      && interval == connection.requestedInterval
+      && latency == connection.requestedLatency) {
+    return;
+  }
+
+  Log.printTimestamp();
+  Log.print("Will request Connection-Parameters (handle=");
+  Log.print(connection.handle);
+  Log.print("): interval=");
+  Log.print(interval);
+  Log.print(" (x1.25ms), latency=");
+  Log.println(latency);
+
+  requestVirtualConnectionUpdate(connection.handle, interval, latency);
+
+  connection.isUpdateRequestPending = true;
+  connection.requestedInterval = interval;
+  connection.requestedLatency = latency;
+}
+
+// MARK: - Public
+
+void setupConnection(void) {
+  // Precedes the handler of the GATT-Server (`BLE.begin()`), as on the board.
+  addVirtualControllerEventHandler(onVirtualControllerEvent);
+}
+
+uint16_t getConnectionHandle(const char *address) {
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    if (connections[i].isConnected && strcasecmp(connections[i].address, address) == 0) {
+      return connections[i].handle;
+    }
+  }
+
+  return CONNECTION_HANDLE_NONE;
+}
+
+void setConnectionIntervals(uint16_t fast, uint16_t idle) {
+  connectionIntervalFast = fast;
+  connectionIntervalIdle = idle;
+}
+
+void setConnectionMode(uint16_t handle, connectionMode_t mode) {
+  Connection *connection = findConnection(handle);
+  if (connection) {
+    connection->desiredMode = mode;
+  }
+}
+
+void updateConnectionParametersIfNeeded(void) {
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    if (connections[i].isConnected) {
+      updateConnectionParametersIfNeeded(connections[i]);
+    }
+  }
+}
+
+bool isConnectionEstablished(uint16_t handle) {
+  return findConnection(handle) != nullptr;
+}
+
+uint16_t getConnectionInterval(uint16_t handle) {
+  Connection *connection = findConnection(handle);
+  return connection ? connection->interval : 0;
+}
+
+unsigned long getConnectionIntervalMicros(uint16_t handle) {
+  Connection *connection = findConnection(handle);
+  return connection ? getIntervalMicros(*connection) : 0;
+}
+
+uint16_t getSlaveLatency(uint16_t handle) {
+  Connection *connection = findConnection(handle);
+  return connection ? connection->latency : 0;
+}
+
+unsigned long getLastConnectionEventTime(uint16_t handle) {
+  Connection *connection = findConnection(handle);
+  if (!connection) return millisRtc(false);
+
+  unsigned long anchor = connection->connectionEventTracker.getAnchor(connection->lastPacketReceivedTime);
+  unsigned long age = micros() - anchor;  // in µs
+
+  return millisRtc(false) - age / 1000UL;
+}
+
+unsigned long getLastConnectionEventRxOffsetMicros(uint16_t handle) {
+  Connection *connection = findConnection(handle);
+  if (!connection) return 0;
+
+  unsigned long receivedTime = connection->lastPacketReceivedTime;
+  return receivedTime - connection->connectionEventTracker.getAnchor(receivedTime);
+}
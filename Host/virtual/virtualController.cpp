@@ -0,0 +1,356 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <Arduino.h>
+#include "ArduinoShim.h"
+#include "virtualController.h"
+#include "virtualLink.h"
+
+struct Packet {
+  uint8_t data[VIRTUAL_LINK_MAX_MESSAGE_SIZE];
+  int length;
+};
+
+struct PacketQueue {
+  Packet packets[VIRTUAL_CONTROLLER_QUEUE_SIZE];
+  int head;
+  int count;
+};
+
+struct VirtualConnection {
+  bool isConnected;
+  int fd;
+  uint16_t handle;
+  char address[sizeof(VirtualLinkConnect::address) + 1];
+
+  /// Connection-Parameters (in units of 1.25 ms).
+  uint16_t interval;
+  uint16_t latency;
+
+  bool isUpdatePending;
+  uint16_t updateInterval;
+  uint16_t updateLatency;
+  /// The Connection-Event at which the pending update takes effect.
+  uint32_t updateInstant;
+
+  /// Time (in µs, `monotonicMicros()`) of the next anchor.
+  uint64_t nextAnchorTime;
+  uint32_t eventCounter;
+  /// Number of consecutive Connection-Events the Peripheral did not listen in.
+  uint16_t skippedEventsCount;
+
+  PacketQueue rxQueue;
+  PacketQueue txQueue;
+};
+
+static int listenFd = -1;
+static char socketPath[sizeof(((sockaddr_un *)0)->sun_path)];
+
+static VirtualConnection connections[VIRTUAL_CONTROLLER_MAX_CONNECTIONS];
+static uint16_t nextHandle = 1;
+
+static VirtualControllerEventHandler eventHandlers[VIRTUAL_CONTROLLER_MAX_HANDLERS];
+static int eventHandlerCount = 0;
+
+static VirtualLinkPinChange pinChanges[VIRTUAL_CONTROLLER_MAX_PIN_CHANGES];
+static int pinChangesCount = 0;
+
+static unsigned long getIntervalMicros(uint16_t interval) {
+  return interval * 1250UL;
+}
+
+static void dispatchEvent(const VirtualControllerEvent &event) {
+  for (int i = 0; i < eventHandlerCount; i++) {
+    eventHandlers[i](event);
+  }
+}
+
+static VirtualControllerEvent makeEvent(virtualEventType_t type, VirtualConnection &connection) {
+  VirtualControllerEvent event = {};
+  event.type = type;
+  event.handle = connection.handle;
+  event.address = connection.address;
+  event.interval = connection.interval;
+  event.latency = connection.latency;
+  event.receivedTime = micros();
+  return event;
+}
+
+static VirtualConnection *findConnection(uint16_t handle) {
+  for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+    if (connections[i].fd >= 0 && connections[i].handle == handle) {
+      return &connections[i];
+    }
+  }
+
+  return nullptr;
+}
+
+static bool pushPacket(PacketQueue &queue, const uint8_t *data, int length) {
+  if (queue.count == VIRTUAL_CONTROLLER_QUEUE_SIZE || length > VIRTUAL_LINK_MAX_MESSAGE_SIZE) return false;
+
+  Packet &packet = queue.packets[(queue.head + queue.count) % VIRTUAL_CONTROLLER_QUEUE_SIZE];
+  memcpy(packet.data, data, length);
+  packet.length = length;
+  queue.count++;
+  return true;
+}
+
+static Packet *popPacket(PacketQueue &queue) {
+  if (queue.count == 0) return nullptr;
+
+  Packet *packet = &queue.packets[queue.head];
+  queue.head = (queue.head + 1) % VIRTUAL_CONTROLLER_QUEUE_SIZE;
+  queue.count--;
+  return packet;
+}
+
+static void closeConnection(VirtualConnection &connection) {
+  close(connection.fd);
+  connection.fd = -1;
+
+  if (connection.isConnected) {
+    connection.isConnected = false;
+    dispatchEvent(makeEvent(virtualEventDISCONNECTED, connection));
+  }
+}
+
+static void sendMessage(VirtualConnection &connection, const void *data, int length) {
+  // The Central is expected to keep up: Messages are dropped otherwise.
+  send(connection.fd, data, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+static void flushPinChanges() {
+  for (int i = 0; i < pinChangesCount; i++) {
+    uint8_t message[1 + sizeof(VirtualLinkPinChange)];
+    message[0] = VIRTUAL_LINK_MSG_PIN_CHANGE;
+    memcpy(&message[1], &pinChanges[i], sizeof(VirtualLinkPinChange));
+
+    for (int j = 0; j < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; j++) {
+      if (connections[j].isConnected) {
+        sendMessage(connections[j], message, sizeof(message));
+      }
+    }
+  }
+
+  pinChangesCount = 0;
+}
+
+static void acceptConnections() {
+  int fd;
+  while ((fd = accept(listenFd, nullptr, nullptr)) >= 0) {
+    VirtualConnection *connection = nullptr;
+    for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+      if (connections[i].fd < 0) {
+        connection = &connections[i];
+        break;
+      }
+    }
+
+    if (!connection) {
+      close(fd);
+      continue;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    memset(connection, 0, sizeof(*connection));
+    connection->fd = fd;
+    connection->handle = nextHandle;
+    nextHandle = nextHandle == 0x0eff ? 1 : nextHandle + 1;
+  }
+}
+
+static void onConnect(VirtualConnection &connection, const uint8_t *data, int length) {
+  VirtualLinkConnect request;
+  if (connection.isConnected || length < 1 + (int)sizeof(request)) return;
+  memcpy(&request, &data[1], sizeof(request));
+
+  memcpy(connection.address, request.address, sizeof(request.address));
+  connection.address[sizeof(request.address)] = '\0';
+  connection.interval = request.interval > 0 ? request.interval : 1;
+  connection.latency = 0;
+  connection.nextAnchorTime = monotonicMicros() + getIntervalMicros(connection.interval);
+  connection.isConnected = true;
+
+  dispatchEvent(makeEvent(virtualEventCONNECTED, connection));
+}
+
+static void receivePackets(VirtualConnection &connection) {
+  uint8_t data[VIRTUAL_LINK_MAX_MESSAGE_SIZE];
+
+  while (connection.fd >= 0) {
+    ssize_t length = recv(connection.fd, data, sizeof(data), MSG_DONTWAIT);
+    if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+    if (length <= 0) {
+      closeConnection(connection);
+      return;
+    }
+
+    if (data[0] == VIRTUAL_LINK_MSG_CONNECT) {
+      onConnect(connection, data, length);
+    } else if (connection.isConnected && !pushPacket(connection.rxQueue, data, length)) {
+      // The Central would not be acknowledged (and retransmit): Not emulated.
+      fprintf(stderr, "Virtual Controller: RX-queue full (handle=%u). Packet dropped.\n", connection.handle);
+    }
+  }
+}
+
+static void runConnectionEvent(VirtualConnection &connection) {
+  bool isListening = connection.skippedEventsCount >= connection.latency
+    || connection.txQueue.count > 0
+    || connection.isUpdatePending;
+
+  VirtualLinkConnectionEvent event = {
+    connection.nextAnchorTime,
+    (uint32_t)getIntervalMicros(connection.interval),
+    (uint8_t)isListening
+  };
+
+  if (isListening) {
+    connection.skippedEventsCount = 0;
+
+    for (int i = 0; i < VIRTUAL_LINK_MAX_WRITES_PER_EVENT; i++) {
+      Packet *packet = popPacket(connection.rxQueue);
+      if (!packet) break;
+
+      VirtualControllerEvent packetEvent = makeEvent(virtualEventPACKET, connection);
+      packetEvent.data = packet->data;
+      packetEvent.length = packet->length;
+      dispatchEvent(packetEvent);
+      // The handlers may have disconnected.
+      if (!connection.isConnected) return;
+    }
+
+    Packet *packet;
+    while ((packet = popPacket(connection.txQueue))) {
+      sendMessage(connection, packet->data, packet->length);
+    }
+  } else {
+    connection.skippedEventsCount++;
+  }
+
+  uint8_t message[1 + sizeof(event)];
+  message[0] = VIRTUAL_LINK_MSG_CONNECTION_EVENT;
+  memcpy(&message[1], &event, sizeof(event));
+  sendMessage(connection, message, sizeof(message));
+}
+
+static void runConnectionEvents(VirtualConnection &connection) {
+  uint64_t time = monotonicMicros();
+  if (time < connection.nextAnchorTime) return;
+
+  runConnectionEvent(connection);
+  if (!connection.isConnected) return;
+
+  // Connection-Events missed (while the loop was busy) are skipped.
+  uint64_t interval = getIntervalMicros(connection.interval);
+  uint32_t elapsedEventsCount = (time - connection.nextAnchorTime) / interval + 1;
+  connection.nextAnchorTime += elapsedEventsCount * interval;
+  connection.eventCounter += elapsedEventsCount;
+
+  if (connection.isUpdatePending && (int32_t)(connection.eventCounter - connection.updateInstant) >= 0) {
+    connection.isUpdatePending = false;
+    connection.interval = connection.updateInterval;
+    connection.latency = connection.updateLatency;
+    connection.nextAnchorTime = connection.nextAnchorTime - interval + getIntervalMicros(connection.interval);
+
+    dispatchEvent(makeEvent(virtualEventCONNECTION_UPDATED, connection));
+  }
+}
+
+// MARK: - Public
+
+bool openVirtualController(const char *path) {
+  for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+    connections[i].fd = -1;
+  }
+
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(address.sun_path)) return false;
+  strcpy(address.sun_path, path);
+
+  listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK, 0);
+  if (listenFd < 0) return false;
+
+  unlink(path);
+  if (bind(listenFd, (sockaddr *)&address, sizeof(address)) != 0 || listen(listenFd, VIRTUAL_CONTROLLER_MAX_CONNECTIONS) != 0) {
+    close(listenFd);
+    listenFd = -1;
+    return false;
+  }
+
+  strcpy(socketPath, path);
+  return true;
+}
+
+void closeVirtualController() {
+  if (listenFd < 0) return;
+
+  for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+    if (connections[i].fd >= 0) closeConnection(connections[i]);
+  }
+
+  close(listenFd);
+  listenFd = -1;
+  unlink(socketPath);
+}
+
+bool isVirtualControllerOpen() {
+  return listenFd >= 0;
+}
+
+bool addVirtualControllerEventHandler(VirtualControllerEventHandler handler) {
+  if (eventHandlerCount == VIRTUAL_CONTROLLER_MAX_HANDLERS) return false;
+
+  eventHandlers[eventHandlerCount++] = handler;
+  return true;
+}
+
+void pollVirtualController() {
+  if (listenFd < 0) return;
+
+  flushPinChanges();
+  acceptConnections();
+
+  for (int i = 0; i < VIRTUAL_CONTROLLER_MAX_CONNECTIONS; i++) {
+    VirtualConnection &connection = connections[i];
+    if (connection.fd < 0) continue;
+
+    receivePackets(connection);
+    if (connection.isConnected) {
+      runConnectionEvents(connection);
+    }
+  }
+}
+
+bool sendVirtualPacket(uint16_t handle, const uint8_t *data, int length) {
+  VirtualConnection *connection = findConnection(handle);
+  return connection && connection->isConnected && pushPacket(connection->txQueue, data, length);
+}
+
+void requestVirtualConnectionUpdate(uint16_t handle, uint16_t interval, uint16_t latency) {
+  VirtualConnection *connection = findConnection(handle);
+  if (!connection || !connection->isConnected) return;
+
+  connection->isUpdatePending = true;
+  connection->updateInterval = interval;
+  connection->updateLatency = latency;
+  connection->updateInstant = connection->eventCounter + VIRTUAL_LINK_UPDATE_INSTANT;
+}
+
+void disconnectVirtualConnection(uint16_t handle) {
+  VirtualConnection *connection = findConnection(handle);
+  if (connection) closeConnection(*connection);
+}
+
+void sendVirtualPinChange(int pin, int level, uint64_t time) {
+  if (pinChangesCount == VIRTUAL_CONTROLLER_MAX_PIN_CHANGES) flushPinChanges();
+
+  pinChanges[pinChangesCount++] = { (uint8_t)pin, (uint8_t)level, time };
+}
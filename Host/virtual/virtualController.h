@@ -0,0 +1,78 @@
+/*
+  Virtual Controller
+
+  Emulates the BLE controller of the virtual Signalboy on the Virtual Link
+  (s. virtualLink.h): Accepts the connections of Centrals and runs their
+  Connection-Events. The packets of a Central are queued until the anchor of
+  the next Connection-Event the Peripheral listens in (s. Slave-Latency), and
+  so are the packets sent to the Central.
+
+  The host stack (s. `ArduinoBLE.h` and `virtualConnection.cpp`) receives the
+  controller's events by handlers (like the `HCITap` of the sketch).
+*/
+
+#ifndef virtualController_h
+#define virtualController_h
+
+#include <stdint.h>
+
+/// Maximum number of simultaneous connections.
+#define VIRTUAL_CONTROLLER_MAX_CONNECTIONS 4
+/// Maximum number of packets queued per connection and direction.
+#define VIRTUAL_CONTROLLER_QUEUE_SIZE 32
+/// Maximum number of event handlers.
+#define VIRTUAL_CONTROLLER_MAX_HANDLERS 4
+/// Maximum number of pin changes buffered until the next poll (s. `sendVirtualPinChange()`).
+#define VIRTUAL_CONTROLLER_MAX_PIN_CHANGES 64
+
+typedef enum {
+  /// A Central connected (`address`, `interval` and `latency` are set).
+  virtualEventCONNECTED,
+  virtualEventDISCONNECTED,
+  /// The Connection-Parameters changed (`interval` and `latency` are set).
+  virtualEventCONNECTION_UPDATED,
+  /// A packet of the Central has been delivered (`data` and `length` are set).
+  virtualEventPACKET,
+} virtualEventType_t;
+
+struct VirtualControllerEvent {
+  virtualEventType_t type;
+  uint16_t handle;
+  const char *address;
+  /// Connection-Interval (in units of 1.25 ms).
+  uint16_t interval;
+  uint16_t latency;
+  /// The packet (a message of the Virtual Link).
+  const uint8_t *data;
+  int length;
+  /// Time (in µs, `micros()`) of the event.
+  unsigned long receivedTime;
+};
+
+typedef void (*VirtualControllerEventHandler)(const VirtualControllerEvent &event);
+
+/// Listens for Centrals on the socket at `path` (replacing any stale socket).
+bool openVirtualController(const char *path);
+void closeVirtualController();
+bool isVirtualControllerOpen();
+
+/// Returns `false`, if the maximum number of handlers has been added already.
+bool addVirtualControllerEventHandler(VirtualControllerEventHandler handler);
+
+/// Accepts connections, receives packets and runs the due Connection-Events.
+void pollVirtualController();
+
+/// Queues a packet (a message of the Virtual Link) for the next Connection-Event.
+/// Returns `false`, if the queue of the connection is full.
+bool sendVirtualPacket(uint16_t handle, const uint8_t *data, int length);
+/// Requests Connection-Parameters: The Central accepts them, effective
+/// `VIRTUAL_LINK_UPDATE_INSTANT` Connection-Events later.
+void requestVirtualConnectionUpdate(uint16_t handle, uint16_t interval, uint16_t latency);
+void disconnectVirtualConnection(uint16_t handle);
+
+/// Reports a change of an output pin to every Central (not being part of the emulated
+/// BLE link): Buffered until the next poll, sparing the sketch the context switches to
+/// the Centrals (i.e. while emitting a pulse train, s. pulseCode.h).
+void sendVirtualPinChange(int pin, int level, uint64_t time);
+
+#endif /* virtualController_h */
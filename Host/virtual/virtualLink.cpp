@@ -0,0 +1,29 @@
+#include <string.h>
+#include "virtualLink.h"
+
+int encodeVirtualLinkMessage(uint8_t type, const char *uuid, const uint8_t *value, int length, uint8_t *message) {
+  int uuidLength = strlen(uuid);
+  if (uuidLength > VIRTUAL_LINK_MAX_UUID_SIZE || length > VIRTUAL_LINK_MAX_VALUE_SIZE) return 0;
+
+  message[0] = type;
+  message[1] = uuidLength;
+  memcpy(&message[2], uuid, uuidLength);
+  if (length > 0) {
+    memcpy(&message[2 + uuidLength], value, length);
+  }
+
+  return 2 + uuidLength + length;
+}
+
+int decodeVirtualLinkMessage(const uint8_t *message, int size, char *uuid, const uint8_t **value) {
+  if (size < 2) return -1;
+
+  int uuidLength = message[1];
+  if (uuidLength > VIRTUAL_LINK_MAX_UUID_SIZE || size < 2 + uuidLength) return -1;
+
+  memcpy(uuid, &message[2], uuidLength);
+  uuid[uuidLength] = '\0';
+  *value = &message[2 + uuidLength];
+
+  return size - 2 - uuidLength;
+}
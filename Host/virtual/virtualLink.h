@@ -0,0 +1,90 @@
+/*
+  Virtual Link
+
+  Emulates the BLE link between Centrals and the virtual Signalboy (s. `signalboy-virtual`)
+  on a local socket (`SOCK_SEQPACKET`, one connection per Central): The virtual Signalboy
+  runs the Connection-Events of every connection and delivers the writes of a Central
+  at their anchors - as the controller of the Signalboy does.
+
+  Every message starts with its type (`VirtualLinkMessageType`), followed by its
+  parameters (little-endian). Characteristics are identified by their UUID (as
+  declared by the sketch, i.e. "92360002-7858-41a5-b0cc-942dd4189715").
+*/
+
+#ifndef virtualLink_h
+#define virtualLink_h
+
+#include <stdint.h>
+
+#define VIRTUAL_LINK_DEFAULT_PATH "/tmp/signalboy-virtual.sock"
+
+/// Maximum size of a message (including its type).
+#define VIRTUAL_LINK_MAX_MESSAGE_SIZE 128
+#define VIRTUAL_LINK_MAX_UUID_SIZE 36
+/// Maximum size of a characteristic's value.
+#define VIRTUAL_LINK_MAX_VALUE_SIZE 64
+
+/// Maximum number of writes delivered per Connection-Event (the rest is delivered
+/// in the following Connection-Events).
+#define VIRTUAL_LINK_MAX_WRITES_PER_EVENT 6
+/// Number of Connection-Events until requested Connection-Parameters take effect
+/// (the "instant" of the Connection Update procedure).
+#define VIRTUAL_LINK_UPDATE_INSTANT 6
+
+enum VirtualLinkMessageType : uint8_t {
+  // Central -> Peripheral
+
+  /// First message of a Central: `VirtualLinkConnect`.
+  VIRTUAL_LINK_MSG_CONNECT = 0x01,
+  /// Write (with or without response): UUID, followed by the value.
+  VIRTUAL_LINK_MSG_WRITE = 0x02,
+  /// Subscribes to the notifications of a characteristic: UUID.
+  VIRTUAL_LINK_MSG_SUBSCRIBE = 0x03,
+  /// Reads a characteristic: UUID (answered by `VIRTUAL_LINK_MSG_READ_RESPONSE`).
+  VIRTUAL_LINK_MSG_READ = 0x04,
+
+  // Peripheral -> Central
+
+  /// UUID, followed by the value.
+  VIRTUAL_LINK_MSG_READ_RESPONSE = 0x81,
+  /// UUID, followed by the value.
+  VIRTUAL_LINK_MSG_NOTIFY = 0x82,
+  /// Sent at the anchor of every Connection-Event: `VirtualLinkConnectionEvent`.
+  VIRTUAL_LINK_MSG_CONNECTION_EVENT = 0x83,
+  /// Probe of the Signalboy's output pins (not part of BLE): `VirtualLinkPinChange`.
+  VIRTUAL_LINK_MSG_PIN_CHANGE = 0x84,
+};
+
+struct __attribute__((packed)) VirtualLinkConnect {
+  /// The Central's address (formatted as "aa:bb:cc:dd:ee:ff").
+  char address[17];
+  /// The initial Connection-Interval (in units of 1.25 ms, as chosen by the Central).
+  uint16_t interval;
+};
+
+struct __attribute__((packed)) VirtualLinkConnectionEvent {
+  /// Time of the anchor in µs (`CLOCK_MONOTONIC` of the host).
+  uint64_t anchorTime;
+  /// The Connection-Interval in µs.
+  uint32_t interval;
+  /// `1`, if the Peripheral listened in this Connection-Event (it skips up to
+  /// Slave-Latency Connection-Events): Only then writes have been delivered.
+  uint8_t isListening;
+};
+
+struct __attribute__((packed)) VirtualLinkPinChange {
+  uint8_t pin;
+  uint8_t level;
+  /// Time of the change in µs (`CLOCK_MONOTONIC` of the host).
+  uint64_t time;
+};
+
+/// Encodes a message referring to a characteristic: type, UUID (length-prefixed),
+/// value. Returns the size of the message (0, if too large).
+int encodeVirtualLinkMessage(uint8_t type, const char *uuid, const uint8_t *value, int length, uint8_t *message);
+/// Decodes a message referring to a characteristic: `uuid` receives the
+/// (null-terminated) UUID, `value` points to the value within `message`.
+/// Returns the length of the value (-1, if invalid).
+int decodeVirtualLinkMessage(const uint8_t *message, int size, char *uuid, const uint8_t **value);
+
+#endif /* virtualLink_h */
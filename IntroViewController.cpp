@@ -1,4 +1,8 @@
 #include <Arduino.h>
+#include "Globals.hpp"
+
+#ifndef HEADLESS
+
 #include "IntroViewController.h"
 #include "Resources.h"
 
@@ -23,4 +27,6 @@ arduino::String IntroViewController::getLine2() {
 
 void IntroViewController::update() {}
 
-void IntroViewController::onButtonPushed(Button_t button) {}
\ No newline at end of file
+void IntroViewController::onButtonPushed(Button_t button) {}
+
+#endif /* HEADLESS */
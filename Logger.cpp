@@ -1,6 +1,7 @@
 #include <Arduino.h>
 #include <MemoryFree.h>
 #include "Logger.hpp"
+#include "faultLog.h"
 #include "rtc.hpp"
 
 /*
@@ -114,6 +115,7 @@ void Logger::handleBufferOverflow() {
   serialPtr->println();
   serialPtr->print("WARNING: Buffer overflow! Logs will be dropped.");
   serialPtr->println(" (" + String(size) + " B).");
+  reportFault(FAULT_DOMAIN_LOG, FAULT_CODE_LOG_OVERFLOW, size);
 
   serialPtr->println();
   serialPtr->println();
@@ -1,5 +1,9 @@
 #include <cstddef>
 #include <Arduino.h>
+#include "Globals.hpp"
+
+#ifndef HEADLESS
+
 #include "LCDKeypadShieldLib.h"
 #include "MainViewController.h"
 #include "MenuViewController.h"
@@ -15,7 +19,10 @@ MainViewController::MainViewController()
     m_lastMenuInteractionTime(0) {}
 
 void MainViewController::setText(arduino::String text) {
+  if (text == m_text) return;
+
   m_text = text;
+  setNeedsDisplay();
 }
 
 void MainViewController::setMenuItems(std::vector<std::unique_ptr<IMenuItem>> &menuItems) {
@@ -24,6 +31,7 @@ void MainViewController::setMenuItems(std::vector<std::unique_ptr<IMenuItem>> &m
     menuItems.push_back(makeCloseMenuMenuItem());
   }
   getMenuViewController().setMenuItems(menuItems);
+  setNeedsDisplay();
 }
 
 void MainViewController::presentMenu() {
@@ -33,6 +41,7 @@ void MainViewController::presentMenu() {
   if (hasAnyMenuItems()) {
     m_isPresentingMenu = true;
     m_lastMenuInteractionTime = millis();
+    setNeedsDisplay();
   } else {
     dismissMenu();
   }
@@ -40,6 +49,7 @@ void MainViewController::presentMenu() {
 
 void MainViewController::dismissMenu() {
   m_isPresentingMenu = false;
+  setNeedsDisplay();
 }
 
 arduino::String MainViewController::getLine1() {
@@ -71,6 +81,8 @@ void MainViewController::onButtonPushed(Button_t button) {
   if (m_isPresentingMenu) {
     getMenuViewController().onButtonPushed(button);
     m_lastMenuInteractionTime = millis();
+    // The selected menu-item changed.
+    setNeedsDisplay();
   } else {
     if (button == btnUP || button == btnDOWN) {
       presentMenu();
@@ -109,4 +121,6 @@ MenuViewController *MainViewController::makeMenuViewController() {
 std::unique_ptr<MainViewController::CloseMenuMenuItem> MainViewController::makeCloseMenuMenuItem() {
   std::unique_ptr<CloseMenuMenuItem> menuItemPtr(new CloseMenuMenuItem{ this });
   return menuItemPtr;
-}
\ No newline at end of file
+}
+
+#endif /* HEADLESS */
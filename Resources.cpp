@@ -1,4 +1,8 @@
 #include <Arduino.h>
+#include "Globals.hpp"
+
+#ifndef HEADLESS
+
 #include <LCDKeypadShieldLib.h>
 #include "Resources.h"
 #include "constants.h"
@@ -25,7 +29,10 @@ Resources::Resources()
   this->closeMenuAction = "***Close menu***";
   this->executeAction = "SELECT to exec.";
   this->rejectConnection = ">Reject conn.";
+  this->calibrateOutput = ">Calibrate out.";
+  this->showFaults = ">Show faults";
   this->errorCodeLabelPrefix = "Error: ";
+  this->noFaults = "No faults";
 }
 
 arduino::String Resources::getStateLabel_init() {
@@ -42,3 +49,5 @@ arduino::String Resources::getStateLabel_connected(bool isSynced) {
   string += ")";
   return string;
 }
+
+#endif /* HEADLESS */
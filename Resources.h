@@ -15,8 +15,14 @@ public:
   arduino::String executeAction;
   // ">Reject conn."
   arduino::String rejectConnection;
+  // ">Calibrate out."
+  arduino::String calibrateOutput;
+  // ">Show faults"
+  arduino::String showFaults;
   // "Error: "
   arduino::String errorCodeLabelPrefix;
+  // "No faults"
+  arduino::String noFaults;
 
   static Resources *shared;
 
@@ -5,16 +5,37 @@
 # would be read from the project's `sketch.json`-file.
 BOARD="arduino:samd:nano_33_iot"
 PORT="$(cat arduino-cli-w.tmp 2>/dev/null)"
+# Build profile (s. `sketch.yaml`): "default" or "headless" (optional).
+PROFILE="${PROFILE:-}"
 
 # Strict mode.
 set -euo pipefail
 
 print_help() {
-    echo "usage: arduino-cli-w.sh <command>"
+    echo "usage: [PROFILE=<profile>] arduino-cli-w.sh <command>"
     echo ""
     echo "Available Commands:"
     echo "  run\t\tCompiles & Uploads program in working-directory to board."
     echo "  monitor\tOpens a communication port with a board."
+    echo "  size\t\tCompiles program in working-directory and reports its memory usage (s. memory-report.sh)."
+    echo "  compare\tCompiles both profiles and reports the memory usage of 'headless' relative to 'default'."
+}
+
+# Compiles the sketch (with the build profile `$1`, if any) into the build path `$2` (if any).
+compile() {
+  local args=()
+  if [[ -n "$1" ]]; then
+    args+=(--profile "$1")
+    # Profiles cannot pass build flags (s. `sketch.yaml`).
+    if [[ "$1" == "headless" ]]; then
+      args+=(--build-property "compiler.cpp.extra_flags=-DHEADLESS")
+    fi
+  fi
+  if [[ -n "${2:-}" ]]; then
+    args+=(--build-path "$2")
+  fi
+
+  arduino-cli compile ${args[@]+"${args[@]}"}
 }
 
 query_port() {
@@ -35,6 +56,36 @@ if [[ $# -lt 1 ]]; then
 fi
 operand=$1; shift
 
+# Do not need a board.
+if [[ "$operand" == "size" ]]; then
+  build_path="$(pwd)/build${PROFILE:+/$PROFILE}"
+  compile "$PROFILE" "$build_path"
+
+  # Each profile has its own baseline.
+  baseline="memory-baseline${PROFILE:+-$PROFILE}.tsv"
+  if [[ "$PROFILE" == "default" ]]; then
+    baseline="memory-baseline.tsv"
+  fi
+
+  # The map is written by the platform (`{build.path}/{build.project_name}.map`).
+  ./memory-report.sh "$@" "$build_path/$(basename "$(pwd)").ino.map" "$baseline"
+  exit
+fi
+
+if [[ "$operand" == "compare" ]]; then
+  map_name="$(basename "$(pwd)").ino.map"
+  for profile in default headless; do
+    compile "$profile" "$(pwd)/build/$profile"
+  done
+
+  # The report of the default profile as the baseline: Δ is headless - default.
+  baseline="build/memory-report-default.tsv"
+  rm -f "$baseline"
+  ./memory-report.sh "build/default/$map_name" "$baseline" >/dev/null
+  MEMORY_REPORT_TOLERANCE=2147483647 ./memory-report.sh "build/headless/$map_name" "$baseline"
+  exit
+fi
+
 if [[ -z "$PORT" ]]; then
   echo "PORT ($PORT) is empty or device is non-existant. Will search for a port for BOARD ($BOARD)."
   read -p "Press ENTER to continue..."
@@ -63,7 +114,7 @@ fi
 
 case "$operand" in
   run)
-    arduino-cli compile
+    compile "$PROFILE"
     echo "Compilation succeeded. Will upload to board at PORT: $PORT"
     arduino-cli upload -p "$PORT"
 
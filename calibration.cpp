@@ -0,0 +1,123 @@
+#include <Arduino.h>
+#include "calibration.h"
+#include "constants.h"
+#include "Globals.hpp"
+#include "Logger.hpp"
+#include "faultLog.h"
+#include "scheduler.h"
+#include "rtc.hpp"
+
+// Delay of a test pulse after arming its timer.
+#define CALIBRATION_PULSE_DELAY 20UL  // in ms
+// Interval of the test pulses (each pulse lasts for the pulse width of the default channel).
+#define CALIBRATION_PULSE_INTERVAL 250UL  // in ms
+
+static bool isActive = false;
+static uint8_t captureChannel = 0;
+
+static int pulsesCount = 0;
+/// Local time (unsynced) of the pending test pulse.
+static unsigned long pulseTargetTime = 0;
+static bool isPulseCaptured = true;
+
+static long latencies[CALIBRATION_PULSES_COUNT];
+static unsigned int latenciesCount = 0;
+
+static CalibrationResult result = { false, 0, 0, 0, 0 };
+
+static void finishCalibration(void) {
+  isActive = false;
+
+  // Sort (insertion sort: a few samples only)
+  for (unsigned int i = 1; i < latenciesCount; i++) {
+    long latency = latencies[i];
+    int j = i - 1;
+    for (; j >= 0 && latencies[j] > latency; j--) {
+      latencies[j + 1] = latencies[j];
+    }
+    latencies[j + 1] = latency;
+  }
+
+  result.samplesCount = latenciesCount;
+  result.isValid = latenciesCount > CALIBRATION_PULSES_COUNT / 2;
+  result.median = latenciesCount > 0 ? latencies[latenciesCount / 2] : 0;
+  result.minimum = latenciesCount > 0 ? latencies[0] : 0;
+  result.maximum = latenciesCount > 0 ? latencies[latenciesCount - 1] : 0;
+
+  Log.printTimestamp();
+  if (!result.isValid) {
+    Log.print("WARNING: Calibration failed! Is the output wired to the capture pin? (captured: ");
+    Log.print(latenciesCount);
+    Log.print("/");
+    Log.print(CALIBRATION_PULSES_COUNT);
+    Log.println(")");
+    reportFault(FAULT_DOMAIN_CAPTURE, FAULT_CODE_CALIBRATION_FAILED, latenciesCount, CALIBRATION_PULSES_COUNT);
+    return;
+  }
+
+  Log.print("Calibration finished: output latency (median): ");
+  Log.print(result.median);
+  Log.print(" us (min: ");
+  Log.print(result.minimum);
+  Log.print(" us, max: ");
+  Log.print(result.maximum);
+  Log.print(" us, samples: ");
+  Log.print(latenciesCount);
+  Log.println(")");
+
+  setOutputLatencyCompensation(result.median);
+}
+
+void startCalibration(uint8_t channel) {
+  Log.printTimestamp();
+  Log.println("Starting calibration of the output latency...");
+
+  isActive = true;
+  captureChannel = channel;
+  pulsesCount = 0;
+  latenciesCount = 0;
+  isPulseCaptured = true;
+  pulseTargetTime = millisRtc(false);
+
+  // Measure the raw latency.
+  setOutputLatencyCompensation(0);
+}
+
+bool isCalibrating(void) {
+  return isActive;
+}
+
+void onCalibrationEdge(const CaptureEvent &event) {
+  if (!isActive || event.channel != captureChannel || !event.isRisingEdge || isPulseCaptured) return;
+
+  isPulseCaptured = true;
+  if (latenciesCount < CALIBRATION_PULSES_COUNT) {
+    // (Not `microsAtMillisRtc()`: The edge is dispatched by the loop, up to some ms later.)
+    latencies[latenciesCount++] = (long)(event.time - lastCalibrationTimerDueMicros());
+  }
+}
+
+bool updateCalibration(void) {
+  if (!isActive) return false;
+
+  unsigned long localTime = millisRtc(false);
+  // The pending test pulse is due in the future (`CALIBRATION_PULSE_DELAY`) right after arming.
+  if ((long)(localTime - pulseTargetTime) < (long)CALIBRATION_PULSE_INTERVAL) return false;
+
+  if (pulsesCount >= CALIBRATION_PULSES_COUNT) {
+    finishCalibration();
+    return true;
+  }
+
+  // Next test pulse
+  pulseTargetTime = localTime + CALIBRATION_PULSE_DELAY;
+  isPulseCaptured = false;
+  armTimer(pulseTargetTime, SCHEDULER_DEFAULT_CHANNEL, timerSourceCALIBRATION);
+  pulsesCount++;
+
+  return false;
+}
+
+CalibrationResult calibrationResult(void) {
+  return result;
+}
@@ -0,0 +1,43 @@
+/*
+  Output-Calibration
+
+  Measures the latency of the output path: From a timer's target time (the SQW tick
+  at which it became due) to the physical edge on the output pin. For the calibration, the output pin has to be
+  wired back to an input-capture pin (s. capture.h). The median latency of a
+  series of test pulses is applied as compensation to every timer (s. scheduler.h).
+*/
+
+#ifndef calibration_h
+#define calibration_h
+
+#include <stdint.h>
+#include "capture.h"
+
+// Number of test pulses of a calibration.
+#define CALIBRATION_PULSES_COUNT 15
+
+struct CalibrationResult {
+  /// `true`, if (the majority of) the test pulses have been captured.
+  bool isValid;
+  /// Number of captured test pulses.
+  unsigned int samplesCount;
+  /// Latencies (in µs) of the captured test pulses.
+  long median;
+  long minimum;
+  long maximum;
+};
+
+/// Starts a calibration, capturing the test pulses on capture channel `channel`.
+void startCalibration(uint8_t channel);
+bool isCalibrating(void);
+/// Handles an edge captured while calibrating.
+void onCalibrationEdge(const CaptureEvent &event);
+/// Fires the test pulses (while calibrating).
+///
+/// Returns `true`, when a calibration has finished.
+bool updateCalibration(void);
+
+/// The result of the last finished calibration.
+CalibrationResult calibrationResult(void);
+
+#endif /* calibration_h */
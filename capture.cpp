@@ -0,0 +1,98 @@
+#include <Arduino.h>
+#include "capture.h"
+#include "Globals.hpp"
+#include "Logger.hpp"
+#include "faultLog.h"
+#include "rtc.hpp"
+#include "trace.h"
+#include "recorder.h"
+
+struct CapturedEdge {
+  uint8_t channel;
+  bool isRisingEdge;
+  /// Time (in µs, `micros()`) of the interrupt.
+  unsigned long time;
+};
+
+static int capturePins[CAPTURE_MAX_CHANNELS];
+
+// Written by the interrupts (head) and the event-loop (tail).
+static volatile CapturedEdge queue[CAPTURE_QUEUE_SIZE];
+static volatile uint8_t queueHead = 0;
+static volatile uint8_t queueTail = 0;
+static volatile unsigned int droppedCount = 0;
+
+// Interrupt callback (ISR)
+template <uint8_t channel>
+static void onEdge(void) {
+  TRACE_SCOPE(TRACE_POINT_ISR_CAPTURE);
+  unsigned long time = micros();
+  bool isRisingEdge = digitalRead(capturePins[channel]) == HIGH;
+  recordInputEdge(capturePins[channel], isRisingEdge);
+
+  uint8_t next = (queueHead + 1) % CAPTURE_QUEUE_SIZE;
+  if (next == queueTail) {
+    droppedCount++;
+    return;
+  }
+
+  queue[queueHead].channel = channel;
+  queue[queueHead].isRisingEdge = isRisingEdge;
+  queue[queueHead].time = time;
+  queueHead = next;
+}
+
+static void (*const edgeCallbacks[CAPTURE_MAX_CHANNELS])(void) = {
+  onEdge<0>,
+  onEdge<1>,
+};
+
+void setupCapture(const int pins[], int count) {
+  for (int i = 0; i < min(count, CAPTURE_MAX_CHANNELS); i++) {
+    capturePins[i] = pins[i];
+
+    pinMode(pins[i], INPUT_PULLDOWN);
+    attachInterrupt(digitalPinToInterrupt(pins[i]), edgeCallbacks[i], CHANGE);
+  }
+}
+
+bool isAnyCaptureEventQueued(void) {
+  return queueTail != queueHead;
+}
+
+bool popCaptureEvent(CaptureEvent *event) {
+  if (!isAnyCaptureEventQueued()) return false;
+
+  CapturedEdge edge;
+  noInterrupts();
+  edge.channel = queue[queueTail].channel;
+  edge.isRisingEdge = queue[queueTail].isRisingEdge;
+  edge.time = queue[queueTail].time;
+  queueTail = (queueTail + 1) % CAPTURE_QUEUE_SIZE;
+  interrupts();
+
+  // Age of the edge
+  unsigned long elapsed = micros() - edge.time;
+
+  event->channel = edge.channel;
+  event->isRisingEdge = edge.isRisingEdge;
+  event->localTime = millisRtc(false) - elapsed / 1000UL;
+  event->time = edge.time;
+  return true;
+}
+
+unsigned int takeDroppedCaptureEventsCount(void) {
+  noInterrupts();
+  unsigned int count = droppedCount;
+  droppedCount = 0;
+  interrupts();
+
+  if (count > 0) {
+    Log.printTimestamp();
+    Log.print("WARNING: Capture-Queue is full! Dropped edges: ");
+    Log.println(count);
+    reportFault(FAULT_DOMAIN_CAPTURE, FAULT_CODE_CAPTURE_QUEUE_FULL, count);
+  }
+
+  return count;
+}
@@ -0,0 +1,39 @@
+/*
+  Input-Capture
+
+  Edges on the capture pins are timestamped in their interrupt (EIC), rather
+  than by polling the pins in the event-loop. The edges are queued until they
+  are processed by the event-loop.
+*/
+
+#ifndef capture_h
+#define capture_h
+
+#include <stdint.h>
+
+// Maximum number of capture pins.
+#define CAPTURE_MAX_CHANNELS 2
+// Maximum number of queued edges.
+#define CAPTURE_QUEUE_SIZE 16
+
+struct CaptureEvent {
+  /// Index of the pin (as passed to `setupCapture()`).
+  uint8_t channel;
+  bool isRisingEdge;
+  /// Local time (unsynced: `millisRtc()`) of the edge.
+  unsigned long localTime;
+  /// Time (in µs, `micros()`) of the edge.
+  unsigned long time;
+};
+
+/// Attaches the interrupts of (up to `CAPTURE_MAX_CHANNELS`) interrupt-capable pins.
+void setupCapture(const int pins[], int count);
+
+/// `true`, if any edge is queued.
+bool isAnyCaptureEventQueued(void);
+/// Pops the oldest queued edge. Returns `false`, if no edge is queued.
+bool popCaptureEvent(CaptureEvent *event);
+/// Returns the number of edges dropped (due to a full queue) since the last call.
+unsigned int takeDroppedCaptureEventsCount(void);
+
+#endif /* capture_h */
@@ -0,0 +1,226 @@
+#include <Arduino.h>
+#include "config.h"
+#include "constants.h"
+#include "Globals.hpp"
+#include "Logger.hpp"
+#include "faultLog.h"
+#include "flashStorage.h"
+#include "recorder.h"
+#include "serialFrame.h"
+
+// Marks a configuration persisted to the flash ("CONF").
+#define STORED_MAGIC 0x464e4f43
+// Marks the configuration key persisted to the flash ("CKEY").
+#define STORED_KEY_MAGIC 0x59454b43
+
+/// Precedes the encoded configuration (s. `encodeConfig()`) in the flash.
+struct __attribute__((packed)) StoredConfigHeader {
+  uint32_t magic;
+  uint8_t length;
+  /// CRC-16 (s. serialFrame.h) of the encoded configuration.
+  uint16_t crc;
+};
+
+/// The key authenticating the writes of the Centrals, as persisted to the flash.
+struct __attribute__((packed)) StoredConfigKey {
+  uint32_t magic;
+  bool isProvisioned;
+  uint8_t key[CONFIG_KEY_SIZE];
+  /// Sequence number of the last authenticated write.
+  uint32_t sequenceNumber;
+  /// CRC-16 (s. serialFrame.h) of the preceding bytes.
+  uint16_t crc;
+};
+
+static_assert(sizeof(StoredConfigKey) <= FLASH_STORAGE_CONFIG_KEY_SIZE, "The key exceeds its region of the flash storage");
+
+static const Config DEFAULT_CONFIG = {
+  SIGNAL_HIGH_INTERVAL_DEFAULT,
+  MAX_TIMER_DELAY_DEFAULT,
+  SYNC_INTERVAL_DEFAULT,
+  TRAINING_MSGS_COUNT_DEFAULT,
+  CONNECTION_INTERVAL_FAST_DEFAULT,
+  CONNECTION_INTERVAL_IDLE_DEFAULT,
+  SYNC_ACCURACY_BUDGET,
+};
+
+static Config config = DEFAULT_CONFIG;
+static uint8_t lastStatus = CONFIG_STATUS_OK;
+static ConfigChangeHandler changeHandler = nullptr;
+/// `true`, if the configuration has been written since it has been persisted.
+static bool isPersistPending = false;
+
+static StoredConfigKey storedKey;
+/// `true`, if the key (or its sequence number) has changed since it has been persisted.
+static bool isKeyPersistPending = false;
+
+static void logConfig(void) {
+  for (int i = 0; i < CONFIG_PARAMETERS_COUNT; i++) {
+    Log.print(i == 0 ? " (" : ", ");
+    Log.print(CONFIG_PARAMETERS[i].name);
+    Log.print("=");
+    Log.print(getConfigValue(config, CONFIG_PARAMETERS[i].tag));
+  }
+  Log.println(")");
+}
+
+/// Restores the configuration persisted to the flash. Returns `false`, if none is valid.
+static bool restoreConfig(void) {
+  const uint8_t *stored = flashStorage() + FLASH_STORAGE_CONFIG_OFFSET;
+
+  StoredConfigHeader header;
+  memcpy(&header, stored, sizeof(header));
+  if (header.magic != STORED_MAGIC) return false;
+
+  const uint8_t *data = stored + sizeof(header);
+  if (header.length > CONFIG_MAX_LENGTH || crc16(data, header.length) != header.crc) {
+    Log.printTimestamp();
+    Log.println("WARNING: Persisted configuration is corrupted! Will use the defaults.");
+    reportFault(FAULT_DOMAIN_CONFIG, FAULT_CODE_CONFIG_INVALID);
+    return false;
+  }
+
+  // Validated like a write: Values out of the ranges of this sketch are rejected.
+  uint8_t status = parseConfig(data, header.length, config);
+  if (status != CONFIG_STATUS_OK) {
+    Log.printTimestamp();
+    Log.print("WARNING: Persisted configuration is invalid (");
+    Log.print(getConfigStatusName(status));
+    Log.println(")! Will use the defaults.");
+    reportFault(FAULT_DOMAIN_CONFIG, FAULT_CODE_CONFIG_INVALID, status);
+    return false;
+  }
+
+  return true;
+}
+
+/// Restores the key persisted to the flash (none, if it is not valid).
+static void restoreConfigKey(void) {
+  memcpy(&storedKey, flashStorage() + FLASH_STORAGE_CONFIG_KEY_OFFSET, sizeof(storedKey));
+  bool isValid = storedKey.magic == STORED_KEY_MAGIC
+    && crc16((const uint8_t *)&storedKey, offsetof(StoredConfigKey, crc)) == storedKey.crc;
+  if (!isValid) {
+    memset(&storedKey, 0, sizeof(storedKey));
+    storedKey.magic = STORED_KEY_MAGIC;
+  }
+
+  if (!storedKey.isProvisioned) {
+    Log.printTimestamp();
+    Log.println("No configuration key is provisioned: The Centrals may read the configuration only.");
+  }
+}
+
+static void persistConfigKeyIfNeeded(void) {
+  if (!isKeyPersistPending) return;
+  isKeyPersistPending = false;
+
+  storedKey.crc = crc16((const uint8_t *)&storedKey, offsetof(StoredConfigKey, crc));
+  writeFlashStorage(FLASH_STORAGE_CONFIG_KEY_OFFSET, &storedKey, sizeof(storedKey));
+
+  Log.printTimestamp();
+  Log.println("Configuration key persisted.");
+}
+
+// MARK: - Public
+
+void setupConfig(ConfigChangeHandler handler) {
+  changeHandler = handler;
+
+  config = DEFAULT_CONFIG;
+  bool isRestored = restoreConfig();
+  if (!isRestored) config = DEFAULT_CONFIG;
+
+  Log.printTimestamp();
+  Log.print(isRestored ? "Restored configuration" : "Default configuration");
+  logConfig();
+  restoreConfigKey();
+
+  if (changeHandler) changeHandler(config);
+}
+
+const Config &currentConfig(void) {
+  return config;
+}
+
+uint8_t applyConfig(const uint8_t *data, size_t length) {
+  lastStatus = parseConfig(data, length, config);
+
+  Log.printTimestamp();
+  if (lastStatus != CONFIG_STATUS_OK) {
+    Log.print("WARNING: Configuration rejected (");
+    Log.print(getConfigStatusName(lastStatus));
+    Log.println(")!");
+    reportFault(FAULT_DOMAIN_CONFIG, FAULT_CODE_CONFIG_REJECTED, lastStatus);
+    return lastStatus;
+  }
+
+  Log.print("Configuration applied");
+  logConfig();
+
+  isPersistPending = true;
+  recordConfig(config);
+  if (changeHandler) changeHandler(config);
+
+  return lastStatus;
+}
+
+uint8_t applyAuthenticatedConfig(const uint8_t *data, size_t length) {
+  uint32_t sequenceNumber = 0;
+  size_t configLength = storedKey.isProvisioned ? verifyConfigAuthentication(data, length, storedKey.key, &sequenceNumber) : 0;
+  // (Sequence numbers only increase: A replay of an earlier write is rejected.)
+  if (configLength == 0 || sequenceNumber <= storedKey.sequenceNumber) {
+    lastStatus = CONFIG_STATUS_UNAUTHENTICATED;
+
+    Log.printTimestamp();
+    Log.println(storedKey.isProvisioned ? "WARNING: Configuration rejected (unauthenticated)!" : "WARNING: Configuration rejected (no key is provisioned)!");
+    reportFault(FAULT_DOMAIN_CONFIG, FAULT_CODE_CONFIG_REJECTED, lastStatus);
+    return lastStatus;
+  }
+
+  // Consumed, even if the entries are rejected.
+  storedKey.sequenceNumber = sequenceNumber;
+  isKeyPersistPending = true;
+
+  return applyConfig(data, configLength);
+}
+
+void provisionConfigKey(const uint8_t *key) {
+  storedKey.isProvisioned = key != nullptr;
+  if (key) {
+    memcpy(storedKey.key, key, sizeof(storedKey.key));
+  } else {
+    memset(storedKey.key, 0, sizeof(storedKey.key));
+  }
+  storedKey.sequenceNumber = 0;
+  isKeyPersistPending = true;
+
+  Log.printTimestamp();
+  Log.println(key ? "Configuration key provisioned." : "Configuration key revoked.");
+}
+
+size_t configReport(uint8_t *data) {
+  return encodeConfigReport(config, lastStatus, data);
+}
+
+void persistConfigIfNeeded(void) {
+  persistConfigKeyIfNeeded();
+
+  if (!isPersistPending) return;
+  isPersistPending = false;
+
+  uint8_t stored[sizeof(StoredConfigHeader) + CONFIG_MAX_LENGTH];
+  StoredConfigHeader header;
+  header.magic = STORED_MAGIC;
+  header.length = encodeConfig(config, stored + sizeof(header));
+  header.crc = crc16(stored + sizeof(header), header.length);
+  memcpy(stored, &header, sizeof(header));
+
+  size_t length = sizeof(header) + header.length;
+  // Spares the flash (its endurance) rewriting the configuration persisted already.
+  if (memcmp(flashStorage() + FLASH_STORAGE_CONFIG_OFFSET, stored, length) == 0) return;
+
+  writeFlashStorage(FLASH_STORAGE_CONFIG_OFFSET, stored, length);
+
+  Log.printTimestamp();
+  Log.println("Configuration persisted.");
+}
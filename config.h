@@ -0,0 +1,57 @@
+/*
+  Configuration
+
+  Parameters applied at runtime (s. configFormat.h for the parameters and their
+  format): The width of the pulses of channel 0, the maximum delay of a timer, the
+  maximum interval between syncs, the number of Reference-Timestamps of a Training and
+  the Connection-Intervals requested. Written via the Serial-Protocol
+  (`SERIAL_MSG_CONFIGURE`) or by the Centrals, validated, applied (s.
+  `ConfigChangeHandler`) and persisted to the flash (s. flashStorage.h), from where they
+  are restored at startup. Until then, the defaults of constants.h apply.
+
+  The writes of the Centrals are authenticated by the configuration key (s.
+  configFormat.h), which is provisioned by USB only and persisted along with the
+  sequence number of the last authenticated write: Without a key, the Centrals may read
+  the configuration only.
+
+  Persisting is deferred until no timer is armed (s. `persistConfigIfNeeded()`): Writing
+  the flash stalls the CPU.
+*/
+
+#ifndef config_h
+#define config_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include "configFormat.h"
+
+/// Applies `config` to the modules (called by `setupConfig()` and every change).
+typedef void (*ConfigChangeHandler)(const Config &config);
+
+/// Restores the configuration persisted to the flash (the defaults, if none is valid)
+/// and applies it.
+void setupConfig(ConfigChangeHandler handler);
+
+/// The effective configuration.
+const Config &currentConfig(void);
+
+/// Validates the entries of the `length` bytes of `data` and applies them (s.
+/// `parseConfig()`). Returns the status (s. `ConfigStatus`), which is reported as well.
+uint8_t applyConfig(const uint8_t *data, size_t length);
+/// Verifies the authentication of the `length` bytes of `data` (written by a Central, s.
+/// configFormat.h) and applies its entries like `applyConfig()`. Returns the status
+/// (`CONFIG_STATUS_UNAUTHENTICATED`, if the authentication is invalid or no key is provisioned).
+uint8_t applyAuthenticatedConfig(const uint8_t *data, size_t length);
+/// Provisions the key authenticating the writes of the Centrals (revokes it, if `key` is
+/// `nullptr`): The sequence numbers start over.
+void provisionConfigKey(const uint8_t *key);
+
+/// Encodes the effective configuration and the status of the last write (at most
+/// `CONFIG_MAX_LENGTH` bytes). Returns the length.
+size_t configReport(uint8_t *data);
+
+/// Persists the configuration and its key, if changed: Called by the loop, while no
+/// timer is armed.
+void persistConfigIfNeeded(void);
+
+#endif /* config_h */
@@ -0,0 +1,182 @@
+#include <string.h>
+#include "configFormat.h"
+#include "siphash.h"
+
+// Size of the version preceding the entries, and of the tag and the length of an entry.
+#define VERSION_SIZE 1
+#define ENTRY_HEADER_SIZE 2
+
+const ConfigParameter CONFIG_PARAMETERS[] = {
+  // The pulses must end before the next test pulse of the calibration (s. calibration.cpp).
+  { CONFIG_TAG_SIGNAL_HIGH_INTERVAL, sizeof(uint16_t), 1, 200, "signal-high-interval" },
+  { CONFIG_TAG_MAX_TIMER_DELAY, sizeof(uint16_t), 100, 10000, "max-timer-delay" },
+  { CONFIG_TAG_SYNC_INTERVAL, sizeof(uint32_t), 60000, 3600000, "sync-interval" },
+  { CONFIG_TAG_TRAINING_MSGS_COUNT, sizeof(uint8_t), 2, CONFIG_TRAINING_MSGS_COUNT_MAX, "training-msgs-count" },
+  // 7.5 ms - 320 ms: The Supervision-Timeout (4 s) must exceed the idle interval with its
+  // Slave-Latency (s. constants.h) twice.
+  { CONFIG_TAG_CONNECTION_INTERVAL_FAST, sizeof(uint16_t), 0x0006, 0x0100, "connection-interval-fast" },
+  { CONFIG_TAG_CONNECTION_INTERVAL_IDLE, sizeof(uint16_t), 0x0006, 0x0100, "connection-interval-idle" },
+  // 5 ms - 1 s (in µs)
+  { CONFIG_TAG_SYNC_ACCURACY_BUDGET, sizeof(uint32_t), 5000, 1000000, "sync-accuracy-budget" },
+};
+
+const int CONFIG_PARAMETERS_COUNT = sizeof(CONFIG_PARAMETERS) / sizeof(CONFIG_PARAMETERS[0]);
+
+const ConfigParameter *findConfigParameter(uint8_t tag) {
+  for (int i = 0; i < CONFIG_PARAMETERS_COUNT; i++) {
+    if (CONFIG_PARAMETERS[i].tag == tag) return &CONFIG_PARAMETERS[i];
+  }
+
+  return nullptr;
+}
+
+const ConfigParameter *findConfigParameter(const char *name) {
+  for (int i = 0; i < CONFIG_PARAMETERS_COUNT; i++) {
+    if (strcmp(CONFIG_PARAMETERS[i].name, name) == 0) return &CONFIG_PARAMETERS[i];
+  }
+
+  return nullptr;
+}
+
+uint32_t getConfigValue(const Config &config, uint8_t tag) {
+  switch (tag) {
+    case CONFIG_TAG_SIGNAL_HIGH_INTERVAL: return config.signalHighInterval;
+    case CONFIG_TAG_MAX_TIMER_DELAY: return config.maxTimerDelay;
+    case CONFIG_TAG_SYNC_INTERVAL: return config.syncInterval;
+    case CONFIG_TAG_TRAINING_MSGS_COUNT: return config.trainingMsgsCount;
+    case CONFIG_TAG_CONNECTION_INTERVAL_FAST: return config.connectionIntervalFast;
+    case CONFIG_TAG_CONNECTION_INTERVAL_IDLE: return config.connectionIntervalIdle;
+    case CONFIG_TAG_SYNC_ACCURACY_BUDGET: return config.syncAccuracyBudget;
+  }
+  return 0;
+}
+
+void setConfigValue(Config &config, uint8_t tag, uint32_t value) {
+  switch (tag) {
+    case CONFIG_TAG_SIGNAL_HIGH_INTERVAL: config.signalHighInterval = value; break;
+    case CONFIG_TAG_MAX_TIMER_DELAY: config.maxTimerDelay = value; break;
+    case CONFIG_TAG_SYNC_INTERVAL: config.syncInterval = value; break;
+    case CONFIG_TAG_TRAINING_MSGS_COUNT: config.trainingMsgsCount = value; break;
+    case CONFIG_TAG_CONNECTION_INTERVAL_FAST: config.connectionIntervalFast = value; break;
+    case CONFIG_TAG_CONNECTION_INTERVAL_IDLE: config.connectionIntervalIdle = value; break;
+    case CONFIG_TAG_SYNC_ACCURACY_BUDGET: config.syncAccuracyBudget = value; break;
+  }
+}
+
+static uint32_t readValue(const uint8_t *data, uint8_t size) {
+  uint32_t value = 0;
+  for (int i = size - 1; i >= 0; i--) {
+    value = (value << 8) | data[i];
+  }
+  return value;
+}
+
+uint8_t parseConfig(const uint8_t *data, size_t length, Config &config, uint8_t *status) {
+  if (length < VERSION_SIZE || data[0] != CONFIG_FORMAT_VERSION) return CONFIG_STATUS_UNSUPPORTED_VERSION;
+
+  // Applied to a copy: Any invalid entry rejects the others.
+  Config parsed = config;
+
+  size_t index = VERSION_SIZE;
+  while (index < length) {
+    if (length - index < ENTRY_HEADER_SIZE) return CONFIG_STATUS_MALFORMED;
+
+    uint8_t tag = data[index];
+    uint8_t size = data[index + 1];
+    const uint8_t *value = &data[index + ENTRY_HEADER_SIZE];
+    index += ENTRY_HEADER_SIZE;
+    if (length - index < size) return CONFIG_STATUS_MALFORMED;
+    index += size;
+
+    if (tag == CONFIG_TAG_STATUS) {
+      if (size != sizeof(uint8_t)) return CONFIG_STATUS_MALFORMED;
+      if (status) *status = value[0];
+      continue;
+    }
+
+    const ConfigParameter *parameter = findConfigParameter(tag);
+    if (!parameter) return CONFIG_STATUS_UNKNOWN_TAG;
+    if (size != parameter->size) return CONFIG_STATUS_MALFORMED;
+
+    uint32_t parameterValue = readValue(value, size);
+    if (parameterValue < parameter->minimum || parameterValue > parameter->maximum) return CONFIG_STATUS_OUT_OF_RANGE;
+
+    setConfigValue(parsed, tag, parameterValue);
+  }
+
+  if (parsed.connectionIntervalFast > parsed.connectionIntervalIdle) return CONFIG_STATUS_OUT_OF_RANGE;
+  // Otherwise, every Training would request the next one (s. `CONFIG_TAG_SYNC_ACCURACY_BUDGET`).
+  if (parsed.syncAccuracyBudget <= parsed.connectionIntervalFast * 1250UL / 2 + 2000) return CONFIG_STATUS_OUT_OF_RANGE;
+
+  config = parsed;
+  return CONFIG_STATUS_OK;
+}
+
+size_t encodeConfigEntry(uint8_t tag, uint32_t value, uint8_t *data) {
+  const ConfigParameter *parameter = findConfigParameter(tag);
+  uint8_t size = parameter ? parameter->size : sizeof(uint8_t);
+
+  data[0] = tag;
+  data[1] = size;
+  for (int i = 0; i < size; i++) {
+    data[ENTRY_HEADER_SIZE + i] = (value >> (8 * i)) & 0xff;
+  }
+
+  return ENTRY_HEADER_SIZE + size;
+}
+
+size_t encodeConfig(const Config &config, uint8_t *data) {
+  size_t length = 0;
+  data[length++] = CONFIG_FORMAT_VERSION;
+
+  for (int i = 0; i < CONFIG_PARAMETERS_COUNT; i++) {
+    uint8_t tag = CONFIG_PARAMETERS[i].tag;
+    length += encodeConfigEntry(tag, getConfigValue(config, tag), &data[length]);
+  }
+
+  return length;
+}
+
+size_t encodeConfigReport(const Config &config, uint8_t status, uint8_t *data) {
+  size_t length = encodeConfig(config, data);
+  length += encodeConfigEntry(CONFIG_TAG_STATUS, status, &data[length]);
+  return length;
+}
+
+size_t authenticateConfig(uint8_t *data, size_t length, uint32_t sequenceNumber, const uint8_t key[CONFIG_KEY_SIZE]) {
+  for (int i = 0; i < 4; i++) {
+    data[length++] = (sequenceNumber >> (8 * i)) & 0xff;
+  }
+
+  uint64_t mac = siphash24(data, length, key);
+  for (int i = 0; i < 8; i++) {
+    data[length++] = (mac >> (8 * i)) & 0xff;
+  }
+  return length;
+}
+
+size_t verifyConfigAuthentication(const uint8_t *data, size_t length, const uint8_t key[CONFIG_KEY_SIZE], uint32_t *sequenceNumber) {
+  if (length < VERSION_SIZE + CONFIG_AUTHENTICATION_SIZE) return 0;
+
+  size_t macOffset = length - 8;
+  uint64_t mac = 0;
+  for (int i = 7; i >= 0; i--) {
+    mac = (mac << 8) | data[macOffset + i];
+  }
+  if (mac != siphash24(data, macOffset, key)) return 0;
+
+  *sequenceNumber = readValue(&data[macOffset - 4], sizeof(uint32_t));
+  return length - CONFIG_AUTHENTICATION_SIZE;
+}
+
+const char *getConfigStatusName(uint8_t status) {
+  switch (status) {
+    case CONFIG_STATUS_OK: return "ok";
+    case CONFIG_STATUS_UNSUPPORTED_VERSION: return "unsupported version";
+    case CONFIG_STATUS_MALFORMED: return "malformed";
+    case CONFIG_STATUS_UNKNOWN_TAG: return "unknown tag";
+    case CONFIG_STATUS_OUT_OF_RANGE: return "out of range";
+    case CONFIG_STATUS_UNAUTHENTICATED: return "unauthenticated";
+  }
+  return "unknown";
+}
@@ -0,0 +1,139 @@
+/*
+  Configuration-Format
+
+  Format of the configuration applied at runtime (s. config.h): A version, followed by
+  entries of a tag, the length of the value and the value (TLV, little-endian):
+
+    uint8_t version | uint8_t tag, uint8_t length, value | ...
+
+  A write holds the entries of the parameters to change only. It is validated as a
+  whole: An unsupported version, an unknown tag, a length not matching the tag or a
+  value out of range rejects every entry. The effective configuration is reported with
+  every parameter and the status of the last write (`CONFIG_TAG_STATUS`).
+
+  A write via the `configuration`-Characteristic is authenticated: The encoded entries
+  are followed by a sequence number and a MAC keyed by the configuration key, which is
+  provisioned by USB (s. config.h):
+
+    uint8_t version | entries ... | uint32_t sequence number | uint64_t mac
+
+  The MAC is SipHash-2-4 (s. siphash.h) of the preceding bytes. The sequence number must
+  exceed the one of the last authenticated write (replays are rejected).
+
+  This header does not depend on the Arduino core: It is shared with the host tools
+  (s. `Host/`).
+*/
+
+#ifndef configFormat_h
+#define configFormat_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CONFIG_FORMAT_VERSION 1
+
+/// Maximum length of an encoded configuration (every parameter and the status).
+#define CONFIG_MAX_LENGTH 40
+
+/// Size of the authentication of a write via the `configuration`-Characteristic (the
+/// sequence number and the MAC), and the size of the configuration key.
+#define CONFIG_AUTHENTICATION_SIZE 12
+#define CONFIG_KEY_SIZE 16
+/// Maximum length of an authenticated write.
+#define CONFIG_MAX_AUTHENTICATED_LENGTH (CONFIG_MAX_LENGTH + CONFIG_AUTHENTICATION_SIZE)
+
+/// Maximum number of Reference-Timestamps of a Training: The capacity of the Training's
+/// buffers (s. training.h).
+#define CONFIG_TRAINING_MSGS_COUNT_MAX 8
+
+enum ConfigTag {
+  /// `uint16_t` width (in ms) of the pulses of channel 0 (and of the heartbeat).
+  CONFIG_TAG_SIGNAL_HIGH_INTERVAL = 0x01,
+  /// `uint16_t` maximum delay (in ms) of a timer: Timers due later fire immediately
+  /// (Broadcast-Advertisements due later are rejected).
+  CONFIG_TAG_MAX_TIMER_DELAY = 0x02,
+  /// `uint32_t` maximum interval (in ms) between syncs.
+  CONFIG_TAG_SYNC_INTERVAL = 0x03,
+  /// `uint8_t` number of Reference-Timestamps of a Training.
+  CONFIG_TAG_TRAINING_MSGS_COUNT = 0x04,
+  /// `uint16_t` Connection-Interval (in units of 1.25 ms) requested in the fast and in
+  /// the idle Connection-Mode (s. connection.h): The fast one must not exceed the idle one.
+  CONFIG_TAG_CONNECTION_INTERVAL_FAST = 0x05,
+  CONFIG_TAG_CONNECTION_INTERVAL_IDLE = 0x06,
+  /// `uint32_t` maximum predicted uncertainty (in µs) of a synced time before a re-sync is
+  /// needed (s. time.h): It must exceed the uncertainty of a Training in the fast
+  /// Connection-Mode (at least half the fast Connection-Interval and 2 ms).
+  CONFIG_TAG_SYNC_ACCURACY_BUDGET = 0x07,
+  /// `uint8_t` status of the last write (s. `ConfigStatus`): Reported only (ignored in writes).
+  CONFIG_TAG_STATUS = 0x7f,
+};
+
+enum ConfigStatus {
+  CONFIG_STATUS_OK = 0x00,
+  CONFIG_STATUS_UNSUPPORTED_VERSION = 0x01,
+  /// An entry is truncated, or its length does not match its tag.
+  CONFIG_STATUS_MALFORMED = 0x02,
+  CONFIG_STATUS_UNKNOWN_TAG = 0x03,
+  /// A value is out of range (or the Connection-Intervals and the accuracy budget are inconsistent).
+  CONFIG_STATUS_OUT_OF_RANGE = 0x04,
+  /// The MAC of an authenticated write is invalid, its sequence number has been used
+  /// already, or no configuration key is provisioned.
+  CONFIG_STATUS_UNAUTHENTICATED = 0x05,
+};
+
+struct Config {
+  uint16_t signalHighInterval;
+  uint16_t maxTimerDelay;
+  uint32_t syncInterval;
+  uint8_t trainingMsgsCount;
+  uint16_t connectionIntervalFast;
+  uint16_t connectionIntervalIdle;
+  uint32_t syncAccuracyBudget;
+};
+
+/// A parameter of the configuration: Its tag, the size of its value and its range.
+struct ConfigParameter {
+  uint8_t tag;
+  uint8_t size;
+  uint32_t minimum;
+  uint32_t maximum;
+  /// Name (as used by `signalboy-cli config`).
+  const char *name;
+};
+
+/// The parameters (in the order of their tags).
+extern const ConfigParameter CONFIG_PARAMETERS[];
+extern const int CONFIG_PARAMETERS_COUNT;
+
+/// The parameter of `tag` (`nullptr`, if unknown).
+const ConfigParameter *findConfigParameter(uint8_t tag);
+/// The parameter named `name` (`nullptr`, if unknown).
+const ConfigParameter *findConfigParameter(const char *name);
+
+uint32_t getConfigValue(const Config &config, uint8_t tag);
+void setConfigValue(Config &config, uint8_t tag, uint32_t value);
+
+/// Validates the `length` bytes of `data` and applies their entries to `config` (s.
+/// `ConfigStatus`): `config` is left unchanged, unless `CONFIG_STATUS_OK` is returned.
+/// `status` receives the value of `CONFIG_TAG_STATUS` (if any, i.e. of a report).
+uint8_t parseConfig(const uint8_t *data, size_t length, Config &config, uint8_t *status = nullptr);
+
+/// Encodes the entry of the parameter of `tag` (at most 6 bytes). Returns its length.
+size_t encodeConfigEntry(uint8_t tag, uint32_t value, uint8_t *data);
+/// Encodes every parameter of `config` (at most `CONFIG_MAX_LENGTH` bytes, the version
+/// included). Returns the length.
+size_t encodeConfig(const Config &config, uint8_t *data);
+/// Encodes every parameter of `config` and `status` (s. `CONFIG_TAG_STATUS`).
+size_t encodeConfigReport(const Config &config, uint8_t status, uint8_t *data);
+
+/// Appends the authentication (`sequenceNumber` and the MAC keyed by `key`) to the
+/// `length` bytes of an encoded configuration in `data`. Returns the length.
+size_t authenticateConfig(uint8_t *data, size_t length, uint32_t sequenceNumber, const uint8_t key[CONFIG_KEY_SIZE]);
+/// Verifies the MAC (keyed by `key`) of the `length` bytes of an authenticated write and
+/// reads its sequence number. Returns the length of the encoded configuration, or 0, if
+/// the MAC is invalid.
+size_t verifyConfigAuthentication(const uint8_t *data, size_t length, const uint8_t key[CONFIG_KEY_SIZE], uint32_t *sequenceNumber);
+
+const char *getConfigStatusName(uint8_t status);
+
+#endif /* configFormat_h */
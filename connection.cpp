@@ -0,0 +1,364 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+#include <utility/HCI.h>
+#include "connection.h"
+#include "constants.h"
+#include "Globals.hpp"
+#include "Logger.hpp"
+#include "faultLog.h"
+#include "HCITap.h"
+#include "ConnectionEventTracker.h"
+#include "rtc.hpp"
+
+#define EVT_DISCONN_COMPLETE 0x05
+#define EVT_LE_META_EVENT 0x3e
+
+#define LE_META_EVENT_CONN_COMPLETE 0x01
+#define LE_META_EVENT_CONN_UPDATE_COMPLETE 0x03
+#define LE_META_EVENT_ENHANCED_CONN_COMPLETE 0x0a
+
+#define HCI_ROLE_SLAVE 0x01
+
+#define SIGNALING_CID 0x0005
+#define CONNECTION_PARAMETER_UPDATE_REQUEST 0x12
+#define CONNECTION_PARAMETER_UPDATE_RESPONSE 0x13
+
+#define CONNECTION_PARAMETER_UPDATE_RESULT_ACCEPTED 0x0000
+
+// A request that has not been answered (or has been rejected) will be resent
+// after this timeout.
+#define TIMEOUT_CONNECTION_PARAMETER_UPDATE 5 * 1000UL  // in ms
+
+struct __attribute__((packed)) ConnectionParameterUpdateRequest {
+  uint8_t code;
+  uint8_t identifier;
+  uint16_t length;
+  uint16_t minInterval;
+  uint16_t maxInterval;
+  uint16_t latency;
+  uint16_t supervisionTimeout;
+};
+
+struct Connection {
+  bool isConnected;
+  uint16_t handle;
+  /// Peer address (as transmitted by HCI: least significant byte first).
+  uint8_t peerAddress[6];
+  /// Negotiated Connection-Interval (in units of 1.25 ms).
+  uint16_t interval;
+  uint16_t latency;
+
+  ConnectionEventTracker connectionEventTracker;
+  /// Time (in µs, `micros()`) the last packet was received from the Central.
+  unsigned long lastPacketReceivedTime;
+
+  connectionMode_t desiredMode;
+
+  bool isUpdateRequestPending;
+  unsigned long lastUpdateRequestTime;
+  uint8_t lastUpdateRequestIdentifier;
+  uint16_t requestedInterval;
+  uint16_t requestedLatency;
+};
+
+static Connection connections[MAX_CENTRALS];
+// Connection-Intervals of the Connection-Modes (s. `setConnectionIntervals()`)
+static uint16_t connectionIntervalFast = CONNECTION_INTERVAL_FAST_DEFAULT;
+static uint16_t connectionIntervalIdle = CONNECTION_INTERVAL_IDLE_DEFAULT;
+
+static uint16_t readUInt16(const uint8_t *data) {
+  return data[0] | (data[1] << 8);
+}
+
+static Connection *findConnection(uint16_t handle) {
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    if (connections[i].isConnected && connections[i].handle == handle) {
+      return &connections[i];
+    }
+  }
+
+  return nullptr;
+}
+
+static unsigned long getIntervalMicros(Connection &connection) {
+  return connection.interval * 1250UL;
+}
+
+static void setConnectionParameters(Connection &connection, uint16_t interval, uint16_t latency) {
+  connection.interval = interval;
+  connection.latency = latency;
+
+  // The anchors are shifted by the update: Start over.
+  connection.connectionEventTracker.reset();
+  connection.connectionEventTracker.setConnectionInterval(getIntervalMicros(connection));
+
+  Log.printTimestamp();
+  Log.print("Connection-Parameters updated (handle=");
+  Log.print(connection.handle);
+  Log.print("): interval=");
+  Log.print(getIntervalMicros(connection));
+  Log.print(" us, latency=");
+  Log.println(latency);
+}
+
+static void handleLeMetaEvent(const uint8_t *params, uint16_t length) {
+  uint8_t subevent = params[0];
+  // Subevent's parameters
+  const uint8_t *p = &params[1];
+
+  switch (subevent) {
+    case LE_META_EVENT_CONN_COMPLETE:
+    case LE_META_EVENT_ENHANCED_CONN_COMPLETE:
+      {
+        // The enhanced event additionally holds the local and peer resolvable private
+        // addresses (6 bytes each) before the Connection-Parameters.
+        uint16_t offset = subevent == LE_META_EVENT_CONN_COMPLETE ? 11 : 23;
+        if (length < 1 + offset + 4 || p[0] != 0x00 || p[3] != HCI_ROLE_SLAVE) break;
+
+        Connection *connection = nullptr;
+        for (int i = 0; i < MAX_CENTRALS; i++) {
+          if (!connections[i].isConnected) {
+            connection = &connections[i];
+            break;
+          }
+        }
+        if (!connection) break;
+
+        connection->isConnected = true;
+        connection->handle = readUInt16(&p[1]) & 0x0fff;
+        memcpy(connection->peerAddress, &p[5], 6);
+        connection->lastPacketReceivedTime = micros();
+        connection->desiredMode = connectionModeFAST;
+        connection->isUpdateRequestPending = false;
+        setConnectionParameters(*connection, readUInt16(&p[offset]), readUInt16(&p[offset + 2]));
+        break;
+      }
+
+    case LE_META_EVENT_CONN_UPDATE_COMPLETE:
+      {
+        if (length < 1 + 7 || p[0] != 0x00) break;
+
+        Connection *connection = findConnection(readUInt16(&p[1]) & 0x0fff);
+        if (!connection) break;
+
+        setConnectionParameters(*connection, readUInt16(&p[3]), readUInt16(&p[5]));
+        break;
+      }
+
+    default:
+      break;
+  }
+}
+
+static void handleEvent(const uint8_t *data, uint16_t length) {
+  uint8_t eventCode = data[0];
+  const uint8_t *params = &data[2];
+  uint16_t paramsLength = length - 2;
+
+  switch (eventCode) {
+    case EVT_DISCONN_COMPLETE:
+      if (paramsLength >= 3 && params[0] == 0x00) {
+        Connection *connection = findConnection(readUInt16(&params[1]));
+        if (connection) {
+          connection->isConnected = false;
+          connection->interval = 0;
+          connection->latency = 0;
+          connection->isUpdateRequestPending = false;
+        }
+      }
+      break;
+
+    case EVT_LE_META_EVENT:
+      if (paramsLength > 0) {
+        handleLeMetaEvent(params, paramsLength);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+static void handleAclData(const uint8_t *data, uint16_t length, unsigned long receivedTime) {
+  if (length < 4) return;
+
+  Connection *connection = findConnection(readUInt16(&data[0]) & 0x0fff);
+  if (!connection) return;
+
+  connection->lastPacketReceivedTime = receivedTime;
+  connection->connectionEventTracker.onPacketReceived(receivedTime);
+
+  // ACL-header (4 bytes), L2CAP-header (4 bytes), Signaling-command (6 bytes)
+  if (length < 14) return;
+  if (readUInt16(&data[6]) != SIGNALING_CID) return;
+
+  uint8_t code = data[8];
+  uint8_t identifier = data[9];
+  if (code != CONNECTION_PARAMETER_UPDATE_RESPONSE || identifier != connection->lastUpdateRequestIdentifier) return;
+
+  uint16_t result = readUInt16(&data[12]);
+  if (result != CONNECTION_PARAMETER_UPDATE_RESULT_ACCEPTED) {
+    // Keep request pending: It will be resent after timeout.
+    Log.printTimestamp();
+    Log.print("WARNING: Central rejected Connection Parameter Update Request (handle=");
+    Log.print(connection->handle);
+    Log.println(").");
+    reportFault(FAULT_DOMAIN_CONNECTION, FAULT_CODE_PARAMETERS_REJECTED, connection->handle);
+  }
+}
+
+static void onHCIPacketReceived(uint8_t packetType, const uint8_t *data, uint16_t length, unsigned long receivedTime) {
+  if (packetType == HCI_EVENT_PKT && length >= 2) {
+    handleEvent(data, length);
+  } else if (packetType == HCI_ACLDATA_PKT) {
+    handleAclData(data, length, receivedTime);
+  }
+}
+
+static void getConnectionParameters(connectionMode_t mode, uint16_t *interval, uint16_t *latency) {
+  switch (mode) {
+    case connectionModeIDLE:
+      *interval = connectionIntervalIdle;
+      *latency = CONNECTION_SLAVE_LATENCY_IDLE;
+      break;
+
+    case connectionModeFAST:
+      *interval = connectionIntervalFast;
+      *latency = 0;
+      break;
+  }
+}
+
+static void sendConnectionParameterUpdateRequest(Connection &connection, uint16_t interval, uint16_t latency) {
+  // Identifier must be non-zero.
+  uint8_t identifier = connection.lastUpdateRequestIdentifier;
+  connection.lastUpdateRequestIdentifier = identifier == 0xff ? 1 : identifier + 1;
+
+  struct ConnectionParameterUpdateRequest request = {
+    CONNECTION_PARAMETER_UPDATE_REQUEST,
+    connection.lastUpdateRequestIdentifier,
+    8,
+    interval,
+    interval,
+    latency,
+    CONNECTION_SUPERVISION_TIMEOUT
+  };
+
+  Log.printTimestamp();
+  Log.print("Will request Connection-Parameters (handle=");
+  Log.print(connection.handle);
+  Log.print("): interval=");
+  Log.print(interval);
+  Log.print(" (x1.25ms), latency=");
+  Log.println(latency);
+
+  HCI.sendAclPkt(connection.handle, SIGNALING_CID, sizeof(request), &request);
+
+  connection.isUpdateRequestPending = true;
+  connection.lastUpdateRequestTime = millis();
+  connection.requestedInterval = interval;
+  connection.requestedLatency = latency;
+}
+
+static void updateConnectionParametersIfNeeded(Connection &connection) {
+  uint16_t interval = 0, latency = 0;
+  getConnectionParameters(connection.desiredMode, &interval, &latency);
+
+  if (interval == connection.interval && latency == connection.latency) {
+    connection.isUpdateRequestPending = false;
+    return;
+  }
+
+  if (connection.isUpdateRequestPending
+      && interval == connection.requestedInterval
+      && latency == connection.requestedLatency
+      && millis() - connection.lastUpdateRequestTime < TIMEOUT_CONNECTION_PARAMETER_UPDATE) {
+    // Awaiting response of Central.
+    return;
+  }
+
+  sendConnectionParameterUpdateRequest(connection, interval, latency);
+}
+
+// MARK: - Public
+
+void setupConnection(void) {
+  hciTap.addPacketHandler(onHCIPacketReceived);
+  HCI.setTransport(&hciTap);
+}
+
+uint16_t getConnectionHandle(const char *address) {
+  uint8_t peerAddress[6];
+  for (int i = 0; i < 6; i++) {
+    unsigned int value;
+    if (sscanf(&address[i * 3], "%2x", &value) != 1) return CONNECTION_HANDLE_NONE;
+
+    // Most significant byte first.
+    peerAddress[5 - i] = value;
+  }
+
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    if (connections[i].isConnected && memcmp(connections[i].peerAddress, peerAddress, 6) == 0) {
+      return connections[i].handle;
+    }
+  }
+
+  return CONNECTION_HANDLE_NONE;
+}
+
+void setConnectionIntervals(uint16_t fast, uint16_t idle) {
+  connectionIntervalFast = fast;
+  connectionIntervalIdle = idle;
+}
+
+void setConnectionMode(uint16_t handle, connectionMode_t mode) {
+  Connection *connection = findConnection(handle);
+  if (connection) {
+    connection->desiredMode = mode;
+  }
+}
+
+void updateConnectionParametersIfNeeded(void) {
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    if (connections[i].isConnected) {
+      updateConnectionParametersIfNeeded(connections[i]);
+    }
+  }
+}
+
+bool isConnectionEstablished(uint16_t handle) {
+  return findConnection(handle) != nullptr;
+}
+
+uint16_t getConnectionInterval(uint16_t handle) {
+  Connection *connection = findConnection(handle);
+  return connection ? connection->interval : 0;
+}
+
+unsigned long getConnectionIntervalMicros(uint16_t handle) {
+  Connection *connection = findConnection(handle);
+  return connection ? getIntervalMicros(*connection) : 0;
+}
+
+uint16_t getSlaveLatency(uint16_t handle) {
+  Connection *connection = findConnection(handle);
+  return connection ? connection->latency : 0;
+}
+
+unsigned long getLastConnectionEventTime(uint16_t handle) {
+  Connection *connection = findConnection(handle);
+  if (!connection) return millisRtc(false);
+
+  unsigned long anchor = connection->connectionEventTracker.getAnchor(connection->lastPacketReceivedTime);
+  unsigned long age = micros() - anchor;  // in µs
+
+  return millisRtc(false) - age / 1000UL;
+}
+
+unsigned long getLastConnectionEventRxOffsetMicros(uint16_t handle) {
+  Connection *connection = findConnection(handle);
+  if (!connection) return 0;
+
+  unsigned long receivedTime = connection->lastPacketReceivedTime;
+  return receivedTime - connection->connectionEventTracker.getAnchor(receivedTime);
+}
@@ -0,0 +1,66 @@
+/*
+  Connection-Parameters (BLE)
+
+  Allows the Peripheral to request updated Connection-Parameters for its
+  established connections (L2CAP Connection Parameter Update Request) and keeps
+  track of the Connection-Parameters actually negotiated with each Central.
+
+  Connections are identified by their connection handle (s. `getConnectionHandle()`).
+*/
+
+#ifndef connection_h
+#define connection_h
+
+#define CONNECTION_HANDLE_NONE 0xffff
+
+typedef enum {
+  /// Long Connection-Interval with Slave-Latency (saves power while idle).
+  connectionModeIDLE,
+  /// Short Connection-Interval w/o Slave-Latency (used during Training
+  /// and for scheduled bursts).
+  connectionModeFAST,
+} connectionMode_t;
+
+/// Installs the HCI-transport used for tracking the Connection-Parameters.
+/// NOTE: Must be called before `BLE.begin()`.
+void setupConnection(void);
+
+/// Returns the handle of the connection with the Central of the specified address
+/// (formatted as "aa:bb:cc:dd:ee:ff"), or `CONNECTION_HANDLE_NONE` if not connected.
+uint16_t getConnectionHandle(const char *address);
+
+/// Sets the Connection-Intervals (in units of 1.25 ms) of the fast and of the idle
+/// Connection-Mode (default: `CONNECTION_INTERVAL_FAST_DEFAULT`, `..._IDLE_DEFAULT`):
+/// Connections not matching them are updated by `updateConnectionParametersIfNeeded()`.
+void setConnectionIntervals(uint16_t fast, uint16_t idle);
+
+/// Sets the desired Connection-Mode. The respective Connection-Parameters
+/// will be requested from the Central by `updateConnectionParametersIfNeeded()`.
+void setConnectionMode(uint16_t handle, connectionMode_t mode);
+
+/// Sends a Connection Parameter Update Request to every Central, whose
+/// negotiated Connection-Parameters do not match the desired Connection-Mode.
+/// NOTE: Should be called from the loop (not from within BLE-callbacks).
+void updateConnectionParametersIfNeeded(void);
+
+/// `true`, if the connection is established.
+bool isConnectionEstablished(uint16_t handle);
+
+/// The negotiated Connection-Interval (in units of 1.25 ms), or 0 if not connected.
+uint16_t getConnectionInterval(uint16_t handle);
+/// The negotiated Connection-Interval in µs, or 0 if not connected.
+unsigned long getConnectionIntervalMicros(uint16_t handle);
+/// The negotiated Slave-Latency (number of Connection-Events).
+uint16_t getSlaveLatency(uint16_t handle);
+
+/// Returns the time (unsynced, in ms) of the anchor of the Connection-Event, in which
+/// the last packet was received from the Central.
+///
+/// If the anchors have not been estimated, yet, the time the packet was received
+/// by the host is returned.
+unsigned long getLastConnectionEventTime(uint16_t handle);
+/// The (estimated) offset in µs of the reception of the last packet relative to the
+/// anchor of its Connection-Event.
+unsigned long getLastConnectionEventRxOffsetMicros(uint16_t handle);
+
+#endif /* connection_h */
@@ -3,12 +3,75 @@
 #define HARDWARE_REVISION 1
 #define SOFTWARE_REVISION 1
 
-const unsigned long CONNECTION_INTERVAL = 20UL;   // 20 ms
-const unsigned long MAX_TIMER_DELAY = 1000UL;     // 1 sec
-const unsigned long SIGNAL_HIGH_INTERVAL = 100UL; // 100 ms
+// Defaults of the configuration applied at runtime (s. config.h): The maximum delay of a
+// timer and the width of the pulses of channel 0.
+const unsigned long MAX_TIMER_DELAY_DEFAULT = 1000UL;     // 1 sec
+const unsigned long SIGNAL_HIGH_INTERVAL_DEFAULT = 100UL; // 100 ms
+/// Maximum lateness of a timer (i.e. due to a blocked loop): Later timers are missed.
+const unsigned long TIMER_LATENESS_TOLERANCE = 100UL; // 100 ms
 
-const unsigned long SYNC_INTERVAL = 90000UL;  // 90 sec
-const int TRAINING_MSGS_COUNT = 3;
+/// Maximum number of simultaneously connected Centrals.
+const int MAX_CENTRALS = 3;
+
+/// Maximum interval between syncs (a re-sync is usually needed earlier, s. `SYNC_ACCURACY_BUDGET`):
+/// Default of the configuration (s. config.h).
+const unsigned long SYNC_INTERVAL_DEFAULT = 600000UL;  // 10 min
+/// Maximum predicted uncertainty of a synced time before a re-sync is needed: Above the
+/// uncertainty of a Training in the fast Connection-Mode (about 6.3 ms, s. trainingEngine.h).
+/// Default of the configuration (s. config.h).
+const unsigned long SYNC_ACCURACY_BUDGET = 10000UL;  // 10 ms
+/// Skew (in ppb) of a Central's clock to the local clock assumed until estimated
+/// more accurately by subsequent syncs (typical crystals are specified with +/- 20 ppm).
+const unsigned long CLOCK_SKEW_DEFAULT = 20000UL;  // 20 ppm
+/// Maximum plausible skew (in ppb): A larger change of the offset indicates a reset clock.
+const unsigned long CLOCK_SKEW_MAX = 200000UL;  // 200 ppm
+/// Rate (in ppm) at which corrections of a re-sync are slewed.
+const unsigned long CLOCK_SLEW_RATE = 1000UL;  // 1 ms per sec
+/// Maximum correction (in ms) of a re-sync that is slewed: Larger corrections are stepped.
+const unsigned long CLOCK_STEP_THRESHOLD = 5UL;  // 5 ms
+/// Maximum age of a wired sync edge when pairing it with its Wired-Reference-Timestamp
+/// (must be shorter than the interval of the pulses).
+const unsigned long WIRED_SYNC_PAIRING_WINDOW = 500UL;  // 500 ms
+/// The wired sync signal is considered lost, if no edge has been captured for this duration.
+const unsigned long WIRED_SYNC_TIMEOUT = 3000UL;  // 3 sec
+/// Uncertainty (in µs) of a time synced by a wired pulse: The resolution of the local time.
+const unsigned long WIRED_SYNC_UNCERTAINTY = 1000UL;  // 1 ms
+/// Interval at which the `syncQuality`-Characteristic is updated (and notified).
+const unsigned long SYNC_QUALITY_UPDATE_INTERVAL = 1000UL;  // 1 sec
+/// Number of Reference-Timestamps of a Training: Default of the configuration (s. config.h).
+const int TRAINING_MSGS_COUNT_DEFAULT = 3;
+/// Tolerance of the verification of a restored sync (in addition to the
+/// uncertainty of 1/2 Connection-Interval of a single Reference-Timestamp).
+const unsigned long SYNC_VERIFICATION_TOLERANCE = 2UL;  // 2 ms
+/// Interval (in µs) at which a USB host polls the device (full-speed frames):
+/// The "Connection-Interval" of a Training via the Serial-Protocol.
+const unsigned long USB_FRAME_INTERVAL = 1000UL;  // 1 ms
+/// Maximum age of the synced time established by round-trip sync (s. serialProtocol.h).
+const unsigned long SERIAL_SYNC_MAX_AGE = 1000UL;  // 1 sec
+
+// Connection-Parameters (BLE) requested by the Peripheral.
+// Connection-Intervals are specified in units of 1.25 ms,
+// the Supervision-Timeout in units of 10 ms. The intervals are defaults of the
+// configuration (s. config.h).
+const uint16_t CONNECTION_INTERVAL_FAST_DEFAULT = 0x0006;  // 7.5 ms
+const uint16_t CONNECTION_INTERVAL_IDLE_DEFAULT = 0x000C;  // 15 ms
+const uint16_t CONNECTION_SLAVE_LATENCY_IDLE = 4;          // Peripheral listens at least every 5 idle intervals (75 ms)
+const uint16_t CONNECTION_SUPERVISION_TIMEOUT = 0x0190;    // 4 sec
+/// Duration the fast Connection-Parameters are retained after the last
+/// scheduled signal (in anticipation of further signals).
+const unsigned long CONNECTION_BURST_TIMEOUT = 10000UL;  // 10 sec
+
+/// Identifies Broadcast-Advertisements (s. observer.h).
+const uint16_t BROADCAST_COMPANY_ID = 0xFFFF;  // Reserved for internal use
+const uint8_t BROADCAST_TYPE = 0x53;
+/// Maximum deviation of a broadcaster's timestamp from the broadcaster's time
+/// observed before (drift and advertising latency): Protects against replays.
+const unsigned long BROADCAST_CLOCK_TOLERANCE = 1000UL;  // 1 sec
+/// Duration after which a broadcaster's time is re-learned, if none of its advertisements
+/// has been accepted meanwhile (s. observer.h).
+const unsigned long BROADCAST_STATE_TIMEOUT = 30000UL;  // 30 sec
+/// Number of broadcasters that can be provisioned (s. observer.h).
+const uint8_t BROADCASTERS_MAX = 4;
 
 #define LCD_NUM_COL 16
 
@@ -21,4 +84,16 @@ enum ConnectionOptions {
   /// disconnect and suppress any reconnect-attempts for a
   /// certain duration.
   CONNECTION_OPTION_REJECT_REQUEST = 1 << 0,
+};
+
+/// Values of the Peripheral's `timeNeedsSync`-Characteristic.
+enum TimeNeedsSync {
+  /// Time is synced.
+  TIME_NEEDS_SYNC_NONE = 0x00,
+  /// Time needs to be synced: The Central is expected to perform a Training.
+  TIME_NEEDS_SYNC_TRAINING = 0x01,
+  /// A previous sync of the (reconnected) Central has been restored: The Central
+  /// is expected to confirm it by writing a single Reference-Timestamp.
+  /// (A Training is accepted, too.)
+  TIME_NEEDS_SYNC_VERIFICATION = 0x02,
 };
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include "fault.h"
+
+struct FaultMessage {
+  uint8_t domain;
+  uint8_t code;
+  const char *message;
+};
+
+// `const`: Kept in the flash (the records store only the domain and the code).
+static const FaultMessage FAULT_MESSAGES[] = {
+  { FAULT_DOMAIN_SYSTEM, FAULT_CODE_BLE_INIT_FAILURE, "BLE-init fail." },
+  { FAULT_DOMAIN_SYSTEM, FAULT_CODE_LOOP_OVERRUN, "Loop overrun" },
+  { FAULT_DOMAIN_TRAINING, FAULT_CODE_TRAINING_TIMEOUT, "Train. timeout" },
+  { FAULT_DOMAIN_TIMER, FAULT_CODE_INVALID_DELAY, "Invalid delay" },
+  { FAULT_DOMAIN_TIMER, FAULT_CODE_INVALID_CHANNEL, "Invalid chan." },
+  { FAULT_DOMAIN_TIMER, FAULT_CODE_NO_TIMER_AVAILABLE, "No timer free" },
+  { FAULT_DOMAIN_TIMER, FAULT_CODE_MISSED_TIMER, "Missed timer" },
+  { FAULT_DOMAIN_TIMER, FAULT_CODE_INVALID_UNIT_WIDTH, "Inv. unit wid." },
+  { FAULT_DOMAIN_LOG, FAULT_CODE_LOG_OVERFLOW, "Log overflow" },
+  { FAULT_DOMAIN_CONNECTION, FAULT_CODE_TOO_MANY_CENTRALS, "Too many conn." },
+  { FAULT_DOMAIN_CONNECTION, FAULT_CODE_PARAMETERS_REJECTED, "Param. reject." },
+  { FAULT_DOMAIN_CAPTURE, FAULT_CODE_CAPTURE_QUEUE_FULL, "Capt. q. full" },
+  { FAULT_DOMAIN_CAPTURE, FAULT_CODE_CALIBRATION_FAILED, "Calib. failed" },
+  { FAULT_DOMAIN_CAPTURE, FAULT_CODE_WIRED_SYNC_UNPAIRED, "Wired unpaired" },
+  { FAULT_DOMAIN_SERIAL, FAULT_CODE_HOST_NOT_READING, "Host not read." },
+  { FAULT_DOMAIN_SERIAL, FAULT_CODE_INVALID_FRAME, "Invalid frame" },
+  { FAULT_DOMAIN_CONFIG, FAULT_CODE_CONFIG_REJECTED, "Config reject." },
+  { FAULT_DOMAIN_CONFIG, FAULT_CODE_CONFIG_INVALID, "Config invalid" },
+};
+
+const char *getFaultMessage(uint8_t domain, uint8_t code) {
+  for (const FaultMessage &message : FAULT_MESSAGES) {
+    if (message.domain == domain && message.code == code) return message.message;
+  }
+
+  return "Unknown fault";
+}
+
+const char *getFaultDomainName(uint8_t domain) {
+  switch (domain) {
+    case FAULT_DOMAIN_SYSTEM: return "system";
+    case FAULT_DOMAIN_TRAINING: return "training";
+    case FAULT_DOMAIN_TIMER: return "timer";
+    case FAULT_DOMAIN_LOG: return "log";
+    case FAULT_DOMAIN_CONNECTION: return "connection";
+    case FAULT_DOMAIN_CAPTURE: return "capture";
+    case FAULT_DOMAIN_SERIAL: return "serial";
+    case FAULT_DOMAIN_CONFIG: return "config";
+  }
+  return "unknown";
+}
@@ -0,0 +1,108 @@
+/*
+  Fault
+
+  Compact record of a fault (s. faultLog.h): Its domain, its code, the local time it
+  occurred and two arguments specific to the code (i.e. the delay of a timer that was
+  rejected). The message of a fault is not stored, but looked up by its domain and code
+  (s. `getFaultMessage()`) from a table in the flash. Read page-wise by the
+  `faultLog`-Characteristic and by `SERIAL_MSG_READ_FAULTS` (s. `FaultLogPage`).
+
+  This header does not depend on the Arduino core: It is shared with the host tools
+  (s. `Host/`).
+*/
+
+#ifndef fault_h
+#define fault_h
+
+#include <stdint.h>
+
+// Number of faults kept by the log (the oldest are overwritten).
+#define FAULT_LOG_SIZE 16
+// Number of faults of a `FaultLogPage`.
+#define FAULT_LOG_PAGE_SIZE 4
+
+enum FaultDomain {
+  FAULT_DOMAIN_SYSTEM = 0,
+  FAULT_DOMAIN_TRAINING = 1,
+  FAULT_DOMAIN_TIMER = 2,
+  FAULT_DOMAIN_LOG = 3,
+  FAULT_DOMAIN_CONNECTION = 4,
+  FAULT_DOMAIN_CAPTURE = 5,
+  FAULT_DOMAIN_SERIAL = 6,
+  FAULT_DOMAIN_CONFIG = 7,
+};
+
+/// Codes of the faults (by domain). The arguments of a fault are listed by its code.
+enum FaultCode {
+  /// Starting the BLE module failed (fatal).
+  FAULT_CODE_BLE_INIT_FAILURE = 0,
+  /// Runs of the loop took too long (DEBUG, reported once per 3 s): 0: longest duration
+  /// (in ms), 1: number of runs.
+  FAULT_CODE_LOOP_OVERRUN = 1,
+
+  /// Training-Messages were lost: 0: number received, 1: number expected.
+  FAULT_CODE_TRAINING_TIMEOUT = 0,
+
+  /// The delay of a timer is invalid (fired immediately): 0: delay (in ms), 1: channel.
+  FAULT_CODE_INVALID_DELAY = 0,
+  /// The channel of a timer is invalid (dropped): 0: channel.
+  FAULT_CODE_INVALID_CHANNEL = 1,
+  /// Every timer is armed (dropped): 0: source (s. `timerSource_t`).
+  FAULT_CODE_NO_TIMER_AVAILABLE = 2,
+  /// A timer fired too late (dropped): 0: source, 1: channel.
+  FAULT_CODE_MISSED_TIMER = 3,
+  /// The unit width of a coded timer is out of range (default used): 0: unit width (in µs).
+  FAULT_CODE_INVALID_UNIT_WIDTH = 4,
+
+  /// The buffer of the logger overflowed (logs dropped): 0: number of bytes dropped.
+  FAULT_CODE_LOG_OVERFLOW = 0,
+
+  /// A Central connected while every context is in use (disconnected).
+  FAULT_CODE_TOO_MANY_CENTRALS = 0,
+  /// A Central rejected the Connection-Parameters requested: 0: connection handle.
+  FAULT_CODE_PARAMETERS_REJECTED = 1,
+
+  /// The Capture-Queue is full (edges dropped): 0: number of edges dropped.
+  FAULT_CODE_CAPTURE_QUEUE_FULL = 0,
+  /// The calibration failed: 0: number of test pulses captured, 1: number emitted.
+  FAULT_CODE_CALIBRATION_FAILED = 1,
+  /// A Wired-Reference-Timestamp has no matching edge (ignored).
+  FAULT_CODE_WIRED_SYNC_UNPAIRED = 2,
+
+  /// The host is not reading (message dropped): 0: type of the message.
+  FAULT_CODE_HOST_NOT_READING = 0,
+  /// A frame is invalid (dropped).
+  FAULT_CODE_INVALID_FRAME = 1,
+
+  /// A write of the configuration was rejected: 0: status (s. `ConfigStatus`).
+  FAULT_CODE_CONFIG_REJECTED = 0,
+  /// The configuration persisted to the flash is invalid (defaults used).
+  FAULT_CODE_CONFIG_INVALID = 1,
+};
+
+struct __attribute__((packed)) FaultRecord {
+  uint8_t domain;
+  uint8_t code;
+  /// Local time (`millisRtc()`) of the fault.
+  uint32_t time;
+  int32_t arguments[2];
+};
+
+/// A page of the log (little-endian): The faults from `index` on (0: the latest one),
+/// from the latest to the oldest.
+struct __attribute__((packed)) FaultLogPage {
+  /// Number of faults since startup (saturating).
+  uint16_t faultsCount;
+  /// Number of faults kept by the log (at most `FAULT_LOG_SIZE`).
+  uint8_t storedCount;
+  uint8_t index;
+  /// Number of `faults` (0, if `index` is out of range).
+  uint8_t count;
+  FaultRecord faults[FAULT_LOG_PAGE_SIZE];
+};
+
+/// The message of a fault (at most 14 characters: fits the display in parentheses).
+const char *getFaultMessage(uint8_t domain, uint8_t code);
+const char *getFaultDomainName(uint8_t domain);
+
+#endif /* fault_h */
@@ -0,0 +1,50 @@
+#include <Arduino.h>
+#include "faultLog.h"
+#include "rtc.hpp"
+
+static FaultRecord faults[FAULT_LOG_SIZE];
+// Index of the next fault to write.
+static uint8_t nextIndex = 0;
+static uint8_t storedCount = 0;
+static uint16_t totalCount = 0;
+
+void reportFault(uint8_t domain, uint8_t code, int32_t argument0, int32_t argument1) {
+  FaultRecord &fault = faults[nextIndex];
+  fault.domain = domain;
+  fault.code = code;
+  fault.time = millisRtc(false);
+  fault.arguments[0] = argument0;
+  fault.arguments[1] = argument1;
+
+  nextIndex = (nextIndex + 1) % FAULT_LOG_SIZE;
+  if (storedCount < FAULT_LOG_SIZE) storedCount++;
+  if (totalCount < 0xffff) totalCount++;
+}
+
+uint16_t faultsCount(void) {
+  return totalCount;
+}
+
+uint8_t storedFaultsCount(void) {
+  return storedCount;
+}
+
+bool faultAt(uint8_t index, FaultRecord *fault) {
+  if (index >= storedCount) return false;
+
+  *fault = faults[(nextIndex + FAULT_LOG_SIZE - 1 - index) % FAULT_LOG_SIZE];
+  return true;
+}
+
+FaultLogPage faultLogPage(uint8_t index) {
+  FaultLogPage page = {};
+  page.faultsCount = totalCount;
+  page.storedCount = storedCount;
+  page.index = index;
+  while (page.count < FAULT_LOG_PAGE_SIZE && index + page.count < storedCount) {
+    faultAt(index + page.count, &page.faults[page.count]);
+    page.count++;
+  }
+
+  return page;
+}
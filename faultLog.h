@@ -0,0 +1,33 @@
+/*
+  Fault-Log
+
+  Keeps the latest `FAULT_LOG_SIZE` faults (s. fault.h) in a ring buffer of fixed size:
+  Non-fatal faults (i.e. a Training that timed out, a timer with an invalid delay or an
+  overflow of the logger's buffer) are reported in addition to their log message, the
+  fatal ones before the Signalboy halts. Nothing is allocated.
+
+  Read by the `faultLog`-Characteristic, by `SERIAL_MSG_READ_FAULTS` (s.
+  `signalboy-cli faults`) and browsed by the menu of the LCD-display.
+*/
+
+#ifndef faultLog_h
+#define faultLog_h
+
+#include <stdint.h>
+#include "fault.h"
+
+/// Adds a fault (s. `FaultCode` for its arguments), overwriting the oldest one if the
+/// log is full. Does not log: Safe to call from the logger.
+void reportFault(uint8_t domain, uint8_t code, int32_t argument0 = 0, int32_t argument1 = 0);
+
+/// Number of faults since startup (saturating).
+uint16_t faultsCount(void);
+/// Number of faults kept by the log (at most `FAULT_LOG_SIZE`).
+uint8_t storedFaultsCount(void);
+/// Copies the fault at `index` (0: the latest one). Returns `false`, if `index` is out
+/// of range.
+bool faultAt(uint8_t index, FaultRecord *fault);
+/// The faults from `index` on (s. `FaultLogPage`).
+FaultLogPage faultLogPage(uint8_t index);
+
+#endif /* faultLog_h */
@@ -0,0 +1,63 @@
+#include <Arduino.h>
+#include "flashStorage.h"
+
+// Geometry of the SAMD21's flash (in bytes): A row is erased at once, pages are written.
+#define PAGE_SIZE 64
+#define PAGES_PER_ROW 4
+
+// The row (aligned to a row, so no code shares it). Part of the image, so the upload
+// writes it with 0: Its content is validated by the user of the storage. Volatile: It is
+// changed by the NVM controller, so the compiler must neither fold its reads to the
+// initializer nor elide the writes to the page buffer.
+__attribute__((__aligned__(FLASH_STORAGE_SIZE)))
+static const volatile uint8_t storage[FLASH_STORAGE_SIZE] = {};
+
+static void waitUntilReady(void) {
+  while (NVMCTRL->INTFLAG.bit.READY == 0);
+}
+
+static void executeCommand(uint32_t command) {
+  NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | command;
+  waitUntilReady();
+}
+
+const uint8_t *flashStorage(void) {
+  // The callers (in other translation units) do not see the initializer: Their reads
+  // are not folded.
+  return (const uint8_t *)storage;
+}
+
+bool writeFlashStorage(size_t offset, const void *data, size_t length) {
+  if (offset > FLASH_STORAGE_SIZE || length > FLASH_STORAGE_SIZE - offset) return false;
+
+  // The row is erased as a whole: Its other bytes are rewritten.
+  uint8_t row[FLASH_STORAGE_SIZE];
+  for (size_t i = 0; i < sizeof(row); i++) row[i] = storage[i];
+  memcpy(&row[offset], data, length);
+
+  // Pages are written by command (not automatically by the last word of a page).
+  NVMCTRL->CTRLB.bit.MANW = 1;
+
+  // The address of the row is specified in 16-bit words.
+  NVMCTRL->ADDR.reg = (uintptr_t)storage / 2;
+  executeCommand(NVMCTRL_CTRLA_CMD_ER);
+
+  for (int page = 0; page < PAGES_PER_ROW; page++) {
+    size_t pageOffset = page * PAGE_SIZE;
+
+    executeCommand(NVMCTRL_CTRLA_CMD_PBC);
+
+    // The page buffer is written in 32-bit words (at the addresses of the page).
+    volatile uint32_t *destination = (volatile uint32_t *)&storage[pageOffset];
+    for (size_t i = 0; i < PAGE_SIZE; i += sizeof(uint32_t)) {
+      uint32_t word;
+      memcpy(&word, &row[pageOffset + i], sizeof(word));
+      *destination++ = word;
+    }
+
+    NVMCTRL->ADDR.reg = (uintptr_t)&storage[pageOffset] / 2;
+    executeCommand(NVMCTRL_CTRLA_CMD_WP);
+  }
+
+  return true;
+}
@@ -0,0 +1,36 @@
+/*
+  Flash-Storage
+
+  A row of the flash (256 bytes), reserved for data that survives a power cycle (the
+  configuration and its key, s. config.h, and the keys of the broadcasters, s. observer.h): Written
+  by the NVM controller. The row is part of the sketch's image, so uploading a sketch
+  erases it.
+
+  A write erases the row and writes its pages: The CPU stalls on every access to the
+  flash meanwhile (~15 ms), ISRs included. Write only while no timer is armed.
+*/
+
+#ifndef flashStorage_h
+#define flashStorage_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Size of the storage (a row of the SAMD21's flash).
+#define FLASH_STORAGE_SIZE 256
+
+// Regions of the storage (offsets and sizes in bytes), by user.
+#define FLASH_STORAGE_CONFIG_OFFSET 0
+#define FLASH_STORAGE_CONFIG_SIZE 64
+#define FLASH_STORAGE_KEYS_OFFSET 64
+#define FLASH_STORAGE_KEYS_SIZE 128
+#define FLASH_STORAGE_CONFIG_KEY_OFFSET 192
+#define FLASH_STORAGE_CONFIG_KEY_SIZE 64
+
+/// The stored bytes (`FLASH_STORAGE_SIZE` bytes, 0xff if erased).
+const uint8_t *flashStorage(void);
+/// Replaces `length` stored bytes from `offset` on by `data`: The rest of the storage is
+/// kept. Returns `false`, if the bytes exceed the storage.
+bool writeFlashStorage(size_t offset, const void *data, size_t length);
+
+#endif /* flashStorage_h */
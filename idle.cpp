@@ -0,0 +1,70 @@
+#include <Arduino.h>
+#include "idle.h"
+#include "rtc.hpp"
+#include "trace.h"
+
+#ifdef IDLE_SLEEP
+
+static uint32_t sleepsCount = 0;
+// in µs
+static unsigned long long sleepTime = 0;
+static uint32_t wakeLatencyMaximum = 0;
+static unsigned long long wakeLatencySum = 0;
+static uint32_t wakeLatencySamplesCount = 0;
+
+void setupIdle(void) {
+  // Sleep mode IDLE 0 (only the CPU's clock is stopped), not standby
+  PM->SLEEP.reg = PM_SLEEP_IDLE_CPU;
+  SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+}
+
+void idle(bool hasDeadline, unsigned long deadline) {
+  unsigned int ticks = rtcTicks();
+  if (hasDeadline) {
+    long remaining = (long)(deadline - millisRtc(false));
+    // Time (in µs) until the tick of the deadline (the last tick started the current ms)
+    long untilDeadline = remaining * 1000L - (long)(micros() - rtcLastTickMicros());
+    if (remaining <= 0 || untilDeadline < IDLE_GUARD_BAND) return;
+  }
+
+  TRACE_BEGIN(TRACE_POINT_IDLE);
+  unsigned long sleepStartTime = micros();
+
+  // With interrupts suspended, the interrupt of a tick cannot slip in between the check
+  // of the deadline and the sleep: It is pending and ends the sleep immediately.
+  noInterrupts();
+  bool isTicked = rtcTicks() != ticks;
+  if (!isTicked) {
+    __DSB();
+    __WFI();
+  }
+  // Runs the ISR, that ended the sleep.
+  interrupts();
+
+  unsigned long wakeTime = micros();
+  TRACE_END(TRACE_POINT_IDLE);
+  // Ticked since the check of the deadline: Not slept.
+  if (isTicked) return;
+
+  sleepsCount++;
+  sleepTime += wakeTime - sleepStartTime;
+
+  if (rtcTicks() != ticks) {
+    uint32_t latency = wakeTime - rtcLastTickMicros();
+    wakeLatencyMaximum = max(wakeLatencyMaximum, latency);
+    wakeLatencySum += latency;
+    wakeLatencySamplesCount++;
+  }
+}
+
+IdleStats idleStats(void) {
+  IdleStats stats;
+  stats.sleepsCount = sleepsCount;
+  stats.sleepTime = sleepTime / 1000;
+  stats.wakeLatencyMaximum = min(wakeLatencyMaximum, (uint32_t)0xffff);
+  stats.wakeLatencyMean = wakeLatencySamplesCount > 0 ? wakeLatencySum / wakeLatencySamplesCount : 0;
+  stats.wakeLatencySamplesCount = wakeLatencySamplesCount;
+  return stats;
+}
+
+#endif /* IDLE_SLEEP */
@@ -0,0 +1,61 @@
+/*
+  Idle
+
+  Lets the loop sleep until the next interrupt (WFI, sleep mode IDLE: The CPU's clock
+  is stopped), once it has nothing to do before its next deadline. The loop is woken
+  at the latest by the next SQW tick (1.024 kHz, the time base of `millisRtc()`): Every
+  advance of the local time wakes it, so a deadline is never slept through - no wakeup
+  timer is needed. The same holds for the UI's timeouts (`millis()`, woken by SysTick)
+  and for BLE, USB and the capture pins (woken by their interrupts).
+
+  A deadline (i.e. the next change of a timer, s. `nextTimerDeadline()`) closer than
+  the guard band is spun into instead. The wake-up latency (from the interrupt of the
+  SQW tick, that ended the sleep, to the loop) is measured (s. `idleStats()`): The
+  guard band must exceed it.
+
+  Standby is not used: It stops the clocks of SysTick, the native USB and the HCI UART,
+  and would be woken by every SQW tick anyway.
+
+  Enabled by defining `IDLE_SLEEP` (s. `Globals.hpp`): Otherwise, the loop spins.
+*/
+
+#ifndef idle_h
+#define idle_h
+
+#include <stdint.h>
+#include "Globals.hpp"
+
+// Minimum time (in µs) to the next deadline for the loop to sleep (s. above).
+// Not measured, yet: Must exceed the `wakeLatencyMaximum` measured on a board (s.
+// `idleStats()`), update it from the diagnostics of an IDLE_SLEEP build under load.
+#define IDLE_GUARD_BAND 200
+
+struct IdleStats {
+  uint32_t sleepsCount;
+  /// Total time slept (in ms).
+  uint32_t sleepTime;
+  /// Wake-up latency (in µs): From the interrupt of the SQW tick to the loop.
+  uint16_t wakeLatencyMaximum;
+  uint16_t wakeLatencyMean;
+  uint32_t wakeLatencySamplesCount;
+};
+
+#ifdef IDLE_SLEEP
+
+void setupIdle(void);
+
+/// Sleeps until the next interrupt, unless the deadline (local time, `millisRtc()`) is
+/// closer than the guard band (or due). NOTE: Must be called from the loop only.
+void idle(bool hasDeadline, unsigned long deadline);
+
+IdleStats idleStats(void);
+
+#else
+
+inline void setupIdle(void) {}
+inline void idle(bool hasDeadline, unsigned long deadline) {}
+inline IdleStats idleStats(void) { return IdleStats{}; }
+
+#endif /* IDLE_SLEEP */
+
+#endif /* idle_h */
@@ -37,6 +37,8 @@ LCDKeypadScreen::LCDKeypadScreen(
     m_lcdLine2(""),
     m_nextLcdLine1(""),
     m_nextLcdLine2(""),
+    m_rootViewControllerPtr(NULL),
+    m_needsDisplay(true),
     m_lastAdcKeyIn(1023),
     m_lastAnalogReadTime(0UL),
     m_isBacklightActive(false),
@@ -56,6 +58,7 @@ ViewController *LCDKeypadScreen::getRootViewController() {
 
 void LCDKeypadScreen::setRootViewController(ViewController *viewController) {
   m_rootViewControllerPtr = viewController;
+  m_needsDisplay = true;
 }
 
 Button_t LCDKeypadScreen::readLcdButtons() {  
@@ -149,13 +152,17 @@ void LCDKeypadScreen::update() {
 
   if (m_rootViewControllerPtr) {
     m_rootViewControllerPtr->update();
-    
-    m_nextLcdLine1 = m_rootViewControllerPtr->getLine1();
-    m_nextLcdLine2 = m_rootViewControllerPtr->getLine2();
+
+    // Only fetch the lines if changed.
+    if (m_rootViewControllerPtr->takeNeedsDisplay() || m_needsDisplay) {
+      m_nextLcdLine1 = m_rootViewControllerPtr->getLine1();
+      m_nextLcdLine2 = m_rootViewControllerPtr->getLine2();
+    }
   } else {
     m_nextLcdLine1 = "";
     m_nextLcdLine2 = "";
   }
+  m_needsDisplay = false;
 
   // Only update display if necessary.
   bool isDisplayUpdateNeeded = m_nextLcdLine1 != m_lcdLine1 || m_nextLcdLine2 != m_lcdLine2;
@@ -60,6 +60,9 @@ private:
   arduino::String m_nextLcdLine2;
 
   ViewController *m_rootViewControllerPtr;
+  /// `true`, if the lines of the root View-Controller need to be fetched
+  /// (i.e. it has been replaced).
+  bool m_needsDisplay;
 
   int m_lastAdcKeyIn;
   unsigned long m_lastAnalogReadTime;
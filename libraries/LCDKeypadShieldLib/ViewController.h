@@ -27,4 +27,17 @@ public:
 
   // IResponder
   virtual void onButtonPushed(Button_t button) = 0;
+
+  /// Marks the lines as changed: They are fetched by the screen on its next update
+  /// (otherwise, the screen does not fetch them at all).
+  void setNeedsDisplay() { m_needsDisplay = true; }
+  /// Returns `true`, if the lines changed since the last call (s. `setNeedsDisplay()`).
+  bool takeNeedsDisplay() {
+    bool needsDisplay = m_needsDisplay;
+    m_needsDisplay = false;
+    return needsDisplay;
+  }
+
+private:
+  bool m_needsDisplay = true;
 };
\ No newline at end of file
@@ -0,0 +1,150 @@
+#!/usr/bin/env bash
+# Reports the static usage of flash and RAM per translation unit from the linker map of
+# the sketch, compared to a stored baseline: Flags the translation units that grew.
+#
+#   memory-report.sh [--update] <map> [<baseline>]
+#
+# The map is written by `arduino-cli compile` (s. `arduino-cli-w.sh size`). Flash counts
+# `.text`, `.rodata` and `.data` (the initial values), RAM counts `.data` and `.bss`.
+# Without a baseline (default: `memory-baseline.tsv`) or with `--update`, the report is
+# stored as the baseline. Exits with 1, if any translation unit grew by more than
+# `MEMORY_REPORT_TOLERANCE` bytes (default: 0) of flash or RAM. Translation units of the
+# baseline missing from the map are listed as removed.
+
+# Strict mode.
+set -euo pipefail
+
+print_help() {
+  echo "usage: memory-report.sh [--update] <map> [<baseline>]"
+}
+
+update=false
+if [[ $# -gt 0 && "$1" == "--update" ]]; then
+  update=true
+  shift
+fi
+
+if [[ $# -lt 1 ]]; then
+  print_help
+  exit 1
+fi
+
+map=$1
+baseline=${2:-memory-baseline.tsv}
+tolerance=${MEMORY_REPORT_TOLERANCE:-0}
+
+# The input sections of the memory map: "<unit>\t<flash>\t<ram>" per translation unit
+report=$(awk '
+  function hex(string,    value, i) {
+    value = 0
+    for (i = 3; i <= length(string); i++) {
+      value = value * 16 + index("0123456789abcdef", tolower(substr(string, i, 1))) - 1
+    }
+    return value
+  }
+
+  function unit(path,    name, library) {
+    # Archive members: "core.a(wiring.c.o)"
+    if (match(path, /[^\/]*\(.*\)$/)) return substr(path, RSTART, RLENGTH)
+
+    name = path
+    sub(/.*\//, "", name)
+    sub(/\.o$/, "", name)
+    # Libraries of the sketch: "ArduinoBLE/HCI.cpp"
+    if (match(path, /\/libraries\/[^\/]+\//)) {
+      library = substr(path, RSTART + 11, RLENGTH - 12)
+      return library "/" name
+    }
+    return name
+  }
+
+  function add(section, size, path,    flash, ram) {
+    if (section ~ /^\.(text|rodata|ARM\.extab|ARM\.exidx)/) {
+      flash = size
+    } else if (section ~ /^\.(data|ramfunc)/) {
+      flash = size
+      ram = size
+    } else if (section ~ /^(\.bss|COMMON)/) {
+      ram = size
+    } else {
+      return
+    }
+
+    units[unit(path)] = 1
+    flashSizes[unit(path)] += flash
+    ramSizes[unit(path)] += ram
+  }
+
+  /^Linker script and memory map/ { isMap = 1; next }
+  !isMap { next }
+
+  # An input section: " <section> <address> <size> <file>", or its name alone (if long),
+  # followed by "<address> <size> <file>" on the next line
+  /^ [.A-Z]/ {
+    if (NF == 4 && $2 ~ /^0x/ && $3 ~ /^0x/) {
+      add($1, hex($3), $4)
+      pending = ""
+    } else if (NF == 1) {
+      pending = $1
+    } else {
+      pending = ""
+    }
+    next
+  }
+  pending != "" && NF == 3 && $1 ~ /^0x/ && $2 ~ /^0x/ {
+    add(pending, hex($2), $3)
+    pending = ""
+    next
+  }
+  { pending = "" }
+
+  END {
+    for (u in units) printf "%s\t%d\t%d\n", u, flashSizes[u], ramSizes[u]
+  }
+' "$map" | sort)
+
+if [[ -z "$report" ]]; then
+  echo "No input sections found in $map."
+  exit 1
+fi
+
+if [[ ! -f "$baseline" ]]; then
+  echo "WARNING: No baseline at $baseline: Nothing checked, storing this report (commit it)."
+  echo "$report" >"$baseline"
+fi
+
+regressed=0
+# "<flash> <ram> <Δflash> <Δram> <unit>", largest first
+table=$(awk -F '\t' -v tolerance="$tolerance" '
+  FNR == NR { baseFlash[$1] = $2; baseRam[$1] = $3; next }
+  {
+    isReported[$1] = 1
+    deltaFlash = $2 - baseFlash[$1]
+    deltaRam = $3 - baseRam[$1]
+    flag = (deltaFlash > tolerance || deltaRam > tolerance) ? "  <- grew" : ""
+    if (flag != "") regressed++
+    printf "%8d %8d %+8d %+8d  %s%s\n", $2, $3, deltaFlash, deltaRam, $1, flag
+    totalFlash += $2; totalRam += $3; totalDeltaFlash += deltaFlash; totalDeltaRam += deltaRam
+  }
+  END {
+    # Translation units of the baseline, that are gone
+    for (u in baseFlash) {
+      if (u in isReported) continue
+      printf "%8d %8d %+8d %+8d  %s  <- removed\n", 0, 0, -baseFlash[u], -baseRam[u], u
+      totalDeltaFlash -= baseFlash[u]; totalDeltaRam -= baseRam[u]
+    }
+    printf "%8d %8d %+8d %+8d  total\n", totalFlash, totalRam, totalDeltaFlash, totalDeltaRam
+    exit regressed > 0
+  }
+' "$baseline" - <<<"$report" | sort -k1,1nr) || regressed=1
+
+printf "%8s %8s %8s %8s  %s\n" "flash" "ram" "Δflash" "Δram" "unit"
+echo "$table"
+
+if [[ "$update" = true ]]; then
+  echo "$report" >"$baseline"
+  echo "Stored the baseline at $baseline."
+elif [[ $regressed -ne 0 ]]; then
+  echo "Translation units grew (tolerance: $tolerance bytes): Check them, or store the baseline by --update."
+  exit 1
+fi
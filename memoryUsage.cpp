@@ -0,0 +1,67 @@
+#include <Arduino.h>
+#include <malloc.h>
+#include "memoryUsage.h"
+
+// should use unistd.h to define sbrk but Due causes a conflict (s. MemoryFree.cpp)
+extern "C" char *sbrk(int incr);
+// Start of the heap (s. the linker script)
+extern "C" char end;
+
+// Painted into the free memory: The stack has never reached below the lowest
+// overwritten byte.
+#define PAINT_PATTERN 0xa5
+// Bytes below the stack pointer not painted (the frame of `setupMemoryUsage()`)
+#define PAINT_MARGIN 64
+
+static volatile uint32_t allocationsCount = 0;
+static volatile uint32_t deallocationsCount = 0;
+
+void setupMemoryUsage(void) {
+  uint8_t top;
+  uint8_t *p = (uint8_t *)sbrk(0);
+  uint8_t *stackLimit = &top - PAINT_MARGIN;
+
+  while (p < stackLimit) {
+    *p++ = PAINT_PATTERN;
+  }
+}
+
+MemoryUsage memoryUsage(void) {
+  MemoryUsage usage;
+
+  uint8_t top;
+  uint8_t *heapEnd = (uint8_t *)sbrk(0);
+  usage.heapSize = heapEnd - (uint8_t *)&end;
+  usage.heapUsed = mallinfo().uordblks;
+
+  // The stack (and the heap) has never reached the bytes still painted.
+  uint8_t *p = heapEnd;
+  while (p < &top && *p == PAINT_PATTERN) p++;
+  usage.minimumFreeStack = p - heapEnd;
+
+  usage.allocationsCount = allocationsCount;
+  usage.deallocationsCount = deallocationsCount;
+  return usage;
+}
+
+// MARK: - Allocations (replacing `new.cpp` of the core)
+
+void *operator new(size_t size) {
+  allocationsCount++;
+  return malloc(size);
+}
+
+void *operator new[](size_t size) {
+  allocationsCount++;
+  return malloc(size);
+}
+
+void operator delete(void *ptr) {
+  if (ptr) deallocationsCount++;
+  free(ptr);
+}
+
+void operator delete[](void *ptr) {
+  if (ptr) deallocationsCount++;
+  free(ptr);
+}
@@ -0,0 +1,37 @@
+/*
+  Memory-Usage
+
+  Tracks the usage of the RAM at runtime: The heap's high-water mark (the extent of the
+  heap, which never shrinks), the bytes allocated from it, the number of allocations by
+  `new` (i.e. the menu items, `std::vector`) and the minimum of free
+  memory between the heap and the stack ever seen (by painting the free memory at
+  startup, s. `setupMemoryUsage()`). Read by the host via `SERIAL_MSG_READ_DIAGNOSTICS`.
+
+  The static usage of each translation unit is reported by `memory-report.sh` (from the
+  linker map).
+*/
+
+#ifndef memoryUsage_h
+#define memoryUsage_h
+
+#include <stdint.h>
+
+struct MemoryUsage {
+  /// High-water mark of the heap (in bytes).
+  uint32_t heapSize;
+  /// Bytes currently allocated from the heap (by `new` and `malloc()`, i.e. `String`).
+  uint32_t heapUsed;
+  /// Minimum of free memory between the heap and the stack since startup (in bytes).
+  uint32_t minimumFreeStack;
+  /// Number of allocations and deallocations by `new` and `delete` since startup.
+  uint32_t allocationsCount;
+  uint32_t deallocationsCount;
+};
+
+/// Paints the free memory between the heap and the stack, so its minimum can be found.
+/// NOTE: Should be called first in `setup()`.
+void setupMemoryUsage(void);
+
+MemoryUsage memoryUsage(void);
+
+#endif /* memoryUsage_h */
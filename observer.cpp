@@ -0,0 +1,244 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+#include "observer.h"
+#include "constants.h"
+#include "config.h"
+#include "flashStorage.h"
+#include "Globals.hpp"
+#include "Logger.hpp"
+#include "HCITap.h"
+#include "scheduler.h"
+#include "serialFrame.h"
+#include "siphash.h"
+#include "rtc.hpp"
+
+#define EVT_LE_META_EVENT 0x3e
+#define LE_META_EVENT_ADVERTISING_REPORT 0x02
+
+#define AD_TYPE_MANUFACTURER_SPECIFIC_DATA 0xff
+
+#define BROADCAST_PAYLOAD_SIZE 24
+#define BROADCAST_MAC_OFFSET 20
+
+// Marks the keys persisted to the flash ("BKEY").
+#define STORED_KEYS_MAGIC 0x59454b42
+
+/// The provisioned keys, as persisted to the flash (s. flashStorage.h).
+struct __attribute__((packed)) StoredKeys {
+  uint32_t magic;
+  /// Bit `i` is set, if the key of broadcaster `i` is provisioned.
+  uint8_t provisionedMask;
+  uint8_t keys[BROADCASTERS_MAX][SIPHASH_KEY_SIZE];
+  /// CRC-16 (s. serialFrame.h) of the preceding bytes.
+  uint16_t crc;
+};
+
+static_assert(sizeof(StoredKeys) <= FLASH_STORAGE_KEYS_SIZE, "The keys exceed their region of the flash storage");
+
+struct Broadcaster {
+  bool hasReceived;
+  uint32_t epoch;
+  uint32_t lastSequenceNumber;
+  /// Offset of the broadcaster's time to the local time (unsynced).
+  unsigned long offset;
+  /// Local time of the last accepted advertisement.
+  unsigned long lastAcceptedTime;
+};
+
+static StoredKeys storedKeys;
+static Broadcaster broadcasters[BROADCASTERS_MAX];
+/// `true`, if a key has been provisioned since the keys have been persisted.
+static bool isPersistPending = false;
+
+static uint16_t readUInt16(const uint8_t *data) {
+  return data[0] | (data[1] << 8);
+}
+
+static uint32_t readUInt32(const uint8_t *data) {
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static bool isProvisioned(uint8_t broadcasterId) {
+  return storedKeys.provisionedMask & (1 << broadcasterId);
+}
+
+static void logRejected(const char *reason) {
+  Log.printTimestamp();
+  Log.print("WARNING: Rejected Broadcast-Advertisement (");
+  Log.print(reason);
+  Log.println(").");
+}
+
+/// Restores the keys persisted to the flash (none, if they are not valid).
+static void restoreBroadcasterKeys(void) {
+  memcpy(&storedKeys, flashStorage() + FLASH_STORAGE_KEYS_OFFSET, sizeof(storedKeys));
+  bool isValid = storedKeys.magic == STORED_KEYS_MAGIC
+    && crc16((const uint8_t *)&storedKeys, offsetof(StoredKeys, crc)) == storedKeys.crc;
+  if (!isValid) {
+    memset(&storedKeys, 0, sizeof(storedKeys));
+    storedKeys.magic = STORED_KEYS_MAGIC;
+  }
+
+  Log.printTimestamp();
+  if (storedKeys.provisionedMask == 0) {
+    Log.println("WARNING: No broadcaster is provisioned: Broadcast-Advertisements are rejected.");
+    return;
+  }
+  String ids;
+  for (uint8_t i = 0; i < BROADCASTERS_MAX; i++) {
+    if (isProvisioned(i)) ids += String(ids.length() > 0 ? ", " : "") + String(i);
+  }
+  Log.println("Provisioned broadcasters: " + ids);
+}
+
+static bool handleBroadcastPayload(const uint8_t *payload, unsigned long receivedTime) {
+  uint8_t broadcasterId = payload[3];
+  if (broadcasterId >= BROADCASTERS_MAX || !isProvisioned(broadcasterId)) {
+    logRejected("unknown broadcaster");
+    return false;
+  }
+
+  uint32_t mac = (uint32_t)siphash24(payload, BROADCAST_MAC_OFFSET, storedKeys.keys[broadcasterId]);
+  if (mac != readUInt32(&payload[BROADCAST_MAC_OFFSET])) {
+    logRejected("invalid mac");
+    return false;
+  }
+
+  Broadcaster &broadcaster = broadcasters[broadcasterId];
+  uint32_t epoch = readUInt32(&payload[4]);
+  uint32_t sequenceNumber = readUInt32(&payload[8]);
+  if (broadcaster.hasReceived) {
+    if (epoch < broadcaster.epoch) {
+      logRejected("previous epoch");
+      return false;
+    }
+    // Repetitions of the same payload by subsequent advertising events are expected:
+    // Only the first reception is used.
+    if (epoch == broadcaster.epoch && (int32_t)(sequenceNumber - broadcaster.lastSequenceNumber) <= 0) return false;
+  }
+
+  unsigned long localReceivedTime = millisRtc(false) - (micros() - receivedTime) / 1000UL;
+  unsigned long timestamp = readUInt32(&payload[12]);
+  unsigned long targetTimestamp = readUInt32(&payload[16]);
+  unsigned long offset = timestamp - localReceivedTime;
+
+  // A new epoch starts over, and the time of a broadcaster that has been silent for
+  // long is re-learned (it may have been pinned by a replay).
+  bool isTimeKnown = broadcaster.hasReceived && epoch == broadcaster.epoch
+    && localReceivedTime - broadcaster.lastAcceptedTime <= BROADCAST_STATE_TIMEOUT;
+
+  // Replay protection across reboots of the Signalboy (i.e. of an earlier sequence
+  // number): The timestamp has to be consistent with the broadcaster's time observed
+  // before.
+  if (isTimeKnown && abs((long)(offset - broadcaster.offset)) > (long)BROADCAST_CLOCK_TOLERANCE) {
+    logRejected("inconsistent timestamp");
+    return false;
+  }
+
+  broadcaster.hasReceived = true;
+  broadcaster.epoch = epoch;
+  broadcaster.lastSequenceNumber = sequenceNumber;
+  broadcaster.offset = offset;
+  broadcaster.lastAcceptedTime = localReceivedTime;
+
+  unsigned long delay = targetTimestamp - timestamp;
+  if (delay > currentConfig().maxTimerDelay) {
+    logRejected("delay exceeds limit");
+    return false;
+  }
+
+  Log.printTimestamp();
+  Log.print("Received Broadcast-Advertisement (broadcaster=");
+  Log.print(broadcasterId);
+  Log.print(", epoch=");
+  Log.print(epoch);
+  Log.print(", sequence=");
+  Log.print(sequenceNumber);
+  Log.print("): delay=");
+  Log.print(delay);
+  Log.println(" ms");
+
+  return armTimer(localReceivedTime + delay, SCHEDULER_DEFAULT_CHANNEL, timerSourceBROADCAST);
+}
+
+static void onHCIPacketReceived(uint8_t packetType, const uint8_t *data, uint16_t length, unsigned long receivedTime) {
+  if (packetType != HCI_EVENT_PKT || length < 4) return;
+  if (data[0] != EVT_LE_META_EVENT || data[2] != LE_META_EVENT_ADVERTISING_REPORT) return;
+
+  // Only the first report of an event is handled: The controller reports
+  // one advertisement per event.
+  // Subevent (1), num reports (1), event type (1), address type (1), address (6), data length (1)
+  if (length < 2 + 11) return;
+  uint8_t dataLength = data[2 + 10];
+  if (length < 2 + 11 + dataLength) return;
+
+  onAdvertisingDataReceived(&data[2 + 11], dataLength, receivedTime);
+}
+
+// MARK: - Public
+
+void setupObserver(void) {
+  restoreBroadcasterKeys();
+  hciTap.addPacketHandler(onHCIPacketReceived);
+
+  // Duplicates are reported, too: Otherwise, the controller's duplicate
+  // filter would suppress advertisements with an updated payload.
+  BLE.scan(true);
+}
+
+void pollObserver(void) {
+  while (BLE.available()) {}
+}
+
+bool onAdvertisingDataReceived(const uint8_t *data, uint8_t length, unsigned long receivedTime) {
+  // Iterate AD structures: length (1), type (1), data (length - 1)
+  for (uint8_t i = 0; i + 1 < length; i += data[i] + 1) {
+    uint8_t adLength = data[i];
+    if (adLength == 0 || i + 1 + adLength > length) break;
+
+    const uint8_t *payload = &data[i + 2];
+    if (data[i + 1] == AD_TYPE_MANUFACTURER_SPECIFIC_DATA
+        && adLength - 1 == BROADCAST_PAYLOAD_SIZE
+        && readUInt16(&payload[0]) == BROADCAST_COMPANY_ID
+        && payload[2] == BROADCAST_TYPE) {
+      return handleBroadcastPayload(payload, receivedTime);
+    }
+  }
+
+  return false;
+}
+
+bool provisionBroadcasterKey(uint8_t broadcasterId, const uint8_t *key) {
+  if (broadcasterId >= BROADCASTERS_MAX) return false;
+
+  if (key) {
+    memcpy(storedKeys.keys[broadcasterId], key, SIPHASH_KEY_SIZE);
+    storedKeys.provisionedMask |= 1 << broadcasterId;
+  } else {
+    memset(storedKeys.keys[broadcasterId], 0, SIPHASH_KEY_SIZE);
+    storedKeys.provisionedMask &= ~(1 << broadcasterId);
+  }
+  memset(&broadcasters[broadcasterId], 0, sizeof(Broadcaster));
+
+  Log.printTimestamp();
+  Log.print(key ? "Provisioned broadcaster " : "Revoked broadcaster ");
+  Log.println(broadcasterId);
+
+  isPersistPending = true;
+  return true;
+}
+
+void persistBroadcasterKeysIfNeeded(void) {
+  if (!isPersistPending) return;
+  isPersistPending = false;
+
+  storedKeys.magic = STORED_KEYS_MAGIC;
+  storedKeys.crc = crc16((const uint8_t *)&storedKeys, offsetof(StoredKeys, crc));
+  // Spares the flash (its endurance) rewriting the keys persisted already.
+  if (memcmp(flashStorage() + FLASH_STORAGE_KEYS_OFFSET, &storedKeys, sizeof(storedKeys)) == 0) return;
+
+  writeFlashStorage(FLASH_STORAGE_KEYS_OFFSET, &storedKeys, sizeof(storedKeys));
+
+  Log.printTimestamp();
+  Log.println("Broadcaster keys persisted.");
+}
@@ -0,0 +1,62 @@
+/*
+  Broadcast-Observer
+
+  Optional mode (s. `OBSERVER_MODE`) in which the Signalboy additionally scans
+  for Broadcast-Advertisements of authorized broadcasters. A single advertisement
+  schedules a signal on every Signalboy in range, without any connection or Training.
+
+  Advertisement (Manufacturer Specific Data, all values little-endian):
+
+    company id          uint16  BROADCAST_COMPANY_ID
+    type                uint8   BROADCAST_TYPE
+    broadcaster id      uint8   Index into the provisioned keys
+    epoch               uint32  Boot counter of the broadcaster (persisted by it)
+    sequence number     uint32  Strictly increasing within an epoch
+    timestamp           uint32  Broadcaster's time (in ms) the payload was set
+    target timestamp    uint32  Broadcaster's time (in ms) to fire at
+    mac                 uint32  Lower 32 bits of SipHash-2-4 over all preceding bytes
+
+  The signal fires `target timestamp - timestamp` after the advertisement was first
+  received. Thus, the accuracy is bounded by the latency of the broadcaster's first
+  advertising event after updating the payload (advertising interval plus `advDelay`).
+
+  Broadcasters are authorized by their secret key, provisioned by the Serial-Protocol
+  (`SERIAL_MSG_PROVISION_BROADCASTER`, i.e. by USB only) and persisted to the flash (s.
+  flashStorage.h). Advertisements of a broadcaster without a key are rejected.
+
+  Replays are rejected by the epoch and the sequence number, and by the broadcaster's
+  time observed before. A new epoch (i.e. the broadcaster rebooted, or its sequence
+  number wrapped) starts over with its sequence number and time. The time of a
+  broadcaster none of whose advertisements has been accepted for
+  `BROADCAST_STATE_TIMEOUT` is re-learned as well: A replayed advertisement (accepted
+  after the Signalboy restarted) cannot pin a stale time for longer.
+*/
+
+#ifndef observer_h
+#define observer_h
+
+#include <stdint.h>
+
+/// Restores the provisioned keys, registers the observer with the HCI-tap and starts
+/// scanning. Must be called after `setupConnection()` and `BLE.begin()`.
+void setupObserver(void);
+
+/// Discards ArduinoBLE's queue of discovered devices (advertisements are
+/// handled by the HCI-tap already).
+void pollObserver(void);
+
+/// Handles the data of a single advertisement (i.e. as contained in an
+/// HCI LE Advertising Report). Returns `true`, if a signal has been scheduled.
+///
+/// `receivedTime` is the time (in µs, `micros()`) the report was received.
+bool onAdvertisingDataReceived(const uint8_t *data, uint8_t length, unsigned long receivedTime);
+
+/// Provisions the key of broadcaster `broadcasterId` (revokes it, if `key` is `nullptr`)
+/// and forgets the broadcaster's state. Returns `false`, if `broadcasterId` is out of
+/// range (s. `BROADCASTERS_MAX`).
+bool provisionBroadcasterKey(uint8_t broadcasterId, const uint8_t *key);
+
+/// Persists the keys, if provisioned: Called by the loop, while no timer is armed.
+void persistBroadcasterKeysIfNeeded(void);
+
+#endif /* observer_h */
@@ -0,0 +1,64 @@
+/*
+  Output-Channels
+
+  The output channels are specified at compile time: A list of `OutputChannel`s (pin
+  and pulse width) specializes `OutputChannels`, whose functions unroll into one
+  `digitalWrite()` per channel (no table lookups or loops at runtime). Channel `i` is
+  the `i`-th of the list.
+
+    typedef OutputChannels<OutputChannel<10, 100>, OutputChannel<5, 10>> Outputs;
+*/
+
+#ifndef outputChannels_h
+#define outputChannels_h
+
+#include <Arduino.h>
+#include "scheduler.h"
+
+/// An output pin and the width (in ms) of its pulses.
+template <int PIN, unsigned long PULSE_WIDTH>
+struct OutputChannel {
+  static const int pin = PIN;
+  static const unsigned long pulseWidth = PULSE_WIDTH;
+};
+
+template <typename... Channels>
+struct OutputChannels;
+
+template <>
+struct OutputChannels<> {
+  static const uint8_t count = 0;
+
+  static void setup(uint8_t channel) {}
+  static void write(uint8_t levels) {}
+  static int getPin(uint8_t channel) { return -1; }
+};
+
+template <typename Channel, typename... Channels>
+struct OutputChannels<Channel, Channels...> {
+  typedef OutputChannels<Channels...> Next;
+
+  static const uint8_t count = 1 + Next::count;
+  static_assert(count <= SCHEDULER_MAX_CHANNELS, "Too many output channels");
+
+  /// Sets up the pins (as outputs) and the channels' pulse widths (s. scheduler.h),
+  /// starting at `channel`.
+  static void setup(uint8_t channel = 0) {
+    pinMode(Channel::pin, OUTPUT);
+    setChannelPulseWidth(channel, Channel::pulseWidth);
+    Next::setup(channel + 1);
+  }
+
+  /// Writes the levels of every channel (bit `i`: channel `i`, s. `updateTimers()`).
+  static void write(uint8_t levels) {
+    digitalWrite(Channel::pin, levels & 1 ? HIGH : LOW);
+    Next::write(levels >> 1);
+  }
+
+  /// The pin of `channel` (-1, if invalid).
+  static int getPin(uint8_t channel) {
+    return channel == 0 ? Channel::pin : Next::getPin(channel - 1);
+  }
+};
+
+#endif /* outputChannels_h */
@@ -0,0 +1,15 @@
+#include <Arduino.h>
+#include "pulseCode.h"
+
+void emitPulseCode(int pin, const PulseCode &pulseCode) {
+  uint32_t edges[PULSE_CODE_EDGES_COUNT];
+  getPulseCodeEdges(pulseCode, edges);
+
+  // Every edge is timed relative to the marker (delays would accumulate the
+  // overhead of `digitalWrite()`). Interrupts stay enabled (s. `pps_tick()`).
+  unsigned long startTime = micros();
+  for (int i = 0; i < PULSE_CODE_EDGES_COUNT; i++) {
+    while (micros() - startTime < edges[i]) {}
+    digitalWrite(pin, i % 2 == 0 ? HIGH : LOW);
+  }
+}
@@ -0,0 +1,75 @@
+/*
+  Pulse-Code
+
+  Coded signals carry an event code (8 bits), that is emitted on the output as a train of
+  short pulses (pulse-width coding) instead of a single pulse (of the channel's pulse width):
+  A marker pulse, whose rising edge marks the target time, followed by one pulse per bit
+  (MSB first). Every width is a multiple of the train's unit width:
+
+    marker: 3 units HIGH | per bit: 1 unit LOW, then 1 unit (0) or 2 units (1) HIGH
+
+  The edges are timed in µs relative to the marker (busy-waiting, s. `emitPulseCode()`).
+  The code is self-clocking: Decoders measure the unit width by the marker.
+
+  This header does not depend on the Arduino core: It is shared with the host tools
+  (s. `Host/`).
+*/
+
+#ifndef pulseCode_h
+#define pulseCode_h
+
+#include <stdint.h>
+
+#define PULSE_CODE_BITS_COUNT 8
+// Widths (in units) of the pulses and of the gaps between them.
+#define PULSE_CODE_MARKER_UNITS 3
+#define PULSE_CODE_ZERO_UNITS 1
+#define PULSE_CODE_ONE_UNITS 2
+#define PULSE_CODE_GAP_UNITS 1
+
+// Range of the unit width (in µs): The loop is blocked while a train is emitted.
+#define PULSE_CODE_UNIT_WIDTH_MIN 20
+#define PULSE_CODE_UNIT_WIDTH_MAX 250
+#define PULSE_CODE_UNIT_WIDTH_DEFAULT 100
+
+/// Number of edges (rising and falling alternately) of a pulse train.
+#define PULSE_CODE_EDGES_COUNT (2 * (1 + PULSE_CODE_BITS_COUNT))
+
+struct PulseCode {
+  uint8_t code;
+  /// in µs
+  uint16_t unitWidth;
+};
+
+/// `true`, if `unitWidth` is within `PULSE_CODE_UNIT_WIDTH_MIN` ... `PULSE_CODE_UNIT_WIDTH_MAX`.
+inline bool isValidPulseCodeUnitWidth(uint16_t unitWidth) {
+  return unitWidth >= PULSE_CODE_UNIT_WIDTH_MIN && unitWidth <= PULSE_CODE_UNIT_WIDTH_MAX;
+}
+
+/// Computes the times (in µs, relative to the rising edge of the marker) of the edges of
+/// the pulse train of `pulseCode`. Returns the duration of the train.
+inline uint32_t getPulseCodeEdges(const PulseCode &pulseCode, uint32_t edges[PULSE_CODE_EDGES_COUNT]) {
+  uint32_t unit = pulseCode.unitWidth;
+  uint32_t time = 0;
+
+  edges[0] = time;
+  time += PULSE_CODE_MARKER_UNITS * unit;
+  edges[1] = time;
+
+  for (int i = 0; i < PULSE_CODE_BITS_COUNT; i++) {
+    bool bit = pulseCode.code & (1 << (PULSE_CODE_BITS_COUNT - 1 - i));
+
+    time += PULSE_CODE_GAP_UNITS * unit;
+    edges[2 + 2 * i] = time;
+    time += (bit ? PULSE_CODE_ONE_UNITS : PULSE_CODE_ZERO_UNITS) * unit;
+    edges[3 + 2 * i] = time;
+  }
+
+  return time;
+}
+
+/// Emits the pulse train of `pulseCode` on `pin` (firmware only): Blocks until the
+/// train has been emitted (for at most 27 units).
+void emitPulseCode(int pin, const PulseCode &pulseCode);
+
+#endif /* pulseCode_h */
@@ -0,0 +1,142 @@
+#include <Arduino.h>
+#include "recorder.h"
+#include "constants.h"
+#include "connection.h"
+#include "rtc.hpp"
+
+#ifdef RECORD
+
+static uint8_t buffer[RECORDER_BUFFER_SIZE];
+// Index of the oldest byte and number of bytes (written by the loop and the ISRs).
+static volatile unsigned int bufferTail = 0;
+static volatile unsigned int bufferCount = 0;
+/// Number of records dropped since the last `RECORD_OVERFLOW`.
+static volatile unsigned int droppedCount = 0;
+
+static bool isRecording = false;
+static uint8_t lastOutputLevels = 0;
+
+static void writeBytes(const void *bytes, unsigned int size) {
+  for (unsigned int i = 0; i < size; i++) {
+    buffer[(bufferTail + bufferCount) % RECORDER_BUFFER_SIZE] = ((const uint8_t *)bytes)[i];
+    bufferCount++;
+  }
+}
+
+/// Appends a record (dropped, if the buffer is full).
+static void record(uint8_t type, const void *parameters, uint8_t length, const void *value = nullptr, uint8_t valueLength = 0) {
+  if (!isRecording) return;
+
+  noInterrupts();
+  RecordHeader header = { type, (uint8_t)(length + valueLength), rtcTicks(), (uint32_t)micros() };
+
+  if (droppedCount > 0) {
+    // Mark the gap (once there is space).
+    if (RECORDER_BUFFER_SIZE - bufferCount < 2 * sizeof(RecordHeader) + sizeof(uint16_t) + header.length) {
+      droppedCount++;
+      interrupts();
+      return;
+    }
+
+    RecordHeader overflowHeader = { RECORD_OVERFLOW, sizeof(uint16_t), header.ticks, header.time };
+    uint16_t count = min(droppedCount, 0xffffU);
+    writeBytes(&overflowHeader, sizeof(overflowHeader));
+    writeBytes(&count, sizeof(count));
+    droppedCount = 0;
+  } else if (RECORDER_BUFFER_SIZE - bufferCount < sizeof(RecordHeader) + header.length) {
+    droppedCount++;
+    interrupts();
+    return;
+  }
+
+  writeBytes(&header, sizeof(header));
+  writeBytes(parameters, length);
+  writeBytes(value, valueLength);
+  interrupts();
+}
+
+static void packAddress(BLEDevice &central, uint8_t address[RECORD_ADDRESS_SIZE]) {
+  memset(address, 0, RECORD_ADDRESS_SIZE);
+  packRecordHex(central.address().c_str(), address, RECORD_ADDRESS_SIZE);
+}
+
+static void packUuid(BLECharacteristic &characteristic, uint8_t uuid[RECORD_UUID_SIZE]) {
+  memset(uuid, 0, RECORD_UUID_SIZE);
+  packRecordHex(characteristic.uuid(), uuid, RECORD_UUID_SIZE);
+}
+
+// MARK: - Public
+
+void setupRecorder(void) {
+  isRecording = true;
+
+  RecordStart start = { RECORDING_FORMAT_VERSION, SOFTWARE_REVISION };
+  record(RECORD_START, &start, sizeof(start));
+}
+
+void recordConnected(BLEDevice central) {
+  RecordCentral value;
+  packAddress(central, value.address);
+  record(RECORD_CONNECTED, &value, sizeof(value));
+}
+
+void recordDisconnected(BLEDevice central) {
+  RecordCentral value;
+  packAddress(central, value.address);
+  record(RECORD_DISCONNECTED, &value, sizeof(value));
+}
+
+void recordWritten(BLEDevice central, BLECharacteristic characteristic) {
+  RecordWritten value;
+  packAddress(central, value.address);
+  packUuid(characteristic, value.uuid);
+
+  uint16_t handle = getConnectionHandle(central.address().c_str());
+  value.connectionEventTime = getLastConnectionEventTime(handle);
+  value.rxOffset = getLastConnectionEventRxOffsetMicros(handle);
+  value.connectionInterval = getConnectionIntervalMicros(handle);
+
+  int valueLength = min(characteristic.valueLength(), RECORD_MAX_LENGTH - (int)sizeof(value));
+  record(RECORD_WRITTEN, &value, sizeof(value), characteristic.value(), valueLength);
+}
+
+void recordSubscribed(BLEDevice central, BLECharacteristic characteristic) {
+  RecordSubscribed value;
+  packAddress(central, value.address);
+  packUuid(characteristic, value.uuid);
+  record(RECORD_SUBSCRIBED, &value, sizeof(value));
+}
+
+void recordInputEdge(uint8_t pin, uint8_t level) {
+  RecordInputEdge value = { pin, level };
+  record(RECORD_INPUT_EDGE, &value, sizeof(value));
+}
+
+void recordOutput(uint8_t levels) {
+  if (levels == lastOutputLevels) return;
+
+  lastOutputLevels = levels;
+  record(RECORD_OUTPUT, &levels, sizeof(levels));
+}
+
+void recordConfig(const Config &config) {
+  uint8_t value[CONFIG_MAX_LENGTH];
+  size_t length = encodeConfig(config, value);
+  record(RECORD_CONFIG, value, length);
+}
+
+int takeRecording(uint8_t *bytes, int size) {
+  int taken = 0;
+
+  noInterrupts();
+  while (taken < size && bufferCount > 0) {
+    bytes[taken++] = buffer[bufferTail];
+    bufferTail = (bufferTail + 1) % RECORDER_BUFFER_SIZE;
+    bufferCount--;
+  }
+  interrupts();
+
+  return taken;
+}
+
+#endif /* RECORD */
@@ -0,0 +1,64 @@
+/*
+  Recorder
+
+  Records every external input with its local time (s. recording.h for the format):
+  Connects and disconnects of Centrals, their writes (with the values and the
+  Connection-Events that delivered them) and subscriptions, and the edges of the input
+  pins. The local time is the number of SQW ticks (the time base of `millisRtc()`)
+  and `micros()` - the tick counts are recorded with every input. The levels of the
+  output channels are recorded as well, so a replay can be compared to the recording,
+  and the configuration (s. config.h), so a replay applies it.
+
+  Records are buffered until they are read by the host via `SERIAL_MSG_READ_RECORDING`
+  (s. `signalboy-cli record`) and replayed by `signalboy-replay` (s. `Host/replay`).
+  Recording starts at the end of `setup()`: A replay starts from the state after setup.
+
+  Enabled by defining `RECORD` (s. `Globals.hpp`): Otherwise, every function is empty.
+*/
+
+#ifndef recorder_h
+#define recorder_h
+
+#include <ArduinoBLE.h>
+#include "Globals.hpp"
+#include "recording.h"
+#include "configFormat.h"
+
+// Size (in bytes) of the buffer of the records not read, yet.
+#define RECORDER_BUFFER_SIZE 2048
+
+#ifdef RECORD
+
+/// Starts the recording (`RECORD_START`).
+void setupRecorder(void);
+
+void recordConnected(BLEDevice central);
+void recordDisconnected(BLEDevice central);
+/// Records the value written to `characteristic`. NOTE: Must be called from its handler.
+void recordWritten(BLEDevice central, BLECharacteristic characteristic);
+void recordSubscribed(BLEDevice central, BLECharacteristic characteristic);
+/// Records an edge of an input pin (also from ISRs).
+void recordInputEdge(uint8_t pin, uint8_t level);
+/// Records the levels of the output channels, if changed.
+void recordOutput(uint8_t levels);
+/// Records the configuration (s. config.h).
+void recordConfig(const Config &config);
+
+/// Moves up to `size` bytes of the recording to `bytes` (records may span calls).
+/// Returns the number of bytes moved.
+int takeRecording(uint8_t *bytes, int size);
+
+#else
+
+inline void setupRecorder(void) {}
+inline void recordConnected(BLEDevice central) {}
+inline void recordDisconnected(BLEDevice central) {}
+inline void recordWritten(BLEDevice central, BLECharacteristic characteristic) {}
+inline void recordSubscribed(BLEDevice central, BLECharacteristic characteristic) {}
+inline void recordInputEdge(uint8_t pin, uint8_t level) {}
+inline void recordOutput(uint8_t levels) {}
+inline void recordConfig(const Config &config) {}
+
+#endif /* RECORD */
+
+#endif /* recorder_h */
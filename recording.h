@@ -0,0 +1,139 @@
+/*
+  Recording
+
+  Format of the recording of the external inputs (s. recorder.h): A stream of records,
+  each a `RecordHeader` (its type, the length of its parameters and the local time it
+  has been recorded at), followed by its parameters (little-endian). The local time is
+  the number of SQW ticks (s. `rtcTicks()`) and `micros()`: Together with the inputs,
+  they determine the behaviour of the timers (s. `Host/replay`).
+
+  A recording starts with `RECORD_START`. Unknown types are skipped (by their length).
+
+  This header does not depend on the Arduino core: It is shared with the host tools
+  (s. `Host/`).
+*/
+
+#ifndef recording_h
+#define recording_h
+
+#include <stdint.h>
+
+#define RECORDING_FORMAT_VERSION 1
+
+#define RECORD_ADDRESS_SIZE 6
+#define RECORD_UUID_SIZE 16
+/// Maximum length of the parameters of a record.
+#define RECORD_MAX_LENGTH 64
+
+enum RecordType {
+  /// First record (at the end of `setup()`): `RecordStart`.
+  RECORD_START = 0x01,
+  /// A Central connected: `RecordCentral`.
+  RECORD_CONNECTED = 0x02,
+  /// A Central disconnected: `RecordCentral`.
+  RECORD_DISCONNECTED = 0x03,
+  /// A Central wrote a characteristic: `RecordWritten`, followed by the value.
+  RECORD_WRITTEN = 0x04,
+  /// A Central subscribed to a characteristic: `RecordSubscribed`.
+  RECORD_SUBSCRIBED = 0x05,
+  /// An edge of an input pin (capture or GPIO-input): `RecordInputEdge`.
+  RECORD_INPUT_EDGE = 0x06,
+  /// The levels of the output channels changed: `uint8_t` levels (bit `i`: channel `i`).
+  /// Not an input: Allows to compare the replayed outputs to the recorded ones.
+  RECORD_OUTPUT = 0x07,
+  /// Records have been dropped (the buffer was full): `uint16_t` number of records.
+  /// The recording cannot be replayed beyond.
+  RECORD_OVERFLOW = 0x08,
+  /// The configuration (s. config.h) at the start and whenever it changes: The encoded
+  /// configuration (s. `encodeConfig()`). Not an input: Applied before the replay continues.
+  RECORD_CONFIG = 0x09,
+};
+
+struct __attribute__((packed)) RecordHeader {
+  uint8_t type;
+  /// Length of the parameters following the header.
+  uint8_t length;
+  /// Number of SQW ticks (s. `rtcTicks()`).
+  uint32_t ticks;
+  /// in µs (`micros()`)
+  uint32_t time;
+};
+
+struct __attribute__((packed)) RecordStart {
+  uint8_t formatVersion;
+  uint8_t softwareRevision;
+};
+
+struct __attribute__((packed)) RecordCentral {
+  /// The Central's address (most significant byte first).
+  uint8_t address[RECORD_ADDRESS_SIZE];
+};
+
+struct __attribute__((packed)) RecordWritten {
+  uint8_t address[RECORD_ADDRESS_SIZE];
+  /// The characteristic's (128-bit) UUID (most significant byte first).
+  uint8_t uuid[RECORD_UUID_SIZE];
+  /// The Connection-Event that delivered the value (s. connection.h): Time (unsynced,
+  /// in ms) of its anchor, ...
+  uint32_t connectionEventTime;
+  /// ... offset (in µs) of the reception relative to its anchor ...
+  uint32_t rxOffset;
+  /// ... and the Connection-Interval (in µs).
+  uint32_t connectionInterval;
+};
+
+struct __attribute__((packed)) RecordSubscribed {
+  uint8_t address[RECORD_ADDRESS_SIZE];
+  uint8_t uuid[RECORD_UUID_SIZE];
+};
+
+struct __attribute__((packed)) RecordInputEdge {
+  uint8_t pin;
+  uint8_t level;
+};
+
+inline int parseRecordHexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+/// Parses the hex digits of `string` (i.e. an address "aa:bb:cc:dd:ee:ff" or a UUID,
+/// skipping any separators) into `size` bytes. Returns `false`, if too short.
+inline bool packRecordHex(const char *string, uint8_t *bytes, int size) {
+  int count = 0;
+  for (; *string && count < 2 * size; string++) {
+    int digit = parseRecordHexDigit(*string);
+    if (digit < 0) continue;
+
+    bytes[count / 2] = (count % 2) ? (bytes[count / 2] | digit) : (uint8_t)(digit << 4);
+    count++;
+  }
+
+  return count == 2 * size;
+}
+
+/// Formats an address ("aa:bb:cc:dd:ee:ff", 18 bytes including the terminator).
+inline void formatRecordAddress(const uint8_t address[RECORD_ADDRESS_SIZE], char *string) {
+  static const char digits[] = "0123456789abcdef";
+  for (int i = 0; i < RECORD_ADDRESS_SIZE; i++) {
+    *string++ = digits[address[i] >> 4];
+    *string++ = digits[address[i] & 0xf];
+    if (i < RECORD_ADDRESS_SIZE - 1) *string++ = ':';
+  }
+  *string = '\0';
+}
+
+/// Formats a UUID ("92360002-7858-41a5-b0cc-942dd4189715", 37 bytes including the terminator).
+inline void formatRecordUuid(const uint8_t uuid[RECORD_UUID_SIZE], char *string) {
+  static const char digits[] = "0123456789abcdef";
+  for (int i = 0; i < RECORD_UUID_SIZE; i++) {
+    if (i == 4 || i == 6 || i == 8 || i == 10) *string++ = '-';
+    *string++ = digits[uuid[i] >> 4];
+    *string++ = digits[uuid[i] & 0xf];
+  }
+  *string = '\0';
+}
+
+#endif /* recording_h */
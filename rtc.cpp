@@ -12,6 +12,8 @@ unsigned long _millis = 0;
 unsigned int errorFract = 0;
 // counter; set in interrupt callback
 volatile unsigned int tickTock = 0;
+// Time (in µs, `micros()`) of the last tick; set in interrupt callback
+volatile unsigned long lastTickTime = 0;
 unsigned int lastTickTock = 0;
 
 void printSqwMode() {
@@ -31,6 +33,7 @@ void printSqwMode() {
 // INT0 interrupt callback
 void pps_tick(void) {
   tickTock++;
+  lastTickTime = micros();
 }
 
 void setupRtc() {
@@ -54,6 +57,22 @@ void setupRtc() {
   printSqwMode();
 }
 
+static unsigned long updateMillis(unsigned int tickTockCopy) {
+  while (tickTockCopy - lastTickTock > 0) {
+    _millis++;
+    lastTickTock++;
+    errorFract += ERROR_FRACT_INC;
+
+    // Apply correction (SQW's frequency is set to 1024Hz).
+    if (errorFract >= 1024) {
+      _millis--;
+      errorFract -= 1024;
+    }
+  }
+
+  return _millis;
+}
+
 unsigned long millisRtc(bool skipSuspendInterrupts) {
   unsigned int tickTockCopy;
 
@@ -67,17 +86,27 @@ unsigned long millisRtc(bool skipSuspendInterrupts) {
     interrupts();
   }
 
-  while (tickTockCopy - lastTickTock > 0) {
-    _millis++;
-    lastTickTock++;
-    errorFract += ERROR_FRACT_INC;
+  return updateMillis(tickTockCopy);
+}
 
-    // Apply correction (SQW's frequency is set to 1024Hz).
-    if (errorFract >= 1024) {
-      _millis--;
-      errorFract -= 1024;
-    }
-  }
+unsigned int rtcTicks(void) {
+  // A single (aligned) word: Read atomically (also from ISRs).
+  return tickTock;
+}
 
-  return _millis;
+unsigned long rtcLastTickMicros(void) {
+  // A single (aligned) word: Read atomically (also from ISRs).
+  return lastTickTime;
+}
+
+unsigned long microsAtMillisRtc(unsigned long t) {
+  noInterrupts();
+  unsigned int tickTockCopy = tickTock;  // capture values (volatile variables)
+  unsigned long lastTickTimeCopy = lastTickTime;
+  interrupts();
+
+  // The last tick advanced `millisRtc()` to its current value (approximately: Some
+  // ticks are skipped by the correction).
+  unsigned long elapsed = updateMillis(tickTockCopy) - t;  // in ms
+  return lastTickTimeCopy - elapsed * 1000UL;
 }
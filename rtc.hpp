@@ -6,3 +6,33 @@ void pps_tick(void);
 void setupRtc();
 
 unsigned long millisRtc(bool skipSuspendInterrupts);
+/// Number of SQW ticks (1.024 kHz) since startup: The time base of `millisRtc()`.
+unsigned int rtcTicks(void);
+/// The local time (`millisRtc()`) after `ticks` SQW ticks: Every tick advances it by
+/// 1 ms, corrected by 24 ms per 1024 ticks.
+inline unsigned long millisFromRtcTicks(unsigned int ticks) {
+  return (unsigned long)(ticks - (unsigned long long)ticks * (1024 - 1000) / 1024);
+}
+/// Time (in µs, `micros()`) of the last SQW tick.
+unsigned long rtcLastTickMicros(void);
+/// Estimates the time (in µs, `micros()`) at which `millisRtc()` advanced to
+/// the (recent) local time `t`.
+unsigned long microsAtMillisRtc(unsigned long t);
+/// Time (in µs, `micros()`) of the SQW tick that advanced `millisRtc()` to the (recent)
+/// local time `t`: Counted back from the last tick by the ticks' period (976.5625 µs),
+/// the ms skipped by the correction included (unlike `microsAtMillisRtc()`).
+inline unsigned long rtcTickMicrosAtMillis(unsigned long t) {
+  unsigned int lastTicks;
+  unsigned long lastTickMicros;
+  // (Read again, if a tick interrupted the reads.)
+  do {
+    lastTicks = rtcTicks();
+    lastTickMicros = rtcLastTickMicros();
+  } while (rtcTicks() != lastTicks);
+
+  // The first tick of `t`
+  unsigned int ticks = lastTicks;
+  while (ticks > 0 && (long)(millisFromRtcTicks(ticks - 1) - t) >= 0) ticks--;
+
+  return lastTickMicros - (unsigned long)(((unsigned long long)(lastTicks - ticks) * 1000000 + 512) / 1024);
+}
@@ -0,0 +1,316 @@
+#include <Arduino.h>
+#include "scheduler.h"
+#include "constants.h"
+#include "Globals.hpp"
+#include "Logger.hpp"
+#include "faultLog.h"
+#include "rtc.hpp"
+#include "trace.h"
+
+struct Timer {
+  bool isArmed;
+  bool hasFired;
+  /// The clock `targetTime` is specified in, or `nullptr` for local time (unsynced).
+  SyncedClock *clock;
+  /// Time at which the timer begins to fire.
+  unsigned long targetTime;
+  uint8_t channel;
+  timerSource_t source;
+  /// `true`, if the timer emits the pulse train of `pulseCode`.
+  bool isCoded;
+  PulseCode pulseCode;
+};
+
+static Timer timers[SCHEDULER_CAPACITY];
+
+/// in ms
+static unsigned long channelPulseWidths[SCHEDULER_MAX_CHANNELS] = {
+  SIGNAL_HIGH_INTERVAL_DEFAULT, SIGNAL_HIGH_INTERVAL_DEFAULT, SIGNAL_HIGH_INTERVAL_DEFAULT, SIGNAL_HIGH_INTERVAL_DEFAULT,
+  SIGNAL_HIGH_INTERVAL_DEFAULT, SIGNAL_HIGH_INTERVAL_DEFAULT, SIGNAL_HIGH_INTERVAL_DEFAULT, SIGNAL_HIGH_INTERVAL_DEFAULT,
+};
+
+/// in ms
+static long outputLatencyCompensation = 0;
+
+/// Time (in µs) of the SQW tick at which the last calibration timer became due.
+static unsigned long calibrationTimerDueMicros = 0;
+
+static const char *getSourceLabel(timerSource_t source) {
+  switch (source) {
+    case timerSourceSCHEDULED: return "Scheduled Timer";
+    case timerSourceTRIGGER: return "Trigger Timer";
+    case timerSourceBROADCAST: return "Broadcast Timer";
+    case timerSourceCALIBRATION: return "Calibration Timer";
+  }
+  return "";
+}
+
+static unsigned long getLocalTargetTime(Timer &timer) {
+  return timer.clock ? toLocalTime(*timer.clock, timer.targetTime) : timer.targetTime;
+}
+
+/// The local time at which the timer begins to fire (compensated for the output latency).
+static unsigned long getLocalFireTime(Timer &timer) {
+  unsigned long targetTime = getLocalTargetTime(timer);
+  if (timer.source == timerSourceCALIBRATION || timer.hasFired) return targetTime;
+
+  return targetTime - outputLatencyCompensation;
+}
+
+/// Fixes the timer at local time `targetTime`.
+static void setLocalTargetTime(Timer &timer, unsigned long targetTime) {
+  timer.clock = nullptr;
+  timer.targetTime = targetTime;
+}
+
+static bool armTimer(SyncedClock *clock, unsigned long targetTime, uint8_t channel, const PulseCode *pulseCode, timerSource_t source) {
+  if (channel >= SCHEDULER_MAX_CHANNELS) {
+    Log.printTimestamp();
+    Log.print("WARNING: Invalid channel (");
+    Log.print(channel);
+    Log.println(")! Dropping timer.");
+    reportFault(FAULT_DOMAIN_TIMER, FAULT_CODE_INVALID_CHANNEL, channel);
+    return false;
+  }
+
+  for (int i = 0; i < SCHEDULER_CAPACITY; i++) {
+    Timer &timer = timers[i];
+    if (!timer.isArmed) {
+      timer.clock = clock;
+      timer.targetTime = targetTime;
+      timer.channel = channel;
+      timer.source = source;
+      timer.isCoded = pulseCode != nullptr;
+      if (pulseCode) timer.pulseCode = *pulseCode;
+      timer.hasFired = false;
+      timer.isArmed = true;
+      return true;
+    }
+  }
+
+  Log.printTimestamp();
+  Log.print("WARNING: Every timer is armed! Dropping timer (");
+  Log.print(getSourceLabel(source));
+  Log.println(").");
+  reportFault(FAULT_DOMAIN_TIMER, FAULT_CODE_NO_TIMER_AVAILABLE, source);
+  return false;
+}
+
+void setChannelPulseWidth(uint8_t channel, unsigned long width) {
+  if (channel < SCHEDULER_MAX_CHANNELS) {
+    channelPulseWidths[channel] = width;
+  }
+}
+
+bool armTimer(unsigned long targetTime, uint8_t channel, timerSource_t source) {
+  return armTimer(nullptr, targetTime, channel, nullptr, source);
+}
+
+bool armTimer(SyncedClock &clock, unsigned long targetTime, uint8_t channel, timerSource_t source) {
+  return armTimer(&clock, targetTime, channel, nullptr, source);
+}
+
+bool armCodedTimer(SyncedClock &clock, unsigned long targetTime, uint8_t channel, PulseCode pulseCode, timerSource_t source) {
+  return armTimer(&clock, targetTime, channel, &pulseCode, source);
+}
+
+bool armCodedTimer(unsigned long targetTime, uint8_t channel, PulseCode pulseCode, timerSource_t source) {
+  return armTimer(nullptr, targetTime, channel, &pulseCode, source);
+}
+
+void rebaseTimers(SyncedClock &clock, long step) {
+  if (step == 0) return;
+
+  unsigned long localTime = millisRtc(false);
+  for (int i = 0; i < SCHEDULER_CAPACITY; i++) {
+    Timer &timer = timers[i];
+    if (!timer.isArmed || timer.clock != &clock) continue;
+
+    Log.printTimestamp();
+    Log.print("Rebasing timer (");
+    Log.print(getSourceLabel(timer.source));
+    Log.print(") by ");
+    Log.print(-step);
+    Log.println(" ms (clock stepped).");
+
+    long elapsed = (long)(localTime - getLocalFireTime(timer));
+    if (elapsed > (long)TIMER_LATENESS_TOLERANCE) {
+      // Fire late rather than never.
+      setLocalTargetTime(timer, localTime);
+    }
+  }
+}
+
+void releaseTimers(SyncedClock &clock) {
+  for (int i = 0; i < SCHEDULER_CAPACITY; i++) {
+    Timer &timer = timers[i];
+    if (timer.isArmed && timer.clock == &clock) {
+      setLocalTargetTime(timer, getLocalTargetTime(timer));
+    }
+  }
+}
+
+void setOutputLatencyCompensation(long compensation) {
+  outputLatencyCompensation = (compensation + (compensation >= 0 ? 500L : -500L)) / 1000L;
+}
+
+unsigned long lastCalibrationTimerDueMicros(void) {
+  return calibrationTimerDueMicros;
+}
+
+bool isAnyTimerArmed(void) {
+  for (int i = 0; i < SCHEDULER_CAPACITY; i++) {
+    if (timers[i].isArmed) return true;
+  }
+
+  return false;
+}
+
+int armedTimersCount(void) {
+  int count = 0;
+  for (int i = 0; i < SCHEDULER_CAPACITY; i++) {
+    if (timers[i].isArmed) count++;
+  }
+
+  return count;
+}
+
+bool nextTimerDeadline(unsigned long *deadline) {
+  return nextTimerDeadline(millisRtc(false), deadline);
+}
+
+bool nextTimerDeadline(unsigned long localTime, unsigned long *deadline) {
+  bool hasDeadline = false;
+
+  for (int i = 0; i < SCHEDULER_CAPACITY; i++) {
+    Timer &timer = timers[i];
+    if (!timer.isArmed) continue;
+
+    unsigned long time = getLocalFireTime(timer);
+    if (timer.hasFired) {
+      // The pulse ends (s. `updateTimers()`).
+      time += channelPulseWidths[timer.channel] + 1;
+    }
+
+    if (!hasDeadline || (long)(time - localTime) < (long)(*deadline - localTime)) {
+      *deadline = time;
+      hasDeadline = true;
+    }
+  }
+
+  return hasDeadline;
+}
+
+uint8_t updateTimers(void) {
+  unsigned long localTime = millisRtc(false);
+  uint8_t levels = 0;
+
+  for (int i = 0; i < SCHEDULER_CAPACITY; i++) {
+    Timer &timer = timers[i];
+    if (!timer.isArmed || timer.isCoded) continue;
+
+    long elapsed = (long)(localTime - getLocalFireTime(timer));
+    if (elapsed < 0) continue;
+
+    long width = (long)channelPulseWidths[timer.channel];
+    if (!timer.hasFired) {
+      if (elapsed > (long)TIMER_LATENESS_TOLERANCE) {
+        TRACE_INSTANT(TRACE_POINT_TIMER_MISSED, timer.channel);
+        TRACE_FREEZE();
+        Log.printTimestamp();
+        Log.print("WARNING: Missed timer (");
+        Log.print(getSourceLabel(timer.source));
+        Log.println(")!");
+        reportFault(FAULT_DOMAIN_TIMER, FAULT_CODE_MISSED_TIMER, timer.source, timer.channel);
+
+        // Invalidate timer
+        timer.isArmed = false;
+        continue;
+      }
+
+      // (Measured from the tick it became due: Its latency includes the loop's.)
+      if (timer.source == timerSourceCALIBRATION) {
+        calibrationTimerDueMicros = rtcTickMicrosAtMillis(localTime - elapsed);
+      }
+
+      // Late by more than the pulse width (i.e. blocked loop): The pulse starts now.
+      if (elapsed > width) {
+        TRACE_INSTANT(TRACE_POINT_TIMER_LATE, timer.channel);
+        TRACE_FREEZE();
+        elapsed = 0;
+      }
+      // The signal's duration is not affected by subsequent corrections of the clock.
+      setLocalTargetTime(timer, localTime - elapsed);
+      timer.hasFired = true;
+      TRACE_INSTANT(TRACE_POINT_TIMER_FIRED, timer.channel);
+
+      Log.print(localTime);
+      Log.print(" ms (millisRtc) -> ");
+      Log.print("Fire! (");
+      Log.print(getSourceLabel(timer.source));
+      Log.print(", channel: ");
+      Log.print(timer.channel);
+      Log.println(")");
+    }
+
+    if (elapsed <= width) {
+      // Turn on
+      levels |= 1 << timer.channel;
+    } else {
+      // Invalidate timer
+      timer.isArmed = false;
+    }
+  }
+
+  return levels;
+}
+
+bool takeDueCodedTimer(PulseCode *pulseCode, uint8_t *channel) {
+  unsigned long localTime = millisRtc(false);
+  // The earliest due timer and its elapsed time
+  Timer *dueTimer = nullptr;
+  long dueElapsed = 0;
+
+  for (int i = 0; i < SCHEDULER_CAPACITY; i++) {
+    Timer &timer = timers[i];
+    if (!timer.isArmed || !timer.isCoded) continue;
+
+    long elapsed = (long)(localTime - getLocalFireTime(timer));
+    if (elapsed < 0) continue;
+
+    if (elapsed > (long)TIMER_LATENESS_TOLERANCE) {
+      TRACE_INSTANT(TRACE_POINT_TIMER_MISSED, timer.channel);
+      TRACE_FREEZE();
+      Log.printTimestamp();
+      Log.print("WARNING: Missed coded timer (");
+      Log.print(getSourceLabel(timer.source));
+      Log.println(")!");
+      reportFault(FAULT_DOMAIN_TIMER, FAULT_CODE_MISSED_TIMER, timer.source, timer.channel);
+
+      // Invalidate timer
+      timer.isArmed = false;
+    } else if (!dueTimer || elapsed > dueElapsed) {
+      dueTimer = &timer;
+      dueElapsed = elapsed;
+    }
+  }
+
+  if (!dueTimer) return false;
+
+  TRACE_INSTANT(TRACE_POINT_TIMER_FIRED, dueTimer->channel);
+  Log.print(localTime);
+  Log.print(" ms (millisRtc) -> ");
+  Log.print("Fire! (");
+  Log.print(getSourceLabel(dueTimer->source));
+  Log.print(", channel: ");
+  Log.print(dueTimer->channel);
+  Log.print(", code: ");
+  Log.print(dueTimer->pulseCode.code);
+  Log.println(")");
+
+  // Invalidate timer: The pulse train is emitted by the caller.
+  dueTimer->isArmed = false;
+  *pulseCode = dueTimer->pulseCode;
+  *channel = dueTimer->channel;
+  return true;
+}
@@ -0,0 +1,90 @@
+/*
+  Output-Scheduler
+
+  Timers armed by any Central (or the input) are collected by a single scheduler.
+  Timers store absolute target times: Either in local time (unsynced: `millisRtc()`),
+  or in the synced time of a Central's clock. The latter follow any correction of
+  the clock (slewed or stepped, s. `setTime()`) until they fire.
+
+  Every timer fires on an output channel: A single pass over the timers yields the
+  levels of every channel (s. `updateTimers()`), each channel with its own pulse width.
+
+  Coded timers emit a pulse train (s. pulseCode.h) instead of the pulse: They are
+  taken from the scheduler, once due (s. `takeDueCodedTimer()`).
+*/
+
+#ifndef scheduler_h
+#define scheduler_h
+
+#include "time.h"
+#include "pulseCode.h"
+
+// Maximum number of simultaneously armed timers.
+#define SCHEDULER_CAPACITY 8
+// Maximum number of output channels (bits of the levels returned by `updateTimers()`).
+#define SCHEDULER_MAX_CHANNELS 8
+// The channel of the Target-Timestamp, the Trigger-Timer and the calibration.
+#define SCHEDULER_DEFAULT_CHANNEL 0
+
+typedef enum {
+  /// Armed with a Target-Timestamp (synced time).
+  timerSourceSCHEDULED,
+  /// Armed by the Trigger-Timer characteristic (or input).
+  timerSourceTRIGGER,
+  /// Armed by a Broadcast-Advertisement (s. observer.h).
+  timerSourceBROADCAST,
+  /// Armed by the output calibration (s. calibration.h): Not compensated.
+  timerSourceCALIBRATION,
+} timerSource_t;
+
+/// Sets the pulse width (in ms) of `channel` (default: `SIGNAL_HIGH_INTERVAL_DEFAULT`).
+void setChannelPulseWidth(uint8_t channel, unsigned long width);
+
+/// Arms a timer that fires on `channel` at local time `targetTime` for the
+/// channel's pulse width.
+///
+/// Returns `false`, if every timer is armed already.
+bool armTimer(unsigned long targetTime, uint8_t channel, timerSource_t source);
+/// Arms a timer that fires on `channel` at the synced time `targetTime` of `clock`.
+bool armTimer(SyncedClock &clock, unsigned long targetTime, uint8_t channel, timerSource_t source);
+/// Arms a coded timer that fires on `channel` at the synced time `targetTime` of `clock`.
+bool armCodedTimer(SyncedClock &clock, unsigned long targetTime, uint8_t channel, PulseCode pulseCode, timerSource_t source);
+/// Arms a coded timer that fires on `channel` at local time `targetTime`.
+bool armCodedTimer(unsigned long targetTime, uint8_t channel, PulseCode pulseCode, timerSource_t source);
+
+/// Handles a step of `clock` by `step` ms (s. `setTime()`): Timers, whose
+/// target time has been moved into the past by the step, fire immediately
+/// (instead of being missed).
+void rebaseTimers(SyncedClock &clock, long step);
+/// Fixes the timers of `clock` at their current local target time
+/// (i.e. before the clock is discarded).
+void releaseTimers(SyncedClock &clock);
+
+/// Timers fire earlier by the output latency `compensation` (in µs, rounded to ms).
+void setOutputLatencyCompensation(long compensation);
+
+/// Time (in µs, `micros()`) of the SQW tick at which the last calibration timer (s.
+/// `timerSourceCALIBRATION`) that fired became due: The reference of its latency.
+unsigned long lastCalibrationTimerDueMicros(void);
+
+/// `true`, if any timer is armed (and has not finished firing, yet).
+bool isAnyTimerArmed(void);
+/// Number of armed timers (s. `isAnyTimerArmed()`).
+int armedTimersCount(void);
+/// The next local time, at which any timer begins or ends firing (or is due, if coded):
+/// The loop must not sleep through it (s. idle.h). Returns `false`, if no timer is armed.
+bool nextTimerDeadline(unsigned long *deadline);
+/// The next deadline after the local time `localTime` (i.e. from ISRs, s. watchdog.h).
+bool nextTimerDeadline(unsigned long localTime, unsigned long *deadline);
+
+/// Returns the levels of the channels (bit `i`: channel `i`) at the current local time:
+/// A channel is HIGH, if any (uncoded) timer is firing on it. Timers that have finished
+/// firing (or were missed) are invalidated.
+uint8_t updateTimers(void);
+/// Takes the next coded timer due at the current local time: Its pulse train is to
+/// be emitted immediately on `channel`. Missed coded timers are invalidated.
+///
+/// Returns `false`, if no coded timer is due.
+bool takeDueCodedTimer(PulseCode *pulseCode, uint8_t *channel);
+
+#endif /* scheduler_h */
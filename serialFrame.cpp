@@ -0,0 +1,125 @@
+#include <string.h>
+#include "serialFrame.h"
+
+// Size of the CRC appended to the payload.
+#define CRC_SIZE 2
+
+uint16_t crc16(const uint8_t *data, size_t length) {
+  uint16_t crc = 0xffff;
+
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+
+  return crc;
+}
+
+size_t cobsEncode(const uint8_t *data, size_t length, uint8_t *out) {
+  size_t codeIndex = 0;
+  size_t writeIndex = 1;
+  uint8_t code = 1;
+
+  for (size_t i = 0; i < length; i++) {
+    if (data[i] == 0) {
+      out[codeIndex] = code;
+      code = 1;
+      codeIndex = writeIndex++;
+    } else {
+      out[writeIndex++] = data[i];
+      code++;
+
+      if (code == 0xff) {
+        // Maximum block length: Start a new block.
+        out[codeIndex] = code;
+        code = 1;
+        codeIndex = writeIndex++;
+      }
+    }
+  }
+  out[codeIndex] = code;
+
+  return writeIndex;
+}
+
+size_t cobsDecode(const uint8_t *data, size_t length, uint8_t *out) {
+  size_t readIndex = 0;
+  size_t writeIndex = 0;
+  // Every block but a maximum length block (and the last one) is followed by a zero.
+  bool isZeroPending = false;
+
+  while (readIndex < length) {
+    uint8_t code = data[readIndex++];
+    if (code == 0) return 0;
+
+    // (Written only after the next code has been read: Allows to decode in place.)
+    if (isZeroPending) {
+      out[writeIndex++] = 0;
+    }
+
+    for (uint8_t i = 1; i < code; i++) {
+      if (readIndex >= length || data[readIndex] == 0) return 0;
+      out[writeIndex++] = data[readIndex++];
+    }
+    isZeroPending = code != 0xff;
+  }
+
+  return writeIndex;
+}
+
+size_t encodeSerialFrame(const uint8_t *payload, size_t length, uint8_t *out) {
+  if (length > SERIAL_FRAME_MAX_PAYLOAD_SIZE) return 0;
+
+  uint8_t data[SERIAL_FRAME_MAX_PAYLOAD_SIZE + CRC_SIZE];
+  memcpy(data, payload, length);
+
+  uint16_t crc = crc16(payload, length);
+  data[length] = crc & 0xff;
+  data[length + 1] = crc >> 8;
+
+  size_t size = cobsEncode(data, length + CRC_SIZE, out);
+  out[size++] = 0;
+
+  return size;
+}
+
+void initSerialFrameDecoder(SerialFrameDecoder &decoder) {
+  decoder.length = 0;
+  decoder.isDiscarding = false;
+}
+
+int feedSerialFrameDecoder(SerialFrameDecoder &decoder, uint8_t value, uint8_t *payload) {
+  if (value != 0) {
+    if (decoder.isDiscarding) return 0;
+
+    // Keep room for the terminator.
+    if (decoder.length >= SERIAL_FRAME_MAX_SIZE - 1) {
+      decoder.isDiscarding = true;
+      return 0;
+    }
+
+    decoder.buffer[decoder.length++] = value;
+    return 0;
+  }
+
+  // Terminator
+  size_t length = decoder.length;
+  bool isDiscarding = decoder.isDiscarding;
+  initSerialFrameDecoder(decoder);
+
+  if (isDiscarding) return -1;
+  if (length == 0) return 0;
+
+  // The decoded data is never longer than the encoded data: Decode in place.
+  size_t size = cobsDecode(decoder.buffer, length, decoder.buffer);
+  if (size <= CRC_SIZE || size - CRC_SIZE > SERIAL_FRAME_MAX_PAYLOAD_SIZE) return -1;
+
+  size -= CRC_SIZE;
+  uint16_t crc = decoder.buffer[size] | (decoder.buffer[size + 1] << 8);
+  if (crc != crc16(decoder.buffer, size)) return -1;
+
+  memcpy(payload, decoder.buffer, size);
+  return (int)size;
+}
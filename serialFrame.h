@@ -0,0 +1,56 @@
+/*
+  Serial-Frame
+
+  Framing of the Serial-Protocol (s. serialProtocol.h): Every frame is the COBS-encoded
+  payload followed by its CRC-16 (CCITT-FALSE, little-endian), terminated by a zero byte.
+  As COBS eliminates every zero byte from the encoded data, the receiver resynchronizes at
+  the next terminator after any corrupted or truncated frame.
+
+  This module does not depend on the Arduino core: It is shared with the host tools
+  (s. `Host/`).
+*/
+
+#ifndef serialFrame_h
+#define serialFrame_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Maximum size of a (decoded) payload.
+#define SERIAL_FRAME_MAX_PAYLOAD_SIZE 72
+// Maximum size of an encoded frame: The payload and its CRC, the COBS overhead
+// (1 byte per 254 bytes), and the terminator.
+#define SERIAL_FRAME_MAX_SIZE (SERIAL_FRAME_MAX_PAYLOAD_SIZE + 2 + 1 + 1)
+
+/// Reassembles the frames of a byte stream.
+struct SerialFrameDecoder {
+  uint8_t buffer[SERIAL_FRAME_MAX_SIZE];
+  size_t length;
+  /// `true`, while skipping the remainder of an oversized frame.
+  bool isDiscarding;
+};
+
+uint16_t crc16(const uint8_t *data, size_t length);
+
+/// Encodes `length` bytes into `out` (at least `length + length / 254 + 1` bytes).
+/// Returns the encoded size.
+size_t cobsEncode(const uint8_t *data, size_t length, uint8_t *out);
+/// Decodes `length` bytes (without terminator) into `out` (at least `length` bytes).
+/// Returns the decoded size, or 0 if the data is malformed.
+size_t cobsDecode(const uint8_t *data, size_t length, uint8_t *out);
+
+/// Encodes the frame of `payload` (up to `SERIAL_FRAME_MAX_PAYLOAD_SIZE` bytes) into `out`
+/// (`SERIAL_FRAME_MAX_SIZE` bytes). Returns the frame's size (including the terminator),
+/// or 0 if the payload is too large.
+size_t encodeSerialFrame(const uint8_t *payload, size_t length, uint8_t *out);
+
+void initSerialFrameDecoder(SerialFrameDecoder &decoder);
+/// Feeds a received byte to the decoder (an empty frame is ignored: A sender may
+/// prepend a terminator to flush any partial frame).
+///
+/// Returns the size of the payload (copied to `payload`: `SERIAL_FRAME_MAX_PAYLOAD_SIZE`
+/// bytes) once a frame is complete, -1 if the completed frame is invalid (malformed,
+/// oversized or failing the CRC), and 0 otherwise.
+int feedSerialFrameDecoder(SerialFrameDecoder &decoder, uint8_t value, uint8_t *payload);
+
+#endif /* serialFrame_h */
@@ -0,0 +1,250 @@
+/*
+  Serial-Messages
+
+  Messages of the Serial-Protocol (s. serialProtocol.h). The payload of every frame
+  (s. serialFrame.h) starts with the message's type and a sequence number, followed by
+  its parameters (little-endian).
+
+  Requests are answered by a response of type `request.type | SERIAL_MSG_RESPONSE`
+  with the request's sequence number: Its parameters start with a status (`SerialStatus`).
+  Notifications are sent unsolicited (with sequence number 0).
+
+  This header does not depend on the Arduino core: It is shared with the host tools
+  (s. `Host/`).
+*/
+
+#ifndef serialMessages_h
+#define serialMessages_h
+
+#include <stdint.h>
+#include "configFormat.h"
+#include "fault.h"
+#include "stall.h"
+#include "traceEvents.h"
+
+#define SERIAL_PROTOCOL_VERSION 13
+
+// Maximum number of Target-Timestamps of a single `SERIAL_MSG_SCHEDULE`-request
+// (or `SERIAL_MSG_CODED_SCHEDULE`- or `SERIAL_MSG_CHANNEL_SCHEDULE`-request).
+#define SERIAL_SCHEDULE_MAX_TARGETS 8
+
+// Maximum number of trace events of a single `SERIAL_MSG_READ_TRACE`-response.
+#define SERIAL_TRACE_MAX_EVENTS 8
+// Maximum number of bytes of a single `SERIAL_MSG_READ_RECORDING`-response.
+#define SERIAL_RECORDING_MAX_LENGTH 64
+
+enum SerialMessageType {
+  /// Mirrors the `targetTimestamp`-Characteristic: `uint32_t` target timestamp (synced time).
+  SERIAL_MSG_TARGET_TIMESTAMP = 0x01,
+  /// Schedules a batch of signals: Up to `SERIAL_SCHEDULE_MAX_TARGETS` `uint32_t` target
+  /// timestamps (synced time).
+  SERIAL_MSG_SCHEDULE = 0x02,
+  /// Mirrors the `triggerTimer`-Characteristic: `uint8_t` delay (in ms) relative to the
+  /// reception of the request.
+  SERIAL_MSG_TRIGGER = 0x03,
+  /// Mirrors the `referenceTimestamp`-Characteristic (Training): `uint32_t` reference timestamp.
+  SERIAL_MSG_REFERENCE_TIMESTAMP = 0x04,
+  /// Mirrors the `wiredReferenceTimestamp`-Characteristic (s. wiredSync.h): `uint32_t`
+  /// reference timestamp of the last pulse.
+  SERIAL_MSG_WIRED_REFERENCE_TIMESTAMP = 0x05,
+  /// Round-trip sync: `uint32_t` host timestamp (echoed). The response holds the
+  /// local times the request has been received and the response has been sent
+  /// (s. `SerialSyncResponse`).
+  SERIAL_MSG_SYNC = 0x06,
+  /// Sets the synced time established by round-trip sync (s. `SerialSetTimeRequest`).
+  SERIAL_MSG_SET_TIME = 0x07,
+  /// Schedules a batch of coded signals (s. pulseCode.h): `uint16_t` unit width (in µs,
+  /// 0 for `PULSE_CODE_UNIT_WIDTH_DEFAULT`), followed by up to `SERIAL_SCHEDULE_MAX_TARGETS`
+  /// `SerialCodedTarget`s.
+  SERIAL_MSG_CODED_SCHEDULE = 0x08,
+  /// Schedules a batch of signals on an output channel: `uint8_t` channel, followed by up
+  /// to `SERIAL_SCHEDULE_MAX_TARGETS` `uint32_t` target timestamps (synced time).
+  SERIAL_MSG_CHANNEL_SCHEDULE = 0x09,
+  /// Starts the calibration of the output (s. calibration.h), as the UI's menu does: The
+  /// result is read by `SERIAL_MSG_READ_DIAGNOSTICS`. Rejected while calibrating.
+  SERIAL_MSG_CALIBRATE = 0x0a,
+  /// Mirrors writing the `configuration`-Characteristic (s. config.h), but unauthenticated:
+  /// The entries to change (s. configFormat.h). Answered by `SerialConfigResponse` (with
+  /// `SERIAL_STATUS_INVALID_PARAMETER`, if rejected: s. `CONFIG_TAG_STATUS` for the reason).
+  SERIAL_MSG_CONFIGURE = 0x0b,
+  /// Provisions the key of a broadcaster of the Broadcast-Observer (s. observer.h):
+  /// `SerialBroadcasterKey` (an all-zero key revokes the broadcaster). Answered by
+  /// `SERIAL_STATUS_INVALID_PARAMETER`, if the broadcaster id is out of range, and by
+  /// `SERIAL_STATUS_UNKNOWN_MESSAGE`, unless the sketch is built with `OBSERVER_MODE`.
+  SERIAL_MSG_PROVISION_BROADCASTER = 0x0c,
+  /// Provisions the key authenticating the writes of the Centrals to the `configuration`-
+  /// Characteristic (s. config.h): `SerialConfigKey` (an all-zero key revokes it).
+  SERIAL_MSG_PROVISION_CONFIG_KEY = 0x0d,
+  /// Reads `SerialInfo`.
+  SERIAL_MSG_READ_INFO = 0x10,
+  /// Reads `SerialDiagnostics`.
+  SERIAL_MSG_READ_DIAGNOSTICS = 0x11,
+  /// Takes the oldest events of the timeline trace (s. trace.h), s. `SerialTraceResponse`:
+  /// Repeated until the response holds no events. Answered by `SERIAL_STATUS_UNKNOWN_MESSAGE`,
+  /// unless the sketch is built with `TRACE`.
+  SERIAL_MSG_READ_TRACE = 0x12,
+  /// Takes the oldest bytes of the recording of the inputs (s. recorder.h), s.
+  /// `SerialRecordingResponse`. Answered by `SERIAL_STATUS_UNKNOWN_MESSAGE`, unless the
+  /// sketch is built with `RECORD`.
+  SERIAL_MSG_READ_RECORDING = 0x13,
+  /// Reads the stalls of the loop captured by the watchdog (s. watchdog.h), s.
+  /// `SerialStallsResponse`. Answered by `SERIAL_STATUS_UNKNOWN_MESSAGE`, unless the
+  /// sketch is built with `WATCHDOG`.
+  SERIAL_MSG_READ_STALLS = 0x14,
+  /// Reads the effective configuration (s. config.h), s. `SerialConfigResponse`.
+  SERIAL_MSG_READ_CONFIG = 0x15,
+  /// Mirrors the `faultLog`-Characteristic (s. faultLog.h): `uint8_t` index of the first
+  /// fault to read (0: the latest one), s. `SerialFaultsResponse`.
+  SERIAL_MSG_READ_FAULTS = 0x16,
+
+  /// Notification mirroring the `timeNeedsSync`-Characteristic: `uint8_t` value
+  /// (s. `TimeNeedsSync`).
+  SERIAL_MSG_TIME_NEEDS_SYNC = 0x40,
+
+  /// Flag of the type of a response.
+  SERIAL_MSG_RESPONSE = 0x80,
+};
+
+enum SerialStatus {
+  SERIAL_STATUS_OK = 0x00,
+  /// The parameters' length does not match the request's type.
+  SERIAL_STATUS_INVALID_LENGTH = 0x01,
+  SERIAL_STATUS_UNKNOWN_MESSAGE = 0x02,
+  /// The request is valid, but could not be applied (i.e. no timer available, time not
+  /// set, or no wired sync pulse to pair with).
+  SERIAL_STATUS_REJECTED = 0x03,
+  /// A parameter is out of range (i.e. the unit width of a coded signal, or a channel).
+  SERIAL_STATUS_INVALID_PARAMETER = 0x04,
+};
+
+struct __attribute__((packed)) SerialMessageHeader {
+  uint8_t type;
+  uint8_t sequence;
+};
+
+/// A local time (unsynced: `millisRtc()`) with µs-resolution.
+struct __attribute__((packed)) SerialLocalTime {
+  uint32_t time;  // in ms
+  /// Time (in µs) elapsed since `time` advanced.
+  uint16_t fraction;
+};
+
+struct __attribute__((packed)) SerialSyncResponse {
+  uint8_t status;
+  uint32_t hostTimestamp;
+  SerialLocalTime receivedTime;
+  SerialLocalTime sentTime;
+};
+
+struct __attribute__((packed)) SerialSetTimeRequest {
+  /// Local time (unsynced: `millisRtc()`) ...
+  uint32_t localTime;
+  /// ... and the synced time at that moment (in ms).
+  uint32_t syncedTime;
+  /// Uncertainty (in µs) of `syncedTime`.
+  uint32_t uncertainty;
+  /// Number of round-trips the synced time has been estimated of.
+  uint16_t samplesCount;
+};
+
+struct __attribute__((packed)) SerialCodedTarget {
+  /// Target timestamp (synced time).
+  uint32_t targetTimestamp;
+  uint8_t code;
+};
+
+struct __attribute__((packed)) SerialBroadcasterKey {
+  uint8_t broadcasterId;
+  /// SipHash-2-4 key (s. `SIPHASH_KEY_SIZE`).
+  uint8_t key[16];
+};
+
+struct __attribute__((packed)) SerialConfigKey {
+  /// SipHash-2-4 key (s. `CONFIG_KEY_SIZE`).
+  uint8_t key[CONFIG_KEY_SIZE];
+};
+
+struct __attribute__((packed)) SerialInfo {
+  uint8_t status;
+  uint8_t protocolVersion;
+  uint8_t hardwareRevision;
+  uint8_t softwareRevision;
+};
+
+/// State of the Signalboy (`SerialDiagnostics.state`).
+enum SerialState {
+  SERIAL_STATE_STARTING = 0x00,
+  SERIAL_STATE_AWAITING_CONNECTION = 0x01,
+  /// Any Central is connected.
+  SERIAL_STATE_CONNECTED = 0x02,
+};
+
+/// Diagnostics of the host's synced time (mirroring the `syncQuality`-Characteristic)
+/// and of the output (mirroring the `outputLatency`-Characteristic).
+struct __attribute__((packed)) SerialDiagnostics {
+  uint8_t status;
+  uint8_t timeNeedsSync;
+  uint32_t syncUncertainty;  // in µs (0xffffffff, if not synced)
+  uint32_t timeSinceSync;    // in ms
+  uint16_t syncSamplesCount;
+  int32_t skew;              // in ppb
+  uint32_t skewUncertainty;  // in ppb
+  uint8_t isOutputCalibrated;
+  uint16_t calibrationSamplesCount;
+  int32_t outputLatency;     // in µs (median)
+  int32_t outputLatencyMinimum;
+  int32_t outputLatencyMaximum;
+  /// Number of frames dropped (invalid or unhandled) since startup.
+  uint16_t droppedFramesCount;
+  /// Usage of the RAM (s. memoryUsage.h), in bytes: High-water mark of the heap, bytes
+  /// allocated, minimum of free memory between the heap and the stack, ...
+  uint16_t heapSize;
+  uint16_t heapUsed;
+  uint16_t minimumFreeStack;
+  /// ... and the number of allocations and deallocations by `new` and `delete`.
+  uint32_t allocationsCount;
+  uint32_t deallocationsCount;
+  /// Time slept by the loop since startup (in ms) and the wake-up latency (in µs, s.
+  /// idle.h): 0, unless built with `IDLE_SLEEP`.
+  uint32_t idleTime;
+  uint16_t wakeLatencyMaximum;
+  uint16_t wakeLatencyMean;
+  /// The state shown by the LCD-display or the status-LED (s. `SerialState`).
+  uint8_t state;
+};
+
+struct __attribute__((packed)) SerialTraceResponse {
+  uint8_t status;
+  /// Number of `events` (0, once the trace is drained).
+  uint8_t count;
+  TraceEvent events[SERIAL_TRACE_MAX_EVENTS];
+};
+
+struct __attribute__((packed)) SerialRecordingResponse {
+  uint8_t status;
+  /// Number of `bytes` (0, if no records are pending).
+  uint8_t length;
+  /// The stream of records (s. recording.h): Records may span responses.
+  uint8_t bytes[SERIAL_RECORDING_MAX_LENGTH];
+};
+
+struct __attribute__((packed)) SerialStallsResponse {
+  uint8_t status;
+  StallReport report;
+};
+
+struct __attribute__((packed)) SerialFaultsResponse {
+  uint8_t status;
+  /// The faults from the index requested on (`page.count` of `page.faults` are sent).
+  FaultLogPage page;
+};
+
+struct __attribute__((packed)) SerialConfigResponse {
+  uint8_t status;
+  /// Number of `bytes`.
+  uint8_t length;
+  /// The effective configuration and the status of the last write (s. `encodeConfigReport()`).
+  uint8_t bytes[CONFIG_MAX_LENGTH];
+};
+
+#endif /* serialMessages_h */
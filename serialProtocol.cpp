@@ -0,0 +1,172 @@
+#include <Arduino.h>
+#include "serialProtocol.h"
+#include "serialFrame.h"
+#include "Globals.hpp"
+#include "Logger.hpp"
+#include "faultLog.h"
+#include "rtc.hpp"
+#include "trace.h"
+
+// Maximum number of bytes read per poll (bounds the time spent in the event-loop).
+#define MAX_BYTES_PER_POLL 64
+
+struct SerialMessageHandlerEntry {
+  uint8_t type;
+  SerialMessageHandler handler;
+};
+
+static arduino::Stream *serialStream = nullptr;
+static SerialFrameDecoder decoder;
+static SerialMessageHandlerEntry handlers[SERIAL_PROTOCOL_MAX_HANDLERS];
+static int handlersCount = 0;
+
+/// Local time the first byte of the pending frame was read.
+static SerialLocalTime frameStartTime;
+static unsigned int droppedFramesCount = 0;
+
+/// The local time with µs-resolution.
+static SerialLocalTime getSerialLocalTime() {
+  unsigned long localTime = millisRtc(false);
+  unsigned long fraction = micros() - microsAtMillisRtc(localTime);
+
+  // The corrections of `millisRtc()` (s. rtc.cpp) occasionally stretch a ms:
+  // Keep the time monotonic.
+  return { (uint32_t)localTime, (uint16_t)min(fraction, 999UL) };
+}
+
+static bool send(uint8_t type, uint8_t sequence, const void *parameters, size_t length) {
+  if (!serialStream) return false;
+
+  uint8_t payload[SERIAL_FRAME_MAX_PAYLOAD_SIZE];
+  if (sizeof(SerialMessageHeader) + length > sizeof(payload)) return false;
+
+  SerialMessageHeader header = { type, sequence };
+  memcpy(payload, &header, sizeof(header));
+  memcpy(&payload[sizeof(header)], parameters, length);
+
+  uint8_t frame[SERIAL_FRAME_MAX_SIZE];
+  size_t size = encodeSerialFrame(payload, sizeof(header) + length, frame);
+
+  // Never block the event-loop.
+  if ((size_t)serialStream->availableForWrite() < size) {
+    Log.printTimestamp();
+    Log.println("WARNING: Serial-Protocol: Host is not reading. Dropping message.");
+    reportFault(FAULT_DOMAIN_SERIAL, FAULT_CODE_HOST_NOT_READING, type);
+    return false;
+  }
+
+  serialStream->write(frame, size);
+  return true;
+}
+
+static void handleSync(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, sizeof(uint32_t))) return;
+
+  SerialSyncResponse response;
+  response.status = SERIAL_STATUS_OK;
+  memcpy(&response.hostTimestamp, message.parameters, sizeof(uint32_t));
+  response.receivedTime = frameStartTime;
+  // As late as possible.
+  response.sentTime = getSerialLocalTime();
+
+  sendSerialResponse(message, &response, sizeof(response));
+}
+
+static void dispatch(const uint8_t *payload, size_t length) {
+  TRACE_SCOPE(TRACE_POINT_SERIAL_MESSAGE);
+
+  if (length < sizeof(SerialMessageHeader)) {
+    droppedFramesCount++;
+    return;
+  }
+
+  SerialMessage message = {
+    payload[0],
+    payload[1],
+    &payload[sizeof(SerialMessageHeader)],
+    length - sizeof(SerialMessageHeader),
+    frameStartTime.time
+  };
+
+  if (message.type == SERIAL_MSG_SYNC) {
+    handleSync(message);
+    return;
+  }
+
+  for (int i = 0; i < handlersCount; i++) {
+    if (handlers[i].type == message.type) {
+      handlers[i].handler(message);
+      return;
+    }
+  }
+
+  droppedFramesCount++;
+  sendSerialStatus(message, SERIAL_STATUS_UNKNOWN_MESSAGE);
+}
+
+// MARK: - Public
+
+void setupSerialProtocol(arduino::Stream *stream) {
+  serialStream = stream;
+  initSerialFrameDecoder(decoder);
+}
+
+bool setSerialMessageHandler(uint8_t type, SerialMessageHandler handler) {
+  for (int i = 0; i < handlersCount; i++) {
+    if (handlers[i].type == type) {
+      handlers[i].handler = handler;
+      return true;
+    }
+  }
+
+  if (handlersCount >= SERIAL_PROTOCOL_MAX_HANDLERS) return false;
+
+  handlers[handlersCount++] = { type, handler };
+  return true;
+}
+
+void pollSerialProtocol(void) {
+  if (!serialStream) return;
+
+  uint8_t payload[SERIAL_FRAME_MAX_PAYLOAD_SIZE];
+
+  for (int i = 0; i < MAX_BYTES_PER_POLL && serialStream->available() > 0; i++) {
+    if (decoder.length == 0) {
+      frameStartTime = getSerialLocalTime();
+    }
+
+    int length = feedSerialFrameDecoder(decoder, serialStream->read(), payload);
+    if (length > 0) {
+      dispatch(payload, length);
+    } else if (length < 0) {
+      droppedFramesCount++;
+
+      Log.printTimestamp();
+      Log.println("WARNING: Serial-Protocol: Dropping invalid frame.");
+      reportFault(FAULT_DOMAIN_SERIAL, FAULT_CODE_INVALID_FRAME);
+    }
+  }
+}
+
+bool sendSerialResponse(const SerialMessage &request, const void *parameters, size_t length) {
+  return send(request.type | SERIAL_MSG_RESPONSE, request.sequence, parameters, length);
+}
+
+bool sendSerialStatus(const SerialMessage &request, uint8_t status) {
+  return sendSerialResponse(request, &status, sizeof(status));
+}
+
+bool validateSerialMessageLength(const SerialMessage &request, size_t length) {
+  if (request.length == length) return true;
+
+  sendSerialStatus(request, SERIAL_STATUS_INVALID_LENGTH);
+  return false;
+}
+
+bool sendSerialNotification(uint8_t type, const void *parameters, size_t length) {
+  return send(type, 0, parameters, length);
+}
+
+unsigned int droppedSerialFramesCount(void) {
+  return droppedFramesCount;
+}
@@ -0,0 +1,59 @@
+/*
+  Serial-Protocol
+
+  Framed binary protocol on the native USB port: A wired alternative to BLE for hosts
+  that are connected by USB (s. serialMessages.h for the messages, serialFrame.h for
+  the framing). The requests mirror the GATT operations and are dispatched to the
+  handlers registered by the sketch.
+
+  Round-trip sync (`SERIAL_MSG_SYNC`) is answered by the protocol itself: The
+  latency of USB is far more deterministic than the latency of BLE, so the host
+  estimates the offset of its clock by the round-trip times of a few requests.
+*/
+
+#ifndef serialProtocol_h
+#define serialProtocol_h
+
+#include <Arduino.h>
+#include "serialMessages.h"
+
+// Maximum number of registered message handlers.
+#define SERIAL_PROTOCOL_MAX_HANDLERS 20
+
+/// A received request.
+struct SerialMessage {
+  uint8_t type;
+  uint8_t sequence;
+  const uint8_t *parameters;
+  size_t length;
+  /// Local time (unsynced: `millisRtc()`) the first byte of the request was read.
+  unsigned long receivedTime;
+};
+
+/// Handlers are expected to answer every request (s. `sendSerialResponse()`).
+typedef void (*SerialMessageHandler)(const SerialMessage &message);
+
+void setupSerialProtocol(arduino::Stream *stream);
+/// Registers the handler of requests of type `type`. Returns `false`, if every
+/// handler slot is taken.
+bool setSerialMessageHandler(uint8_t type, SerialMessageHandler handler);
+
+/// Reads the received bytes and dispatches the completed requests.
+void pollSerialProtocol(void);
+
+/// Answers `request`: `parameters` start with the status (s. `SerialStatus`).
+///
+/// Returns `false`, if the response has been dropped: It is never blocking, so
+/// a host that does not read its responses loses them.
+bool sendSerialResponse(const SerialMessage &request, const void *parameters, size_t length);
+/// Answers `request` with `status` (without further parameters).
+bool sendSerialStatus(const SerialMessage &request, uint8_t status);
+/// Answers `request` with `SERIAL_STATUS_INVALID_LENGTH`, unless its parameters are
+/// `length` bytes. Returns `true`, if the length is valid.
+bool validateSerialMessageLength(const SerialMessage &request, size_t length);
+bool sendSerialNotification(uint8_t type, const void *parameters, size_t length);
+
+/// Number of frames dropped (invalid or unhandled) since startup.
+unsigned int droppedSerialFramesCount(void);
+
+#endif /* serialProtocol_h */
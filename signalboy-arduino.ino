@@ -17,21 +17,42 @@
 */
 
 #include <ArduinoBLE.h>
-#include <LCDKeypadShieldLib.h>
 #include "constants.h"
+#include "config.h"
 #include "Globals.hpp"
 #include "Logger.hpp"
 #include "rtc.hpp"
 #include "time.h"
 #include "training.h"
+#include "connection.h"
+#include "syncCache.h"
+#include "scheduler.h"
+#include "pulseCode.h"
+#include "outputChannels.h"
+#include "observer.h"
+#include "capture.h"
+#include "calibration.h"
+#include "wiredSync.h"
+#include "serialProtocol.h"
+#include "trace.h"
+#include "recorder.h"
+#include "memoryUsage.h"
+#include "idle.h"
+#include "watchdog.h"
+#include "faultLog.h"
+#ifdef HEADLESS
+#include "statusLed.h"
+#else
+#include <LCDKeypadShieldLib.h>
 #include "IntroViewController.h"
 #include "ErrorViewController.h"
 #include "MainViewController.h"
-#include "Error.h"
+#include "FaultLogViewController.h"
 #include "Resources.h"
+#endif
 
 /// The states that will be displayed to the user
-/// using the LCD-display.
+/// using the LCD-display (or the status-LED, if `HEADLESS`).
 enum State_t {
   stateINITIAL,
   // BLE is advertising and connectable.
@@ -39,6 +60,69 @@ enum State_t {
   stateCONNECTED,
 };
 
+/// Value of the `syncQuality`-Characteristic (little-endian).
+struct __attribute__((packed)) SyncQualityValue {
+  /// Predicted uncertainty (in µs) of the synced time (`0xffffffff`, if not synced).
+  uint32_t uncertainty;
+  /// Time (in ms) since the last sync.
+  uint32_t timeSinceSync;
+  /// Number of Reference-Timestamps the sync is based on.
+  uint16_t samplesCount;
+  /// Estimated skew (in ppb) of the Central's clock and its uncertainty.
+  int32_t skew;
+  uint32_t skewUncertainty;
+};
+
+/// Value of the `channelTargetTimestamp`-Characteristic (little-endian).
+struct __attribute__((packed)) ChannelTargetTimestampValue {
+  /// Target timestamp (synced time).
+  uint32_t targetTimestamp;
+  /// Output channel (s. `Outputs`).
+  uint8_t channel;
+};
+
+/// Value of the `codedTargetTimestamp`-Characteristic (little-endian).
+struct __attribute__((packed)) CodedTargetTimestampValue {
+  /// Target timestamp (synced time).
+  uint32_t targetTimestamp;
+  /// Event code emitted by the pulse train (s. pulseCode.h).
+  uint8_t code;
+  /// Unit width (in µs) of the pulse train (0 for `PULSE_CODE_UNIT_WIDTH_DEFAULT`).
+  uint16_t unitWidth;
+};
+
+#define CAPTURE_BATCH_SIZE 3
+
+#define CAPTURE_EVENT_FLAG_RISING_EDGE (1 << 4)
+#define CAPTURE_EVENT_FLAG_SYNCED (1 << 5)
+
+/// Value of the `captureEvents`-Characteristic (little-endian).
+struct __attribute__((packed)) CaptureEventsValue {
+  /// Incremented with every notification (allows to detect lost notifications).
+  uint8_t sequenceNumber;
+  uint8_t count;
+  /// Number of edges dropped (due to a full queue) since the previous notification.
+  uint8_t droppedCount;
+  struct __attribute__((packed)) {
+    /// Channel (bits 0-3) and `CAPTURE_EVENT_FLAG_*`.
+    uint8_t flags;
+    /// Time of the edge: Synced time of the recording Central (s. `CAPTURE_EVENT_FLAG_SYNCED`),
+    /// otherwise local time.
+    uint32_t timestamp;
+  } events[CAPTURE_BATCH_SIZE];
+};
+
+/// Value of the `outputLatency`-Characteristic (little-endian).
+struct __attribute__((packed)) OutputLatencyValue {
+  /// `1`, if the output has been calibrated successfully.
+  uint8_t isCalibrated;
+  uint16_t samplesCount;
+  /// Latencies (in µs) of the calibration's test pulses: The median is compensated.
+  int32_t median;
+  int32_t minimum;
+  int32_t maximum;
+};
+
 #define REVISION_STRING_SIZE_BYTES 8
 BLEService deviceInformationService("180a");
 BLECharacteristic hardwareRevisionChar("2a27", BLERead, REVISION_STRING_SIZE_BYTES, false);
@@ -49,26 +133,79 @@ BLEService outputService("37410000-b4d1-f445-aa29-989ea26dc614");
 BLEUnsignedLongCharacteristic targetTimestampChar("37410001-b4d1-f445-aa29-989ea26dc614", BLERead | BLEWrite | BLEWriteWithoutResponse);
 // create triggerOutput (signal) characteristic and allow remote device to write (trigger)
 BLEByteCharacteristic triggerTimerChar("37410002-b4d1-f445-aa29-989ea26dc614", BLEWrite | BLEWriteWithoutResponse);
+// create codedTargetTimestamp (signal) characteristic: A target timestamp with an event code,
+// that is emitted as a pulse train (s. `CodedTargetTimestampValue`).
+BLECharacteristic codedTargetTimestampChar("37410003-b4d1-f445-aa29-989ea26dc614", BLEWrite | BLEWriteWithoutResponse, sizeof(CodedTargetTimestampValue), true);
+// create channelTargetTimestamp (signal) characteristic: A target timestamp addressed to an
+// output channel (s. `ChannelTargetTimestampValue`).
+BLECharacteristic channelTargetTimestampChar("37410004-b4d1-f445-aa29-989ea26dc614", BLEWrite | BLEWriteWithoutResponse, sizeof(ChannelTargetTimestampValue), true);
 
 BLEService timeSyncService("92360000-7858-41a5-b0cc-942dd4189715");
 // create switch characteristic ("timeNeedsSync")
 BLEByteCharacteristic timeNeedsSyncChar("92360001-7858-41a5-b0cc-942dd4189715", BLERead | BLENotify);
 // create unsigned long characteristic ("referenceTimestamp")
 BLEUnsignedLongCharacteristic referenceTimestampChar("92360002-7858-41a5-b0cc-942dd4189715", BLEWrite | BLEWriteWithoutResponse);
+// create identity-token characteristic ("syncIdentityToken"): Allows the Central to identify itself
+// (independent of its address) in order to restore a previous sync on reconnect.
+BLECharacteristic syncIdentityTokenChar("92360003-7858-41a5-b0cc-942dd4189715", BLEWrite | BLEWriteWithoutResponse, SYNC_CACHE_KEY_SIZE, false);
+// create sync-quality characteristic ("syncQuality"): The quality of the least accurate
+// synced time of any connected Central (s. `SyncQualityValue`).
+BLECharacteristic syncQualityChar("92360004-7858-41a5-b0cc-942dd4189715", BLERead | BLENotify, sizeof(SyncQualityValue), true);
+// create unsigned long characteristic ("wiredReferenceTimestamp"): The synced time of the
+// most recent pulse on the wired sync input (s. wiredSync.h).
+BLEUnsignedLongCharacteristic wiredReferenceTimestampChar("92360005-7858-41a5-b0cc-942dd4189715", BLEWrite | BLEWriteWithoutResponse);
+
+BLEService inputService("37410100-b4d1-f445-aa29-989ea26dc614");
+// create capture-events characteristic ("captureEvents"): Notifies the edges captured on the
+// input pins. The Central that subscribed most recently becomes the recording Central.
+BLECharacteristic captureEventsChar("37410101-b4d1-f445-aa29-989ea26dc614", BLERead | BLENotify, sizeof(CaptureEventsValue), false);
+
+BLEService diagnosticsService("5b6a0000-3b1b-4a8f-9d0e-2c6f4e1d7a10");
+// create output-latency characteristic ("outputLatency"): Result of the last calibration of the output.
+BLECharacteristic outputLatencyChar("5b6a0001-3b1b-4a8f-9d0e-2c6f4e1d7a10", BLERead, sizeof(OutputLatencyValue), true);
+// create fault-log characteristic ("faultLog"): A page of the fault log (`FaultLogPage`, s.
+// fault.h). Writing a `uint8_t` index selects the page: Reset to the latest faults (and
+// notified), once a fault occurs.
+BLECharacteristic faultLogChar("5b6a0002-3b1b-4a8f-9d0e-2c6f4e1d7a10", BLERead | BLEWrite | BLENotify, sizeof(FaultLogPage), false);
+
+BLEService configurationService("6e4c0000-2f5b-4c1e-9a7d-3b8e1f0c5a62");
+// create configuration characteristic ("configuration"): The parameters applied at runtime
+// (s. configFormat.h). Writes change the parameters, if authenticated by the configuration key
+// (provisioned by USB, s. `onSerialProvisionConfigKey()`), reads report the effective ones.
+BLECharacteristic configurationChar("6e4c0001-2f5b-4c1e-9a7d-3b8e1f0c5a62", BLERead | BLEWrite, CONFIG_MAX_AUTHENTICATED_LENGTH, false);
 
 BLEService connectionInformationService("a5210000-9859-499a-ad8a-1264b41a7750");
 // OptionSet-value indicating options specific to an established connection.
 BLEByteCharacteristic connectionOptionsChar("a5210001-9859-499a-ad8a-1264b41a7750", BLERead | BLENotify);
 
-// pin == HIGH if signal is triggered (either by "Scheduled-timer" or "Trigger-timer") for the duration
-// of `SIGNAL_HIGH_INTERVAL`.
-const int PIN_OUTPUT = 10;
+// Output channels (pin, pulse width in ms): A channel's pin is HIGH while a timer fires on it.
+// Channel 0 (`SCHEDULER_DEFAULT_CHANNEL`) fires the "Scheduled-timer" and the "Trigger-timer"
+// (and the coded signals), and is calibrated. Its pulse width is configured at runtime
+// (s. `applyConfigChange()`).
+typedef OutputChannels<
+  OutputChannel<10, SIGNAL_HIGH_INTERVAL_DEFAULT>,
+  OutputChannel<5, 10>,
+  OutputChannel<A2, 10>
+> Outputs;
 // INPUT which may trigger activation of the "Trigger-timer" (for DEBUG-purposes)
 const int PIN_INPUT_DEBUG = 12;
 // Pin receiving the one-pulse-per-second signal from the RTC.
 // This should be an interrupt-capable pin.
 #define PIN_PPS A1
-
+// Pins whose edges are captured (and notified to the recording Central).
+// These must be interrupt-capable pins on EXTINT lines not used otherwise: D11 is EXTINT0,
+// A3 is EXTINT10 (`PIN_PPS` is EXTINT2). NOTE: A4/A5 are the I2C bus of the RTC.
+const int PIN_CAPTURE[] = { 11, A3 };
+// Capture channel (index into `PIN_CAPTURE`) the output is wired back to for calibration.
+const uint8_t CAPTURE_CHANNEL_CALIBRATION = 0;
+// Capture channel (index into `PIN_CAPTURE`) of the wired sync input (i.e. PPS): Its edges
+// are recorded like the others', unless the wired sync is in use (s. `dispatchCaptureEvents()`).
+const uint8_t CAPTURE_CHANNEL_WIRED_SYNC = 1;
+
+#ifdef HEADLESS
+// Pin of the status-LED (s. statusLed.h)
+const int PIN_STATUS_LED = LED_BUILTIN;
+#else
 // Pins used for the LCD-Display
 const int PIN_LCD_RS = 7;
 const int PIN_LCD_ENABLE = 8;
@@ -82,21 +219,14 @@ const int PIN_LCD_D3 = 6;
 // Set to HIGH to enable the lcd-panel's backlight.
 const int PIN_BACKLIGHT = 9;
 
-// #define CONNECTION_INTERVAL_15MS 0x000C
-#define CONNECTION_INTERVAL_20MS 0x0010
-// #define CONNECTION_INTERVAL_100MS 0x0050
-
-// #define CONNECTION_INTERVAL_DEFAULT CONNECTION_INTERVAL_100MS
-#define CONNECTION_INTERVAL_TRAINING CONNECTION_INTERVAL_20MS
-
 #define TIMEOUT_INTRO_SCREEN 3 * 1000UL  // in ms
-
-/// Currently configured Connection Interval (BLE).
-uint16_t connectionInterval = 0;
+#endif /* HEADLESS */
 
 /// The state that is currently displayed to the user
 /// using the LCD-display.
 State_t displayedState;
+/// `true`, if the displayed state is outdated (s. `invalidateStateDisplay()`).
+bool isStateDisplayInvalid = true;
 
 bool isBLESetupComplete = false;
 
@@ -106,29 +236,68 @@ bool isBLESetupComplete = false;
 bool isHeartbeatEnabled = false;
 
 unsigned long loopCount = 0;
+// in µs: Allows to compare the build profiles (i.e. `HEADLESS`)
 float avgLoopRuntime = 0.0;
+unsigned long maxLoopRuntime = 0;
+/// Runs of the loop that took too long: Reported as a single fault per period of the stats.
+unsigned long loopOverrunsCount = 0;
 
 unsigned long lastPrintEventLoopStatsTime = 0;
 #endif
 
-// - Main/"Scheduled Timer"-Timer
-bool isScheduledTimerArmed = false;
-bool hasScheduledTimerFired = false;
-/// The timestamp (synced time) at which timer was armed.
-unsigned long lastScheduledTimerArmedTime = 0;
-/// The delay after which the armed timer will begin to fire (for the duration of `SIGNAL_HIGH_INTERVAL`).
-unsigned long scheduledTimerDelay = 0;
-
-// - Alternative/"Trigger"-Timer
-bool isTriggerTimerArmed = false;
-bool hasTriggerTimerFired = false;
-/// The timestamp (unsynced time) at which timer was armed.
-unsigned long lastTriggerTimerArmedTime = 0;
-/// The delay after which the armed timer will begin to fire (for the duration of `SIGNAL_HIGH_INTERVAL`).
-unsigned long triggerTimerDelay = 0;
+/// State specific to a connected Central.
+struct CentralContext {
+  bool isActive;
+  /// Identifies the Central by its address.
+  SyncCacheKey addressKey;
+  uint16_t connectionHandle;
+
+  /// Identifies the Central in the Sync-Cache.
+  SyncCacheKey syncCacheKey;
+  /// `true`, if the sync of a reconnected Central has been restored from the Sync-Cache,
+  /// but not been confirmed by the Central, yet.
+  bool isSyncVerificationPending;
+
+  /// The Central's synced time.
+  SyncedClock clock;
+  TrainingState training;
+
+  /// The time (unsynced) the Central's clock was last synced by the wired sync (s. wiredSync.h).
+  unsigned long lastWiredSyncTime;
+  bool isWiredSyncActive;
+  WiredSyncPairing wiredSyncPairing;
+
+  /// The timestamp (unsynced time) at which the Central last armed any timer.
+  /// (Used to retain the fast Connection-Parameters for bursts of signals.)
+  unsigned long lastTimerArmedTime;
+};
+
+CentralContext centralContexts[MAX_CENTRALS];
+
+/// The host connected by USB (s. serialProtocol.h): Synced like a Central, but via the
+/// Serial-Protocol. It is not tracked (the USB port does not reliably indicate whether
+/// the host is attached), so its context is always active.
+CentralContext serialContext;
+/// The `timeNeedsSync`-value last notified to the host connected by USB.
+byte serialTimeNeedsSync = TIME_NEEDS_SYNC_TRAINING;
+
+/// The Central whose synced time captured edges are reported in (or `nullptr`).
+CentralContext *recordingContext = nullptr;
+/// Captured edges pending to be notified.
+CaptureEvent pendingCaptureEvents[CAPTURE_QUEUE_SIZE];
+int pendingCaptureEventsCount = 0;
+uint8_t captureEventsSequenceNumber = 0;
+/// The time (in µs, `micros()`) of the last notification of captured edges.
+unsigned long lastCaptureEventsNotifiedTime = 0;
+
+/// `faultsCount()` when the `faultLog`-Characteristic was notified last.
+uint16_t notifiedFaultsCount = 0;
+/// Index of the page of the `faultLog`-Characteristic.
+uint8_t faultLogIndex = 0;
 
 /* --- LCD-Display --- */
 
+#ifndef HEADLESS
 LCDKeypadScreen screen(
   LCD_NUM_COL,
   PIN_LCD_RS,
@@ -142,6 +311,7 @@ LCDKeypadScreen screen(
 IntroViewController introViewController;
 ErrorViewController errorViewController;
 MainViewController mainViewController;
+FaultLogViewController faultLogViewController;
 
 struct RejectConnectionMenuItem : public IMenuItem {
   String getLabel() {
@@ -155,106 +325,396 @@ struct RejectConnectionMenuItem : public IMenuItem {
   }
 };
 
+struct CalibrateOutputMenuItem : public IMenuItem {
+  String getLabel() {
+    return Resources::shared->calibrateOutput;
+  }
+
+  void onSelection() {
+    mainViewController.dismissMenu();
+
+    startCalibration(CAPTURE_CHANNEL_CALIBRATION);
+  }
+};
+
+struct ShowFaultsMenuItem : public IMenuItem {
+  String getLabel() {
+    return Resources::shared->showFaults;
+  }
+
+  void onSelection() {
+    mainViewController.dismissMenu();
+
+    faultLogViewController.reset();
+    screen.setRootViewController(&faultLogViewController);
+  }
+};
+
+std::unique_ptr<std::vector<std::unique_ptr<IMenuItem>>> makeStateAwaitingConnectionMenu() {
+  std::unique_ptr<CalibrateOutputMenuItem> calibrateOutputMenuItemPtr(new CalibrateOutputMenuItem);
+
+  std::unique_ptr<std::vector<std::unique_ptr<IMenuItem>>> menuItemsPtr(new std::vector<std::unique_ptr<IMenuItem>>);
+  menuItemsPtr->push_back(std::move(calibrateOutputMenuItemPtr));
+  menuItemsPtr->push_back(std::unique_ptr<ShowFaultsMenuItem>(new ShowFaultsMenuItem));
+
+  return menuItemsPtr;
+}
+
 std::unique_ptr<std::vector<std::unique_ptr<IMenuItem>>> makeStateConnectedMenu() {
   std::unique_ptr<RejectConnectionMenuItem> dropConnectionMenuItemPtr(new RejectConnectionMenuItem);
 
   std::unique_ptr<std::vector<std::unique_ptr<IMenuItem>>> menuItemsPtr(new std::vector<std::unique_ptr<IMenuItem>>);
   menuItemsPtr->push_back(std::move(dropConnectionMenuItemPtr));
+  menuItemsPtr->push_back(std::unique_ptr<ShowFaultsMenuItem>(new ShowFaultsMenuItem));
 
   return menuItemsPtr;
 }
+#endif /* HEADLESS */
 
 // MARK: - Private
 
 #ifdef DEBUG
 // Only used for debugging-purposes.
 void blockThreadUntilSerialOpen() {
+#ifdef HEADLESS
+  while (!Serial) {
+    updateStatusLed();
+  }
+#else
   // Inform user via lcd-display.
   introViewController.m_isShowingAwaitingSerialPortNotice = true;
+  introViewController.setNeedsDisplay();
 
   // Initialize serial and wait for port to open... (needed for native USB port only)
   while (!Serial) {
     screen.update();
   }
+#endif
 }
 #endif
 
-// TimeProvider routine for `training.h`
-unsigned long _millisRtc() {
-  return millisRtc(false);
-}
+/// Returns the context of the connected Central, or `nullptr` if
+/// the Central is unknown.
+CentralContext *findCentralContext(BLEDevice central) {
+  SyncCacheKey addressKey = makeSyncCacheKey(central.address().c_str());
 
-uint16_t getConnectionInterval() {
-  return connectionInterval;
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    CentralContext &context = centralContexts[i];
+    if (context.isActive && isEqualSyncCacheKey(context.addressKey, addressKey)) {
+      return &context;
+    }
+  }
+
+  return nullptr;
 }
 
-void setConnectionInterval(uint16_t interval) {
-  connectionInterval = interval;
-  BLE.setConnectionInterval(interval, interval);
+int getConnectedCentralsCount() {
+  int count = 0;
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    if (centralContexts[i].isActive) count++;
+  }
+
+  return count;
 }
 
-void armScheduledTimer(unsigned long delay) {
-  scheduledTimerDelay = delay;
-  // synced time: `now()`
-  lastScheduledTimerArmedTime = now();
+/// `true`, if a Training with any Central is pending.
+bool isAnyTrainingPending() {
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    CentralContext &context = centralContexts[i];
+    if (context.isActive && trainingStatus(context.training).statusCode == trainingPending) {
+      return true;
+    }
+  }
 
-  hasScheduledTimerFired = false;
-  isScheduledTimerArmed = true;
+  return trainingStatus(serialContext.training).statusCode == trainingPending;
 }
 
-void armTriggerTimer(unsigned long delay) {
-  triggerTimerDelay = delay;
-  // unsynced time: `millisRtc()`
-  lastTriggerTimerArmedTime = millisRtc(false);
+/// `true`, if any Central (or the host) is synced by the wired sync (s. `updateSyncSource()`).
+bool isAnyWiredSyncActive() {
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    if (centralContexts[i].isActive && centralContexts[i].isWiredSyncActive) return true;
+  }
 
-  hasTriggerTimerFired = false;
-  isTriggerTimerArmed = true;
+  return serialContext.isWiredSyncActive;
 }
 
 bool inputValue = false;
 void pollInput() {
   bool newValue = digitalRead(PIN_INPUT_DEBUG);
+  if (newValue != inputValue) {
+    recordInputEdge(PIN_INPUT_DEBUG, newValue);
+  }
+
   if (newValue && !inputValue) {
     Log.printTimestamp();
     Log.println("Rising-edge detected. Arming trigger timer...");
 
     // rising edge -> fire timer immediately
-    armTriggerTimer(millisRtc(false));
+    armTimer(millisRtc(false), SCHEDULER_DEFAULT_CHANNEL, timerSourceTRIGGER);
     updateOutputPin();
   }
 
   inputValue = newValue;
 }
 
+/// Dispatches the captured edges: To the wired sync (s. `CAPTURE_CHANNEL_WIRED_SYNC`),
+/// the calibration (while calibrating), or to be notified to the recording Central.
+void dispatchCaptureEvents() {
+  CaptureEvent event;
+  while (pendingCaptureEventsCount < CAPTURE_QUEUE_SIZE && popCaptureEvent(&event)) {
+    if (event.channel == CAPTURE_CHANNEL_WIRED_SYNC) {
+      // Kept for pairing in any case (a pulse precedes its Wired-Reference-Timestamp), but
+      // taken from the recording only while the wired sync is in use.
+      onWiredSyncEdge(event);
+      if (isAnyWiredSyncActive()) continue;
+    }
+
+    if (isCalibrating()) {
+      onCalibrationEdge(event);
+    } else {
+      pendingCaptureEvents[pendingCaptureEventsCount++] = event;
+    }
+  }
+}
+
+/// Notifies the captured edges in batches of up to `CAPTURE_BATCH_SIZE`: At most
+/// once per Connection-Interval of the recording Central.
+void notifyCaptureEventsIfNeeded() {
+  if (pendingCaptureEventsCount == 0) return;
+
+  unsigned long interval = recordingContext ? getConnectionIntervalMicros(recordingContext->connectionHandle) : 0;
+  if (micros() - lastCaptureEventsNotifiedTime < interval) return;
+  lastCaptureEventsNotifiedTime = micros();
+
+  bool isSynced = recordingContext && timeStatus(recordingContext->clock) != timeNotSet;
+  unsigned int droppedCount = takeDroppedCaptureEventsCount();
+
+  CaptureEventsValue value;
+  value.sequenceNumber = captureEventsSequenceNumber++;
+  value.count = 0;
+  value.droppedCount = min(droppedCount, 0xffU);
+
+  while (value.count < CAPTURE_BATCH_SIZE && value.count < pendingCaptureEventsCount) {
+    CaptureEvent &event = pendingCaptureEvents[value.count];
+    value.events[value.count].flags = event.channel
+      | (event.isRisingEdge ? CAPTURE_EVENT_FLAG_RISING_EDGE : 0)
+      | (isSynced ? CAPTURE_EVENT_FLAG_SYNCED : 0);
+    value.events[value.count].timestamp = isSynced ? toSyncedTime(recordingContext->clock, event.localTime) : event.localTime;
+    value.count++;
+  }
+
+  pendingCaptureEventsCount -= value.count;
+  memmove(&pendingCaptureEvents[0], &pendingCaptureEvents[value.count], pendingCaptureEventsCount * sizeof(CaptureEvent));
+
+  captureEventsChar.writeValue((uint8_t *)&value, 3 + value.count * sizeof(value.events[0]), false);
+}
+
+/// Updates the `outputLatency`-Characteristic with the result of the last calibration.
+void updateOutputLatency() {
+  CalibrationResult result = calibrationResult();
+
+  OutputLatencyValue value = {
+    (uint8_t)result.isValid,
+    (uint16_t)result.samplesCount,
+    (int32_t)result.median,
+    (int32_t)result.minimum,
+    (int32_t)result.maximum
+  };
+  outputLatencyChar.writeValue((uint8_t *)&value, sizeof(value), false);
+}
+
+/// Updates the `configuration`-Characteristic with the effective configuration (and
+/// the status of the last write).
+void updateConfiguration() {
+  uint8_t value[CONFIG_MAX_LENGTH];
+  size_t length = configReport(value);
+  configurationChar.writeValue(value, length, false);
+}
+
+/// Updates the `faultLog`-Characteristic with the selected page of the fault log.
+void updateFaultLog() {
+  FaultLogPage page = faultLogPage(faultLogIndex);
+  faultLogChar.writeValue((uint8_t *)&page, offsetof(FaultLogPage, faults) + page.count * sizeof(FaultRecord), false);
+}
+
+/// Notifies the latest faults, once a fault occurred (s. faultLog.h).
+void notifyFaultLogIfNeeded() {
+  if (faultsCount() == notifiedFaultsCount) return;
+
+  notifiedFaultsCount = faultsCount();
+  faultLogIndex = 0;
+  updateFaultLog();
+}
+
+/// Applies the configuration to the modules (s. config.h): Timers armed already keep
+/// their pulse width, an ongoing Training its number of Reference-Timestamps.
+void applyConfigChange(const Config &config) {
+  setChannelPulseWidth(SCHEDULER_DEFAULT_CHANNEL, config.signalHighInterval);
+  setSyncInterval(config.syncInterval);
+  setSyncAccuracyBudget(config.syncAccuracyBudget);
+  setTrainingMsgsCount(config.trainingMsgsCount);
+  // Requested from the Centrals by `updateConnectionMode()`
+  setConnectionIntervals(config.connectionIntervalFast, config.connectionIntervalIdle);
+}
+
+/// The sync needed by the Central (s. `TimeNeedsSync`).
+byte getTimeNeedsSync(CentralContext &context) {
+  if (timeStatus(context.clock) != timeSet) return TIME_NEEDS_SYNC_TRAINING;
+  if (context.isSyncVerificationPending) return TIME_NEEDS_SYNC_VERIFICATION;
+
+  return TIME_NEEDS_SYNC_NONE;
+}
+
+/// Updates the `timeNeedsSync`-Characteristic, that is shared by every Central:
+/// It indicates the most demanding sync that is needed by any connected Central.
+/// (The host connected by USB is notified separately.)
 void updateTimeNeedsSync() {
-  bool timeNeedsSync = timeNeedsSyncChar.value();
-  bool newValue = timeStatus() != timeSet;
+  byte timeNeedsSync = timeNeedsSyncChar.value();
+  byte newValue = getConnectedCentralsCount() > 0 ? TIME_NEEDS_SYNC_NONE : TIME_NEEDS_SYNC_TRAINING;
+
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    CentralContext &context = centralContexts[i];
+    if (!context.isActive) continue;
+
+    byte value = getTimeNeedsSync(context);
+    if (value == TIME_NEEDS_SYNC_TRAINING) {
+      newValue = value;
+      break;
+    } else if (value == TIME_NEEDS_SYNC_VERIFICATION) {
+      newValue = value;
+    }
+  }
 
   if (newValue != timeNeedsSync) {
     Log.printTimestamp();
-    byte data = newValue ? 0x01 : 0x00;
     Log.print(": update timeNeedsSync-characteristic, new value: ");
-    Log.println(data);
+    Log.println(newValue);
+
+    timeNeedsSyncChar.writeValue(newValue);
+    invalidateStateDisplay();
+  }
+
+  newValue = getTimeNeedsSync(serialContext);
+  if (newValue != serialTimeNeedsSync) {
+    serialTimeNeedsSync = newValue;
+    sendSerialNotification(SERIAL_MSG_TIME_NEEDS_SYNC, &newValue, sizeof(newValue));
+  }
+}
+
+unsigned long lastSyncQualityUpdateTime = 0;
+
+/// Updates the `syncQuality`-Characteristic, that is shared by every Central:
+/// It indicates the quality of the least accurate synced time of any connected Central.
+/// Updated every `SYNC_QUALITY_UPDATE_INTERVAL`, unless `isForced`.
+void updateSyncQuality(bool isForced) {
+  unsigned long localTime = millisRtc(false);
+  if (!isForced && localTime - lastSyncQualityUpdateTime < SYNC_QUALITY_UPDATE_INTERVAL) return;
+  lastSyncQualityUpdateTime = localTime;
+
+  SyncQualityValue value = { 0xffffffff, 0, 0, 0, CLOCK_SKEW_DEFAULT };
+  bool hasValue = false;
+
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    CentralContext &context = centralContexts[i];
+    if (!context.isActive) continue;
+
+    if (timeStatus(context.clock) == timeNotSet) {
+      value = { 0xffffffff, 0, 0, 0, CLOCK_SKEW_DEFAULT };
+      break;
+    }
+
+    SyncQuality quality = syncQuality(context.clock);
+    if (!hasValue || quality.uncertainty > value.uncertainty) {
+      value = {
+        (uint32_t)quality.uncertainty,
+        (uint32_t)quality.timeSinceSync,
+        (uint16_t)quality.samplesCount,
+        (int32_t)quality.skew,
+        (uint32_t)quality.skewUncertainty
+      };
+      hasValue = true;
+    }
+  }
+
+  syncQualityChar.writeValue((uint8_t *)&value, sizeof(value), false);
+}
+
+/// Restores the sync of the connected Central from the Sync-Cache (if any
+/// has been cached and is not expired). The restored sync then merely needs
+/// to be confirmed by the Central.
+///
+/// Returns `true`, if the sync has been restored.
+bool restoreSyncIfCached(CentralContext &context) {
+  SyncEpoch epoch;
+  if (!findSyncEpoch(context.syncCacheKey, &epoch)) return false;
+
+  unsigned long localTime = millisRtc(false);
+  unsigned long elapsedSinceSync = localTime - epoch.syncTime;
+  if (elapsedSinceSync >= currentConfig().syncInterval) return false;
+
+  SyncedClock clock = context.clock;
+  long step = restoreTime(clock, localTime + epoch.offset, elapsedSinceSync, epoch.uncertainty);
+  // The predicted uncertainty may exceed the accuracy budget already.
+  if (timeStatus(clock) != timeSet) return false;
+
+  Log.printTimestamp();
+  Log.print("Restoring sync from Sync-Cache (synced ");
+  Log.print(elapsedSinceSync);
+  Log.println(" ms ago).");
+
+  context.clock = clock;
+  rebaseTimers(context.clock, step);
+  context.isSyncVerificationPending = true;
+  updateTimeNeedsSync();
+
+  return true;
+}
+
+/// Detects the loss of the wired sync signal: The synced time of the affected Centrals
+/// falls back to Training (once the predicted uncertainty exceeds the accuracy budget).
+void updateSyncSource(CentralContext &context, unsigned long localTime) {
+  if (!context.isActive || !context.isWiredSyncActive) return;
+
+  if (!isWiredSyncSignalPresent() || localTime - context.lastWiredSyncTime >= WIRED_SYNC_TIMEOUT) {
+    Log.printTimestamp();
+    Log.println("Wired-Sync lost. Falling back to Training.");
+
+    context.isWiredSyncActive = false;
+  }
+}
+
+void updateSyncSource() {
+  unsigned long localTime = millisRtc(false);
+
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    updateSyncSource(centralContexts[i], localTime);
+  }
+  updateSyncSource(serialContext, localTime);
+}
+
+/// Selects the Connection-Parameters (BLE) for the current activity of every Central:
+/// Fast Connection-Parameters are requested during Training and for
+/// (bursts of) scheduled signals.
+void updateConnectionMode() {
+  unsigned long localTime = millisRtc(false);
 
-    timeNeedsSyncChar.writeValue(data);
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    CentralContext &context = centralContexts[i];
+    if (!context.isActive) continue;
 
-    // @WORKAROUND[1]: Set Connection-Interval for Training-Mode initially
-    // when setting up the connection.
-    //
-    // Background: Changing the Connection Interval for an established connection seems
-    // not to be supported currently by ArduinoBLE-library.
-    // if (newValue) {
-    //   Log.println("Will change Connection-Interval for Training-Mode.");
-    //   setConnectionInterval(CONNECTION_INTERVAL_TRAINING);
-    // } else {
-    //   Log.println("Will change Connection-Interval for Default-Mode. (time is synced)");
-    //   setConnectionInterval(CONNECTION_INTERVAL_DEFAULT);
-    // }
+    bool isFastModeNeeded = timeStatus(context.clock) != timeSet
+      || trainingStatus(context.training).statusCode == trainingPending
+      || context.isSyncVerificationPending
+      || localTime - context.lastTimerArmedTime < CONNECTION_BURST_TIMEOUT;
+
+    setConnectionMode(context.connectionHandle, isFastModeNeeded ? connectionModeFAST : connectionModeIDLE);
   }
+
+  updateConnectionParametersIfNeeded();
 }
 
 State_t getState() {
-  if (BLE.central()) {
+  if (getConnectedCentralsCount() > 0) {
     return stateCONNECTED;
   } else if (isBLESetupComplete) {
     return stateAWAITING_CONNECTION;
@@ -263,10 +723,35 @@ State_t getState() {
   return stateINITIAL;
 }
 
+/// Marks the displayed state as outdated: It is updated by the next loop. Called on
+/// every event, that changes the state or its description: A Central connecting or
+/// disconnecting, a change of the `timeNeedsSync`-Characteristic and the completed setup.
+void invalidateStateDisplay() {
+  isStateDisplayInvalid = true;
+}
+
 /// Updates the state-description displayed to the user
-/// (LCD-display).
+/// (LCD-display), if outdated (s. `invalidateStateDisplay()`).
 void updateStateDisplay() {
+  if (!isStateDisplayInvalid) return;
+  isStateDisplayInvalid = false;
+
   State_t state = getState();
+
+#ifdef HEADLESS
+  switch (state) {
+    case stateINITIAL:
+      setStatusLedPattern(statusLedSTARTING);
+      break;
+    case stateAWAITING_CONNECTION:
+      setStatusLedPattern(statusLedAWAITING_CONNECTION);
+      break;
+    case stateCONNECTED:
+      setStatusLedPattern(timeNeedsSyncChar.value() ? statusLedCONNECTED : statusLedSYNCED);
+      break;
+  }
+  displayedState = state;
+#else
   bool isStateChanged = state != displayedState;
 
   String text = "";
@@ -285,7 +770,8 @@ void updateStateDisplay() {
       {
         text = Resources::shared->getStateLabel_awaitingConnection();
         if (isStateChanged) {
-          updatedMenuItemsPtr.reset(new std::vector<std::unique_ptr<IMenuItem>>());
+          auto menuItemsPtr = makeStateAwaitingConnectionMenu();
+          updatedMenuItemsPtr = std::move(menuItemsPtr);
         }
         break;
       }
@@ -311,18 +797,34 @@ void updateStateDisplay() {
   if (isStateChanged) {
     mainViewController.dismissMenu();
   }
+#endif /* HEADLESS */
+}
+
+#ifndef HEADLESS
+/// Returns from the fault log (s. `ShowFaultsMenuItem`) to the main screen.
+void dismissFaultLog() {
+  screen.setRootViewController(&mainViewController);
 }
+#endif
 
 // MARK: - Lifecycle
 
 void setup() {
-  pinMode(PIN_OUTPUT, OUTPUT);
+  setupMemoryUsage();
+  Outputs::setup();
   pinMode(PIN_INPUT_DEBUG, INPUT_PULLDOWN);
+  setupCapture(PIN_CAPTURE, sizeof(PIN_CAPTURE) / sizeof(PIN_CAPTURE[0]));
 
+#ifdef HEADLESS
+  setupStatusLed(PIN_STATUS_LED);
+#else
   screen.setup();
+  faultLogViewController.setDismissHandler(dismissFaultLog);
   screen.setRootViewController(&introViewController);
   screen.update();
+#endif
 
+  // Native USB port: Serial-Protocol (the baud rate is ignored)
   Serial.begin(9600);
   Serial1.begin(57600);
   // blockThreadUntilSerialOpen();
@@ -335,6 +837,10 @@ void setup() {
   pinMode(PIN_PPS, INPUT_PULLUP);
   attachInterrupt(digitalPinToInterrupt(PIN_PPS), pps_tick, FALLING);
 
+#ifdef HEADLESS
+  updateStateDisplay();
+  updateStatusLed();
+#else
 #ifdef DEBUG
   // Shorten intro-time during development.
   delay(1000UL);
@@ -345,29 +851,38 @@ void setup() {
   updateStateDisplay();
   screen.setRootViewController(&mainViewController);
   screen.update();
+#endif /* HEADLESS */
 
-  // Time-library
-  setSyncInterval(SYNC_INTERVAL);
+  // Configuration (applied to the output channels, the time-library, the Training and
+  // the Connection-Parameters)
+  setupConfig(applyConfigChange);
 
-  // Training
-  setTimeProvider(_millisRtc); // Pass `millisRtc()`-function as time provider for training.h
+  // Connection-Parameters (must be set up before initializing BLE)
+  setupConnection();
 
   // begin initialization
   if (!BLE.begin()) {
     Log.println("starting Bluetooth® Low Energy module failed!");
+    reportFault(FAULT_DOMAIN_SYSTEM, FAULT_CODE_BLE_INIT_FAILURE);
 
-    errorViewController.setError(new Signalboy::Error(ERROR_CODE_BLE_INIT_FAILURE, ERROR_MSG_BLE_INIT_FAILURE));
+#ifdef HEADLESS
+    setStatusLedPattern(statusLedERROR);
+
+    while (1) {
+      updateStatusLed();
+    }
+#else
+    FaultRecord fault;
+    faultAt(0, &fault);
+    errorViewController.setFault(fault);
     screen.setRootViewController(&errorViewController);
 
     while (1) {
       screen.update();
     }
+#endif
   }
 
-  // @WORKAROUND[1]: Set Connection-Interval for Training-Mode.
-  // Search for `WORKAROUND[1]` for further information.
-  // setConnectionInterval(CONNECTION_INTERVAL_DEFAULT);
-  setConnectionInterval(CONNECTION_INTERVAL_TRAINING);
   // set the local name peripheral advertises
   BLE.setLocalName("Signalboy_1");
   // set the UUID for the service this peripheral advertises
@@ -388,12 +903,27 @@ void setup() {
   // add the characteristic to the service
   outputService.addCharacteristic(targetTimestampChar);
   outputService.addCharacteristic(triggerTimerChar);
+  outputService.addCharacteristic(codedTargetTimestampChar);
+  outputService.addCharacteristic(channelTargetTimestampChar);
   BLE.addService(outputService);
 
   timeSyncService.addCharacteristic(timeNeedsSyncChar);
   timeSyncService.addCharacteristic(referenceTimestampChar);
+  timeSyncService.addCharacteristic(syncIdentityTokenChar);
+  timeSyncService.addCharacteristic(syncQualityChar);
+  timeSyncService.addCharacteristic(wiredReferenceTimestampChar);
   BLE.addService(timeSyncService);
 
+  inputService.addCharacteristic(captureEventsChar);
+  BLE.addService(inputService);
+
+  diagnosticsService.addCharacteristic(outputLatencyChar);
+  diagnosticsService.addCharacteristic(faultLogChar);
+  BLE.addService(diagnosticsService);
+
+  configurationService.addCharacteristic(configurationChar);
+  BLE.addService(configurationService);
+
   connectionInformationService.addCharacteristic(connectionOptionsChar);
   BLE.addService(connectionInformationService);
 
@@ -405,176 +935,465 @@ void setup() {
   targetTimestampChar.writeValue(0);
 
   triggerTimerChar.setEventHandler(BLEWritten, onTriggerTimerWritten);
+  codedTargetTimestampChar.setEventHandler(BLEWritten, onCodedTargetTimestampWritten);
+  channelTargetTimestampChar.setEventHandler(BLEWritten, onChannelTargetTimestampWritten);
 
   timeNeedsSyncChar.writeValue(1);
 
   referenceTimestampChar.setEventHandler(BLEWritten, onReferenceTimestampWritten);
   referenceTimestampChar.writeValue(0);
 
+  syncIdentityTokenChar.setEventHandler(BLEWritten, onSyncIdentityTokenWritten);
+
+  updateSyncQuality(true);
+
+  captureEventsChar.setEventHandler(BLESubscribed, onCaptureEventsSubscribed);
+  wiredReferenceTimestampChar.setEventHandler(BLEWritten, onWiredReferenceTimestampWritten);
+
+  updateOutputLatency();
+
+  configurationChar.setEventHandler(BLEWritten, onConfigurationWritten);
+  updateConfiguration();
+
+  faultLogChar.setEventHandler(BLEWritten, onFaultLogWritten);
+  updateFaultLog();
+
   connectionOptionsChar.writeValue(0);
 
+  // Serial-Protocol
+  serialContext.isActive = true;
+  serialContext.addressKey = { syncCacheKeyNONE, {} };
+  serialContext.connectionHandle = CONNECTION_HANDLE_NONE;
+  serialContext.syncCacheKey = serialContext.addressKey;
+  serialContext.isSyncVerificationPending = false;
+  serialContext.isWiredSyncActive = false;
+  initWiredSyncPairing(serialContext.wiredSyncPairing);
+  serialContext.lastTimerArmedTime = millisRtc(false);
+  initClock(serialContext.clock);
+  initTraining(serialContext.training);
+
+  setupSerialProtocol(&Serial);
+  setSerialMessageHandler(SERIAL_MSG_TARGET_TIMESTAMP, onSerialTargetTimestamp);
+  setSerialMessageHandler(SERIAL_MSG_SCHEDULE, onSerialSchedule);
+  setSerialMessageHandler(SERIAL_MSG_TRIGGER, onSerialTrigger);
+  setSerialMessageHandler(SERIAL_MSG_REFERENCE_TIMESTAMP, onSerialReferenceTimestamp);
+  setSerialMessageHandler(SERIAL_MSG_WIRED_REFERENCE_TIMESTAMP, onSerialWiredReferenceTimestamp);
+  setSerialMessageHandler(SERIAL_MSG_SET_TIME, onSerialSetTime);
+  setSerialMessageHandler(SERIAL_MSG_CODED_SCHEDULE, onSerialCodedSchedule);
+  setSerialMessageHandler(SERIAL_MSG_CHANNEL_SCHEDULE, onSerialChannelSchedule);
+  setSerialMessageHandler(SERIAL_MSG_CALIBRATE, onSerialCalibrate);
+  setSerialMessageHandler(SERIAL_MSG_CONFIGURE, onSerialConfigure);
+  setSerialMessageHandler(SERIAL_MSG_READ_CONFIG, onSerialReadConfig);
+  setSerialMessageHandler(SERIAL_MSG_READ_INFO, onSerialReadInfo);
+  setSerialMessageHandler(SERIAL_MSG_READ_DIAGNOSTICS, onSerialReadDiagnostics);
+  setSerialMessageHandler(SERIAL_MSG_READ_FAULTS, onSerialReadFaults);
+#ifdef TRACE
+  setSerialMessageHandler(SERIAL_MSG_READ_TRACE, onSerialReadTrace);
+#endif
+#ifdef RECORD
+  setSerialMessageHandler(SERIAL_MSG_READ_RECORDING, onSerialReadRecording);
+#endif
+#ifdef WATCHDOG
+  setSerialMessageHandler(SERIAL_MSG_READ_STALLS, onSerialReadStalls);
+#endif
+  // Keys are provisioned by USB only (not by the Centrals).
+  setSerialMessageHandler(SERIAL_MSG_PROVISION_CONFIG_KEY, onSerialProvisionConfigKey);
+#ifdef OBSERVER_MODE
+  setSerialMessageHandler(SERIAL_MSG_PROVISION_BROADCASTER, onSerialProvisionBroadcaster);
+#endif
+
   // start advertising
   BLE.advertise();
 
+#ifdef OBSERVER_MODE
+  setupObserver();
+#endif
+
   isBLESetupComplete = true;
+  invalidateStateDisplay();
   Log.println(("Bluetooth® device active, waiting for connections..."));
+
+  // Record the inputs from here on (s. recorder.h).
+  setupRecorder();
+  recordConfig(currentConfig());
+  setupIdle();
+  // Watch the loop for stalls from here on (s. watchdog.h).
+  setupWatchdog();
 }
 
 void loop() {
 #ifdef DEBUG
-  unsigned long startTime = millis();
+  unsigned long startTime = micros();
 #endif
-  
+
+  feedWatchdog();
   eventLoop();
 
 #ifdef DEBUG
-  unsigned long endTime = millis();
+  unsigned long endTime = micros();
 
-  if (endTime - startTime > 2) {
-    Log.println("WARNING: Loop took " + String(endTime - startTime) + "ms!");
+  if (endTime - startTime > 2000) {
+    Log.println("WARNING: Loop took " + String((endTime - startTime) / 1000) + "ms!");
+    loopOverrunsCount++;
   }
 
   updateEventLoopStats(startTime, endTime);
 
-  if (endTime - lastPrintEventLoopStatsTime >= 3000 && endTime != lastPrintEventLoopStatsTime) {
+  unsigned long now = millis();
+  if (now - lastPrintEventLoopStatsTime >= 3000) {
     printLoopRuntimeStats();
+    // (Coalesced: A fault per overrun would flush the fault log.)
+    if (loopOverrunsCount > 0) {
+      reportFault(FAULT_DOMAIN_SYSTEM, FAULT_CODE_LOOP_OVERRUN, maxLoopRuntime / 1000, loopOverrunsCount);
+    }
     resetRuntimeStats();
 
-    lastPrintEventLoopStatsTime = endTime;
+    lastPrintEventLoopStatsTime = now;
   }
 #endif /* DEBUG */
+
+  // Sleep until the next interrupt, unless any timer is about to change (s. idle.h).
+  unsigned long deadline = 0;
+  bool hasDeadline = nextTimerDeadline(&deadline);
+  idle(hasDeadline, deadline);
 }
 
 void eventLoop() {
+  TRACE_SCOPE(TRACE_POINT_LOOP);
+
   /* --- High Priority --- */
 
   // Non-blocking (only write while immediate available)
+  TRACE_BEGIN(TRACE_POINT_LOG_DRAIN);
   Log.writeWhileAvailable();
+  TRACE_END(TRACE_POINT_LOG_DRAIN);
 
   updateOutputPin();
 
-  setTrainingTimeoutIfNeeded();
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    if (centralContexts[i].isActive) {
+      setTrainingTimeoutIfNeeded(centralContexts[i].training);
+    }
+  }
+  setTrainingTimeoutIfNeeded(serialContext.training);
   
   // poll for Bluetooth® Low Energy events
+  TRACE_BEGIN(TRACE_POINT_BLE_POLL);
   BLE.poll(0);
+  TRACE_END(TRACE_POINT_BLE_POLL);
+  TRACE_BEGIN(TRACE_POINT_SERIAL_POLL);
+  pollSerialProtocol();
+  TRACE_END(TRACE_POINT_SERIAL_POLL);
+
+  TRACE_BEGIN(TRACE_POINT_CONNECTION_MODE);
+  updateConnectionMode();
+  TRACE_END(TRACE_POINT_CONNECTION_MODE);
+  TRACE_BEGIN(TRACE_POINT_SYNC_SOURCE);
+  updateSyncSource();
+  TRACE_END(TRACE_POINT_SYNC_SOURCE);
+
+#ifdef OBSERVER_MODE
+  TRACE_BEGIN(TRACE_POINT_OBSERVER);
+  pollObserver();
+  TRACE_END(TRACE_POINT_OBSERVER);
+#endif
+
+  TRACE_BEGIN(TRACE_POINT_CAPTURE);
+  dispatchCaptureEvents();
+  notifyCaptureEventsIfNeeded();
+  TRACE_END(TRACE_POINT_CAPTURE);
+  TRACE_BEGIN(TRACE_POINT_CALIBRATION);
+  if (updateCalibration()) {
+    updateOutputLatency();
+  }
+  TRACE_END(TRACE_POINT_CALIBRATION);
 
   // poll for GPIO-input pin (DEBUG)
+  TRACE_BEGIN(TRACE_POINT_INPUT);
   pollInput();
+  TRACE_END(TRACE_POINT_INPUT);
 
   /* --- Low Priority (execution suspended during Training or when any Alarm is armed) --- */
-  if (trainingStatus().statusCode == trainingPending || isScheduledTimerArmed || isTriggerTimerArmed) {
+  if (isAnyTrainingPending() || isAnyTimerArmed()) {
     return; // break loop
   }
 
+  TRACE_BEGIN(TRACE_POINT_TIME_NEEDS_SYNC);
   updateTimeNeedsSync();
+  TRACE_END(TRACE_POINT_TIME_NEEDS_SYNC);
+  TRACE_BEGIN(TRACE_POINT_SYNC_QUALITY);
+  updateSyncQuality(false);
+  TRACE_END(TRACE_POINT_SYNC_QUALITY);
+  TRACE_BEGIN(TRACE_POINT_PERSIST_CONFIG);
+  persistConfigIfNeeded();
+#ifdef OBSERVER_MODE
+  persistBroadcasterKeysIfNeeded();
+#endif
+  TRACE_END(TRACE_POINT_PERSIST_CONFIG);
+  TRACE_BEGIN(TRACE_POINT_FAULT_LOG);
+  notifyFaultLogIfNeeded();
+  TRACE_END(TRACE_POINT_FAULT_LOG);
 
   // Handle LCD-display
+  TRACE_BEGIN(TRACE_POINT_DISPLAY);
   updateStateDisplay();
+  TRACE_END(TRACE_POINT_DISPLAY);
+  TRACE_BEGIN(TRACE_POINT_SCREEN_UPDATE);
+#ifdef HEADLESS
+  updateStatusLed();
+#else
   screen.update();
+#endif
+  TRACE_END(TRACE_POINT_SCREEN_UPDATE);
 }
 
 void blePeripheralConnectHandler(BLEDevice central) {
+  TRACE_SCOPE(TRACE_POINT_CONNECTED);
+  recordConnected(central);
+
   Log.printTimestamp();
 
   // central connected event handler
   Log.print("Connected event, central: ");
   Log.println(central.address());
 
+  CentralContext *context = nullptr;
+  for (int i = 0; i < MAX_CENTRALS; i++) {
+    if (!centralContexts[i].isActive) {
+      context = &centralContexts[i];
+      break;
+    }
+  }
+
+  if (!context) {
+    Log.println("WARNING: Maximum number of Centrals exceeded. Will disconnect.");
+    reportFault(FAULT_DOMAIN_CONNECTION, FAULT_CODE_TOO_MANY_CENTRALS);
+    central.disconnect();
+    return;
+  }
+
+  context->isActive = true;
+  context->addressKey = makeSyncCacheKey(central.address().c_str());
+  context->connectionHandle = getConnectionHandle(central.address().c_str());
+  context->syncCacheKey = context->addressKey;
+  context->isSyncVerificationPending = false;
+  context->isWiredSyncActive = false;
+  initWiredSyncPairing(context->wiredSyncPairing);
+  context->lastTimerArmedTime = millisRtc(false);
+  initClock(context->clock);
+  initTraining(context->training);
+
+  restoreSyncIfCached(*context);
+  updateTimeNeedsSync();
+  invalidateStateDisplay();
+
+  // Keep accepting further Centrals.
+  if (getConnectedCentralsCount() < MAX_CENTRALS) {
+    BLE.advertise();
+  }
+
 #ifdef DEBUG
   // isHeartbeatEnabled = false;
 #endif
 }
 
 void blePeripheralDisconnectHandler(BLEDevice central) {
+  TRACE_SCOPE(TRACE_POINT_DISCONNECTED);
+  recordDisconnected(central);
+
   Log.printTimestamp();
 
   // central disconnected event handler
   Log.print("Disconnected event, central: ");
   Log.println(central.address());
 
-  // Reset connection options.
-  connectionOptionsChar.writeValue(0);
+  CentralContext *context = findCentralContext(central);
+  if (context) {
+    // Pending timers of the Central still fire.
+    releaseTimers(context->clock);
+    context->isActive = false;
+
+    if (recordingContext == context) {
+      recordingContext = nullptr;
+    }
+  }
+  invalidateStateDisplay();
+
+  if (getConnectedCentralsCount() == 0) {
+    // Reset connection options.
+    connectionOptionsChar.writeValue(0);
+  }
+  updateTimeNeedsSync();
+
+  BLE.advertise();
 
 #ifdef DEBUG
   // isHeartbeatEnabled = true;
 #endif
 }
 
-bool isScheduledTimerDue(bool isArmed) {
-  unsigned long nowTime = now();
-  unsigned long elapsed = nowTime - lastScheduledTimerArmedTime;
-
-  if (isArmed) {
-    return elapsed >= scheduledTimerDelay && elapsed <= scheduledTimerDelay + SIGNAL_HIGH_INTERVAL;
+void updateOutputPin() {
+  TRACE_SCOPE(TRACE_POINT_OUTPUT);
+
+  // Coded signals: The pulse trains are emitted immediately (blocking).
+  PulseCode pulseCode;
+  uint8_t channel;
+  while (takeDueCodedTimer(&pulseCode, &channel)) {
+    TRACE_BEGIN(TRACE_POINT_PULSE_CODE);
+    emitPulseCode(Outputs::getPin(channel), pulseCode);
+    TRACE_END(TRACE_POINT_PULSE_CODE);
   }
 
-  return false;
-}
+  // Levels of every channel (bit `i`: channel `i`)
+  uint8_t levels = updateTimers();
 
-bool isTriggerTimerDue(bool isArmed) {
-  unsigned long nowTimeUnsynced = millisRtc(false);
-  unsigned long elapsed = nowTimeUnsynced - lastTriggerTimerArmedTime;
-  
-  if (isArmed) {
-    return elapsed >= triggerTimerDelay && elapsed <= triggerTimerDelay + SIGNAL_HIGH_INTERVAL;
+#ifdef DEBUG
+  // Heartbeat:
+  // Heartbeat is emitted every 3 seconds.
+  if (isHeartbeatEnabled && millisRtc(false) % 3000 <= currentConfig().signalHighInterval) {
+    levels |= 1 << SCHEDULER_DEFAULT_CHANNEL;
   }
+#endif
 
-  return false;
+  // Finally write (signal-)values to the outputs
+  Outputs::write(levels);
+  recordOutput(levels);
 }
 
-void updateOutputPin() {
-  PinStatus value = LOW;
+/// Arms a timer on `channel` at `targetTimestamp` (synced time of the Central), that
+/// emits the pulse train of `pulseCode` (if not `nullptr`).
+///
+/// Returns `false`, if every timer is armed (or `channel` is invalid).
+bool armScheduledTimer(CentralContext &context, unsigned long targetTimestamp, uint8_t channel, const PulseCode *pulseCode) {
+  if (channel >= Outputs::count) {
+    Log.printTimestamp();
+    Log.println(String("WARNING: Invalid channel (channel=") + String(channel) + ")! Timer will be dropped.");
+    reportFault(FAULT_DOMAIN_TIMER, FAULT_CODE_INVALID_CHANNEL, channel);
+    return false;
+  }
 
-  if (isScheduledTimerDue(isScheduledTimerArmed)) {
-    if (!hasScheduledTimerFired) {
-      Log.print(millisRtc(false));
-      Log.print(" ms (millisRtc) -> ");
-      Log.println("Fire! (Scheduled Timer)");
-    }
+  bool isArmed;
 
-    // Turn on
-    value = HIGH;
-    hasScheduledTimerFired = true;
+  unsigned long delay = targetTimestamp - now(context.clock);
+  if (delay <= currentConfig().maxTimerDelay) {
+    isArmed = pulseCode
+      ? armCodedTimer(context.clock, targetTimestamp, channel, *pulseCode, timerSourceSCHEDULED)
+      : armTimer(context.clock, targetTimestamp, channel, timerSourceSCHEDULED);
   } else {
-    if (hasScheduledTimerFired) {
-      // Invalidate timer
-      isScheduledTimerArmed = false;
-    }
+    // Delay is invalid (overflow?): Fire timer immediately.
+    Log.printTimestamp();
+    Log.println(String("WARNING: Delay (delay=") + String(delay) + ") is invalid! Timer will be fired immediately.");
+    reportFault(FAULT_DOMAIN_TIMER, FAULT_CODE_INVALID_DELAY, delay, channel);
+    isArmed = pulseCode
+      ? armCodedTimer(millisRtc(false), channel, *pulseCode, timerSourceSCHEDULED)
+      : armTimer(millisRtc(false), channel, timerSourceSCHEDULED);
   }
+  context.lastTimerArmedTime = millisRtc(false);
 
-  if (isTriggerTimerDue(isTriggerTimerArmed)) {
-    if (!hasTriggerTimerFired) {
-      Log.print(millisRtc(false));
-      Log.print(" ms (millisRtc) -> ");
-      Log.println("Fire! (Trigger Timer)");
-    }
+  return isArmed;
+}
 
-    // Turn on
-    value = HIGH;
-    hasTriggerTimerFired = true;
+/// Arms a timer at `targetTime` (local time).
+///
+/// Returns `false`, if every timer is armed.
+bool armTriggerTimer(CentralContext &context, unsigned long targetTime) {
+  bool isArmed;
+
+  unsigned long delay = targetTime - millisRtc(false);
+  if (delay <= currentConfig().maxTimerDelay) {
+    isArmed = armTimer(targetTime, SCHEDULER_DEFAULT_CHANNEL, timerSourceTRIGGER);
   } else {
-    if (hasTriggerTimerFired) {
-      // Invalidate timer
-      isTriggerTimerArmed = false;
+    // Delay is invalid (overflow?): Fire timer immediately.
+    Log.printTimestamp();
+    Log.println(String("WARNING: Delay (delay=") + String(delay) + ") is invalid! Timer will be fired immediately.");
+    reportFault(FAULT_DOMAIN_TIMER, FAULT_CODE_INVALID_DELAY, delay, SCHEDULER_DEFAULT_CHANNEL);
+    isArmed = armTimer(millisRtc(false), SCHEDULER_DEFAULT_CHANNEL, timerSourceTRIGGER);
+  }
+  context.lastTimerArmedTime = millisRtc(false);
+
+  return isArmed;
+}
+
+/// Passes the Reference-Timestamp (received at local time `receivedTime`) to the
+/// Training (or the verification of a restored sync) of the Central.
+/// - `connectionInterval`: The interval (in µs) of the transport's Connection-Events.
+void handleReferenceTimestamp(CentralContext &context, unsigned long receivedTime, unsigned long value, unsigned long connectionInterval) {
+  if (context.isSyncVerificationPending) {
+    context.isSyncVerificationPending = false;
+
+    // Synced time at reception
+    unsigned long syncedReceivedTime = now(context.clock) - (millisRtc(false) - receivedTime);
+    if (isReferenceTimestampConsistent(value, syncedReceivedTime, connectionInterval)) {
+      Log.println("Restored sync confirmed.");
+    } else {
+      Log.println("Restored sync is inconsistent. Training required.");
+      invalidateTime(context.clock);
     }
+    updateTimeNeedsSync();
   }
 
-#ifdef DEBUG
-  // Heartbeat:
-  // Heartbeat is emitted every 3 seconds.
-  if (isHeartbeatEnabled && millisRtc(false) % 3000 <= SIGNAL_HIGH_INTERVAL) {
-    value = HIGH;
+  // Note: Also pass Reference-Timestamps used for verification to the Training
+  // (Centrals may opt to perform a Training instead).
+  onReceivedReferenceTimestamp(context.training, receivedTime, value, connectionInterval);
+  TrainingStatus status = trainingStatus(context.training);
+
+  switch (status.statusCode) {
+    case trainingSucceeded:
+      {
+        Log.print("Training succeeded. Setting time with synced timestamp (adjusted by network delay): ");
+        Log.println(status.adjustedReferenceTimestamp);
+
+        long step = setTime(context.clock, status.adjustedReferenceTimestamp, status.uncertainty, status.samplesCount);
+        // Small corrections are slewed: Only a step affects the armed timers.
+        rebaseTimers(context.clock, step);
+
+        storeSyncEpoch(context.syncCacheKey, context.clock.offset, context.clock.syncTime, status.uncertainty);
+        updateTimeNeedsSync();
+        updateSyncQuality(true);
+        break;
+      }
+
+    default:
+      break;
   }
-#endif
+}
+
+/// Syncs the Central's clock by the Wired-Reference-Timestamp (received at local time
+/// `receivedTime`) of the last wired sync pulse.
+///
+/// Returns `false`, if no pulse has been paired with the timestamp.
+bool handleWiredReferenceTimestamp(CentralContext &context, unsigned long receivedTime, unsigned long value) {
+  unsigned long edgeTime;
+  if (!pairWiredReferenceTimestamp(context.wiredSyncPairing, receivedTime, &edgeTime)) return false;
+
+  if (!context.isWiredSyncActive) {
+    Log.printTimestamp();
+    Log.println("Syncing by Wired-Sync (instead of Training).");
+  }
+
+  // Synced time (at the current local time)
+  long step = setTime(context.clock, value + (millisRtc(false) - edgeTime), WIRED_SYNC_UNCERTAINTY, 1);
+  rebaseTimers(context.clock, step);
+  storeSyncEpoch(context.syncCacheKey, context.clock.offset, context.clock.syncTime, WIRED_SYNC_UNCERTAINTY);
+
+  context.isWiredSyncActive = true;
+  context.lastWiredSyncTime = receivedTime;
+  // The wired sync supersedes a restored sync.
+  context.isSyncVerificationPending = false;
+  updateTimeNeedsSync();
 
-  // Finally write (signal-)value to output
-  // if (value == HIGH) Log.println("HIGH");
-  digitalWrite(PIN_OUTPUT, value);
+  return true;
 }
 
 void onTargetTimestampWritten(BLEDevice central, BLECharacteristic characteristic) {
-  // Synced time
-  unsigned long receivedTime = now();
+  TRACE_SCOPE(TRACE_POINT_TARGET_TIMESTAMP);
+  recordWritten(central, characteristic);
+
+  CentralContext *context = findCentralContext(central);
+  if (!context) return;
+
+  // Synced time (of the Central)
+  unsigned long receivedTime = now(context->clock);
   Log.printTimestamp();
   Log.print(String(receivedTime) + " ms (synced) -> ");
 
@@ -587,49 +1406,111 @@ void onTargetTimestampWritten(BLEDevice central, BLECharacteristic characteristi
   Log.print(", delta: ");
   Log.println(targetTimestamp - receivedTime);
 
-  unsigned long delay = targetTimestamp - now();
-  if (delay <= MAX_TIMER_DELAY) {
-    armScheduledTimer(delay);
-  } else {
-    // Delay is invalid (overflow?): Fire timer immediately.
-    Log.printTimestamp();
-    Log.println(String("WARNING: Delay (delay=") + String(delay) + ") is invalid! Timer will be fired immediately.");
-    armScheduledTimer(0);
-  }
+  armScheduledTimer(*context, targetTimestamp, SCHEDULER_DEFAULT_CHANNEL, nullptr);
 
   updateOutputPin();
 }
 
 void onTriggerTimerWritten(BLEDevice central, BLECharacteristic characteristic) {
-  // Unsynced time
-  unsigned long receivedTime = millisRtc(false);
+  TRACE_SCOPE(TRACE_POINT_TRIGGER_TIMER);
+  recordWritten(central, characteristic);
+
+  CentralContext *context = findCentralContext(central);
+  if (!context) return;
+
+  // Unsynced time (at the anchor of the Connection-Event that delivered the value)
+  unsigned long receivedTime = getLastConnectionEventTime(context->connectionHandle);
   Log.printTimestamp();
 
   // central wrote new value to characteristic
   Log.print("on -> Characteristic event (triggerOutput), value: ");
 
   byte value = triggerTimerChar.value();
-  Log.println(value);
+  Log.print(value);
+  Log.print(", rx-offset: ");
+  Log.print(getLastConnectionEventRxOffsetMicros(context->connectionHandle));
+  Log.println(" us");
 
   unsigned long targetTime = receivedTime + value;
-  // Correct network latency (guesstimation: 1/2 Connection-Interval)
-  targetTime -= getConnectionInterval() / 2;
+  // Correct network latency: The value has been queued by the Central until the
+  // Connection-Event's anchor (on average for 1/2 Connection-Interval).
+  targetTime -= getConnectionIntervalMicros(context->connectionHandle) / 2000UL;
 
-  unsigned long delay = targetTime - millisRtc(false);
-  if (delay <= MAX_TIMER_DELAY) {
-    armTriggerTimer(delay);
-  } else {
-    // Delay is invalid (overflow?): Fire timer immediately.
+  armTriggerTimer(*context, targetTime);
+
+  updateOutputPin();
+}
+
+void onChannelTargetTimestampWritten(BLEDevice central, BLECharacteristic characteristic) {
+  TRACE_SCOPE(TRACE_POINT_CHANNEL_TARGET_TIMESTAMP);
+  recordWritten(central, characteristic);
+
+  CentralContext *context = findCentralContext(central);
+  if (!context) return;
+
+  ChannelTargetTimestampValue value;
+  memcpy(&value, channelTargetTimestampChar.value(), sizeof(value));
+
+  // Synced time (of the Central)
+  unsigned long receivedTime = now(context->clock);
+  Log.printTimestamp();
+  Log.print(String(receivedTime) + " ms (synced) -> ");
+  Log.print("on -> Characteristic event (channelTargetTimestamp), value: ");
+  Log.print(value.targetTimestamp);
+  Log.print(", channel: ");
+  Log.print(value.channel);
+  Log.print(", delta: ");
+  Log.println(value.targetTimestamp - receivedTime);
+
+  armScheduledTimer(*context, value.targetTimestamp, value.channel, nullptr);
+
+  updateOutputPin();
+}
+
+void onCodedTargetTimestampWritten(BLEDevice central, BLECharacteristic characteristic) {
+  TRACE_SCOPE(TRACE_POINT_CODED_TARGET_TIMESTAMP);
+  recordWritten(central, characteristic);
+
+  CentralContext *context = findCentralContext(central);
+  if (!context) return;
+
+  CodedTargetTimestampValue value;
+  memcpy(&value, codedTargetTimestampChar.value(), sizeof(value));
+
+  // Synced time (of the Central)
+  unsigned long receivedTime = now(context->clock);
+  Log.printTimestamp();
+  Log.print(String(receivedTime) + " ms (synced) -> ");
+  Log.print("on -> Characteristic event (codedTargetTimestamp), value: ");
+  Log.print(value.targetTimestamp);
+  Log.print(", code: ");
+  Log.print(value.code);
+  Log.print(", delta: ");
+  Log.println(value.targetTimestamp - receivedTime);
+
+  PulseCode pulseCode = { value.code, value.unitWidth ? value.unitWidth : (uint16_t)PULSE_CODE_UNIT_WIDTH_DEFAULT };
+  if (!isValidPulseCodeUnitWidth(pulseCode.unitWidth)) {
     Log.printTimestamp();
-    Log.println(String("WARNING: Delay (delay=") + String(delay) + ") is invalid! Timer will be fired immediately.");
-    armTriggerTimer(0);
+    Log.println(String("WARNING: Unit width (") + String(pulseCode.unitWidth) + " us) is out of range! Using default.");
+    reportFault(FAULT_DOMAIN_TIMER, FAULT_CODE_INVALID_UNIT_WIDTH, pulseCode.unitWidth);
+    pulseCode.unitWidth = PULSE_CODE_UNIT_WIDTH_DEFAULT;
   }
 
+  armScheduledTimer(*context, value.targetTimestamp, SCHEDULER_DEFAULT_CHANNEL, &pulseCode);
+
   updateOutputPin();
 }
 
 void onReferenceTimestampWritten(BLEDevice central, BLECharacteristic characteristic) {
-  unsigned long receivedTime = millisRtc(false);
+  TRACE_SCOPE(TRACE_POINT_REFERENCE_TIMESTAMP);
+  recordWritten(central, characteristic);
+
+  CentralContext *context = findCentralContext(central);
+  if (!context) return;
+
+  // Unsynced time (at the anchor of the Connection-Event that delivered the value)
+  unsigned long receivedTime = getLastConnectionEventTime(context->connectionHandle);
+  unsigned long connectionInterval = getConnectionIntervalMicros(context->connectionHandle);
 
   // central wrote new value to characteristic
   Log.print(receivedTime);
@@ -639,33 +1520,421 @@ void onReferenceTimestampWritten(BLEDevice central, BLECharacteristic characteri
   unsigned long value = referenceTimestampChar.value();
   Log.println(value);
 
-  onReceivedReferenceTimestamp(receivedTime, value);
-  TrainingStatus status = trainingStatus();
+  handleReferenceTimestamp(*context, receivedTime, value, connectionInterval);
 
-  switch (status.statusCode) {
-    case trainingSucceeded:
-      Log.print("Training succeeded. Setting time with synced timestamp (adjusted by network delay): ");
-      Log.println(status.adjustedReferenceTimestamp);
+  updateOutputPin();
+}
 
-      setTime(status.adjustedReferenceTimestamp);
-      updateTimeNeedsSync();
-      break;
+void onSyncIdentityTokenWritten(BLEDevice central, BLECharacteristic characteristic) {
+  recordWritten(central, characteristic);
 
-    default:
-      break;
+  CentralContext *context = findCentralContext(central);
+  if (!context) return;
+
+  Log.printTimestamp();
+  Log.println("on -> Characteristic event (syncIdentityToken)");
+
+  // Identify the Central by its token from now on.
+  context->syncCacheKey = makeSyncCacheKey(syncIdentityTokenChar.value(), syncIdentityTokenChar.valueLength());
+  restoreSyncIfCached(*context);
+}
+
+void onWiredReferenceTimestampWritten(BLEDevice central, BLECharacteristic characteristic) {
+  recordWritten(central, characteristic);
+
+  CentralContext *context = findCentralContext(central);
+  if (!context) return;
+
+  handleWiredReferenceTimestamp(*context, millisRtc(false), wiredReferenceTimestampChar.value());
+}
+
+void onConfigurationWritten(BLEDevice central, BLECharacteristic characteristic) {
+  recordWritten(central, characteristic);
+
+  Log.printTimestamp();
+  Log.println("on -> Characteristic event (configuration)");
+
+  applyAuthenticatedConfig(configurationChar.value(), configurationChar.valueLength());
+  updateConfiguration();
+}
+
+void onFaultLogWritten(BLEDevice central, BLECharacteristic characteristic) {
+  recordWritten(central, characteristic);
+
+  if (faultLogChar.valueLength() < 1) return;
+
+  faultLogIndex = faultLogChar.value()[0];
+  updateFaultLog();
+}
+
+void onCaptureEventsSubscribed(BLEDevice central, BLECharacteristic characteristic) {
+  recordSubscribed(central, characteristic);
+
+  CentralContext *context = findCentralContext(central);
+  if (!context) return;
+
+  Log.printTimestamp();
+  Log.print("on -> Characteristic event (captureEvents), subscribed: ");
+  Log.println(central.address());
+
+  // Report captured edges in the synced time of this Central from now on.
+  recordingContext = context;
+}
+
+// MARK: - Serial-Protocol
+
+uint32_t readSerialUInt32(const SerialMessage &message, int index) {
+  uint32_t value;
+  memcpy(&value, &message.parameters[index * sizeof(uint32_t)], sizeof(value));
+  return value;
+}
+
+void onSerialTargetTimestamp(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, sizeof(uint32_t))) return;
+
+  unsigned long targetTimestamp = readSerialUInt32(message, 0);
+  Log.printTimestamp();
+  Log.print("on -> Serial-Message (targetTimestamp), value: ");
+  Log.println(targetTimestamp);
+
+  bool isArmed = armScheduledTimer(serialContext, targetTimestamp, SCHEDULER_DEFAULT_CHANNEL, nullptr);
+  sendSerialStatus(message, isArmed ? SERIAL_STATUS_OK : SERIAL_STATUS_REJECTED);
+
+  updateOutputPin();
+}
+
+void onSerialSchedule(const SerialMessage &message) {
+  int count = message.length / sizeof(uint32_t);
+  if (count == 0 || count > SERIAL_SCHEDULE_MAX_TARGETS) {
+    sendSerialStatus(message, SERIAL_STATUS_INVALID_LENGTH);
+    return;
+  }
+  if (!validateSerialMessageLength(message, count * sizeof(uint32_t))) return;
+
+  Log.printTimestamp();
+  Log.print("on -> Serial-Message (schedule), count: ");
+  Log.println(count);
+
+  bool isArmed = true;
+  for (int i = 0; i < count; i++) {
+    isArmed &= armScheduledTimer(serialContext, readSerialUInt32(message, i), SCHEDULER_DEFAULT_CHANNEL, nullptr);
+  }
+  sendSerialStatus(message, isArmed ? SERIAL_STATUS_OK : SERIAL_STATUS_REJECTED);
+
+  updateOutputPin();
+}
+
+void onSerialChannelSchedule(const SerialMessage &message) {
+  int count = message.length > sizeof(uint8_t) ? (message.length - sizeof(uint8_t)) / sizeof(uint32_t) : 0;
+  if (count == 0 || count > SERIAL_SCHEDULE_MAX_TARGETS) {
+    sendSerialStatus(message, SERIAL_STATUS_INVALID_LENGTH);
+    return;
+  }
+  if (!validateSerialMessageLength(message, sizeof(uint8_t) + count * sizeof(uint32_t))) return;
+
+  uint8_t channel = message.parameters[0];
+  if (channel >= Outputs::count) {
+    sendSerialStatus(message, SERIAL_STATUS_INVALID_PARAMETER);
+    return;
+  }
+
+  Log.printTimestamp();
+  Log.print("on -> Serial-Message (channelSchedule), channel: ");
+  Log.print(channel);
+  Log.print(", count: ");
+  Log.println(count);
+
+  bool isArmed = true;
+  for (int i = 0; i < count; i++) {
+    uint32_t targetTimestamp;
+    memcpy(&targetTimestamp, &message.parameters[sizeof(uint8_t) + i * sizeof(uint32_t)], sizeof(targetTimestamp));
+    isArmed &= armScheduledTimer(serialContext, targetTimestamp, channel, nullptr);
+  }
+  sendSerialStatus(message, isArmed ? SERIAL_STATUS_OK : SERIAL_STATUS_REJECTED);
+
+  updateOutputPin();
+}
+
+void onSerialCodedSchedule(const SerialMessage &message) {
+  int count = message.length > sizeof(uint16_t) ? (message.length - sizeof(uint16_t)) / sizeof(SerialCodedTarget) : 0;
+  if (count == 0 || count > SERIAL_SCHEDULE_MAX_TARGETS) {
+    sendSerialStatus(message, SERIAL_STATUS_INVALID_LENGTH);
+    return;
+  }
+  if (!validateSerialMessageLength(message, sizeof(uint16_t) + count * sizeof(SerialCodedTarget))) return;
+
+  uint16_t unitWidth;
+  memcpy(&unitWidth, message.parameters, sizeof(unitWidth));
+  if (unitWidth == 0) unitWidth = PULSE_CODE_UNIT_WIDTH_DEFAULT;
+  if (!isValidPulseCodeUnitWidth(unitWidth)) {
+    sendSerialStatus(message, SERIAL_STATUS_INVALID_PARAMETER);
+    return;
+  }
+
+  Log.printTimestamp();
+  Log.print("on -> Serial-Message (codedSchedule), count: ");
+  Log.println(count);
+
+  bool isArmed = true;
+  for (int i = 0; i < count; i++) {
+    SerialCodedTarget target;
+    memcpy(&target, &message.parameters[sizeof(uint16_t) + i * sizeof(target)], sizeof(target));
+
+    PulseCode pulseCode = { target.code, unitWidth };
+    isArmed &= armScheduledTimer(serialContext, target.targetTimestamp, SCHEDULER_DEFAULT_CHANNEL, &pulseCode);
   }
+  sendSerialStatus(message, isArmed ? SERIAL_STATUS_OK : SERIAL_STATUS_REJECTED);
+
+  updateOutputPin();
+}
+
+void onSerialTrigger(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, sizeof(uint8_t))) return;
+
+  byte value = message.parameters[0];
+  Log.printTimestamp();
+  Log.print("on -> Serial-Message (triggerOutput), value: ");
+  Log.println(value);
+
+  // Unlike BLE, the request is not queued for a Connection-Event: No correction
+  // of the latency (which is below the resolution of the local time).
+  bool isArmed = armTriggerTimer(serialContext, message.receivedTime + value);
+  sendSerialStatus(message, isArmed ? SERIAL_STATUS_OK : SERIAL_STATUS_REJECTED);
+
+  updateOutputPin();
+}
+
+void onSerialReferenceTimestamp(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, sizeof(uint32_t))) return;
+
+  unsigned long value = readSerialUInt32(message, 0);
+  Log.print(message.receivedTime);
+  Log.print(" ms -> ");
+  Log.print("on -> Serial-Message (referenceTimestamp), written: ");
+  Log.println(value);
+
+  sendSerialStatus(message, SERIAL_STATUS_OK);
+  // The requests are polled by the host every USB-frame.
+  handleReferenceTimestamp(serialContext, message.receivedTime, value, USB_FRAME_INTERVAL);
 
   updateOutputPin();
 }
 
+void onSerialWiredReferenceTimestamp(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, sizeof(uint32_t))) return;
+
+  bool isPaired = handleWiredReferenceTimestamp(serialContext, message.receivedTime, readSerialUInt32(message, 0));
+  sendSerialStatus(message, isPaired ? SERIAL_STATUS_OK : SERIAL_STATUS_REJECTED);
+}
+
+void onSerialSetTime(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, sizeof(SerialSetTimeRequest))) return;
+
+  SerialSetTimeRequest request;
+  memcpy(&request, message.parameters, sizeof(request));
+
+  unsigned long localTime = millisRtc(false);
+  unsigned long age = localTime - request.localTime;
+  Log.printTimestamp();
+  Log.print("on -> Serial-Message (setTime), uncertainty: ");
+  Log.print((unsigned long)request.uncertainty);
+  Log.print(" us, age: ");
+  Log.print(age);
+  Log.println(" ms");
+
+  if (age > SERIAL_SYNC_MAX_AGE) {
+    sendSerialStatus(message, SERIAL_STATUS_REJECTED);
+    return;
+  }
+
+  // Synced time (at the current local time)
+  long step = setTime(serialContext.clock, request.syncedTime + age, request.uncertainty, request.samplesCount);
+  rebaseTimers(serialContext.clock, step);
+
+  // Supersedes the Wired-Sync (until the next Wired-Reference-Timestamp).
+  serialContext.isWiredSyncActive = false;
+  sendSerialStatus(message, SERIAL_STATUS_OK);
+  updateTimeNeedsSync();
+}
+
+void onSerialCalibrate(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, 0)) return;
+
+  if (isCalibrating()) {
+    sendSerialStatus(message, SERIAL_STATUS_REJECTED);
+    return;
+  }
+
+  Log.printTimestamp();
+  Log.println("on -> Serial-Message (calibrate)");
+
+  startCalibration(CAPTURE_CHANNEL_CALIBRATION);
+  sendSerialStatus(message, SERIAL_STATUS_OK);
+}
+
+void sendSerialConfig(const SerialMessage &message, uint8_t status) {
+  SerialConfigResponse response;
+  response.status = status;
+  response.length = configReport(response.bytes);
+
+  sendSerialResponse(message, &response, offsetof(SerialConfigResponse, bytes) + response.length);
+}
+
+void onSerialConfigure(const SerialMessage &message) {
+  Log.printTimestamp();
+  Log.println("on -> Serial-Message (configure)");
+
+  uint8_t status = applyConfig(message.parameters, message.length);
+  updateConfiguration();
+  sendSerialConfig(message, status == CONFIG_STATUS_OK ? SERIAL_STATUS_OK : SERIAL_STATUS_INVALID_PARAMETER);
+}
+
+void onSerialReadConfig(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, 0)) return;
+
+  sendSerialConfig(message, SERIAL_STATUS_OK);
+}
+
+void onSerialReadInfo(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, 0)) return;
+
+  SerialInfo info = { SERIAL_STATUS_OK, SERIAL_PROTOCOL_VERSION, HARDWARE_REVISION, SOFTWARE_REVISION };
+  sendSerialResponse(message, &info, sizeof(info));
+}
+
+void onSerialReadDiagnostics(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, 0)) return;
+
+  SerialDiagnostics diagnostics;
+  diagnostics.status = SERIAL_STATUS_OK;
+  diagnostics.timeNeedsSync = getTimeNeedsSync(serialContext);
+
+  SyncQuality quality = syncQuality(serialContext.clock);
+  bool isSynced = timeStatus(serialContext.clock) != timeNotSet;
+  diagnostics.syncUncertainty = isSynced ? quality.uncertainty : 0xffffffff;
+  diagnostics.timeSinceSync = isSynced ? quality.timeSinceSync : 0;
+  diagnostics.syncSamplesCount = isSynced ? quality.samplesCount : 0;
+  diagnostics.skew = quality.skew;
+  diagnostics.skewUncertainty = quality.skewUncertainty;
+
+  CalibrationResult result = calibrationResult();
+  diagnostics.isOutputCalibrated = result.isValid;
+  diagnostics.calibrationSamplesCount = result.samplesCount;
+  diagnostics.outputLatency = result.median;
+  diagnostics.outputLatencyMinimum = result.minimum;
+  diagnostics.outputLatencyMaximum = result.maximum;
+
+  diagnostics.droppedFramesCount = min(droppedSerialFramesCount(), 0xffffU);
+
+  MemoryUsage usage = memoryUsage();
+  diagnostics.heapSize = min(usage.heapSize, (uint32_t)0xffff);
+  diagnostics.heapUsed = min(usage.heapUsed, (uint32_t)0xffff);
+  diagnostics.minimumFreeStack = min(usage.minimumFreeStack, (uint32_t)0xffff);
+  diagnostics.allocationsCount = usage.allocationsCount;
+  diagnostics.deallocationsCount = usage.deallocationsCount;
+
+  IdleStats stats = idleStats();
+  diagnostics.idleTime = stats.sleepTime;
+  diagnostics.wakeLatencyMaximum = stats.wakeLatencyMaximum;
+  diagnostics.wakeLatencyMean = stats.wakeLatencyMean;
+
+  switch (getState()) {
+    case stateINITIAL: diagnostics.state = SERIAL_STATE_STARTING; break;
+    case stateAWAITING_CONNECTION: diagnostics.state = SERIAL_STATE_AWAITING_CONNECTION; break;
+    case stateCONNECTED: diagnostics.state = SERIAL_STATE_CONNECTED; break;
+  }
+
+  sendSerialResponse(message, &diagnostics, sizeof(diagnostics));
+}
+
+#ifdef TRACE
+void onSerialReadTrace(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, 0)) return;
+
+  SerialTraceResponse response;
+  response.status = SERIAL_STATUS_OK;
+  response.count = takeTraceEvents(response.events, SERIAL_TRACE_MAX_EVENTS);
+
+  sendSerialResponse(message, &response, offsetof(SerialTraceResponse, events) + response.count * sizeof(TraceEvent));
+}
+#endif /* TRACE */
+
+#ifdef RECORD
+void onSerialReadRecording(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, 0)) return;
+
+  SerialRecordingResponse response;
+  response.status = SERIAL_STATUS_OK;
+  response.length = takeRecording(response.bytes, sizeof(response.bytes));
+
+  sendSerialResponse(message, &response, offsetof(SerialRecordingResponse, bytes) + response.length);
+}
+#endif /* RECORD */
+
+void onSerialReadFaults(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, sizeof(uint8_t))) return;
+
+  SerialFaultsResponse response;
+  response.status = SERIAL_STATUS_OK;
+  response.page = faultLogPage(message.parameters[0]);
+
+  sendSerialResponse(message, &response, offsetof(SerialFaultsResponse, page.faults) + response.page.count * sizeof(FaultRecord));
+}
+
+#ifdef WATCHDOG
+void onSerialReadStalls(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, 0)) return;
+
+  SerialStallsResponse response;
+  response.status = SERIAL_STATUS_OK;
+  response.report = stallReport();
+
+  sendSerialResponse(message, &response, sizeof(response));
+}
+#endif /* WATCHDOG */
+
+void onSerialProvisionConfigKey(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, sizeof(SerialConfigKey))) return;
+
+  SerialConfigKey request;
+  memcpy(&request, message.parameters, sizeof(request));
+
+  static const uint8_t REVOKED_KEY[sizeof(request.key)] = {};
+  bool isRevoked = memcmp(request.key, REVOKED_KEY, sizeof(request.key)) == 0;
+  provisionConfigKey(isRevoked ? nullptr : request.key);
+
+  sendSerialStatus(message, SERIAL_STATUS_OK);
+}
+
+#ifdef OBSERVER_MODE
+void onSerialProvisionBroadcaster(const SerialMessage &message) {
+  if (!validateSerialMessageLength(message, sizeof(SerialBroadcasterKey))) return;
+
+  SerialBroadcasterKey request;
+  memcpy(&request, message.parameters, sizeof(request));
+
+  static const uint8_t REVOKED_KEY[sizeof(request.key)] = {};
+  bool isRevoked = memcmp(request.key, REVOKED_KEY, sizeof(request.key)) == 0;
+  if (!provisionBroadcasterKey(request.broadcasterId, isRevoked ? nullptr : request.key)) {
+    sendSerialStatus(message, SERIAL_STATUS_INVALID_PARAMETER);
+    return;
+  }
+
+  sendSerialStatus(message, SERIAL_STATUS_OK);
+}
+#endif /* OBSERVER_MODE */
+
 #ifdef DEBUG
 void resetRuntimeStats() {
   avgLoopRuntime = 0.0;
+  maxLoopRuntime = 0;
   loopCount = 0;
+  loopOverrunsCount = 0;
 }
 
 void updateEventLoopStats(unsigned long startTime, unsigned long endTime) {  
   avgLoopRuntime = (avgLoopRuntime * loopCount + (endTime - startTime)) / (loopCount + 1);
+  maxLoopRuntime = max(maxLoopRuntime, endTime - startTime);
   loopCount++;
 }
 
@@ -673,6 +1942,13 @@ char _buffer [20];
 void printLoopRuntimeStats() {
   Log.printTimestamp();
   snprintf(_buffer, 20, "%.2f", avgLoopRuntime);
-  Log.println("avgLoopRuntime=" + String(_buffer));
+  Log.println("avgLoopRuntime=" + String(_buffer) + "us, maxLoopRuntime=" + String(maxLoopRuntime) + "us");
+
+#ifdef IDLE_SLEEP
+  IdleStats stats = idleStats();
+  Log.printTimestamp();
+  Log.println("idle: " + String(stats.sleepsCount) + " sleeps, wake-up latency " + String(stats.wakeLatencyMean)
+    + " us (max " + String(stats.wakeLatencyMaximum) + " us)");
+#endif
 }
 #endif
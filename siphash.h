@@ -0,0 +1,19 @@
+/*
+  SipHash-2-4
+
+  Keyed hash function (by Jean-Philippe Aumasson and Daniel J. Bernstein) used to
+  authenticate short messages, i.e. the Broadcast-Advertisements (s. observer.h).
+*/
+
+#ifndef siphash_h
+#define siphash_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SIPHASH_KEY_SIZE 16
+
+/// Returns the 64-bit MAC of `length` bytes of `data` using the 128-bit `key`.
+uint64_t siphash24(const uint8_t *data, size_t length, const uint8_t key[SIPHASH_KEY_SIZE]);
+
+#endif /* siphash_h */
@@ -0,0 +1,77 @@
+/*
+  Stall
+
+  Context of a stall of the loop, as captured by the watchdog (s. watchdog.h): Its
+  cause, the task the loop stalled in, the code it stalled at and the state of the
+  timers, and the number of stalls by cause. Read by `SERIAL_MSG_READ_STALLS` (s.
+  serialMessages.h).
+
+  This header does not depend on the Arduino core: It is shared with the host tools
+  (s. `Host/`).
+*/
+
+#ifndef stall_h
+#define stall_h
+
+#include <stdint.h>
+#include "traceEvents.h"
+
+enum StallCause {
+  /// Stalled in a task of the loop (s. `StallContext.task`).
+  STALL_CAUSE_TASK = 0,
+  /// Stalled in a callback (BLE or Serial-Protocol) of a task.
+  STALL_CAUSE_CALLBACK = 1,
+  /// Stalled in an ISR (of a lower priority than the watchdog's).
+  STALL_CAUSE_INTERRUPT = 2,
+  /// Did not recover: Reset by the watchdog (counted in addition to the cause
+  /// captured by the early warning, if any).
+  STALL_CAUSE_RESET = 3,
+};
+
+#define STALL_CAUSES_COUNT 4
+
+/// `StallContext.task` outside of any task (i.e. between runs of `eventLoop()`).
+#define STALL_TASK_NONE 0xff
+/// `StallContext.duration` of a stall the loop did not recover from.
+#define STALL_DURATION_UNRECOVERED 0xffffffff
+
+struct __attribute__((packed)) StallContext {
+  uint8_t cause;
+  /// The innermost task (a `TracePoint`, s. traceEvents.h) the loop stalled in.
+  uint8_t task;
+  /// Program counter and link register of the stalled code (s. the map of the sketch).
+  uint32_t pc;
+  uint32_t lr;
+  /// Local time (`millisRtc()`) of the early warning.
+  uint32_t time;
+  /// in ms: From the last check-in of the loop to the next one.
+  uint32_t duration;
+  /// Number of armed timers and the next local time any of them changes (s.
+  /// `nextTimerDeadline()`): Valid only, if any timer is armed.
+  uint8_t armedTimersCount;
+  uint32_t nextTimerDeadline;
+};
+
+struct __attribute__((packed)) StallReport {
+  /// Number of stalls by cause (s. `StallCause`) since power-on.
+  uint16_t stallsCount[STALL_CAUSES_COUNT];
+  /// 1, if `lastStall` is valid.
+  uint8_t hasLastStall;
+  StallContext lastStall;
+};
+
+inline const char *getStallCauseName(uint8_t cause) {
+  switch (cause) {
+    case STALL_CAUSE_TASK: return "task";
+    case STALL_CAUSE_CALLBACK: return "callback";
+    case STALL_CAUSE_INTERRUPT: return "interrupt";
+    case STALL_CAUSE_RESET: return "reset";
+  }
+  return "unknown";
+}
+
+inline const char *getStallTaskName(uint8_t task) {
+  return task == STALL_TASK_NONE ? "none" : getTracePointName(task);
+}
+
+#endif /* stall_h */
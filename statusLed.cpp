@@ -0,0 +1,40 @@
+#include <Arduino.h>
+#include "statusLed.h"
+
+// in ms
+#define SLOT_DURATION 125
+#define SLOTS_COUNT 16
+
+// The slots of each pattern (bit 15: first slot), by `statusLedPattern_t`
+static const uint16_t PATTERNS[] = {
+  0xcccc,  // statusLedSTARTING
+  0x8000,  // statusLedAWAITING_CONNECTION
+  0xa000,  // statusLedCONNECTED
+  0xfffe,  // statusLedSYNCED
+  0xaaaa,  // statusLedERROR
+};
+
+static int ledPin = -1;
+static statusLedPattern_t currentPattern = statusLedSTARTING;
+static int ledLevel = LOW;
+
+void setupStatusLed(int pin) {
+  ledPin = pin;
+  pinMode(ledPin, OUTPUT);
+  digitalWrite(ledPin, ledLevel);
+}
+
+void setStatusLedPattern(statusLedPattern_t pattern) {
+  currentPattern = pattern;
+}
+
+void updateStatusLed(void) {
+  if (ledPin < 0) return;
+
+  int slot = (millis() / SLOT_DURATION) % SLOTS_COUNT;
+  int level = (PATTERNS[currentPattern] >> (SLOTS_COUNT - 1 - slot)) & 1 ? HIGH : LOW;
+  if (level == ledLevel) return;
+
+  ledLevel = level;
+  digitalWrite(ledPin, ledLevel);
+}
@@ -0,0 +1,32 @@
+/*
+  Status-LED
+
+  Shows the state of the Signalboy by a blink pattern of an LED: Replaces the
+  LCD-display in headless builds (s. `HEADLESS` in `Globals.hpp`). A pattern repeats
+  every 2 s, in 16 slots of 125 ms.
+*/
+
+#ifndef statusLed_h
+#define statusLed_h
+
+#include <stdint.h>
+
+typedef enum {
+  /// Blinking (2 Hz): Starting.
+  statusLedSTARTING,
+  /// A flash every 2 s: Awaiting a connection.
+  statusLedAWAITING_CONNECTION,
+  /// Two flashes every 2 s: Connected, not synced.
+  statusLedCONNECTED,
+  /// On, off for a moment every 2 s: Connected and synced.
+  statusLedSYNCED,
+  /// Blinking fast (4 Hz): Failed (i.e. BLE).
+  statusLedERROR,
+} statusLedPattern_t;
+
+void setupStatusLed(int pin);
+void setStatusLedPattern(statusLedPattern_t pattern);
+/// Switches the LED according to its pattern: Called by the loop.
+void updateStatusLed(void);
+
+#endif /* statusLed_h */
@@ -0,0 +1,81 @@
+#include <Arduino.h>
+#include "syncCache.h"
+
+#define SYNC_CACHE_SIZE 4
+
+struct SyncCacheEntry {
+  bool isValid;
+  SyncCacheKey key;
+  SyncEpoch epoch;
+};
+
+static SyncCacheEntry entries[SYNC_CACHE_SIZE];
+
+bool isEqualSyncCacheKey(const SyncCacheKey &lhs, const SyncCacheKey &rhs) {
+  return lhs.type == rhs.type && memcmp(lhs.data, rhs.data, SYNC_CACHE_KEY_SIZE) == 0;
+}
+
+SyncCacheKey makeSyncCacheKey(const char *address) {
+  SyncCacheKey key = { syncCacheKeyADDRESS, {} };
+
+  for (int i = 0; i < 6; i++) {
+    unsigned int value;
+    if (sscanf(&address[i * 3], "%2x", &value) != 1) {
+      key.type = syncCacheKeyNONE;
+      break;
+    }
+    key.data[i] = value;
+  }
+
+  return key;
+}
+
+SyncCacheKey makeSyncCacheKey(const uint8_t token[], int length) {
+  SyncCacheKey key = { syncCacheKeyTOKEN, {} };
+  memcpy(key.data, token, min(length, SYNC_CACHE_KEY_SIZE));
+
+  return key;
+}
+
+void storeSyncEpoch(const SyncCacheKey &key, unsigned long offset, unsigned long syncTime, unsigned long uncertainty) {
+  if (key.type == syncCacheKeyNONE) return;
+
+  SyncCacheEntry *entry = nullptr;
+  for (int i = 0; i < SYNC_CACHE_SIZE; i++) {
+    if (entries[i].isValid && isEqualSyncCacheKey(entries[i].key, key)) {
+      entry = &entries[i];
+      break;
+    }
+  }
+
+  if (!entry) {
+    // Use an empty entry, or replace the least recent one.
+    entry = &entries[0];
+    for (int i = 0; i < SYNC_CACHE_SIZE; i++) {
+      if (!entries[i].isValid) {
+        entry = &entries[i];
+        break;
+      }
+      if (syncTime - entries[i].epoch.syncTime > syncTime - entry->epoch.syncTime) {
+        entry = &entries[i];
+      }
+    }
+  }
+
+  entry->isValid = true;
+  entry->key = key;
+  entry->epoch = { offset, syncTime, uncertainty };
+}
+
+bool findSyncEpoch(const SyncCacheKey &key, SyncEpoch *epoch) {
+  if (key.type == syncCacheKeyNONE) return false;
+
+  for (int i = 0; i < SYNC_CACHE_SIZE; i++) {
+    if (entries[i].isValid && isEqualSyncCacheKey(entries[i].key, key)) {
+      *epoch = entries[i].epoch;
+      return true;
+    }
+  }
+
+  return false;
+}
@@ -0,0 +1,51 @@
+/*
+  Sync-Cache
+
+  Keeps the sync epochs (the mapping of the local to the synced time established
+  by a Training) of recently connected Centrals. This allows a reconnecting Central
+  to confirm the continuity of its previous sync with a single Reference-Timestamp
+  instead of a full Training.
+*/
+
+#ifndef syncCache_h
+#define syncCache_h
+
+#define SYNC_CACHE_KEY_SIZE 8
+
+typedef enum {
+  syncCacheKeyNONE,
+  /// Keyed by the Central's (BLE-)address.
+  syncCacheKeyADDRESS,
+  /// Keyed by an identity-token provided by the Central (survives
+  /// changes of the Central's address, i.e. when using private addresses).
+  syncCacheKeyTOKEN,
+} syncCacheKeyType_t;
+
+struct SyncCacheKey {
+  syncCacheKeyType_t type;
+  uint8_t data[SYNC_CACHE_KEY_SIZE];
+};
+
+struct SyncEpoch {
+  /// Offset of the synced time to the local time (unsynced): `now() - millisRtc()`.
+  unsigned long offset;
+  /// Time (unsynced) at which the Training that established this epoch completed.
+  unsigned long syncTime;
+  /// Uncertainty (in µs) of the offset at `syncTime`.
+  unsigned long uncertainty;
+};
+
+bool isEqualSyncCacheKey(const SyncCacheKey &lhs, const SyncCacheKey &rhs);
+
+/// Parses an address formatted as "aa:bb:cc:dd:ee:ff".
+SyncCacheKey makeSyncCacheKey(const char *address);
+/// Takes an identity-token of up to `SYNC_CACHE_KEY_SIZE` bytes.
+SyncCacheKey makeSyncCacheKey(const uint8_t token[], int length);
+
+/// Stores the epoch (replacing any previous epoch of the same key, or
+/// the least recent epoch if the cache is full).
+void storeSyncEpoch(const SyncCacheKey &key, unsigned long offset, unsigned long syncTime, unsigned long uncertainty);
+/// Returns `true` and sets `epoch`, if an epoch is cached for `key`.
+bool findSyncEpoch(const SyncCacheKey &key, SyncEpoch *epoch);
+
+#endif /* syncCache_h */
@@ -2,54 +2,214 @@
 // https://github.com/PaulStoffregen/Time/blob/master/Time.cpp
 
 #include <Arduino.h>
+#include "Globals.hpp"
 #include "Logger.hpp"
 #include "time.h"
+#include "constants.h"
 #include "rtc.hpp"
 
-static unsigned long syncInterval = 300 * MILISECS_PER_SEC;  // time sync will be attempted after this many miliseconds
+static unsigned long syncInterval = 300 * MILISECS_PER_SEC;  // time sync will be attempted after this many miliseconds (at the latest)
+static unsigned long syncAccuracyBudget = SYNC_ACCURACY_BUDGET;  // time sync will be attempted once the predicted uncertainty exceeds this many µs
 
-static unsigned long sysTime = 0;
-static unsigned long prevMillisRtc = 0;
+/// The correction (in ms) that remains to be slewed at `localTime`.
+static long remainingSlew(SyncedClock &clock, unsigned long localTime) {
+  if (clock.slewCorrection == 0) return 0;
 
-static unsigned long nextSyncTime = 0;
-static timeStatus_t Status = timeNotSet;
+  // ppm * ms = 1e-6 ms
+  long slewed = (long)((unsigned long long)(localTime - clock.slewStartTime) * CLOCK_SLEW_RATE / 1000000ULL);
+  if (slewed >= abs(clock.slewCorrection)) {
+    // Slewing finished.
+    clock.slewCorrection = 0;
+    return 0;
+  }
+
+  return clock.slewCorrection > 0 ? clock.slewCorrection - slewed : clock.slewCorrection + slewed;
+}
+
+static unsigned long effectiveOffset(SyncedClock &clock, unsigned long localTime) {
+  return clock.offset - remainingSlew(clock, localTime);
+}
+
+/// Uncertainty (in µs) of the (effective) offset at `localTime`.
+static unsigned long predictUncertainty(SyncedClock &clock, unsigned long localTime) {
+  unsigned long long skewBound = clock.hasSkew
+    ? (unsigned long long)abs(clock.skew) + clock.skewUncertainty
+    : CLOCK_SKEW_DEFAULT;
+  unsigned long elapsed = localTime - clock.syncTime;
+  long slew = remainingSlew(clock, localTime);
+
+  // ppb * ms = 1e-6 µs
+  return clock.syncUncertainty + abs(slew) * 1000UL + (unsigned long)(skewBound * elapsed / 1000000ULL);
+}
+
+static void updateStatus(SyncedClock &clock, unsigned long localTime) {
+  if (clock.status != timeSet) return;
+
+  unsigned long elapsed = localTime - clock.syncTime;
+  if (elapsed >= syncInterval || predictUncertainty(clock, localTime) > syncAccuracyBudget) {
+    clock.status = timeNeedsSync;
+  }
+}
+
+/// Starts a new series of syncs (the skew is unknown).
+static void resetBaseline(SyncedClock &clock) {
+  clock.skew = 0;
+  clock.skewUncertainty = 0;
+  clock.hasSkew = false;
+  clock.baselineOffset = clock.offset;
+  clock.baselineSyncTime = clock.syncTime;
+  clock.baselineUncertainty = clock.syncUncertainty;
+  clock.baselineSyncCount = 1;
+  clock.samplesCount = 0;
+}
+
+static void applyTime(SyncedClock &clock, unsigned long t, unsigned long uncertainty, unsigned long localTime) {
+  clock.offset = t - localTime;
+  clock.slewCorrection = 0;
+  clock.syncTime = localTime;
+  clock.syncUncertainty = uncertainty;
+  clock.status = timeSet;
+}
+
+/// Estimates the skew from the offset's change since the baseline. Returns `false`,
+/// if the change is implausible (i.e. the Central's clock has been reset).
+static bool updateSkew(SyncedClock &clock) {
+  long long elapsed = clock.syncTime - clock.baselineSyncTime;  // in ms
+  if (elapsed <= 0) return true;
+
+  // ms / ms -> ppb
+  long long skew = (long long)(long)(clock.offset - clock.baselineOffset) * 1000000000LL / elapsed;
+  // µs / ms -> ppb
+  long long skewUncertainty = ((long long)clock.baselineUncertainty + clock.syncUncertainty) * 1000000LL / elapsed;
+
+  if (llabs(skew) > (long long)CLOCK_SKEW_MAX + skewUncertainty) return false;
+
+  // Prefer the default, as long as the baseline is too short for a more accurate estimation.
+  if (skewUncertainty < (long long)CLOCK_SKEW_DEFAULT) {
+    clock.skew = skew;
+    clock.skewUncertainty = skewUncertainty;
+    clock.hasSkew = true;
+  }
+
+  return true;
+}
+
+void initClock(SyncedClock &clock) {
+  clock.offset = 0;
+  clock.slewCorrection = 0;
+  clock.syncTime = millisRtc(false);
+  clock.syncUncertainty = 0;
+  clock.status = timeNotSet;
+  resetBaseline(clock);
+}
+
+unsigned long now(SyncedClock &clock) {
+  unsigned long localTime = millisRtc(false);
+  updateStatus(clock, localTime);
+
+  return localTime + effectiveOffset(clock, localTime);
+}
+
+long setTime(SyncedClock &clock, unsigned long t, unsigned long uncertainty, unsigned int samplesCount) {
+  unsigned long localTime = millisRtc(false);
+  bool isResync = clock.status != timeNotSet;
+  unsigned long elapsed = localTime - clock.syncTime;
+  unsigned long previousUncertainty = predictUncertainty(clock, localTime);
+  unsigned long previousOffset = effectiveOffset(clock, localTime);
+
+  applyTime(clock, t, uncertainty, localTime);
 
-unsigned long now() {
-  // calculate number of seconds passed since last call to now()
-  while (millisRtc(false) - prevMillisRtc > 0) {
-    // millis() and prevMillis are both unsigned ints thus the subtraction will always be the absolute value of the difference
-    sysTime++;
-    prevMillisRtc++;
+  long correction = isResync ? (long)(clock.offset - previousOffset) : 0;
+  long step = 0;
+  if ((unsigned long)abs(correction) <= CLOCK_STEP_THRESHOLD) {
+    // Keep the synced time continuous: Slew from the previous offset.
+    clock.slewCorrection = correction;
+    clock.slewStartTime = localTime;
+  } else {
+    step = correction;
   }
-  if (nextSyncTime <= sysTime) {
-    // if (getTimePtr != 0) {
-    //   unsigned long t = getTimePtr();
-    //   if (t != 0) {
-    //     setTime(t);
-    //   } else {
-        nextSyncTime = sysTime + syncInterval;
-        Status = (Status == timeNotSet) ? timeNotSet : timeNeedsSync;
-    //   }
-    // }
+
+  if (!isResync || !updateSkew(clock)) {
+    resetBaseline(clock);
+    clock.samplesCount = samplesCount;
+    return step;
+  }
+  clock.baselineSyncCount++;
+  clock.samplesCount += samplesCount;
+
+  Log.printTimestamp();
+  Log.print("Resync #");
+  Log.print(clock.baselineSyncCount - 1);
+  Log.print(" after ");
+  Log.print(elapsed);
+  Log.print(" ms (avg. ");
+  Log.print((localTime - clock.baselineSyncTime) / (clock.baselineSyncCount - 1));
+  Log.print(" ms): predicted uncertainty: ");
+  Log.print(previousUncertainty);
+  Log.print(" us, skew: ");
+  Log.print(clock.hasSkew ? String(clock.skew) + " +/- " + String(clock.skewUncertainty) : String("n/a"));
+  Log.print(" ppb, correction: ");
+  Log.print(correction);
+  Log.println(step != 0 ? " ms (stepped)" : " ms (slewed)");
+
+  return step;
+}
+
+long restoreTime(SyncedClock &clock, unsigned long t, unsigned long elapsedSinceSync, unsigned long uncertainty) {
+  unsigned long localTime = millisRtc(false);
+  bool isSet = clock.status != timeNotSet;
+  unsigned long previousOffset = effectiveOffset(clock, localTime);
+
+  applyTime(clock, t, uncertainty, localTime);
+  clock.syncTime -= elapsedSinceSync;
+  resetBaseline(clock);
+  updateStatus(clock, localTime);
+
+  return isSet ? (long)(clock.offset - previousOffset) : 0;
+}
+
+void invalidateTime(SyncedClock &clock) {
+  if (clock.status == timeSet) {
+    clock.status = timeNeedsSync;
   }
-  return (unsigned long)sysTime;
 }
 
-void setTime(unsigned long t) {
-  sysTime = (unsigned long)t;
-  nextSyncTime = (unsigned long)t + syncInterval;
-  Status = timeSet;
-  prevMillisRtc = millisRtc(false);  // restart counting from now (thanks to Korman for this fix)
+unsigned long toLocalTime(SyncedClock &clock, unsigned long t) {
+  return t - effectiveOffset(clock, millisRtc(false));
+}
+
+unsigned long toSyncedTime(SyncedClock &clock, unsigned long t) {
+  return t + effectiveOffset(clock, millisRtc(false));
 }
 
+unsigned long predictedUncertainty(SyncedClock &clock) {
+  return predictUncertainty(clock, millisRtc(false));
+}
+
+SyncQuality syncQuality(SyncedClock &clock) {
+  unsigned long localTime = millisRtc(false);
+  unsigned long elapsed = localTime - clock.syncTime;
+
+  struct SyncQuality quality = {
+    predictUncertainty(clock, localTime),
+    elapsed,
+    clock.samplesCount,
+    clock.hasSkew ? clock.skew : 0,
+    clock.hasSkew ? clock.skewUncertainty : CLOCK_SKEW_DEFAULT
+  };
+  return quality;
+}
 
 // indicates if time has been set and recently synchronized
-timeStatus_t timeStatus() {
-  now(); // required to actually update the status
-  return Status;
+timeStatus_t timeStatus(SyncedClock &clock) {
+  updateStatus(clock, millisRtc(false)); // required to actually update the status
+  return clock.status;
 }
 
-void setSyncInterval(unsigned long interval) { // set the number of miliseconds between re-sync
+void setSyncInterval(unsigned long interval) { // set the maximum number of miliseconds between re-sync
   syncInterval = interval;
-  nextSyncTime = sysTime + syncInterval;
+}
+
+void setSyncAccuracyBudget(unsigned long budget) { // set the maximum predicted uncertainty (in µs) before re-sync
+  syncAccuracyBudget = budget;
 }
@@ -1,6 +1,9 @@
 // The following code is copied and modified from:
 // https://github.com/PaulStoffregen/Time/blob/master/TimeLib.h
 
+#ifndef time_h
+#define time_h
+
 /*==============================================================================*/
 /* Useful Constants */
 #define MILISECS_PER_SEC 1000UL
@@ -11,10 +14,91 @@ typedef enum {
   timeSet
 } timeStatus_t;
 
+/// Maps the local time (unsynced: `millisRtc()`) to the time synced with
+/// a Central. Every connected Central maintains its own clock.
+///
+/// The clock predicts the uncertainty of its offset: The uncertainty of the
+/// last sync grows with the (estimated) skew of the Central's clock to the
+/// local clock. A re-sync is needed once the prediction exceeds the accuracy
+/// budget (or the sync interval has elapsed).
+///
+/// Small corrections of a re-sync are slewed (at `CLOCK_SLEW_RATE`), larger
+/// ones are stepped (s. `setTime()`).
+struct SyncedClock {
+  /// Offset (in ms) of the synced time to the local time (as of the last sync).
+  unsigned long offset;
+  /// Correction (in ms) of the offset that remained to be slewed at `slewStartTime`:
+  /// The effective offset is `offset - slewCorrection` at that time.
+  long slewCorrection;
+  unsigned long slewStartTime;
+  /// The local time of the last sync.
+  unsigned long syncTime;
+  /// Uncertainty (in µs) of the offset at the last sync.
+  unsigned long syncUncertainty;
+  timeStatus_t status;
+
+  /// Estimated skew (in ppb) of the synced time to the local time.
+  long skew;
+  /// Uncertainty (in ppb) of `skew`.
+  unsigned long skewUncertainty;
+  /// `true`, if the skew has been estimated (otherwise, `CLOCK_SKEW_DEFAULT` is assumed).
+  bool hasSkew;
+
+  /// The first sync of a continuous series of syncs (the baseline of the skew estimation).
+  unsigned long baselineOffset;
+  unsigned long baselineSyncTime;
+  unsigned long baselineUncertainty;
+  /// Number of syncs since (and including) the baseline.
+  unsigned int baselineSyncCount;
+  /// Number of samples (Reference-Timestamps) of the syncs since the baseline.
+  unsigned int samplesCount;
+};
+
+/// Quality of a synced time (s. `syncQuality()`).
+struct SyncQuality {
+  /// Predicted uncertainty (in µs) of the offset.
+  unsigned long uncertainty;
+  /// Time (in ms) since the last sync.
+  unsigned long timeSinceSync;
+  /// Number of samples (Reference-Timestamps) the estimation is based on.
+  unsigned int samplesCount;
+  /// Estimated skew (in ppb) and its uncertainty (`skew == 0` and
+  /// `skewUncertainty == CLOCK_SKEW_DEFAULT`, if not estimated yet).
+  long skew;
+  unsigned long skewUncertainty;
+};
+
+void initClock(SyncedClock &clock);
+
 /// in ms
-unsigned long now();
-void setTime(unsigned long t);
+unsigned long now(SyncedClock &clock);
+/// - `uncertainty`: The uncertainty (in µs) of `t` (s. `TrainingStatus`).
+/// - `samplesCount`: The number of samples `t` has been estimated of.
+///
+/// Returns the step (in ms) the synced time jumped by: 0, if the time has not been
+/// set before or the correction (up to `CLOCK_STEP_THRESHOLD`) is slewed.
+long setTime(SyncedClock &clock, unsigned long t, unsigned long uncertainty, unsigned int samplesCount);
+/// Sets the time from a previous sync that happened `elapsedSinceSync` ms ago
+/// (the uncertainty is predicted relative to that sync).
+///
+/// Returns the step (in ms) the synced time jumped by (the time is never slewed).
+long restoreTime(SyncedClock &clock, unsigned long t, unsigned long elapsedSinceSync, unsigned long uncertainty);
+/// Marks the time as in need of a re-sync.
+void invalidateTime(SyncedClock &clock);
+
+/// Converts the synced time `t` to local time (unsynced: `millisRtc()`).
+unsigned long toLocalTime(SyncedClock &clock, unsigned long t);
+/// Converts the local time `t` (unsynced: `millisRtc()`) to synced time.
+unsigned long toSyncedTime(SyncedClock &clock, unsigned long t);
+
+/// The predicted uncertainty (in µs) of the offset at the current local time.
+unsigned long predictedUncertainty(SyncedClock &clock);
+/// The quality of the synced time at the current local time.
+SyncQuality syncQuality(SyncedClock &clock);
 
 /* time sync functions	*/
-timeStatus_t timeStatus();                     // indicates if time has been set and recently synchronized
-void setSyncInterval(unsigned long interval);  // set the number of seconds between re-sync
+timeStatus_t timeStatus(SyncedClock &clock);   // indicates if time has been set and recently synchronized
+void setSyncInterval(unsigned long interval);  // set the maximum number of miliseconds between re-sync
+void setSyncAccuracyBudget(unsigned long budget);  // set the maximum predicted uncertainty (in µs) before re-sync
+
+#endif /* time_h */
@@ -0,0 +1,60 @@
+#include <Arduino.h>
+#include "trace.h"
+
+#ifdef TRACE
+
+static TraceEvent events[TRACE_CAPACITY];
+// Index of the oldest event and number of events (written by the loop and the ISRs).
+static volatile unsigned int eventsTail = 0;
+static volatile unsigned int eventsCount = 0;
+static volatile bool isFrozen = false;
+
+void traceEvent(uint8_t type, uint8_t point, uint16_t argument) {
+  noInterrupts();
+  if (isFrozen) {
+    interrupts();
+    return;
+  }
+
+  unsigned long time = micros();
+
+  if (eventsCount == TRACE_CAPACITY) {
+    // Overwrite the oldest event.
+    eventsTail = (eventsTail + 1) % TRACE_CAPACITY;
+    eventsCount--;
+  }
+
+  TraceEvent &event = events[(eventsTail + eventsCount) % TRACE_CAPACITY];
+  event.time = time;
+  event.type = type;
+  event.point = point;
+  event.argument = argument;
+  eventsCount++;
+  interrupts();
+}
+
+void freezeTrace(void) {
+  isFrozen = true;
+}
+
+int takeTraceEvents(TraceEvent *out, int count) {
+  int taken = 0;
+
+  noInterrupts();
+  isFrozen = true;
+  while (taken < count && eventsCount > 0) {
+    out[taken++] = events[eventsTail];
+    eventsTail = (eventsTail + 1) % TRACE_CAPACITY;
+    eventsCount--;
+  }
+
+  if (taken == 0) {
+    // Drained
+    isFrozen = false;
+  }
+  interrupts();
+
+  return taken;
+}
+
+#endif /* TRACE */
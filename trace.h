@@ -0,0 +1,72 @@
+/*
+  Timeline-Trace
+
+  A ring buffer of begin/end events of the loop's tasks, of the callbacks and ISRs, and
+  of instants (i.e. a timer firing), stamped in µs (`micros()`: SysTick). Once full,
+  the oldest events are overwritten: The trace holds the recent history.
+
+  The trace is frozen (stops recording) by a late or missed timer, so it holds the
+  history of the late pulse, or by the first read: It is read by the host via
+  `SERIAL_MSG_READ_TRACE` (s. `signalboy-cli trace` and `signalboy-trace2json` of
+  `Host/`) and resumes recording once drained.
+
+  The begin and end of the tasks also mark the task the loop is in for the watchdog
+  (s. watchdog.h).
+
+  Enabled by defining `TRACE` (s. `Globals.hpp`): Otherwise, every trace point
+  compiles out (except for the marks of the watchdog).
+*/
+
+#ifndef trace_h
+#define trace_h
+
+#include <stdint.h>
+#include "Globals.hpp"
+#include "traceEvents.h"
+#include "watchdog.h"
+
+// Capacity of the ring buffer (in events).
+#define TRACE_CAPACITY 256
+
+#ifdef TRACE
+
+/// Records an event (also from ISRs).
+void traceEvent(uint8_t type, uint8_t point, uint16_t argument);
+
+/// Stops recording until the trace has been drained (s. `takeTraceEvents()`).
+void freezeTrace(void);
+
+/// Freezes the trace and moves up to `count` of its oldest events to `events`. Returns
+/// the number of events moved: 0 once drained (recording resumes).
+int takeTraceEvents(TraceEvent *events, int count);
+
+#define TRACE_BEGIN(point) (beginWatchdogTask(point), traceEvent(TRACE_EVENT_BEGIN, point, 0))
+#define TRACE_END(point) (traceEvent(TRACE_EVENT_END, point, 0), endWatchdogTask(point))
+#define TRACE_INSTANT(point, argument) traceEvent(TRACE_EVENT_INSTANT, point, argument)
+#define TRACE_FREEZE() freezeTrace()
+
+#else
+
+#define TRACE_BEGIN(point) beginWatchdogTask(point)
+#define TRACE_END(point) endWatchdogTask(point)
+#define TRACE_INSTANT(point, argument) ((void)0)
+#define TRACE_FREEZE() ((void)0)
+
+#endif /* TRACE */
+
+/// Traces the begin and end of the enclosing scope.
+class TraceScope {
+public:
+  TraceScope(uint8_t point) : point(point) { TRACE_BEGIN(point); }
+  ~TraceScope() { TRACE_END(point); }
+
+private:
+  uint8_t point;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#define TRACE_SCOPE(point) TraceScope TRACE_CONCAT(traceScope, __LINE__)(point)
+
+#endif /* trace_h */
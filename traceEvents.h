@@ -0,0 +1,118 @@
+/*
+  Trace-Events
+
+  Events of the timeline trace (s. trace.h): The begin and end of the loop's tasks and
+  of the BLE callbacks and ISRs, and instants (i.e. a timer firing). Events are read by
+  `SERIAL_MSG_READ_TRACE` (s. serialMessages.h).
+
+  This header does not depend on the Arduino core: It is shared with the host tools
+  (s. `Host/`).
+*/
+
+#ifndef traceEvents_h
+#define traceEvents_h
+
+#include <stdint.h>
+
+enum TraceEventType {
+  TRACE_EVENT_BEGIN = 0x00,
+  TRACE_EVENT_END = 0x01,
+  TRACE_EVENT_INSTANT = 0x02,
+};
+
+enum TracePoint {
+  // Tasks of the loop
+  TRACE_POINT_LOOP = 0x00,
+  TRACE_POINT_LOG_DRAIN = 0x01,
+  TRACE_POINT_OUTPUT = 0x02,
+  TRACE_POINT_BLE_POLL = 0x03,
+  TRACE_POINT_SERIAL_POLL = 0x04,
+  TRACE_POINT_CONNECTION_MODE = 0x05,
+  TRACE_POINT_SYNC_SOURCE = 0x06,
+  TRACE_POINT_OBSERVER = 0x07,
+  TRACE_POINT_CAPTURE = 0x08,
+  TRACE_POINT_CALIBRATION = 0x09,
+  TRACE_POINT_INPUT = 0x0a,
+  TRACE_POINT_TIME_NEEDS_SYNC = 0x0b,
+  TRACE_POINT_SYNC_QUALITY = 0x0c,
+  TRACE_POINT_DISPLAY = 0x0d,
+  TRACE_POINT_SCREEN_UPDATE = 0x0e,
+  TRACE_POINT_PULSE_CODE = 0x0f,
+  /// Sleeping until the next interrupt (s. idle.h)
+  TRACE_POINT_IDLE = 0x10,
+  /// Persisting the configuration to the flash (s. config.h): Stalls the CPU.
+  TRACE_POINT_PERSIST_CONFIG = 0x11,
+  /// Notifying new faults (s. faultLog.h)
+  TRACE_POINT_FAULT_LOG = 0x12,
+
+  // Callbacks (BLE, Serial-Protocol)
+  TRACE_POINT_CONNECTED = 0x20,
+  TRACE_POINT_DISCONNECTED = 0x21,
+  TRACE_POINT_TARGET_TIMESTAMP = 0x22,
+  TRACE_POINT_TRIGGER_TIMER = 0x23,
+  TRACE_POINT_REFERENCE_TIMESTAMP = 0x24,
+  TRACE_POINT_CODED_TARGET_TIMESTAMP = 0x25,
+  TRACE_POINT_CHANNEL_TARGET_TIMESTAMP = 0x26,
+  TRACE_POINT_SERIAL_MESSAGE = 0x27,
+
+  // Instants (argument: channel)
+  TRACE_POINT_TIMER_FIRED = 0x30,
+  TRACE_POINT_TIMER_MISSED = 0x31,
+  /// Late by more than the pulse width: The pulse starts late.
+  TRACE_POINT_TIMER_LATE = 0x32,
+
+  // Interrupts (ISRs): Points from here on are traced on the interrupts' track.
+  TRACE_POINT_ISR_CAPTURE = 0x40,
+};
+
+/// First `TracePoint` of a callback.
+#define TRACE_POINT_CALLBACK_FIRST TRACE_POINT_CONNECTED
+/// First `TracePoint` of an ISR.
+#define TRACE_POINT_ISR_FIRST TRACE_POINT_ISR_CAPTURE
+
+struct __attribute__((packed)) TraceEvent {
+  /// in µs (`micros()`)
+  uint32_t time;
+  uint8_t type;
+  uint8_t point;
+  uint16_t argument;
+};
+
+inline const char *getTracePointName(uint8_t point) {
+  switch (point) {
+    case TRACE_POINT_LOOP: return "loop";
+    case TRACE_POINT_LOG_DRAIN: return "Log.writeWhileAvailable";
+    case TRACE_POINT_OUTPUT: return "updateOutputPin";
+    case TRACE_POINT_BLE_POLL: return "BLE.poll";
+    case TRACE_POINT_SERIAL_POLL: return "pollSerialProtocol";
+    case TRACE_POINT_CONNECTION_MODE: return "updateConnectionMode";
+    case TRACE_POINT_SYNC_SOURCE: return "updateSyncSource";
+    case TRACE_POINT_OBSERVER: return "pollObserver";
+    case TRACE_POINT_CAPTURE: return "captureEvents";
+    case TRACE_POINT_CALIBRATION: return "updateCalibration";
+    case TRACE_POINT_INPUT: return "pollInput";
+    case TRACE_POINT_TIME_NEEDS_SYNC: return "updateTimeNeedsSync";
+    case TRACE_POINT_SYNC_QUALITY: return "updateSyncQuality";
+    case TRACE_POINT_DISPLAY: return "updateStateDisplay";
+    case TRACE_POINT_SCREEN_UPDATE: return "screen.update";
+    case TRACE_POINT_PULSE_CODE: return "emitPulseCode";
+    case TRACE_POINT_IDLE: return "idle";
+    case TRACE_POINT_PERSIST_CONFIG: return "persistConfigIfNeeded";
+    case TRACE_POINT_FAULT_LOG: return "notifyFaultLogIfNeeded";
+    case TRACE_POINT_CONNECTED: return "onConnected";
+    case TRACE_POINT_DISCONNECTED: return "onDisconnected";
+    case TRACE_POINT_TARGET_TIMESTAMP: return "onTargetTimestampWritten";
+    case TRACE_POINT_TRIGGER_TIMER: return "onTriggerTimerWritten";
+    case TRACE_POINT_REFERENCE_TIMESTAMP: return "onReferenceTimestampWritten";
+    case TRACE_POINT_CODED_TARGET_TIMESTAMP: return "onCodedTargetTimestampWritten";
+    case TRACE_POINT_CHANNEL_TARGET_TIMESTAMP: return "onChannelTargetTimestampWritten";
+    case TRACE_POINT_SERIAL_MESSAGE: return "onSerialMessage";
+    case TRACE_POINT_ISR_CAPTURE: return "captureISR";
+    case TRACE_POINT_TIMER_FIRED: return "timerFired";
+    case TRACE_POINT_TIMER_MISSED: return "timerMissed";
+    case TRACE_POINT_TIMER_LATE: return "timerLate";
+  }
+  return "unknown";
+}
+
+#endif /* traceEvents_h */
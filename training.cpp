@@ -3,184 +3,99 @@
 #include "constants.h"
 #include "Globals.hpp"
 #include "Logger.hpp"
+#include "faultLog.h"
+#include "rtc.hpp"
+
+static int trainingMsgsCount = TRAINING_MSGS_COUNT_DEFAULT;
+
+static const char *getTrainingFailureMessage(TrainingFailure failure) {
+  switch (failure) {
+    case TRAINING_FAILURE_INTERVAL_CHANGED: return "Connection-Interval changed during Training";
+    case TRAINING_FAILURE_MINIMUM_DELAY: return "Minimum delay not satisfied";
+    case TRAINING_FAILURE_MAXIMUM_REFERENCE_DELAY: return "Maximum Reference Delay exceeded";
+    case TRAINING_FAILURE_TIMEOUT: return "Training did timeout";
+    default: return "none";
+  }
+}
+
+/// Logs the Training completed (its Reference-Timestamps and the network delay).
+static void logTraining(const TrainingState &state) {
+  unsigned long connectionInterval = state.connectionInterval();
 
-getExternalTime getTimePtr = nullptr;  // pointer to external time provider function
-
-/// - value == -1 initially (no training attempt started, yet)
-/// - value > 0 during Training
-/// - value == 0 after at least one Training finished and while no new Training started
-int receivedTrainingMsgCounter = -1;
-
-// Reference-timestamps received during (time-sync) training
-unsigned long receivedReferenceTimestamps[TRAINING_MSGS_COUNT];
-// Local timestamps of the received messages during (time-sync) training
-unsigned long receivedTrainingMsgTimestamps[TRAINING_MSGS_COUNT];
-
-unsigned long adjustedReferenceTimestamp;
-/// `true`, if the last training was finished successfully.
-bool isSuccess = false;
-
-/// Takes the network delay specified in ms and returns the network delay
-/// as number of Connection-Events.
-int calculateNetworkDelay(unsigned long elapsed) {
-  /// Delay in number of Connection-Events
-  int networkDelay = elapsed / CONNECTION_INTERVAL;
-  // Discussion: While the Training Messages are ideally expected to arrive with
-  // a fixed delay of n-times Connection Events, that received time may not be
-  // exactly accurate on application level. Thus the network delay is just an
-  // approximation.
-  if (elapsed % CONNECTION_INTERVAL >= CONNECTION_INTERVAL / 2) {
-    networkDelay++;
+  for (int i = 1; i < state.samplesCount(); i++) {
+    unsigned long elapsed = state.receivedTime(i) - state.receivedTime(i - 1);
+    unsigned long referenceDelay = state.referenceTimestamp(i) - state.referenceTimestamp(i - 1);
+
+    Log.print(String(i - 1) + " -> " + String(i));
+    Log.print(String("\t") + "referenceDelay: " + String(referenceDelay) + " (ms)");
+    Log.print(String("\t") + "elapsed: " + String(elapsed) + " (ms)");
+    Log.println("\t-> networkDelay: " + String(TrainingState::networkDelay(elapsed, connectionInterval))
+      + " (approx. number of Connection-Events)");
   }
 
-  return networkDelay;
-}
+  Log.print("networkDelay (cumulative avg): ");
+  Log.print(state.networkDelay());
+  Log.println(" (number of Connection-Events)");
 
-void setTimeProvider(getExternalTime getTimeFunction) {
-  getTimePtr = getTimeFunction;
+  if (state.failure() != TRAINING_FAILURE_NONE) {
+    Log.print("EXCEPTION: ");
+    Log.print(getTrainingFailureMessage(state.failure()));
+    Log.print(" (connectionInterval=" + String(connectionInterval) + " us)!");
+    Log.println(" Will invalidate this Training attempt.");
+  }
 }
 
-bool ensureTimeProvider(void) {
-  if (!getTimePtr) {
-    Log.printTimestamp();
-    Log.println("setTrainingTimeoutIfNeeded() -> FATAL: getTimePtr is null!");
-    return false;
-  }
+unsigned long RtcTrainingClock::now(void) {
+  return millisRtc(false);
+}
 
-  return true;
+void setTrainingMsgsCount(int count) {
+  trainingMsgsCount = count;
 }
 
-void setTrainingTimeoutIfNeeded(void) {
-  if (!ensureTimeProvider()) return;
-  unsigned long now = getTimePtr();
-
-  if (receivedTrainingMsgCounter > 0) {
-    int index = receivedTrainingMsgCounter - 1;
-    int networkDelay = calculateNetworkDelay(now - receivedTrainingMsgTimestamps[index]);
-
-    if (networkDelay > 1) {
-      Log.print(now);
-      Log.print(" ms -> ");
-      Log.print("Training did timeout! Were some Training-Messages (BLE-Packets) lost? (received: ");
-      Log.print(receivedTrainingMsgCounter);
-      Log.print("/");
-      Log.print(TRAINING_MSGS_COUNT);
-      Log.println(")");
-
-      // Handle timeout: Reset counter
-      receivedTrainingMsgCounter = 0;
-      isSuccess = false;
-    }
-  }
+void initTraining(TrainingState &state) {
+  state.setSamplesCount(trainingMsgsCount);
+  state.reset();
 }
 
-void onReceivedReferenceTimestamp(unsigned long receivedTime, unsigned long referenceTimestamp) {
-  if (!ensureTimeProvider()) return;
+void setTrainingTimeoutIfNeeded(TrainingState &state) {
+  int receivedCount = state.receivedCount();
+  if (!state.setTimeoutIfNeeded()) return;
+
+  Log.printTimestamp();
+  Log.print("Training did timeout! Were some Training-Messages (BLE-Packets) lost? (received: ");
+  Log.print(receivedCount);
+  Log.print("/");
+  Log.print(state.samplesCount());
+  Log.println(")");
+  reportFault(FAULT_DOMAIN_TRAINING, FAULT_CODE_TRAINING_TIMEOUT, receivedCount, state.samplesCount());
+}
 
-  if (receivedTrainingMsgCounter == -1) {
-    // reset
-    receivedTrainingMsgCounter = 0;
-  }
+void onReceivedReferenceTimestamp(TrainingState &state, unsigned long receivedTime, unsigned long referenceTimestamp, unsigned long connectionInterval) {
+  // Applies, if the Reference-Timestamp starts a Training.
+  state.setSamplesCount(trainingMsgsCount);
 
-  receivedTrainingMsgTimestamps[receivedTrainingMsgCounter] = receivedTime;
-  receivedReferenceTimestamps[receivedTrainingMsgCounter] = referenceTimestamp;
-  receivedTrainingMsgCounter++;
-  isSuccess = false;
-
-  if (receivedTrainingMsgCounter >= TRAINING_MSGS_COUNT) {
-    // Training complete.
-    unsigned int networkDelayTotal = 0;
-    /// `true`, when some training event fails to satisfy the Training requirements.
-    bool isTrainingValid = true;
-
-    for (int i = 1; i < TRAINING_MSGS_COUNT; i++) {
-      // We will measure latency in the number of BLE's Connection-Events between reception
-      // of the Training-Messages (which include the Reference-Timestamps).
-      //
-      // Background: The delta between the local timestamps (therefore `elapsed`) is a multiple of
-      // the BLE's Connection-Interval.
-      unsigned long elapsed = receivedTrainingMsgTimestamps[i] - receivedTrainingMsgTimestamps[i - 1];
-      unsigned long referenceDelay = receivedReferenceTimestamps[i] - receivedReferenceTimestamps[i - 1];
-
-      /// Delay in number of Connection-Events
-      int networkDelay = calculateNetworkDelay(elapsed);
-
-      Log.print(String(i - 1) + " -> " + String(i));
-      Log.print(String("\t") + "referenceDelay: " + String(referenceDelay) + " (ms)");
-      Log.print(String("\t") + "elapsed: " + String(elapsed) + " (ms)");
-      Log.println("\t-> networkDelay: " + String(networkDelay) + " (approx. number of Connection-Events)");
-
-      networkDelayTotal += networkDelay;
-
-      // ensure Training Requirement: elapsed
-      // Only a single Training-Message (containing the Reference-Timestamp)
-      // is allowed for each Connection-Event.
-      int minimumElapsed = CONNECTION_INTERVAL / 2;
-      if (elapsed < minimumElapsed) {
-        Log.print("EXCEPTION: ^^ Minimum delay not satisfied");
-        Log.print(" (elapsed=" + String(elapsed) + ")!");
-        Log.println(" Will invalidate this Training attempt.");
-
-        isTrainingValid = false;
-      }
-
-      // ensure Training Requirement: referenceDelay
-      int maximumReferenceDelay = CONNECTION_INTERVAL + (CONNECTION_INTERVAL / 2);
-      if (referenceDelay >= maximumReferenceDelay) {
-        Log.print("EXCEPTION: ^^ Maximum Reference Delay exceeded");
-        Log.print(" (referenceDelay=" + String(referenceDelay) + ")!");
-        Log.println(" Will invalidate this Training attempt.");
-
-        isTrainingValid = false;
-      }
-    }
-
-    // For starters we will simply opt for the cumulative average (this may be improved...)
-    int networkDelay = networkDelayTotal / (float)(TRAINING_MSGS_COUNT - 1); // number of Connection-Events
-    Log.print("networkDelay (cumulative avg): ");
-    Log.print(networkDelay);
-    Log.println(" (number of Connection-Events)");
-
-    if (isTrainingValid) {
-      // Note: We'll only add half the delay (1/2 * networkDelay) for the last connection-interval.
-      //
-      // This is an approximation as we don't know when exactly the Reference-Timestamp was created
-      // in the interval of the Connection-Interval of its transmission (when working on Application Level).
-      if (networkDelay > 0) {
-        adjustedReferenceTimestamp = referenceTimestamp
-          + ((networkDelay - 1) * CONNECTION_INTERVAL)
-          + (CONNECTION_INTERVAL / 2);
-      } else {
-        // This case should not be possible. But hey, for the sake of completeness:
-        adjustedReferenceTimestamp = referenceTimestamp;
-      }
-
-      // Correct delay since receival
-      unsigned long now = getTimePtr();
-      adjustedReferenceTimestamp += now - receivedTime;
-    }
-
-    isSuccess = isTrainingValid;
-    // reset
-    receivedTrainingMsgCounter = 0;
+  if (state.onReceivedReferenceTimestamp(receivedTime, referenceTimestamp, connectionInterval)) {
+    logTraining(state);
   }
 }
 
-TrainingStatus trainingStatus(void) {
-  trainingStatusCode_t statusCode;
-  if (receivedTrainingMsgCounter == -1) {
-    statusCode = trainingNotStarted;
-  }
-  else if (receivedTrainingMsgCounter == 0) {
-    statusCode = isSuccess ? trainingSucceeded : trainingFailed;
-  }
-  else {
-    statusCode = trainingPending;
-  }
+bool isReferenceTimestampConsistent(unsigned long referenceTimestamp, unsigned long syncedReceivedTime, unsigned long connectionInterval) {
+  // The Reference-Timestamp was queued by the Central for 1/2 Connection-Interval
+  // on average (s. Training) - but this can't be narrowed down for a single one.
+  unsigned long expected = referenceTimestamp + connectionInterval / 2000UL;
+  unsigned long tolerance = connectionInterval / 2000UL + SYNC_VERIFICATION_TOLERANCE;
+
+  long deviation = (long)(syncedReceivedTime - expected);
+  Log.print("Verifying restored sync: deviation: ");
+  Log.print(deviation);
+  Log.print(" ms (tolerance: ");
+  Log.print(tolerance);
+  Log.println(" ms)");
+
+  return (unsigned long)abs(deviation) <= tolerance;
+}
 
-  struct TrainingStatus status = {
-    statusCode,
-    adjustedReferenceTimestamp
-  };
-  return status;
+TrainingStatus trainingStatus(TrainingState &state) {
+  return state.status();
 }
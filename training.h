@@ -1,30 +1,44 @@
 /*
   Training (Time-Sync)
+
+  The firmware's Training (s. trainingEngine.h for its math): The Reference-Timestamps
+  of a Training are timestamped by the local time (`millisRtc()`), their number is set
+  by the configuration (s. config.h) and the Connection-Interval is negotiated per
+  connection. Logs the Trainings completed (or timed out).
 */
 
 #ifndef training_h
 #define training_h
 
-typedef unsigned long (*getExternalTime)();
-
-typedef enum {
-  trainingNotStarted,
-  trainingPending,
-  trainingSucceeded,
-  trainingFailed
-} trainingStatusCode_t;
+#include "constants.h"
+#include "trainingEngine.h"
 
-struct TrainingStatus {
-  trainingStatusCode_t statusCode;
-  unsigned long adjustedReferenceTimestamp;
+/// Clock policy of the firmware's Training: The local time (`millisRtc()`).
+struct RtcTrainingClock {
+  static unsigned long now(void);
 };
 
-void setTimeProvider(getExternalTime getTimeFunction);
+typedef TrainingEngine<DefaultTrainingParameters, RtcTrainingClock> FirmwareTrainingEngine;
+
+/// State of the Training with a single Central.
+typedef FirmwareTrainingEngine TrainingState;
+
+/// Sets the number of Reference-Timestamps of a Training (default: `TRAINING_MSGS_COUNT_DEFAULT`,
+/// at most `CONFIG_TRAINING_MSGS_COUNT_MAX`): Applies from the next Training started.
+void setTrainingMsgsCount(int count);
+
+void initTraining(TrainingState &state);
 
 /// Discards (ongoing) Time-Sync/Training, if a certain timeout-duration has elapsed
 /// since receiving the last Training-Msg.
-void setTrainingTimeoutIfNeeded(void);
-void onReceivedReferenceTimestamp(unsigned long receivedTime, unsigned long referenceTimestamp);
-TrainingStatus trainingStatus(void);
+void setTrainingTimeoutIfNeeded(TrainingState &state);
+/// - `connectionInterval`: The (negotiated) Connection-Interval in µs of the
+///   connection the Reference-Timestamp was received on.
+void onReceivedReferenceTimestamp(TrainingState &state, unsigned long receivedTime, unsigned long referenceTimestamp, unsigned long connectionInterval);
+TrainingStatus trainingStatus(TrainingState &state);
+
+/// Returns `true`, if a single Reference-Timestamp is consistent with the synced time
+/// `syncedReceivedTime` at its reception.
+bool isReferenceTimestampConsistent(unsigned long referenceTimestamp, unsigned long syncedReceivedTime, unsigned long connectionInterval);
 
 #endif /* training_h */
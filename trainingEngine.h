@@ -0,0 +1,297 @@
+/*
+  Training-Engine
+
+  The math of the Training (s. training.h) as a class template: Estimates the Central's
+  time from a series of Reference-Timestamps, each received on a Connection-Event, by
+  the number of Connection-Events they have been queued for (the network delay).
+
+  Specialized at compile time by its parameters (s. `DefaultTrainingParameters`) and by
+  a clock policy providing the local time (a type with a static `now()`, in ms): A
+  number of Reference-Timestamps or a Connection-Interval fixed by the parameters turns
+  the divisions by them into divisions by constants. The state has a fixed size (no
+  heap) and does not log: The firmware instantiates `FirmwareTrainingEngine` (s.
+  training.h), the host tools instantiate others to compare their accuracy and cost (s.
+  `signalboy-trainbench`).
+
+  This header does not depend on the Arduino core: It is shared with the host tools
+  (s. `Host/`).
+*/
+
+#ifndef trainingEngine_h
+#define trainingEngine_h
+
+#include <stdint.h>
+#include "configFormat.h"
+
+typedef enum {
+  trainingNotStarted,
+  trainingPending,
+  trainingSucceeded,
+  trainingFailed
+} trainingStatusCode_t;
+
+struct TrainingStatus {
+  trainingStatusCode_t statusCode;
+  unsigned long adjustedReferenceTimestamp;
+  /// Uncertainty (in µs) of `adjustedReferenceTimestamp`.
+  unsigned long uncertainty;
+  /// Number of Reference-Timestamps `adjustedReferenceTimestamp` has been estimated of
+  /// (0, unless the Training succeeded).
+  unsigned int samplesCount;
+};
+
+/// Why the last Training failed (s. `TrainingEngine::failure()`).
+enum TrainingFailure {
+  TRAINING_FAILURE_NONE = 0,
+  /// The Connection-Interval changed during the Training (or is unknown).
+  TRAINING_FAILURE_INTERVAL_CHANGED = 1,
+  /// Training-Messages were received less than the minimum delay apart (i.e. on the
+  /// same Connection-Event).
+  TRAINING_FAILURE_MINIMUM_DELAY = 2,
+  /// The Reference-Timestamps of consecutive Training-Messages are too far apart.
+  TRAINING_FAILURE_MAXIMUM_REFERENCE_DELAY = 3,
+  /// Training-Messages were lost (s. `TrainingEngine::setTimeoutIfNeeded()`).
+  TRAINING_FAILURE_TIMEOUT = 4,
+};
+
+/// Parameters of the firmware's Training. Specialize others by deriving from it.
+struct DefaultTrainingParameters {
+  /// Capacity of the state: The maximum number of Reference-Timestamps of a Training.
+  static constexpr int maxSamplesCount = CONFIG_TRAINING_MSGS_COUNT_MAX;
+  /// Number of Reference-Timestamps of a Training: 0, if set at runtime (s.
+  /// `TrainingEngine::setSamplesCount()`).
+  static constexpr int samplesCount = 0;
+  /// Connection-Interval (in µs): 0, if negotiated (passed with every Reference-Timestamp).
+  static constexpr unsigned long connectionInterval = 0;
+  /// Minimum delay between Training-Messages, in Connection-Intervals: Only a single
+  /// Training-Message is allowed for each Connection-Event.
+  static constexpr unsigned long minimumElapsedNumerator = 1;
+  static constexpr unsigned long minimumElapsedDenominator = 2;
+  /// Maximum delay between consecutive Reference-Timestamps (exclusive), in
+  /// Connection-Intervals.
+  static constexpr unsigned long maximumReferenceDelayNumerator = 3;
+  static constexpr unsigned long maximumReferenceDelayDenominator = 2;
+  /// Number of Connection-Events without a Training-Message tolerated, before the
+  /// Training times out.
+  static constexpr int timeoutConnectionEvents = 1;
+  /// Resolution (in µs) of the timestamps: Added to the uncertainty (for the
+  /// Reference-Timestamp and for the time of its reception).
+  static constexpr unsigned long timestampResolution = 1000;
+};
+
+template <typename Parameters, typename Clock>
+class TrainingEngine {
+  static_assert(Parameters::maxSamplesCount >= 2, "A Training needs 2 Reference-Timestamps at least");
+  static_assert(Parameters::samplesCount == 0
+      || (Parameters::samplesCount >= 2 && Parameters::samplesCount <= Parameters::maxSamplesCount),
+    "The number of Reference-Timestamps exceeds the capacity");
+
+public:
+  TrainingEngine()
+    : m_requestedSamplesCount(Parameters::maxSamplesCount) {
+    reset();
+  }
+
+  /// Forgets every Training (`trainingNotStarted`).
+  void reset() {
+    m_receivedCount = -1;
+    m_samplesCount = samplesCountForNextTraining();
+    m_connectionInterval = 0;
+    m_adjustedReferenceTimestamp = 0;
+    m_uncertainty = 0;
+    m_networkDelay = 0;
+    m_failure = TRAINING_FAILURE_NONE;
+    m_isSuccess = false;
+  }
+
+  /// Sets the number of Reference-Timestamps (2 to `maxSamplesCount`): Applies from the
+  /// next Training started. Ignored, if fixed by the parameters.
+  void setSamplesCount(int count) {
+    m_requestedSamplesCount = count < 2 ? 2 : (count > Parameters::maxSamplesCount ? Parameters::maxSamplesCount : count);
+  }
+
+  /// Number of Reference-Timestamps of the ongoing (or last) Training.
+  int samplesCount() const {
+    return Parameters::samplesCount ? Parameters::samplesCount : m_samplesCount;
+  }
+
+  /// Discards the ongoing Training, if Training-Messages were lost (none received for
+  /// more than `timeoutConnectionEvents` Connection-Events). Returns `true`, if discarded.
+  bool setTimeoutIfNeeded() {
+    if (m_receivedCount <= 0) return false;
+
+    unsigned long elapsed = Clock::now() - m_receivedTimes[m_receivedCount - 1];
+    if (networkDelay(elapsed, m_connectionInterval) <= Parameters::timeoutConnectionEvents) return false;
+
+    m_failure = TRAINING_FAILURE_TIMEOUT;
+    m_isSuccess = false;
+    m_receivedCount = 0;
+    return true;
+  }
+
+  /// Adds a Reference-Timestamp received at local time `receivedTime` on a connection
+  /// with a Connection-Interval of `connectionInterval` µs. Returns `true`, if it
+  /// completed the Training (s. `status()`).
+  bool onReceivedReferenceTimestamp(unsigned long receivedTime, unsigned long referenceTimestamp, unsigned long connectionInterval) {
+    connectionInterval = interval(connectionInterval);
+
+    if (m_receivedCount <= 0) {
+      // Training started.
+      m_receivedCount = 0;
+      m_samplesCount = samplesCountForNextTraining();
+      m_connectionInterval = connectionInterval;
+    }
+
+    m_receivedTimes[m_receivedCount] = receivedTime;
+    m_referenceTimestamps[m_receivedCount] = referenceTimestamp;
+    m_receivedCount++;
+    m_isSuccess = false;
+
+    if (m_receivedCount < samplesCount()) return false;
+
+    // Training complete.
+    m_failure = TRAINING_FAILURE_NONE;
+    unsigned int networkDelayTotal = 0;
+    /// Maximum deviation (in µs) of `elapsed` from a multiple of the Connection-Interval.
+    unsigned long maximumResidual = 0;
+
+    // The Training's math relies on a constant Connection-Interval.
+    if (connectionInterval == 0 || connectionInterval != m_connectionInterval) {
+      m_failure = TRAINING_FAILURE_INTERVAL_CHANGED;
+    }
+
+    const unsigned long minimumElapsed = connectionInterval * Parameters::minimumElapsedNumerator / Parameters::minimumElapsedDenominator;
+    const unsigned long maximumReferenceDelay = connectionInterval * Parameters::maximumReferenceDelayNumerator / Parameters::maximumReferenceDelayDenominator;
+
+    for (int i = 1; i < samplesCount(); i++) {
+      // The delta between the local timestamps (`elapsed`) is a multiple of the
+      // Connection-Interval.
+      unsigned long elapsed = m_receivedTimes[i] - m_receivedTimes[i - 1];
+      unsigned long referenceDelay = m_referenceTimestamps[i] - m_referenceTimestamps[i - 1];
+
+      int delay = networkDelay(elapsed, connectionInterval);
+      networkDelayTotal += delay;
+
+      long residual = (long)(elapsed * 1000UL - delay * connectionInterval);
+      unsigned long absoluteResidual = residual < 0 ? -residual : residual;
+      if (absoluteResidual > maximumResidual) maximumResidual = absoluteResidual;
+
+      if (m_failure == TRAINING_FAILURE_NONE && elapsed * 1000UL < minimumElapsed) {
+        m_failure = TRAINING_FAILURE_MINIMUM_DELAY;
+      }
+      if (m_failure == TRAINING_FAILURE_NONE && referenceDelay * 1000UL >= maximumReferenceDelay) {
+        m_failure = TRAINING_FAILURE_MAXIMUM_REFERENCE_DELAY;
+      }
+    }
+
+    // For starters we will simply opt for the cumulative average (this may be improved...)
+    m_networkDelay = networkDelayTotal / (unsigned int)(samplesCount() - 1);
+
+    if (m_failure == TRAINING_FAILURE_NONE) {
+      // Only half the delay is added for the last Connection-Interval: When exactly the
+      // Reference-Timestamp was created within it is unknown (on application level).
+      if (m_networkDelay > 0) {
+        m_adjustedReferenceTimestamp = referenceTimestamp
+          + (((m_networkDelay - 1) * connectionInterval) + (connectionInterval / 2)) / 1000UL;
+      } else {
+        m_adjustedReferenceTimestamp = referenceTimestamp;
+      }
+
+      // Correct the delay since the reception.
+      m_adjustedReferenceTimestamp += Clock::now() - receivedTime;
+      m_uncertainty = uncertainty(connectionInterval, maximumResidual);
+    }
+
+    m_isSuccess = m_failure == TRAINING_FAILURE_NONE;
+    m_receivedCount = 0;
+    return true;
+  }
+
+  TrainingStatus status() const {
+    trainingStatusCode_t statusCode;
+    if (m_receivedCount == -1) {
+      statusCode = trainingNotStarted;
+    } else if (m_receivedCount == 0) {
+      statusCode = m_isSuccess ? trainingSucceeded : trainingFailed;
+    } else {
+      statusCode = trainingPending;
+    }
+
+    return {
+      statusCode,
+      m_adjustedReferenceTimestamp,
+      m_uncertainty,
+      statusCode == trainingSucceeded ? (unsigned int)samplesCount() : 0U
+    };
+  }
+
+  /// Number of Reference-Timestamps received by the ongoing Training (0, if none is).
+  int receivedCount() const { return m_receivedCount > 0 ? m_receivedCount : 0; }
+  /// Why the last Training failed (`TRAINING_FAILURE_NONE`, if it succeeded).
+  TrainingFailure failure() const { return m_failure; }
+  /// Network delay (in Connection-Events, averaged) of the last Training completed.
+  int networkDelay() const { return m_networkDelay; }
+  /// Connection-Interval (in µs) of the ongoing (or last) Training.
+  unsigned long connectionInterval() const { return m_connectionInterval; }
+
+  /// The Reference-Timestamps of the ongoing (or last) Training and their local times of
+  /// reception (`index` < `samplesCount()`).
+  unsigned long referenceTimestamp(int index) const { return m_referenceTimestamps[index]; }
+  unsigned long receivedTime(int index) const { return m_receivedTimes[index]; }
+
+  /// The network delay (in Connection-Events) of a Training-Message received `elapsed`
+  /// ms after the previous one (rounded).
+  static int networkDelay(unsigned long elapsed, unsigned long connectionInterval) {
+    connectionInterval = interval(connectionInterval);
+    if (connectionInterval == 0) return 0;
+
+    unsigned long elapsedMicros = elapsed * 1000UL;
+    int delay = elapsedMicros / connectionInterval;
+    // The received time is not exactly the Connection-Event's on application level:
+    // The network delay is an approximation.
+    if (elapsedMicros % connectionInterval >= connectionInterval / 2) {
+      delay++;
+    }
+
+    return delay;
+  }
+
+private:
+  /// - value == -1 initially (no training attempt started, yet)
+  /// - value > 0 during Training
+  /// - value == 0 after at least one Training finished and while no new Training started
+  int m_receivedCount;
+  int m_samplesCount;
+  int m_requestedSamplesCount;
+
+  unsigned long m_referenceTimestamps[Parameters::maxSamplesCount];
+  unsigned long m_receivedTimes[Parameters::maxSamplesCount];
+
+  unsigned long m_connectionInterval;
+  unsigned long m_adjustedReferenceTimestamp;
+  /// Uncertainty (in µs) of `m_adjustedReferenceTimestamp` (s. `uncertainty()`).
+  unsigned long m_uncertainty;
+  int m_networkDelay;
+  TrainingFailure m_failure;
+  /// `true`, if the last Training was finished successfully.
+  bool m_isSuccess;
+
+  int samplesCountForNextTraining() const {
+    return Parameters::samplesCount ? Parameters::samplesCount : m_requestedSamplesCount;
+  }
+
+  /// Bound (in µs) of the error of the adjusted Reference-Timestamp: When the last one
+  /// was created within its Connection-Interval is unknown (half the interval either
+  /// way), the receptions deviate from the Connection-Events by up to the maximum
+  /// residual (queueing and jitter), and the Reference-Timestamp and the reception are
+  /// truncated to the resolution.
+  static unsigned long uncertainty(unsigned long connectionInterval, unsigned long maximumResidual) {
+    return connectionInterval / 2 + maximumResidual + 2 * Parameters::timestampResolution;
+  }
+
+  static unsigned long interval(unsigned long connectionInterval) {
+    return Parameters::connectionInterval ? Parameters::connectionInterval : connectionInterval;
+  }
+};
+
+#endif /* trainingEngine_h */
@@ -0,0 +1,170 @@
+#include <Arduino.h>
+#include "watchdog.h"
+#include "Logger.hpp"
+#include "rtc.hpp"
+#include "scheduler.h"
+
+#ifdef WATCHDOG
+
+// Early warning and reset (in cycles of the WDT's clock: 1.024 kHz)
+#define WARNING_OFFSET WDT_EWCTRL_EWOFFSET_256
+#define RESET_PERIOD WDT_CONFIG_PER_2K
+// Generic clock of the WDT: OSCULP32K divided by 2^(4 + 1)
+#define WATCHDOG_GCLK 2
+#define WATCHDOG_GCLK_DIVIDER 4
+
+// Marks the stalls kept in RAM as valid ("STAL").
+#define PERSISTENT_MAGIC 0x4c415453
+
+struct PersistentStalls {
+  uint32_t magic;
+  StallReport report;
+  uint32_t checksum;
+};
+
+// Not initialized at startup: Survives a reset (s. watchdog.h).
+static PersistentStalls persistentStalls __attribute__((section(".noinit")));
+
+volatile uint8_t watchdogTasks[WATCHDOG_MAX_TASK_DEPTH];
+volatile uint8_t watchdogTaskDepth = 0;
+
+// Time (`millis()`) of the last check-in
+static volatile unsigned long checkInTime = 0;
+// The early warning has captured a stall the loop has not recovered from, yet.
+static volatile bool isStalled = false;
+
+static uint32_t checksum(const StallReport &report) {
+  const uint8_t *bytes = (const uint8_t *)&report;
+  uint32_t sum = PERSISTENT_MAGIC;
+  for (size_t i = 0; i < sizeof(report); i++) {
+    sum = ((sum << 5) | (sum >> 27)) ^ bytes[i];
+  }
+
+  return sum;
+}
+
+static void updateChecksum(void) {
+  persistentStalls.checksum = checksum(persistentStalls.report);
+}
+
+static void countStall(uint8_t cause) {
+  if (persistentStalls.report.stallsCount[cause] < 0xffff) persistentStalls.report.stallsCount[cause]++;
+}
+
+void setupWatchdog(void) {
+  if (persistentStalls.magic != PERSISTENT_MAGIC || persistentStalls.checksum != checksum(persistentStalls.report)) {
+    // Power-on (or overwritten)
+    memset(&persistentStalls, 0, sizeof(persistentStalls));
+    persistentStalls.magic = PERSISTENT_MAGIC;
+  }
+
+  if (PM->RCAUSE.bit.WDT) {
+    countStall(STALL_CAUSE_RESET);
+
+    Log.printTimestamp();
+    Log.print("WARNING: Reset by the watchdog");
+    const StallReport &report = persistentStalls.report;
+    if (report.hasLastStall && report.lastStall.duration == STALL_DURATION_UNRECOVERED) {
+      Log.print(" (stalled in " + String(getStallTaskName(report.lastStall.task)) + ", pc 0x"
+        + String(report.lastStall.pc, HEX) + ")");
+    }
+    Log.println("!");
+  }
+  updateChecksum();
+
+  GCLK->GENDIV.reg = GCLK_GENDIV_ID(WATCHDOG_GCLK) | GCLK_GENDIV_DIV(WATCHDOG_GCLK_DIVIDER);
+  GCLK->GENCTRL.reg = GCLK_GENCTRL_ID(WATCHDOG_GCLK) | GCLK_GENCTRL_GENEN | GCLK_GENCTRL_SRC_OSCULP32K | GCLK_GENCTRL_DIVSEL;
+  while (GCLK->STATUS.bit.SYNCBUSY);
+  GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID_WDT | GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN(WATCHDOG_GCLK);
+
+  WDT->CTRL.reg = 0;
+  while (WDT->STATUS.bit.SYNCBUSY);
+  WDT->CONFIG.reg = RESET_PERIOD;
+  WDT->EWCTRL.reg = WARNING_OFFSET;
+  WDT->INTFLAG.reg = WDT_INTFLAG_EW;
+  WDT->INTENSET.reg = WDT_INTENSET_EW;
+
+  NVIC_SetPriority(WDT_IRQn, 0);
+  NVIC_EnableIRQ(WDT_IRQn);
+
+  checkInTime = millis();
+  WDT->CTRL.reg = WDT_CTRL_ENABLE;
+  while (WDT->STATUS.bit.SYNCBUSY);
+}
+
+void feedWatchdog(void) {
+  // Clearing while synchronizing would stall the bus: The loop checks in again soon.
+  if (!WDT->STATUS.bit.SYNCBUSY) {
+    WDT->CLEAR.reg = WDT_CLEAR_CLEAR_KEY;
+  }
+
+  unsigned long time = millis();
+  if (isStalled) {
+    noInterrupts();
+    StallContext &stall = persistentStalls.report.lastStall;
+    stall.duration = time - checkInTime;
+    isStalled = false;
+    updateChecksum();
+    interrupts();
+
+    Log.printTimestamp();
+    Log.println("WARNING: Loop stalled for " + String(stall.duration) + "ms in "
+      + String(getStallTaskName(stall.task)) + " (" + String(getStallCauseName(stall.cause))
+      + ", pc 0x" + String(stall.pc, HEX) + ")!");
+  }
+  checkInTime = time;
+}
+
+StallReport stallReport(void) {
+  noInterrupts();
+  StallReport report = persistentStalls.report;
+  interrupts();
+
+  return report;
+}
+
+// Captures the context of the stall. `frame`: The registers stacked on entry of the
+// exception (r0-r3, r12, lr, pc, xPSR).
+extern "C" void onWatchdogEarlyWarning(uint32_t *frame) {
+  WDT->INTFLAG.reg = WDT_INTFLAG_EW;
+  if (isStalled) return;
+
+  StallContext &stall = persistentStalls.report.lastStall;
+  uint8_t depth = watchdogTaskDepth;
+  if (depth > WATCHDOG_MAX_TASK_DEPTH) depth = WATCHDOG_MAX_TASK_DEPTH;
+  stall.task = depth > 0 ? watchdogTasks[depth - 1] : STALL_TASK_NONE;
+  stall.lr = frame[5];
+  stall.pc = frame[6];
+
+  // The exception number of the interrupted code (0: thread mode, i.e. the loop)
+  if ((frame[7] & 0x3f) != 0) {
+    stall.cause = STALL_CAUSE_INTERRUPT;
+  } else if (stall.task != STALL_TASK_NONE && stall.task >= TRACE_POINT_CALLBACK_FIRST) {
+    stall.cause = STALL_CAUSE_CALLBACK;
+  } else {
+    stall.cause = STALL_CAUSE_TASK;
+  }
+
+  // `millisRtc()` updates its state: Not safe to call, if the loop was interrupted in it.
+  stall.time = millisFromRtcTicks(rtcTicks());
+  stall.duration = STALL_DURATION_UNRECOVERED;
+  unsigned long deadline = 0;
+  stall.armedTimersCount = armedTimersCount();
+  stall.nextTimerDeadline = nextTimerDeadline(stall.time, &deadline) ? deadline : 0;
+
+  persistentStalls.report.hasLastStall = 1;
+  countStall(stall.cause);
+  updateChecksum();
+  isStalled = true;
+}
+
+// Replaces the weak handler of the core. The core runs on the main stack only.
+extern "C" __attribute__((naked)) void WDT_Handler(void) {
+  __asm volatile(
+    "mrs r0, msp\n"
+    "ldr r1, =onWatchdogEarlyWarning\n"
+    "bx r1\n"
+    ".ltorg\n");
+}
+
+#endif /* WATCHDOG */
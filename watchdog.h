@@ -0,0 +1,74 @@
+/*
+  Watchdog
+
+  Detects stalls of the loop: The loop checks in on every run (s. `feedWatchdog()`).
+  Once it has not checked in for ~250 ms, the early warning of the WDT captures the
+  context of the stall (s. stall.h): The task the loop is in (marked by the trace
+  points, s. trace.h), the program counter of the stalled code and the state of the
+  timers. Once the loop checks in again, the stall is logged. If it does not recover
+  within ~2 s, the WDT resets the Signalboy.
+
+  The context and the number of stalls by cause are kept in RAM that is not
+  initialized at startup (`.noinit`): They survive the reset (not a power cycle) and
+  are read by the host via `SERIAL_MSG_READ_STALLS` (s. `signalboy-cli stalls`). They
+  are validated by a checksum: If overwritten (i.e. by the bootloader), they are
+  cleared.
+
+  The early warning has the highest priority: It preempts the loop and ISRs of lower
+  priority, but not ISRs of the same priority (most of the core's): A stall in those
+  ends in the reset, without its context.
+
+  Enabled by defining `WATCHDOG` (s. `Globals.hpp`): Otherwise, the loop is not
+  watched.
+*/
+
+#ifndef watchdog_h
+#define watchdog_h
+
+#include <stdint.h>
+#include "Globals.hpp"
+#include "stall.h"
+#include "traceEvents.h"
+
+// Maximum depth of nested tasks tracked (i.e. a callback of a task).
+#define WATCHDOG_MAX_TASK_DEPTH 4
+
+#ifdef WATCHDOG
+
+/// Starts the WDT. Counts a reset by the WDT as `STALL_CAUSE_RESET`.
+void setupWatchdog(void);
+
+/// Checks in the loop: Must be called on every run.
+void feedWatchdog(void);
+
+/// The number of stalls by cause and the context of the last one.
+StallReport stallReport(void);
+
+extern volatile uint8_t watchdogTasks[WATCHDOG_MAX_TASK_DEPTH];
+extern volatile uint8_t watchdogTaskDepth;
+
+/// Marks the begin of a task of the loop (`point`: s. `TracePoint`): ISRs are ignored.
+inline void beginWatchdogTask(uint8_t point) {
+  if (point >= TRACE_POINT_ISR_FIRST) return;
+
+  if (watchdogTaskDepth < WATCHDOG_MAX_TASK_DEPTH) watchdogTasks[watchdogTaskDepth] = point;
+  watchdogTaskDepth++;
+}
+
+inline void endWatchdogTask(uint8_t point) {
+  if (point >= TRACE_POINT_ISR_FIRST) return;
+
+  if (watchdogTaskDepth > 0) watchdogTaskDepth--;
+}
+
+#else
+
+inline void setupWatchdog(void) {}
+inline void feedWatchdog(void) {}
+inline StallReport stallReport(void) { return StallReport{}; }
+inline void beginWatchdogTask(uint8_t point) {}
+inline void endWatchdogTask(uint8_t point) {}
+
+#endif /* WATCHDOG */
+
+#endif /* watchdog_h */
@@ -0,0 +1,61 @@
+#include <Arduino.h>
+#include "wiredSync.h"
+#include "constants.h"
+#include "Globals.hpp"
+#include "Logger.hpp"
+#include "faultLog.h"
+#include "rtc.hpp"
+
+// Number of recent edges available for pairing.
+#define WIRED_SYNC_EDGES_COUNT 4
+
+/// Local times (unsynced) of the edges.
+static unsigned long edges[WIRED_SYNC_EDGES_COUNT];
+static int edgesCount = 0;
+static int nextEdgeIndex = 0;
+
+static unsigned long lastEdgeTime = 0;
+
+void onWiredSyncEdge(const CaptureEvent &event) {
+  if (!event.isRisingEdge) return;
+
+  if (!isWiredSyncSignalPresent()) {
+    Log.printTimestamp();
+    Log.println("Wired-Sync signal detected.");
+  }
+
+  edges[nextEdgeIndex] = event.localTime;
+  nextEdgeIndex = (nextEdgeIndex + 1) % WIRED_SYNC_EDGES_COUNT;
+  edgesCount = min(edgesCount + 1, WIRED_SYNC_EDGES_COUNT);
+
+  lastEdgeTime = event.localTime;
+}
+
+void initWiredSyncPairing(WiredSyncPairing &pairing) {
+  pairing = { false, 0 };
+}
+
+bool pairWiredReferenceTimestamp(WiredSyncPairing &pairing, unsigned long receivedTime, unsigned long *edgeTime) {
+  // Most recent edge first
+  for (int i = 1; i <= edgesCount; i++) {
+    unsigned long time = edges[(nextEdgeIndex - i + WIRED_SYNC_EDGES_COUNT) % WIRED_SYNC_EDGES_COUNT];
+
+    long age = (long)(receivedTime - time);
+    if (age < 0) continue;
+    // Older edges are ambiguous (i.e. the previous pulse), as is the edge the Central paired already.
+    if (age > (long)WIRED_SYNC_PAIRING_WINDOW || (pairing.hasPairedEdge && time == pairing.edgeTime)) break;
+
+    pairing = { true, time };
+    *edgeTime = time;
+    return true;
+  }
+
+  Log.printTimestamp();
+  Log.println("WARNING: Wired-Reference-Timestamp without a matching edge! Ignoring.");
+  reportFault(FAULT_DOMAIN_CAPTURE, FAULT_CODE_WIRED_SYNC_UNPAIRED);
+  return false;
+}
+
+bool isWiredSyncSignalPresent(void) {
+  return edgesCount > 0 && millisRtc(false) - lastEdgeTime < WIRED_SYNC_TIMEOUT;
+}
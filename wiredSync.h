@@ -0,0 +1,44 @@
+/*
+  Wired-Sync
+
+  Alternative sync source for stationary setups: A host emits a pulse (i.e. PPS)
+  on the wired sync input and writes the (synced) timestamp of that pulse as
+  Wired-Reference-Timestamp. The pulse's edge is captured in hardware (s. capture.h),
+  thus pairing it with its timestamp is not affected by the latency of the radio.
+
+  While pulses are paired, the synced time is kept within the accuracy budget without
+  any Training. Once the pulses stop, the predicted uncertainty grows until a Training
+  is requested (s. time.h): The sync falls back to BLE-Training automatically.
+
+  The input is a capture pin: Its edges are recorded (s. captureEvents), unless a
+  Central is synced by the wired sync.
+*/
+
+#ifndef wiredSync_h
+#define wiredSync_h
+
+#include "capture.h"
+
+/// The edge last paired by a Central (s. `pairWiredReferenceTimestamp()`): Each pulse is
+/// paired once per Central, thus several Centrals may sync by the same pulse.
+struct WiredSyncPairing {
+  bool hasPairedEdge;
+  /// Local time (unsynced) of the edge last paired.
+  unsigned long edgeTime;
+};
+
+/// Handles an edge captured on the wired sync input.
+void onWiredSyncEdge(const CaptureEvent &event);
+
+/// Resets the edge last paired by a Central (i.e. on its connection).
+void initWiredSyncPairing(WiredSyncPairing &pairing);
+
+/// Pairs the Wired-Reference-Timestamp (received at local time `receivedTime`) with
+/// the most recent edge not paired by the Central (`pairing`), yet. Returns `true` and
+/// sets `edgeTime` to the local time (unsynced) of the edge, if an edge has been paired.
+bool pairWiredReferenceTimestamp(WiredSyncPairing &pairing, unsigned long receivedTime, unsigned long *edgeTime);
+
+/// `true`, if an edge has been captured within `WIRED_SYNC_TIMEOUT`.
+bool isWiredSyncSignalPresent(void);
+
+#endif /* wiredSync_h */